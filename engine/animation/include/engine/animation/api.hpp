@@ -1,9 +1,11 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <iosfwd>
 #include <limits>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -103,6 +105,24 @@ struct AnimationBlendTree {
     std::vector<BlendTreeParameter> parameters;
 };
 
+// Joint poses in structure-of-arrays form, as passed to the batched math kernels.
+struct PoseComponents {
+    std::vector<math::vec3> translations;
+    std::vector<math::quat> rotations;
+    std::vector<math::vec3> scales;
+};
+
+// Working buffers of pose evaluation. Keep one per evaluating thread (one per character in a crowd update
+// loop, say) and pass it to evaluate_controller/evaluate_blend_tree so repeated evaluations reuse its capacity.
+struct PoseEvaluationScratch {
+    PoseComponents lhs;
+    PoseComponents rhs;
+    PoseComponents blended;
+    std::vector<float> weights;
+    std::vector<std::uint8_t> interpolated;
+    std::vector<std::optional<AnimationRigPose>> node_poses;
+};
+
 [[nodiscard]] ENGINE_ANIMATION_API std::string_view module_name() noexcept;
 
 ENGINE_ANIMATION_API void sort_keyframes(JointTrack& track);
@@ -138,6 +158,8 @@ ENGINE_ANIMATION_API void save_clip_json(const AnimationClip& clip,
 ENGINE_ANIMATION_API void advance_controller(AnimationController& controller, double dt) noexcept;
 
 [[nodiscard]] ENGINE_ANIMATION_API AnimationRigPose evaluate_controller(const AnimationController& controller);
+[[nodiscard]] ENGINE_ANIMATION_API AnimationRigPose evaluate_controller(const AnimationController& controller,
+                                                                       PoseEvaluationScratch& scratch);
 
 [[nodiscard]] ENGINE_ANIMATION_API AnimationController make_linear_controller(AnimationClip clip);
 
@@ -210,6 +232,8 @@ ENGINE_ANIMATION_API void advance_blend_tree(AnimationBlendTree& tree, double dt
 [[nodiscard]] ENGINE_ANIMATION_API bool blend_tree_valid(const AnimationBlendTree& tree) noexcept;
 
 [[nodiscard]] ENGINE_ANIMATION_API AnimationRigPose evaluate_blend_tree(const AnimationBlendTree& tree);
+[[nodiscard]] ENGINE_ANIMATION_API AnimationRigPose evaluate_blend_tree(const AnimationBlendTree& tree,
+                                                                       PoseEvaluationScratch& scratch);
 
 }  // namespace engine::animation
 
@@ -5,6 +5,7 @@
 #include <iterator>
 #include <limits>
 #include <optional>
+#include <span>
 #include <unordered_map>
 
 namespace engine::animation {
@@ -18,10 +19,6 @@ constexpr float weight_max = 1.0F;
 
 using PoseMap = std::unordered_map<std::string, JointPose>;
 
-[[nodiscard]] math::vec3 lerp(const math::vec3& a, const math::vec3& b, float t) {
-    return a + (b - a) * t;
-}
-
 [[nodiscard]] PoseMap to_pose_map(const AnimationRigPose& pose) {
     PoseMap map;
     map.reserve(pose.joints.size());
@@ -43,12 +40,76 @@ using PoseMap = std::unordered_map<std::string, JointPose>;
     return pose;
 }
 
-[[nodiscard]] JointPose blend_joint_pose(const JointPose& lhs, const JointPose& rhs, float weight) {
-    JointPose blended;
-    blended.translation = lerp(lhs.translation, rhs.translation, weight);
-    blended.scale = lerp(lhs.scale, rhs.scale, weight);
-    blended.rotation = math::normalize(math::slerp(lhs.rotation, rhs.rotation, weight));
-    return blended;
+// resize() keeps capacity, so scratch components stop allocating once they have seen the largest pose.
+void resize_components(PoseComponents& components, std::size_t count) {
+    components.translations.resize(count);
+    components.rotations.resize(count);
+    components.scales.resize(count);
+}
+
+void set_component(PoseComponents& components, std::size_t index, const JointPose& pose) {
+    components.translations[index] = pose.translation;
+    components.rotations[index] = pose.rotation;
+    components.scales[index] = pose.scale;
+}
+
+[[nodiscard]] JointPose get_component(const PoseComponents& components, std::size_t index) {
+    return JointPose{components.translations[index], components.rotations[index], components.scales[index]};
+}
+
+template <typename Weight>
+void blend_pose_components(const PoseComponents& lhs,
+                           const PoseComponents& rhs,
+                           Weight weight,
+                           PoseComponents& out) {
+    math::lerp<float, 3>(lhs.translations, rhs.translations, weight, out.translations);
+    math::lerp<float, 3>(lhs.scales, rhs.scales, weight, out.scales);
+    math::slerp<float>(lhs.rotations, rhs.rotations, weight, out.rotations);
+    for (auto& rotation : out.rotations) {
+        rotation = math::normalize(rotation);
+    }
+}
+
+struct TrackSegment {
+    const JointPose* lhs{nullptr};
+    const JointPose* rhs{nullptr};  // nullptr: lhs is returned unchanged
+    float t{0.0F};
+};
+
+[[nodiscard]] TrackSegment locate_segment(const JointTrack& track, double time) {
+    if (track.keyframes.empty()) {
+        return {};
+    }
+
+    if (track.keyframes.size() == 1) {
+        return {&track.keyframes.front().pose};
+    }
+
+    const double end_time = track.keyframes.back().time;
+    if (end_time <= epsilon_time) {
+        return {&track.keyframes.back().pose};
+    }
+
+    const double wrapped = [&]() {
+        const double span = end_time;
+        double t = std::fmod(time, span);
+        if (t < 0.0) {
+            t += span;
+        }
+        return t;
+    }();
+
+    for (std::size_t index = 0; index + 1 < track.keyframes.size(); ++index) {
+        const auto& lhs = track.keyframes[index];
+        const auto& rhs = track.keyframes[index + 1];
+        if (wrapped < rhs.time || index + 2 == track.keyframes.size()) {
+            const double segment = std::max(rhs.time - lhs.time, epsilon_time);
+            const double alpha = std::clamp((wrapped - lhs.time) / segment, 0.0, 1.0);
+            return {&lhs.pose, &rhs.pose, static_cast<float>(alpha)};
+        }
+    }
+
+    return {&track.keyframes.back().pose};
 }
 
 [[nodiscard]] JointPose apply_additive_pose(const JointPose& base, const JointPose& additive, float weight) {
@@ -79,7 +140,8 @@ using PoseMap = std::unordered_map<std::string, JointPose>;
 
 [[nodiscard]] AnimationRigPose blend_linear(const AnimationRigPose& lhs,
                                             const AnimationRigPose& rhs,
-                                            float weight) {
+                                            float weight,
+                                            PoseEvaluationScratch& scratch) {
     if (weight <= 0.0F) {
         return lhs;
     }
@@ -100,16 +162,24 @@ using PoseMap = std::unordered_map<std::string, JointPose>;
     accumulate(lhs_map);
     accumulate(rhs_map);
 
-    for (auto& [joint, pose] : result) {
+    // Joints missing from one side blend against the bind (default) pose.
+    resize_components(scratch.lhs, result.size());
+    resize_components(scratch.rhs, result.size());
+    resize_components(scratch.blended, result.size());
+    std::size_t index = 0;
+    for (const auto& [joint, pose] : result) {
         const auto lhs_it = lhs_map.find(joint);
         const auto rhs_it = rhs_map.find(joint);
-        if (lhs_it != lhs_map.end() && rhs_it != rhs_map.end()) {
-            pose = blend_joint_pose(lhs_it->second, rhs_it->second, weight);
-        } else if (rhs_it != rhs_map.end()) {
-            pose = blend_joint_pose(JointPose{}, rhs_it->second, weight);
-        } else if (lhs_it != lhs_map.end()) {
-            pose = blend_joint_pose(lhs_it->second, JointPose{}, weight);
-        }
+        set_component(scratch.lhs, index, lhs_it != lhs_map.end() ? lhs_it->second : JointPose{});
+        set_component(scratch.rhs, index, rhs_it != rhs_map.end() ? rhs_it->second : JointPose{});
+        ++index;
+    }
+
+    blend_pose_components(scratch.lhs, scratch.rhs, weight, scratch.blended);
+
+    index = 0;
+    for (auto& [joint, pose] : result) {
+        pose = get_component(scratch.blended, index++);
     }
 
     return to_rig_pose(std::move(result));
@@ -231,44 +301,19 @@ void sort_keyframes(JointTrack& track) {
 }
 
 JointPose sample_track(const JointTrack& track, double time) {
-    if (track.keyframes.empty()) {
+    const TrackSegment segment = locate_segment(track, time);
+    if (segment.lhs == nullptr) {
         return {};
     }
-
-    if (track.keyframes.size() == 1) {
-        return track.keyframes.front().pose;
-    }
-
-    const double end_time = track.keyframes.back().time;
-    if (end_time <= epsilon_time) {
-        return track.keyframes.back().pose;
+    if (segment.rhs == nullptr) {
+        return *segment.lhs;
     }
 
-    const double wrapped = [&]() {
-        const double span = end_time;
-        double t = std::fmod(time, span);
-        if (t < 0.0) {
-            t += span;
-        }
-        return t;
-    }();
-
-    for (std::size_t index = 0; index + 1 < track.keyframes.size(); ++index) {
-        const auto& lhs = track.keyframes[index];
-        const auto& rhs = track.keyframes[index + 1];
-        if (wrapped < rhs.time || index + 2 == track.keyframes.size()) {
-            const double segment = std::max(rhs.time - lhs.time, epsilon_time);
-            const double alpha = std::clamp((wrapped - lhs.time) / segment, 0.0, 1.0);
-            const float t = static_cast<float>(alpha);
-            JointPose result;
-            result.translation = lerp(lhs.pose.translation, rhs.pose.translation, t);
-            result.scale = lerp(lhs.pose.scale, rhs.pose.scale, t);
-            result.rotation = math::normalize(math::slerp(lhs.pose.rotation, rhs.pose.rotation, t));
-            return result;
-        }
-    }
-
-    return track.keyframes.back().pose;
+    JointPose result;
+    result.translation = math::lerp(segment.lhs->translation, segment.rhs->translation, segment.t);
+    result.scale = math::lerp(segment.lhs->scale, segment.rhs->scale, segment.t);
+    result.rotation = math::normalize(math::slerp(segment.lhs->rotation, segment.rhs->rotation, segment.t));
+    return result;
 }
 
 JointPose sample_clip(const AnimationClip& clip, std::string_view joint, double time) {
@@ -299,10 +344,35 @@ void advance_controller(AnimationController& controller, double dt) noexcept {
 }
 
 AnimationRigPose evaluate_controller(const AnimationController& controller) {
+    PoseEvaluationScratch scratch;
+    return evaluate_controller(controller, scratch);
+}
+
+AnimationRigPose evaluate_controller(const AnimationController& controller, PoseEvaluationScratch& scratch) {
+    const auto& tracks = controller.clip.tracks;
+    resize_components(scratch.lhs, tracks.size());
+    resize_components(scratch.rhs, tracks.size());
+    resize_components(scratch.blended, tracks.size());
+    scratch.weights.assign(tracks.size(), 0.0F);
+    scratch.interpolated.assign(tracks.size(), 0U);
+    // Held tracks (a single key, or none) keep their pose in lhs and skip the blend result.
+    for (std::size_t index = 0; index < tracks.size(); ++index) {
+        const TrackSegment segment = locate_segment(tracks[index], controller.playback_time);
+        set_component(scratch.lhs, index, segment.lhs != nullptr ? *segment.lhs : JointPose{});
+        if (segment.rhs != nullptr) {
+            set_component(scratch.rhs, index, *segment.rhs);
+            scratch.weights[index] = segment.t;
+            scratch.interpolated[index] = 1U;
+        }
+    }
+
+    blend_pose_components(scratch.lhs, scratch.rhs, std::span<const float>(scratch.weights), scratch.blended);
+
     AnimationRigPose pose;
-    pose.joints.reserve(controller.clip.tracks.size());
-    for (const auto& track : controller.clip.tracks) {
-        pose.joints.emplace_back(track.joint_name, sample_track(track, controller.playback_time));
+    pose.joints.reserve(tracks.size());
+    for (std::size_t index = 0; index < tracks.size(); ++index) {
+        const PoseComponents& source = scratch.interpolated[index] != 0U ? scratch.blended : scratch.lhs;
+        pose.joints.emplace_back(tracks[index].joint_name, get_component(source, index));
     }
     return pose;
 }
@@ -606,7 +676,8 @@ namespace {
 
 AnimationRigPose evaluate_node(const AnimationBlendTree& tree,
                                std::size_t index,
-                               std::vector<std::optional<AnimationRigPose>>& cache) {
+                               PoseEvaluationScratch& scratch) {
+    auto& cache = scratch.node_poses;
     if (!node_index_valid(tree, index)) {
         return {};
     }
@@ -617,14 +688,14 @@ AnimationRigPose evaluate_node(const AnimationBlendTree& tree,
     const auto& node = tree.nodes[index].data;
     AnimationRigPose pose;
     if (const auto* clip = std::get_if<BlendTreeClipNode>(&node)) {
-        pose = evaluate_controller(clip->controller);
+        pose = evaluate_controller(clip->controller, scratch);
     } else if (const auto* blend = std::get_if<BlendTreeLinearBlendNode>(&node)) {
-        const auto lhs = evaluate_node(tree, blend->lhs, cache);
-        const auto rhs = evaluate_node(tree, blend->rhs, cache);
-        pose = blend_linear(lhs, rhs, resolved_blend_weight(tree, *blend));
+        const auto lhs = evaluate_node(tree, blend->lhs, scratch);
+        const auto rhs = evaluate_node(tree, blend->rhs, scratch);
+        pose = blend_linear(lhs, rhs, resolved_blend_weight(tree, *blend), scratch);
     } else if (const auto* additive = std::get_if<BlendTreeAdditiveNode>(&node)) {
-        const auto base = evaluate_node(tree, additive->base, cache);
-        const auto delta = evaluate_node(tree, additive->additive, cache);
+        const auto base = evaluate_node(tree, additive->base, scratch);
+        const auto delta = evaluate_node(tree, additive->additive, scratch);
         pose = blend_additive(base, delta, resolved_additive_weight(tree, *additive));
     }
 
@@ -635,11 +706,17 @@ AnimationRigPose evaluate_node(const AnimationBlendTree& tree,
 }  // namespace
 
 AnimationRigPose evaluate_blend_tree(const AnimationBlendTree& tree) {
+    PoseEvaluationScratch scratch;
+    return evaluate_blend_tree(tree, scratch);
+}
+
+AnimationRigPose evaluate_blend_tree(const AnimationBlendTree& tree, PoseEvaluationScratch& scratch) {
     if (!blend_tree_valid(tree)) {
         return {};
     }
-    std::vector<std::optional<AnimationRigPose>> cache(tree.nodes.size());
-    return evaluate_node(tree, tree.root, cache);
+    scratch.node_poses.clear();
+    scratch.node_poses.resize(tree.nodes.size());
+    return evaluate_node(tree, tree.root, scratch);
 }
 
 }  // namespace engine::animation
@@ -2,6 +2,8 @@
 
 #include "engine/animation/api.hpp"
 
+#include <string>
+
 TEST(AnimationModule, ModuleNameMatchesNamespace) {
     EXPECT_EQ(engine::animation::module_name(), "animation");
     EXPECT_STREQ(engine_animation_module_name(), "animation");
@@ -25,3 +27,57 @@ TEST(AnimationModule, ControllerEvaluatesInterpolatedPose) {
     EXPECT_TRUE(root != nullptr);
     EXPECT_NEAR(root->translation[1], 0.25F, 1e-4F);
 }
+
+TEST(AnimationModule, ControllerPoseMatchesPerTrackSampling) {
+    engine::animation::AnimationClip clip;
+    clip.name = "batched";
+    for (int joint = 0; joint < 12; ++joint) {
+        engine::animation::JointTrack track;
+        track.joint_name = "joint" + std::to_string(joint);
+        const int keys = joint % 4;  // includes empty and single-key tracks
+        for (int key = 0; key < keys; ++key) {
+            engine::animation::Keyframe keyframe;
+            keyframe.time = 0.5 * key;
+            keyframe.pose.translation = engine::math::vec3{static_cast<float>(key), static_cast<float>(joint), 0.0F};
+            keyframe.pose.rotation = engine::math::normalize(
+                engine::math::angle_axis(0.4F * static_cast<float>(key + joint),
+                                         engine::math::vec3{0.0F, 1.0F, 0.0F}));
+            keyframe.pose.scale = engine::math::vec3{1.0F + 0.1F * static_cast<float>(key)};
+            track.keyframes.push_back(keyframe);
+        }
+        clip.tracks.push_back(track);
+    }
+
+    auto controller = engine::animation::make_linear_controller(std::move(clip));
+    engine::animation::advance_controller(controller, 0.3);
+    const auto pose = engine::animation::evaluate_controller(controller);
+    ASSERT_EQ(pose.joints.size(), controller.clip.tracks.size());
+    for (std::size_t index = 0; index < pose.joints.size(); ++index) {
+        const auto expected = engine::animation::sample_track(controller.clip.tracks[index], controller.playback_time);
+        const auto& actual = pose.joints[index].second;
+        EXPECT_EQ(actual.translation, expected.translation);
+        EXPECT_EQ(actual.scale, expected.scale);
+        EXPECT_EQ(actual.rotation, expected.rotation);
+    }
+}
+
+TEST(AnimationModule, ControllerReusesEvaluationScratch) {
+    auto controller = engine::animation::make_linear_controller(engine::animation::make_default_clip());
+    engine::animation::PoseEvaluationScratch scratch;
+    engine::animation::advance_controller(controller, 0.2);
+    const auto first = engine::animation::evaluate_controller(controller, scratch);
+    const auto* translations = scratch.blended.translations.data();
+
+    engine::animation::advance_controller(controller, 0.2);
+    const auto second = engine::animation::evaluate_controller(controller, scratch);
+    EXPECT_EQ(scratch.blended.translations.data(), translations);
+
+    const auto expected = engine::animation::evaluate_controller(controller);
+    ASSERT_EQ(second.joints.size(), expected.joints.size());
+    ASSERT_FALSE(first.joints.empty());
+    for (std::size_t index = 0; index < expected.joints.size(); ++index) {
+        EXPECT_EQ(second.joints[index].first, expected.joints[index].first);
+        EXPECT_EQ(second.joints[index].second.translation, expected.joints[index].second.translation);
+        EXPECT_EQ(second.joints[index].second.rotation, expected.joints[index].second.rotation);
+    }
+}
@@ -0,0 +1,157 @@
+// Times linear blend skinning through the 3×4 palette against the per-influence Transform loop it replaced, and
+// dual-quaternion skinning of the same rig for comparison.
+//
+//     engine_geometry_skinning_benchmarks [grid cells per side = 500] [joints = 64] [repetitions = 10]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "bench_timing.hpp"
+#include "engine/animation/rigging/rig_binding.hpp"
+#include "engine/geometry/api.hpp"
+#include "engine/geometry/deform/dual_quaternion_skinning.hpp"
+#include "engine/geometry/deform/linear_blend_skinning.hpp"
+#include "engine/math/parallel.hpp"
+#include "engine/math/transform.hpp"
+
+namespace {
+
+using engine::geometry::SurfaceMesh;
+using engine::geometry::bench::report;
+using engine::geometry::bench::time_ms;
+namespace animation = engine::animation;
+namespace deform = engine::geometry::deform;
+namespace math = engine::math;
+
+SurfaceMesh make_grid(std::uint32_t cells) {
+    SurfaceMesh mesh;
+    const std::uint32_t row = cells + 1;
+    for (std::uint32_t y = 0; y <= cells; ++y) {
+        for (std::uint32_t x = 0; x <= cells; ++x) {
+            mesh.rest_positions.emplace_back(static_cast<float>(x), 0.0F, static_cast<float>(y));
+        }
+    }
+    for (std::uint32_t y = 0; y < cells; ++y) {
+        for (std::uint32_t x = 0; x < cells; ++x) {
+            const std::uint32_t a = y * row + x;
+            mesh.indices.insert(mesh.indices.end(), {a, a + row + 1, a + 1, a, a + row, a + row + 1});
+        }
+    }
+    mesh.positions = mesh.rest_positions;
+    engine::geometry::recompute_vertex_normals(mesh);
+    mesh.rest_normals = mesh.normals;
+    return mesh;
+}
+
+// Four influences per vertex on consecutive joints laid out along the grid's x axis.
+animation::RigBinding make_binding(std::size_t vertex_count, std::uint32_t cells, std::uint16_t joints) {
+    animation::RigBinding binding;
+    binding.joints.resize(joints);
+    binding.resize_vertices(vertex_count);
+    for (std::size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        const auto x = static_cast<float>(vertex % (cells + 1)) / static_cast<float>(cells + 1);
+        const auto first = static_cast<std::uint16_t>(std::min<float>(x * joints, joints - 1.0F));
+        for (std::uint16_t i = 0; i < animation::VertexBinding::kMaxInfluences; ++i) {
+            const auto joint = static_cast<std::uint16_t>(std::min(first + i, joints - 1));
+            (void)binding.vertices[vertex].add_influence(joint, 1.0F / static_cast<float>(i + 1));
+        }
+        binding.vertices[vertex].normalize_weights();
+    }
+    return binding;
+}
+
+std::vector<math::Transform<float>> make_pose(std::uint16_t joints) {
+    std::vector<math::Transform<float>> pose;
+    for (std::uint16_t joint = 0; joint < joints; ++joint) {
+        const float t = static_cast<float>(joint);
+        pose.emplace_back(math::vec3{1.0F + 0.01F * t, 1.0F, 1.0F - 0.005F * t},
+                          math::normalize(math::angle_axis(0.05F * t, math::normalize(math::vec3{0.3F, 1.0F, 0.2F}))),
+                          math::vec3{0.1F * t, std::sin(t), 0.0F});
+    }
+    return pose;
+}
+
+// The single-threaded loop that shipped before the palette rewrite: one transform_point per influence, then
+// normals recomputed from the skinned positions and a separate bounds pass.
+void legacy_apply_linear_blend_skinning(const animation::RigBinding& binding,
+                                        const std::vector<math::Transform<float>>& skinning_transforms,
+                                        SurfaceMesh& mesh) {
+    mesh.positions.resize(mesh.rest_positions.size());
+    for (std::size_t vertex = 0; vertex < mesh.rest_positions.size(); ++vertex) {
+        const auto& rest_position = mesh.rest_positions[vertex];
+        math::vec3 skinned{0.0F, 0.0F, 0.0F};
+        float accumulated_weight = 0.0F;
+        if (vertex < binding.vertices.size()) {
+            const auto& influences = binding.vertices[vertex];
+            for (std::uint8_t i = 0; i < influences.influence_count; ++i) {
+                const auto& influence = influences.influences[i];
+                if (influence.joint >= skinning_transforms.size()) {
+                    continue;
+                }
+                skinned += influence.weight * math::transform_point(skinning_transforms[influence.joint], rest_position);
+                accumulated_weight += influence.weight;
+            }
+        }
+        mesh.positions[vertex] = accumulated_weight > 0.0F ? skinned : rest_position;
+    }
+    engine::geometry::recompute_vertex_normals(mesh);
+    engine::geometry::update_bounds(mesh);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const auto cells = static_cast<std::uint32_t>(argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500UL);
+    const auto joints = static_cast<std::uint16_t>(std::max(1L, argc > 2 ? std::strtol(argv[2], nullptr, 10) : 64L));
+    const int repetitions = argc > 3 ? std::max(1, std::atoi(argv[3])) : 10;
+
+    SurfaceMesh mesh = make_grid(cells);
+    SurfaceMesh reference = mesh;
+    const animation::RigBinding binding = make_binding(mesh.rest_positions.size(), cells, joints);
+    const std::vector<math::Transform<float>> pose = make_pose(joints);
+    std::printf("%zu vertices, %u joints, %zu threads, median of %d runs\n", mesh.rest_positions.size(),
+                static_cast<unsigned>(joints), math::parallel::concurrency(), repetitions);
+
+    const double legacy = time_ms(repetitions, [&]() { legacy_apply_linear_blend_skinning(binding, pose, reference); });
+    report("per-influence transforms (previous)", legacy, legacy);
+
+    std::vector<deform::SkinningMatrix> palette(pose.size());
+    report("build_skinning_palette", time_ms(repetitions, [&]() { deform::build_skinning_palette(pose, palette); }),
+           legacy);
+    report("apply_linear_blend_skinning(palette)", time_ms(repetitions, [&]() {
+        deform::apply_linear_blend_skinning(binding, palette, mesh);
+    }), legacy);
+    report("apply_linear_blend_skinning(transforms)", time_ms(repetitions, [&]() {
+        deform::apply_linear_blend_skinning(binding, pose, mesh);
+    }), legacy);
+
+    std::vector<deform::SkinningDualQuaternion> dual_quaternions(pose.size());
+    SurfaceMesh dual_quaternion_mesh = mesh;
+    report("build_dual_quaternion_palette", time_ms(repetitions, [&]() {
+        deform::build_dual_quaternion_palette(pose, dual_quaternions);
+    }), legacy);
+    report("apply_dual_quaternion_skinning(palette)", time_ms(repetitions, [&]() {
+        deform::apply_dual_quaternion_skinning(binding, dual_quaternions, dual_quaternion_mesh);
+    }), legacy);
+
+    float position_error = 0.0F;
+    float normal_error = 0.0F;
+    for (std::size_t vertex = 0; vertex < mesh.positions.size(); ++vertex) {
+        const math::vec3 dp = mesh.positions[vertex] - reference.positions[vertex];
+        const math::vec3 dn = mesh.normals[vertex] - reference.normals[vertex];
+        position_error = std::max(position_error, std::sqrt(math::dot(dp, dp)));
+        normal_error = std::max(normal_error, std::sqrt(math::dot(dn, dn)));
+    }
+    // Skinned normals only approximate recomputed ones where neighbouring vertices blend differently, so the
+    // normal difference is reported rather than checked.
+    std::printf("  max position difference %.3g, max normal difference %.3g\n", position_error, normal_error);
+    if (position_error > 1.0e-3F) {
+        std::printf("  MISMATCH: palette positions differ from the per-influence loop\n");
+        return 1;
+    }
+    return 0;
+}
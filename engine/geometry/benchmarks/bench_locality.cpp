@@ -0,0 +1,104 @@
+// Measures what optimize_locality buys on a mesh stored in random order, as scans often are: the FIFO
+// post-transform cache miss ratio, and the time of the normal update, which walks triangles and gathers vertices.
+//
+//     engine_geometry_locality_benchmarks [grid cells per side = 1000] [repetitions = 10]
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "bench_timing.hpp"
+#include "engine/geometry/api.hpp"
+#include "engine/math/parallel.hpp"
+
+namespace {
+
+using engine::geometry::SurfaceMesh;
+using engine::geometry::bench::report;
+using engine::geometry::bench::time_ms;
+namespace math = engine::math;
+namespace utils = engine::geometry::utils;
+
+// A wavy grid with vertices and triangles shuffled.
+SurfaceMesh make_scrambled_grid(std::uint32_t cells) {
+    const std::uint32_t row = cells + 1;
+    const std::size_t vertex_count = static_cast<std::size_t>(row) * row;
+    std::mt19937 random(7);
+    std::vector<std::uint32_t> slot(vertex_count);
+    std::iota(slot.begin(), slot.end(), 0U);
+    std::shuffle(slot.begin(), slot.end(), random);
+
+    SurfaceMesh mesh;
+    mesh.positions.resize(vertex_count);
+    for (std::uint32_t y = 0; y <= cells; ++y) {
+        for (std::uint32_t x = 0; x <= cells; ++x) {
+            const float fx = static_cast<float>(x);
+            const float fy = static_cast<float>(y);
+            mesh.positions[slot[y * row + x]] = math::vec3{fx, 0.1F * std::sin(0.05F * fx) * std::cos(0.07F * fy), fy};
+        }
+    }
+    std::vector<std::array<std::uint32_t, 3>> triangles;
+    triangles.reserve(static_cast<std::size_t>(cells) * cells * 2);
+    for (std::uint32_t y = 0; y < cells; ++y) {
+        for (std::uint32_t x = 0; x < cells; ++x) {
+            const std::uint32_t a = y * row + x;
+            triangles.push_back({slot[a], slot[a + row + 1], slot[a + 1]});
+            triangles.push_back({slot[a], slot[a + row], slot[a + row + 1]});
+        }
+    }
+    std::shuffle(triangles.begin(), triangles.end(), random);
+    mesh.indices.reserve(3 * triangles.size());
+    for (const auto& triangle : triangles) {
+        mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+    }
+    return mesh;
+}
+
+void print_acmr(const char* name, const SurfaceMesh& mesh) {
+    std::printf("  %-40s %9.3f\n", name, utils::AverageCacheMissRatio(mesh.indices, mesh.positions.size()));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const auto cells = static_cast<std::uint32_t>(argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000UL);
+    const int repetitions = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+
+    const SurfaceMesh scrambled = make_scrambled_grid(cells);
+    std::printf("%zu vertices, %zu triangles, %zu threads, median of %d runs\n", scrambled.positions.size(),
+                scrambled.indices.size() / 3, math::parallel::concurrency(), repetitions);
+
+    SurfaceMesh curve_only = scrambled;
+    SurfaceMesh optimized = scrambled;
+    const double curve_ms = time_ms(1, [&]() {
+        (void)engine::geometry::optimize_locality(curve_only, {.optimize_vertex_cache = false});
+    });
+    const double optimize_ms = time_ms(1, [&]() { (void)engine::geometry::optimize_locality(optimized); });
+
+    std::printf("vertex cache miss ratio (16-entry FIFO)\n");
+    print_acmr("file order", scrambled);
+    print_acmr("Hilbert order", curve_only);
+    print_acmr("Hilbert + Tipsify", optimized);
+
+    std::printf("reordering (once)\n");
+    std::printf("  %-40s %9.3f ms\n", "optimize_locality, curve only", curve_ms);
+    std::printf("  %-40s %9.3f ms\n", "optimize_locality", optimize_ms);
+
+    std::printf("recompute_vertex_normals\n");
+    SurfaceMesh mesh = scrambled;
+    const double baseline = time_ms(repetitions, [&]() { engine::geometry::recompute_vertex_normals(mesh); });
+    report("file order", baseline, baseline);
+    report("Hilbert order", time_ms(repetitions, [&]() {
+        engine::geometry::recompute_vertex_normals(curve_only);
+    }), baseline);
+    report("Hilbert + Tipsify", time_ms(repetitions, [&]() {
+        engine::geometry::recompute_vertex_normals(optimized);
+    }), baseline);
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Times the SurfaceMesh normal and bounds updates against the serial implementations they replaced.
+//
+//     engine_geometry_benchmarks [grid cells per side = 1000] [repetitions = 10]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include "bench_timing.hpp"
+#include "engine/geometry/api.hpp"
+#include "engine/math/parallel.hpp"
+
+namespace {
+
+using engine::geometry::SurfaceMesh;
+using engine::geometry::bench::report;
+using engine::geometry::bench::time_ms;
+namespace math = engine::math;
+
+SurfaceMesh make_grid(std::uint32_t cells) {
+    SurfaceMesh mesh;
+    const std::uint32_t row = cells + 1;
+    mesh.positions.reserve(static_cast<std::size_t>(row) * row);
+    for (std::uint32_t y = 0; y <= cells; ++y) {
+        for (std::uint32_t x = 0; x <= cells; ++x) {
+            const float fx = static_cast<float>(x);
+            const float fy = static_cast<float>(y);
+            mesh.positions.emplace_back(fx, 0.1F * std::sin(0.05F * fx) * std::cos(0.07F * fy), fy);
+        }
+    }
+    mesh.indices.reserve(static_cast<std::size_t>(cells) * cells * 6);
+    for (std::uint32_t y = 0; y < cells; ++y) {
+        for (std::uint32_t x = 0; x < cells; ++x) {
+            const std::uint32_t a = y * row + x;
+            mesh.indices.insert(mesh.indices.end(), {a, a + row + 1, a + 1, a, a + row, a + row + 1});
+        }
+    }
+    return mesh;
+}
+
+// The single-threaded versions that shipped before the parallel rewrite.
+void legacy_recompute_vertex_normals(SurfaceMesh& mesh) {
+    mesh.normals.assign(mesh.positions.size(), math::vec3{0.0F, 0.0F, 0.0F});
+    for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        const auto ia = mesh.indices[i];
+        const auto ib = mesh.indices[i + 1];
+        const auto ic = mesh.indices[i + 2];
+        if (ia >= mesh.positions.size() || ib >= mesh.positions.size() || ic >= mesh.positions.size()) {
+            continue;
+        }
+        const auto& a = mesh.positions[ia];
+        const auto normal = math::normalize(math::cross(mesh.positions[ib] - a, mesh.positions[ic] - a));
+        mesh.normals[ia] += normal;
+        mesh.normals[ib] += normal;
+        mesh.normals[ic] += normal;
+    }
+    for (auto& normal : mesh.normals) {
+        normal = math::dot(normal, normal) > 0.0F ? math::normalize(normal) : math::vec3{0.0F, 1.0F, 0.0F};
+    }
+}
+
+void legacy_update_bounds(SurfaceMesh& mesh) {
+    math::vec3 min_bounds{std::numeric_limits<float>::max()};
+    math::vec3 max_bounds{std::numeric_limits<float>::lowest()};
+    for (const auto& position : mesh.positions) {
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            min_bounds[axis] = std::min(min_bounds[axis], position[axis]);
+            max_bounds[axis] = std::max(max_bounds[axis], position[axis]);
+        }
+    }
+    mesh.bounds = engine::geometry::Aabb{min_bounds, max_bounds};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const auto cells = static_cast<std::uint32_t>(argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000UL);
+    const int repetitions = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+
+    SurfaceMesh mesh = make_grid(cells);
+    SurfaceMesh reference = mesh;
+    std::printf("%zu vertices, %zu triangles, %zu threads, median of %d runs\n", mesh.positions.size(),
+                mesh.indices.size() / 3, math::parallel::concurrency(), repetitions);
+
+    std::printf("normals\n");
+    const double legacy_normals = time_ms(repetitions, [&]() { legacy_recompute_vertex_normals(reference); });
+    report("serial scatter (previous)", legacy_normals, legacy_normals);
+    report("recompute_vertex_normals", time_ms(repetitions, [&]() {
+        engine::geometry::recompute_vertex_normals(mesh);
+    }), legacy_normals);
+
+    engine::geometry::VertexTriangleAdjacency adjacency;
+    const double build_ms = time_ms(1, [&]() { adjacency = engine::geometry::build_vertex_triangle_adjacency(mesh); });
+    std::printf("  %-40s %9.3f ms\n", "build_vertex_triangle_adjacency (once)", build_ms);
+    report("recompute_vertex_normals(adjacency)", time_ms(repetitions, [&]() {
+        engine::geometry::recompute_vertex_normals(mesh, adjacency);
+    }), legacy_normals);
+
+    // A deformed patch covering about 1% of the vertices.
+    std::vector<std::uint32_t> dirty;
+    const std::uint32_t row = cells + 1;
+    const std::uint32_t patch = std::max<std::uint32_t>(1, row / 10);
+    for (std::uint32_t y = 0; y < patch; ++y) {
+        for (std::uint32_t x = 0; x < patch; ++x) {
+            dirty.push_back(y * row + x);
+        }
+    }
+    for (const std::uint32_t vertex : dirty) {
+        mesh.positions[vertex][1] += 0.25F;
+        reference.positions[vertex][1] += 0.25F;
+    }
+    char label[64];
+    std::snprintf(label, sizeof(label), "incremental (%zu dirty vertices)", dirty.size());
+    report(label, time_ms(repetitions, [&]() {
+        engine::geometry::recompute_vertex_normals(mesh, adjacency, dirty);
+    }), legacy_normals);
+    engine::geometry::NormalUpdateScratch scratch;
+    report("incremental, reused scratch", time_ms(repetitions, [&]() {
+        engine::geometry::recompute_vertex_normals(mesh, adjacency, dirty, scratch);
+    }), legacy_normals);
+
+    legacy_recompute_vertex_normals(reference);
+    if (mesh.normals != reference.normals) {
+        std::printf("  MISMATCH: incremental normals differ from the serial scatter\n");
+        return 1;
+    }
+
+    std::printf("bounds\n");
+    const double legacy_bounds = time_ms(repetitions, [&]() { legacy_update_bounds(reference); });
+    report("serial min/max (previous)", legacy_bounds, legacy_bounds);
+    report("update_bounds", time_ms(repetitions, [&]() { engine::geometry::update_bounds(mesh); }), legacy_bounds);
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        if (mesh.bounds.min[axis] != reference.bounds.min[axis] ||
+            mesh.bounds.max[axis] != reference.bounds.max[axis]) {
+            std::printf("  MISMATCH: bounds differ from the serial min/max\n");
+            return 1;
+        }
+    }
+    return 0;
+}
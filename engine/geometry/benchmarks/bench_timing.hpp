@@ -0,0 +1,27 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace engine::geometry::bench {
+
+// Median wall time of `repetitions` calls, in milliseconds.
+template <class Fn>
+double time_ms(int repetitions, Fn&& fn) {
+    std::vector<double> samples;
+    for (int i = 0; i < repetitions; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+inline void report(const char* name, double ms, double baseline_ms) {
+    std::printf("  %-40s %9.3f ms  %6.2fx\n", name, ms, baseline_ms / ms);
+}
+
+}  // namespace engine::geometry::bench
@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -10,6 +11,7 @@
 
 #include "engine/geometry/export.hpp"
 #include "engine/geometry/shapes/aabb.hpp"
+#include "engine/geometry/utils/locality.hpp"
 #include "engine/math/math.hpp"
 
 namespace engine::geometry {
@@ -19,24 +21,78 @@ namespace mesh
     struct IOFlags;
 } // namespace mesh
 
+// How deform::apply_skinning deforms a mesh. Dual quaternions keep volume around twisting joints, where linear
+// blending collapses into the "candy wrapper"; linear blending is cheaper and handles shear.
+enum class SkinningMethod : std::uint8_t { LinearBlend, DualQuaternion };
+
 struct SurfaceMesh {
     std::vector<math::vec3> rest_positions;
+    // Optional; when it has one entry per rest position, skinning deforms it into normals instead of
+    // recomputing them.
+    std::vector<math::vec3> rest_normals;
     std::vector<math::vec3> positions;
     std::vector<math::vec3> normals;
     std::vector<std::uint32_t> indices;
     Aabb bounds{};
+    SkinningMethod skinning_method{SkinningMethod::LinearBlend};
 };
 
 [[nodiscard]] ENGINE_GEOMETRY_API std::string_view module_name() noexcept;
 
 [[nodiscard]] ENGINE_GEOMETRY_API SurfaceMesh make_unit_quad();
 
+// Triangles around every vertex of a SurfaceMesh in CSR form: vertex v is a corner of the triangles
+// triangles[offsets[v]] .. triangles[offsets[v + 1] - 1], in ascending order and listed once per corner.
+// Triangles with an out-of-range index are left out, as recompute_vertex_normals skips them.
+struct VertexTriangleAdjacency {
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> triangles;
+};
+
+// Buffers the incremental normal update reuses across calls. `queued` grows to the vertex count once and is
+// cleared entry by entry, so later updates cost only the size of the edit.
+struct NormalUpdateScratch {
+    std::vector<std::uint8_t> queued;
+    std::vector<std::uint32_t> affected;
+};
+
+// Area-independent vertex normals: each vertex averages the unit normals of its triangles; vertices without a
+// valid triangle get +Y. Triangle normals are computed in parallel.
 ENGINE_GEOMETRY_API void recompute_vertex_normals(SurfaceMesh& mesh);
 
+// Built once per topology (indices and vertex count) and reused by the gather-based normal updates below.
+[[nodiscard]] ENGINE_GEOMETRY_API VertexTriangleAdjacency build_vertex_triangle_adjacency(const SurfaceMesh& mesh);
+
+// Same result as recompute_vertex_normals(mesh), bit for bit, with every vertex gathering its own normal in
+// parallel through `adjacency`, which must have been built from the current indices and vertex count.
+ENGINE_GEOMETRY_API void recompute_vertex_normals(SurfaceMesh& mesh, const VertexTriangleAdjacency& adjacency);
+
+// Incremental update after only the positions of `dirty_vertices` changed: recomputes the normals of the vertices
+// sharing a triangle with a dirty vertex and leaves the others untouched. Matches a full recompute when the
+// normals were up to date before the positions moved. Falls back to a full recompute when the normals are not
+// sized to the positions. Repeats in the affected set are removed by sorting; callers that edit every frame
+// should keep a NormalUpdateScratch and pass it instead.
+ENGINE_GEOMETRY_API void recompute_vertex_normals(SurfaceMesh& mesh,
+                                                  const VertexTriangleAdjacency& adjacency,
+                                                  std::span<const std::uint32_t> dirty_vertices);
+
+ENGINE_GEOMETRY_API void recompute_vertex_normals(SurfaceMesh& mesh,
+                                                  const VertexTriangleAdjacency& adjacency,
+                                                  std::span<const std::uint32_t> dirty_vertices,
+                                                  NormalUpdateScratch& scratch);
+
+// Parallel min/max reduction over the positions.
 ENGINE_GEOMETRY_API void update_bounds(SurfaceMesh& mesh);
 
 ENGINE_GEOMETRY_API void apply_uniform_translation(SurfaceMesh& mesh, const math::vec3& translation);
 
+// Reorders triangles and vertices for cache locality as utils::PlanLocality, planned on the positions (the rest
+// positions when there are none). Every per-vertex array of the vertex count is permuted and the indices are
+// renumbered; bounds are unchanged. Returns the orders applied, so per-vertex data kept outside the mesh (a
+// RigBinding's vertices, say) can follow.
+ENGINE_GEOMETRY_API utils::LocalityOrder optimize_locality(SurfaceMesh& mesh,
+                                                           const utils::LocalityOptions& options = {});
+
 [[nodiscard]] ENGINE_GEOMETRY_API math::vec3 centroid(const SurfaceMesh& mesh);
 
 [[nodiscard]] ENGINE_GEOMETRY_API SurfaceMesh load_surface_mesh(const std::filesystem::path& path);
@@ -0,0 +1,962 @@
+#pragma once
+
+#include "engine/geometry/api.hpp"
+#include "engine/geometry/mesh/halfedge_mesh.hpp"
+#include "engine/geometry/shapes/aabb.hpp"
+#include "engine/geometry/shapes/ray.hpp"
+#include "engine/geometry/shapes/triangle.hpp"
+#include "engine/geometry/utils/ray_packet.hpp"
+#include "engine/geometry/utils/shape_interactions.hpp"
+#include "engine/geometry/utils/spatial_build.hpp"
+#include "engine/math/parallel.hpp"
+#include "engine/math/vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+template <typename Shape>
+concept TriangleOverlapShape =
+    requires(const Shape& s, const engine::geometry::Aabb& box, const engine::geometry::Triangle& triangle)
+    {
+        { Intersects(box, s) } -> std::convertible_to<bool>;
+        { Intersects(triangle, s) } -> std::convertible_to<bool>;
+    };
+
+namespace engine::geometry
+{
+    // Bounding volume hierarchy over the triangles of a mesh.
+    //
+    // Nodes are 32-byte records stored depth-first (an interior node's left child is the next record) and
+    // leaves reference a contiguous range of the leaf-ordered triangle list. Splits are chosen with the binned
+    // SAH of utils/spatial_build.hpp. Vertex positions are copied, so deforming meshes only need refit(),
+    // which recomputes the bounds bottom-up and keeps the topology.
+    class ENGINE_GEOMETRY_API Bvh
+    {
+    public:
+        struct alignas(16) Node
+        {
+            Aabb bounds;
+            // Interior: index of the right child. Leaf: first leaf-ordered triangle.
+            std::uint32_t offset = 0U;
+            // Leaf: number of triangles; 0 marks an interior node.
+            std::uint32_t count = 0U;
+
+            [[nodiscard]] bool is_leaf() const noexcept { return count != 0U; }
+        };
+        static_assert(sizeof(Node) == 32, "Bvh::Node must stay a 32-byte record");
+
+        struct BuildOptions
+        {
+            std::size_t max_triangles_per_leaf = 4;
+            // Cost of visiting a node relative to one ray/triangle test; larger values give shallower trees.
+            float traversal_cost = 1.0f;
+        };
+
+        // Closest-hit result: primitive is the triangle index (SurfaceMesh) or face index (HalfedgeMesh), and
+        // (u, v) are the barycentric weights of the triangle's second and third corner.
+        struct RayHit
+        {
+            float t = std::numeric_limits<float>::infinity();
+            std::size_t primitive = std::numeric_limits<std::size_t>::max();
+            float u = 0.0f;
+            float v = 0.0f;
+        };
+
+        struct ClosestPointResult
+        {
+            math::vec3 point{0.0f};
+            float distance_sq = std::numeric_limits<float>::infinity();
+            std::size_t primitive = std::numeric_limits<std::size_t>::max();
+        };
+
+        // Deepest level a build creates; traversals keep their stacks on the stack.
+        static constexpr std::size_t kMaxDepth = 64;
+
+        [[nodiscard]] std::span<const Node> nodes() const noexcept { return nodes_; }
+
+        [[nodiscard]] std::size_t node_count() const noexcept { return nodes_.size(); }
+
+        [[nodiscard]] std::size_t triangle_count() const noexcept { return triangles_.size(); }
+
+        // Vertex indices of every leaf-ordered triangle and the primitive it belongs to.
+        [[nodiscard]] std::span<const std::array<std::uint32_t, 3>> triangles() const noexcept { return triangles_; }
+
+        [[nodiscard]] std::span<const std::size_t> primitive_ids() const noexcept { return primitive_ids_; }
+
+        [[nodiscard]] std::span<const math::vec3> vertices() const noexcept { return vertices_; }
+
+        [[nodiscard]] const BuildOptions& get_build_options() const noexcept { return options_; }
+
+        // Rebuild over an indexed triangle list; primitive ids are triangle indices. Returns false if the index
+        // count is not a multiple of three, an index is out of range, or there are no triangles.
+        bool build(std::span<const math::vec3> positions, std::span<const std::uint32_t> indices,
+                   const BuildOptions& options)
+        {
+            clear();
+            if (indices.size() % 3 != 0 || indices.size() / 3 >= std::numeric_limits<std::uint32_t>::max() ||
+                std::any_of(indices.begin(), indices.end(), [&](std::uint32_t i) { return i >= positions.size(); }))
+            {
+                return false;
+            }
+
+            std::vector<std::array<std::uint32_t, 3>> triangles(indices.size() / 3);
+            std::vector<std::size_t> ids(triangles.size());
+            for (std::size_t t = 0; t < triangles.size(); ++t)
+            {
+                triangles[t] = {indices[3 * t], indices[3 * t + 1], indices[3 * t + 2]};
+                ids[t] = t;
+            }
+            return build_triangles(positions, std::move(triangles), std::move(ids), options);
+        }
+
+        bool build(const SurfaceMesh& mesh, const BuildOptions& options)
+        {
+            return build(mesh.positions, mesh.indices, options);
+        }
+
+        // Polygonal faces are fanned into triangles that share the face index as primitive id; deleted faces are
+        // skipped.
+        bool build(const mesh::HalfedgeMeshInterface& mesh, const BuildOptions& options)
+        {
+            clear();
+            std::vector<std::array<std::uint32_t, 3>> triangles;
+            std::vector<std::size_t> ids;
+            std::vector<std::uint32_t> polygon;
+            for (const auto face : mesh.faces())
+            {
+                if (mesh.is_deleted(face))
+                {
+                    continue;
+                }
+                polygon.clear();
+                auto vertices = mesh.vertices(face);
+                const auto end = vertices;
+                if (!vertices)
+                {
+                    continue;
+                }
+                do
+                {
+                    polygon.push_back((*vertices).index());
+                }
+                while (++vertices != end);
+
+                for (std::size_t i = 1; i + 1 < polygon.size(); ++i)
+                {
+                    triangles.push_back({polygon.front(), polygon[i], polygon[i + 1]});
+                    ids.push_back(face.index());
+                }
+            }
+            return build_triangles(mesh.positions(), std::move(triangles), std::move(ids), options);
+        }
+
+        // Updates the vertex positions (same count and triangle indices as the build) and recomputes every
+        // node's bounds bottom-up. Cheaper than a rebuild for skinned or otherwise deforming meshes; the tree
+        // quality degrades with the amount of deformation.
+        bool refit(std::span<const math::vec3> positions)
+        {
+            if (nodes_.empty() || positions.size() != vertices_.size())
+            {
+                return false;
+            }
+            std::copy(positions.begin(), positions.end(), vertices_.begin());
+
+            math::parallel::parallel_for(0, nodes_.size(), utils::kBuildGrain, [&](std::size_t first,
+                                                                                 std::size_t last)
+            {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    if (nodes_[i].is_leaf()) nodes_[i].bounds = leaf_bounds(nodes_[i]);
+                }
+            });
+            // Children are stored after their parent.
+            for (std::size_t i = nodes_.size(); i-- > 0;)
+            {
+                Node& node = nodes_[i];
+                if (node.is_leaf()) continue;
+                node.bounds = nodes_[i + 1].bounds;
+                utils::MergeInline(node.bounds, nodes_[node.offset].bounds);
+            }
+            return true;
+        }
+
+        bool refit(const SurfaceMesh& mesh)
+        {
+            return refit(mesh.positions);
+        }
+
+        bool refit(const mesh::HalfedgeMeshInterface& mesh)
+        {
+            return refit(mesh.positions());
+        }
+
+        // Nearest intersection with t in [0, t_max]; equally distant hits resolve to the smaller primitive id.
+        // Children are visited front to back and skipped once their entry lies beyond the current hit.
+        bool closest_hit(const Ray& ray, RayHit& hit,
+                         float t_max = std::numeric_limits<float>::infinity()) const
+        {
+            hit = RayHit{};
+            hit.t = t_max;
+            if (nodes_.empty()) return false;
+
+            trace_closest(0, ray, hit);
+            return hit.primitive != std::numeric_limits<std::size_t>::max();
+        }
+
+        // Whether any triangle is hit with t in [0, t_max]; stops at the first hit (shadow and visibility rays).
+        [[nodiscard]] bool any_hit(const Ray& ray, float t_max = std::numeric_limits<float>::infinity()) const
+        {
+            return !nodes_.empty() && trace_any(0, ray, t_max);
+        }
+
+        // Batched closest_hit(): hits[i] receives the result for rays[i] (primitive max() and t = t_max when
+        // it misses). Rays are traced in tasks of utils::kRayGrain on the math worker pool, as Width-wide
+        // packets of consecutive rays or as one stream per task (see RayBatchMode); both modes return the same
+        // hits as closest_hit().
+        template <std::size_t Width = kRayPacketWidth>
+        void closest_hit_batch(std::span<const Ray> rays, std::span<RayHit> hits,
+                               RayBatchMode mode = RayBatchMode::Packet,
+                               float t_max = std::numeric_limits<float>::infinity()) const
+        {
+            assert(hits.size() == rays.size());
+            std::fill(hits.begin(), hits.end(), RayHit{.t = t_max});
+            if (nodes_.empty()) return;
+
+            math::parallel::parallel_for(0, rays.size(), utils::kRayGrain, [&](std::size_t first, std::size_t last)
+            {
+                const auto task_rays = rays.subspan(first, last - first);
+                const auto task_hits = hits.subspan(first, last - first);
+                if (mode == RayBatchMode::Stream)
+                {
+                    closest_hit_stream<Width>(task_rays, task_hits, t_max);
+                }
+                else
+                {
+                    closest_hit_packets<Width>(task_rays, task_hits, t_max);
+                }
+            });
+        }
+
+        // Batched any_hit(): occluded[i] is set to 1 if rays[i] hits a triangle with t in [0, t_max], else 0.
+        // Lanes retire at their first hit; a packet or stream finishes once all of its rays have.
+        template <std::size_t Width = kRayPacketWidth>
+        void any_hit_batch(std::span<const Ray> rays, std::span<std::uint8_t> occluded,
+                           RayBatchMode mode = RayBatchMode::Packet,
+                           float t_max = std::numeric_limits<float>::infinity()) const
+        {
+            assert(occluded.size() == rays.size());
+            std::fill(occluded.begin(), occluded.end(), std::uint8_t{0});
+            if (nodes_.empty()) return;
+
+            math::parallel::parallel_for(0, rays.size(), utils::kRayGrain, [&](std::size_t first, std::size_t last)
+            {
+                const auto task_rays = rays.subspan(first, last - first);
+                const auto task_occluded = occluded.subspan(first, last - first);
+                if (mode == RayBatchMode::Stream)
+                {
+                    any_hit_stream<Width>(task_rays, task_occluded, t_max);
+                }
+                else
+                {
+                    any_hit_packets<Width>(task_rays, task_occluded, t_max);
+                }
+            });
+        }
+
+        // Closest point on the mesh to `point` within sqrt(max_distance_sq); equally close triangles resolve to
+        // the smaller primitive id. Nodes are visited best-first by their box distance.
+        bool closest_point(const math::vec3& point, ClosestPointResult& result,
+                           float max_distance_sq = std::numeric_limits<float>::infinity()) const
+        {
+            result = ClosestPointResult{};
+            result.distance_sq = max_distance_sq;
+            if (nodes_.empty()) return false;
+
+            bool found = false;
+            std::vector<std::pair<float, std::uint32_t>> queue;
+            const auto push = [&](float dist_sq, std::uint32_t index)
+            {
+                queue.emplace_back(dist_sq, index);
+                std::push_heap(queue.begin(), queue.end(), std::greater<>{});
+            };
+            push(squared_distance(nodes_[0].bounds, point), 0);
+            while (!queue.empty())
+            {
+                std::pop_heap(queue.begin(), queue.end(), std::greater<>{});
+                const auto [node_dist_sq, index] = queue.back();
+                queue.pop_back();
+                if (node_dist_sq > result.distance_sq) break;
+
+                const Node& node = nodes_[index];
+                if (node.is_leaf())
+                {
+                    for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                    {
+                        const math::vec3 closest = ClosestPoint(triangle(i), point);
+                        const float dist_sq = math::length_squared(closest - point);
+                        if (dist_sq < result.distance_sq ||
+                            (dist_sq == result.distance_sq && (!found || primitive_ids_[i] < result.primitive)))
+                        {
+                            result = {.point = closest, .distance_sq = dist_sq, .primitive = primitive_ids_[i]};
+                            found = true;
+                        }
+                    }
+                    continue;
+                }
+                for (const std::uint32_t child : {index + 1, node.offset})
+                {
+                    const float dist_sq = squared_distance(nodes_[child].bounds, point);
+                    if (dist_sq <= result.distance_sq) push(dist_sq, child);
+                }
+            }
+            return found;
+        }
+
+        // Primitives with a triangle overlapping `shape`, in ascending order without duplicates.
+        template <TriangleOverlapShape Shape>
+        void query(const Shape& shape, std::vector<std::size_t>& result) const
+        {
+            result.clear();
+            if (nodes_.empty()) return;
+
+            std::array<std::uint32_t, kMaxDepth + 1> stack;
+            std::size_t top = 0;
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                const std::uint32_t index = stack[--top];
+                const Node& node = nodes_[index];
+                if (!Intersects(node.bounds, shape)) continue;
+                if (node.is_leaf())
+                {
+                    for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                    {
+                        if (Intersects(triangle(i), shape)) result.push_back(primitive_ids_[i]);
+                    }
+                    continue;
+                }
+                stack[top++] = node.offset;
+                stack[top++] = index + 1;
+            }
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()), result.end());
+        }
+
+        [[nodiscard]] Triangle triangle(std::size_t leaf_index) const noexcept
+        {
+            const auto& [a, b, c] = triangles_[leaf_index];
+            return {vertices_[a], vertices_[b], vertices_[c]};
+        }
+
+        // Checks depth-first numbering, contiguous leaf ranges in order, and that every box encloses its
+        // children or triangles.
+        [[nodiscard]] bool validate_structure() const
+        {
+            if (nodes_.empty()) return triangles_.empty();
+
+            std::uint32_t next_node = 0;
+            std::uint32_t next_triangle = 0;
+            return validate_node(next_node, next_triangle, 0) && next_node == nodes_.size() &&
+                   next_triangle == triangles_.size();
+        }
+
+    private:
+        void clear()
+        {
+            nodes_.clear();
+            triangles_.clear();
+            primitive_ids_.clear();
+            vertices_.clear();
+        }
+
+        bool build_triangles(std::span<const math::vec3> positions, std::vector<std::array<std::uint32_t, 3>> triangles,
+                             std::vector<std::size_t> ids, const BuildOptions& options)
+        {
+            options_ = options;
+            options_.max_triangles_per_leaf = std::max<std::size_t>(1, options.max_triangles_per_leaf);
+            if (triangles.empty())
+            {
+                return false;
+            }
+            vertices_.assign(positions.begin(), positions.end());
+
+            const std::size_t count = triangles.size();
+            std::vector<Aabb> boxes(count);
+            std::vector<math::vec3> centroids(count);
+            math::parallel::parallel_for(0, count, utils::kBuildGrain, [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t t = first; t < last; ++t)
+                {
+                    Aabb box = utils::EmptyAabb();
+                    for (const std::uint32_t v : triangles[t])
+                    {
+                        utils::MergeInline(box, Aabb{.min = vertices_[v], .max = vertices_[v]});
+                    }
+                    boxes[t] = box;
+                    centroids[t] = (box.min + box.max) * 0.5f;
+                }
+            });
+
+            std::vector<std::uint32_t> order(count);
+            std::iota(order.begin(), order.end(), 0U);
+            nodes_.reserve(2 * (count / options_.max_triangles_per_leaf) + 1);
+            build_node(order, boxes, centroids, 0, count, 0);
+
+            triangles_.resize(count);
+            primitive_ids_.resize(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                triangles_[i] = triangles[order[i]];
+                primitive_ids_[i] = ids[order[i]];
+            }
+            return true;
+        }
+
+        void build_node(std::vector<std::uint32_t>& order, const std::vector<Aabb>& boxes,
+                        const std::vector<math::vec3>& centroids, std::size_t begin, std::size_t end,
+                        std::size_t depth)
+        {
+            const std::size_t count = end - begin;
+            const std::uint32_t* items = order.data() + begin;
+            const std::size_t index = nodes_.size();
+            nodes_.emplace_back();
+            nodes_[index].bounds = utils::ParallelBounds(count, [&](std::size_t i) { return boxes[items[i]]; });
+
+            const auto make_leaf = [&]()
+            {
+                nodes_[index].offset = static_cast<std::uint32_t>(begin);
+                nodes_[index].count = static_cast<std::uint32_t>(count);
+            };
+            if (count == 1 || depth >= kMaxDepth)
+            {
+                make_leaf();
+                return;
+            }
+
+            const Aabb centroid_bounds = utils::ParallelBounds(count, [&](std::size_t i)
+            {
+                return Aabb{.min = centroids[items[i]], .max = centroids[items[i]]};
+            });
+            const auto candidates = utils::BinnedSah(count, centroid_bounds,
+                                                     [&](std::size_t i) { return centroids[items[i]]; },
+                                                     [&](std::size_t i) { return boxes[items[i]]; });
+            std::size_t axis = 3;
+            for (std::size_t a = 0; a < 3; ++a)
+            {
+                if (candidates[a].bin != 0 && (axis == 3 || candidates[a].cost < candidates[axis].cost))
+                {
+                    axis = a;
+                }
+            }
+
+            std::size_t mid = begin + count / 2;
+            if (axis == 3)
+            {
+                // Coincident centroids: only an oversized leaf is worth splitting, and then just by count.
+                if (count <= options_.max_triangles_per_leaf)
+                {
+                    make_leaf();
+                    return;
+                }
+            }
+            else
+            {
+                const double split_cost = options_.traversal_cost +
+                    candidates[axis].cost / SurfaceAreaOf(nodes_[index].bounds);
+                if (count <= options_.max_triangles_per_leaf && split_cost >= static_cast<double>(count))
+                {
+                    make_leaf();
+                    return;
+                }
+
+                const float position = candidates[axis].left_centroid_max;
+                const auto goes_left = [&](std::uint32_t t) { return centroids[t][axis] <= position; };
+                const auto range = std::span(order).subspan(begin, count);
+                if (count > utils::kParallelBuildThreshold)
+                {
+                    utils::StableBucketPartition<2>(range, [&](std::uint32_t t) { return goes_left(t) ? 0 : 1; });
+                }
+                else
+                {
+                    std::partition(range.begin(), range.end(), goes_left);
+                }
+                mid = begin + candidates[axis].left_count;
+            }
+
+            build_node(order, boxes, centroids, begin, mid, depth + 1);
+            nodes_[index].offset = static_cast<std::uint32_t>(nodes_.size());
+            build_node(order, boxes, centroids, mid, end, depth + 1);
+        }
+
+        [[nodiscard]] static double SurfaceAreaOf(const Aabb& box) noexcept
+        {
+            const double dx = box.max[0] - box.min[0];
+            const double dy = box.max[1] - box.min[1];
+            const double dz = box.max[2] - box.min[2];
+            const double area = 2.0 * (dx * dy + dy * dz + dz * dx);
+            return area > 0.0 ? area : 1.0;
+        }
+
+        [[nodiscard]] Aabb leaf_bounds(const Node& node) const noexcept
+        {
+            Aabb box = utils::EmptyAabb();
+            for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+            {
+                for (const std::uint32_t v : triangles_[i])
+                {
+                    utils::MergeInline(box, Aabb{.min = vertices_[v], .max = vertices_[v]});
+                }
+            }
+            return box;
+        }
+
+        // Single-ray closest-hit traversal of the subtree at `root`, improving on `hit`.
+        void trace_closest(std::uint32_t root, const Ray& ray, RayHit& hit) const
+        {
+            const math::vec3 inv_dir = inverse(ray.direction);
+            std::array<std::uint32_t, kMaxDepth + 1> stack;
+            std::size_t top = 0;
+            std::uint32_t index = root;
+            if (!slab_entry(nodes_[root].bounds, ray.origin, inv_dir, hit.t)) return;
+            while (true)
+            {
+                const Node& node = nodes_[index];
+                if (node.is_leaf())
+                {
+                    for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                    {
+                        float t, u, v;
+                        if (intersect_triangle(i, ray, t, u, v)) record_hit(hit, i, t, u, v);
+                    }
+                }
+                else
+                {
+                    std::uint32_t near_child = index + 1;
+                    std::uint32_t far_child = node.offset;
+                    float t_near = 0.0f;
+                    float t_far = 0.0f;
+                    bool hit_near = slab_entry(nodes_[near_child].bounds, ray.origin, inv_dir, hit.t, &t_near);
+                    bool hit_far = slab_entry(nodes_[far_child].bounds, ray.origin, inv_dir, hit.t, &t_far);
+                    if (hit_near && hit_far && t_far < t_near)
+                    {
+                        std::swap(near_child, far_child);
+                    }
+                    else if (!hit_near)
+                    {
+                        near_child = far_child;
+                        hit_near = hit_far;
+                        hit_far = false;
+                    }
+                    if (hit_near)
+                    {
+                        if (hit_far) stack[top++] = far_child;
+                        index = near_child;
+                        continue;
+                    }
+                }
+
+                // Pop the next subtree that can still beat the current hit.
+                bool resumed = false;
+                while (top > 0 && !resumed)
+                {
+                    index = stack[--top];
+                    resumed = slab_entry(nodes_[index].bounds, ray.origin, inv_dir, hit.t);
+                }
+                if (!resumed) break;
+            }
+        }
+
+        // Single-ray any-hit traversal of the subtree at `root`.
+        [[nodiscard]] bool trace_any(std::uint32_t root, const Ray& ray, float t_max) const
+        {
+            const math::vec3 inv_dir = inverse(ray.direction);
+            std::array<std::uint32_t, kMaxDepth + 1> stack;
+            std::size_t top = 0;
+            stack[top++] = root;
+            while (top > 0)
+            {
+                const std::uint32_t index = stack[--top];
+                const Node& node = nodes_[index];
+                if (!slab_entry(node.bounds, ray.origin, inv_dir, t_max)) continue;
+                if (node.is_leaf())
+                {
+                    for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                    {
+                        float t, u, v;
+                        if (intersect_triangle(i, ray, t, u, v) && t <= t_max) return true;
+                    }
+                    continue;
+                }
+                stack[top++] = node.offset;
+                stack[top++] = index + 1;
+            }
+            return false;
+        }
+
+        [[nodiscard]] const Aabb& node_bounds(std::uint32_t index) const noexcept
+        {
+            return nodes_[index].bounds;
+        }
+
+        // Pushes both children of an interior node so that the one nearer along `direction` is popped first.
+        // The order is taken from the axis separating the child boxes the most, as nodes store no split axis.
+        void push_children(std::uint32_t index, const math::vec3& direction,
+                           const std::invocable<std::uint32_t> auto& push) const
+        {
+            const Aabb& left = nodes_[index + 1].bounds;
+            const Aabb& right = nodes_[nodes_[index].offset].bounds;
+            std::size_t axis = 0;
+            float separation = 0.0f;
+            for (std::size_t a = 0; a < 3; ++a)
+            {
+                const float d = (right.min[a] + right.max[a]) - (left.min[a] + left.max[a]);
+                if (std::abs(d) > std::abs(separation))
+                {
+                    separation = d;
+                    axis = a;
+                }
+            }
+            const bool right_first = separation * direction[axis] < 0.0f;
+            push(right_first ? index + 1 : nodes_[index].offset);
+            push(right_first ? nodes_[index].offset : index + 1);
+        }
+
+        // Keeps the nearer of `hit` and the candidate, the smaller primitive id on ties, like closest_hit().
+        bool record_hit(RayHit& hit, std::size_t leaf_index, float t, float u, float v) const noexcept
+        {
+            const std::size_t primitive = primitive_ids_[leaf_index];
+            if (t < hit.t || (t == hit.t && (hit.primitive == std::numeric_limits<std::size_t>::max() ||
+                                             primitive < hit.primitive)))
+            {
+                hit = {.t = t, .primitive = primitive, .u = u, .v = v};
+                return true;
+            }
+            return false;
+        }
+
+        template <std::size_t Width>
+        [[nodiscard]] static math::vec3 lane_direction(const RayPacket<Width>& packet, std::uint32_t mask) noexcept
+        {
+            const auto lane = static_cast<std::size_t>(std::countr_zero(mask));
+            return {packet.direction[0][lane], packet.direction[1][lane], packet.direction[2][lane]};
+        }
+
+        template <std::size_t Width>
+        void closest_hit_packets(std::span<const Ray> rays, std::span<RayHit> hits, float t_max) const
+        {
+            std::vector<std::uint32_t> stack;
+            RayPacketHits<Width> lane_hits;
+            for (std::size_t first = 0; first < rays.size(); first += Width)
+            {
+                RayPacket<Width> packet;
+                for (std::size_t lane = 0; lane < std::min(Width, rays.size() - first); ++lane)
+                {
+                    packet.set(lane, rays[first + lane], t_max);
+                }
+                const auto bounds_of = [&](std::uint32_t index) -> const Aabb& { return node_bounds(index); };
+                utils::TraceRayPacket(packet, 0, stack, bounds_of, [&](std::uint32_t index, std::uint32_t mask,
+                                                                       std::vector<std::uint32_t>& next)
+                {
+                    const Node& node = nodes_[index];
+                    if (!node.is_leaf())
+                    {
+                        push_children(index, lane_direction(packet, mask),
+                                      [&](std::uint32_t child) { next.push_back(child); });
+                        return;
+                    }
+                    for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                    {
+                        utils::ForEachLane(Intersects(triangle(i), packet, lane_hits) & mask, [&](std::size_t lane)
+                        {
+                            RayHit& hit = hits[first + lane];
+                            if (record_hit(hit, i, lane_hits.t[lane], lane_hits.u[lane], lane_hits.v[lane]))
+                            {
+                                packet.t_max[lane] = hit.t;
+                            }
+                        });
+                    }
+                });
+            }
+        }
+
+        // Stream mode: Width lanes each run their own depth-first traversal and a lane that finishes takes the
+        // next ray, so the lanes stay busy however incoherent the rays are. Each step tests the children of every
+        // lane's node with one slab test per side, and the independent lanes overlap their node fetches.
+        // `leaf(ray, node)` handles a leaf reached by a ray and returns its new t_max, negative once it is done.
+        template <std::size_t Width, class LeafFn>
+        void trace_stream(std::span<const Ray> rays, float t_max, LeafFn&& leaf) const
+        {
+            struct LaneState
+            {
+                std::uint32_t ray = 0;
+                std::uint32_t node = 0;
+                std::uint32_t top = 0;
+                std::array<std::pair<std::uint32_t, float>, kMaxDepth + 1> stack;
+            };
+            std::array<LaneState, Width> lanes;
+            RayPacket<Width> packet;
+            std::size_t next_ray = 0;
+            const auto refill = [&](std::size_t lane)
+            {
+                if (next_ray == rays.size())
+                {
+                    packet.retire(lane);
+                    return;
+                }
+                lanes[lane].ray = static_cast<std::uint32_t>(next_ray);
+                lanes[lane].node = 0;
+                lanes[lane].top = 0;
+                packet.set(lane, rays[next_ray], t_max);
+                ++next_ray;
+            };
+            // Moves a lane to the next stacked node it can still reach before t_max, or on to the next ray.
+            const auto pop = [&](std::size_t lane)
+            {
+                LaneState& state = lanes[lane];
+                while (state.top > 0)
+                {
+                    const auto [node, entry] = state.stack[--state.top];
+                    if (entry <= packet.t_max[lane])
+                    {
+                        state.node = node;
+                        return;
+                    }
+                }
+                refill(lane);
+            };
+            for (std::size_t lane = 0; lane < Width; ++lane) refill(lane);
+
+            AabbLanes<Width> left;
+            AabbLanes<Width> right;
+            std::array<float, Width> left_entry;
+            std::array<float, Width> right_entry;
+            while (packet.active != 0)
+            {
+                // Run leaves until every active lane sits at an interior node.
+                std::uint32_t interior = 0;
+                utils::ForEachLane(packet.active, [&](std::size_t lane)
+                {
+                    LaneState& state = lanes[lane];
+                    while (packet.active >> lane & 1U)
+                    {
+                        const Node& node = nodes_[state.node];
+                        if (!node.is_leaf())
+                        {
+                            left.set(lane, nodes_[state.node + 1].bounds);
+                            right.set(lane, nodes_[node.offset].bounds);
+                            interior |= std::uint32_t{1} << lane;
+                            return;
+                        }
+                        packet.t_max[lane] = leaf(state.ray, node);
+                        pop(lane);
+                    }
+                });
+
+                const std::uint32_t hit_left = Intersects(left, packet, left_entry) & interior;
+                const std::uint32_t hit_right = Intersects(right, packet, right_entry) & interior;
+                utils::ForEachLane(interior, [&](std::size_t lane)
+                {
+                    LaneState& state = lanes[lane];
+                    std::uint32_t near_child = state.node + 1;
+                    std::uint32_t far_child = nodes_[state.node].offset;
+                    float near_entry = left_entry[lane];
+                    float far_entry = right_entry[lane];
+                    bool hit_near = (hit_left >> lane & 1U) != 0;
+                    bool hit_far = (hit_right >> lane & 1U) != 0;
+                    if ((hit_near && hit_far && far_entry < near_entry) || !hit_near)
+                    {
+                        std::swap(near_child, far_child);
+                        std::swap(near_entry, far_entry);
+                        std::swap(hit_near, hit_far);
+                    }
+                    if (!hit_near)
+                    {
+                        pop(lane);
+                        return;
+                    }
+                    if (hit_far) state.stack[state.top++] = {far_child, far_entry};
+                    state.node = near_child;
+                });
+            }
+        }
+
+        template <std::size_t Width>
+        void closest_hit_stream(std::span<const Ray> rays, std::span<RayHit> hits, float t_max) const
+        {
+            trace_stream<Width>(rays, t_max, [&](std::uint32_t ray, const Node& node)
+            {
+                RayHit& hit = hits[ray];
+                for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                {
+                    float t, u, v;
+                    if (intersect_triangle(i, rays[ray], t, u, v)) record_hit(hit, i, t, u, v);
+                }
+                return hit.t;
+            });
+        }
+
+        template <std::size_t Width>
+        void any_hit_packets(std::span<const Ray> rays, std::span<std::uint8_t> occluded, float t_max) const
+        {
+            std::vector<std::uint32_t> stack;
+            RayPacketHits<Width> lane_hits;
+            for (std::size_t first = 0; first < rays.size(); first += Width)
+            {
+                RayPacket<Width> packet;
+                for (std::size_t lane = 0; lane < std::min(Width, rays.size() - first); ++lane)
+                {
+                    packet.set(lane, rays[first + lane], t_max);
+                }
+                const auto bounds_of = [&](std::uint32_t index) -> const Aabb& { return node_bounds(index); };
+                utils::TraceRayPacket(packet, 0, stack, bounds_of, [&](std::uint32_t index, std::uint32_t mask,
+                                                                       std::vector<std::uint32_t>& next)
+                {
+                    const Node& node = nodes_[index];
+                    if (!node.is_leaf())
+                    {
+                        next.push_back(node.offset);
+                        next.push_back(index + 1);
+                        return;
+                    }
+                    for (std::uint32_t i = node.offset; i < node.offset + node.count && mask != 0; ++i)
+                    {
+                        const std::uint32_t hit = Intersects(triangle(i), packet, lane_hits) & mask;
+                        utils::ForEachLane(hit, [&](std::size_t lane)
+                        {
+                            occluded[first + lane] = 1;
+                            packet.retire(lane);
+                        });
+                        mask &= ~hit;
+                    }
+                });
+            }
+        }
+
+        template <std::size_t Width>
+        void any_hit_stream(std::span<const Ray> rays, std::span<std::uint8_t> occluded, float t_max) const
+        {
+            trace_stream<Width>(rays, t_max, [&](std::uint32_t ray, const Node& node)
+            {
+                for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                {
+                    float t, u, v;
+                    if (intersect_triangle(i, rays[ray], t, u, v) && t <= t_max)
+                    {
+                        occluded[ray] = 1;
+                        return -1.0f;
+                    }
+                }
+                return t_max;
+            });
+        }
+
+        [[nodiscard]] static math::vec3 inverse(const math::vec3& direction) noexcept
+        {
+            return {1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2]};
+        }
+
+        // Slab test of the ray against `box` over [0, t_max]; `entry` receives the entry distance. Axes with a
+        // zero direction component produce NaN or infinite slab bounds, which the comparisons ignore.
+        [[nodiscard]] static bool slab_entry(const Aabb& box, const math::vec3& origin, const math::vec3& inv_dir,
+                                             float t_max, float* entry = nullptr) noexcept
+        {
+            float t0 = 0.0f;
+            float t1 = t_max;
+            for (std::size_t axis = 0; axis < 3; ++axis)
+            {
+                float near_t = (box.min[axis] - origin[axis]) * inv_dir[axis];
+                float far_t = (box.max[axis] - origin[axis]) * inv_dir[axis];
+                if (near_t > far_t) std::swap(near_t, far_t);
+                t0 = near_t > t0 ? near_t : t0;
+                t1 = far_t < t1 ? far_t : t1;
+            }
+            if (entry != nullptr) *entry = t0;
+            return t0 <= t1;
+        }
+
+        [[nodiscard]] static float squared_distance(const Aabb& box, const math::vec3& p) noexcept
+        {
+            float dist_sq = 0.0f;
+            for (std::size_t axis = 0; axis < 3; ++axis)
+            {
+                const float d = std::max({box.min[axis] - p[axis], 0.0f, p[axis] - box.max[axis]});
+                dist_sq += d * d;
+            }
+            return dist_sq;
+        }
+
+        // Moeller-Trumbore, with the same tolerances as Intersects(Ray, Triangle).
+        [[nodiscard]] bool intersect_triangle(std::size_t leaf_index, const Ray& ray, float& t, float& u,
+                                              float& v) const noexcept
+        {
+            const auto& [ia, ib, ic] = triangles_[leaf_index];
+            const math::vec3& a = vertices_[ia];
+            const math::vec3 e1 = vertices_[ib] - a;
+            const math::vec3 e2 = vertices_[ic] - a;
+            const math::vec3 p = math::cross(ray.direction, e2);
+            const float det = math::dot(e1, p);
+            if (std::abs(det) < 1e-8f) return false;
+            const float inv = 1.0f / det;
+            const math::vec3 tvec = ray.origin - a;
+            u = math::dot(tvec, p) * inv;
+            if (u < 0.0f || u > 1.0f) return false;
+            const math::vec3 q = math::cross(tvec, e1);
+            v = math::dot(ray.direction, q) * inv;
+            if (v < 0.0f || u + v > 1.0f) return false;
+            t = math::dot(e2, q) * inv;
+            return t >= 0.0f;
+        }
+
+        [[nodiscard]] bool validate_node(std::uint32_t& next_node, std::uint32_t& next_triangle,
+                                         std::size_t depth) const
+        {
+            if (next_node >= nodes_.size() || depth > kMaxDepth)
+            {
+                return false;
+            }
+            const std::uint32_t index = next_node++;
+            const Node& node = nodes_[index];
+            const auto encloses = [&](const Aabb& inner)
+            {
+                return inner.min[0] >= node.bounds.min[0] && inner.min[1] >= node.bounds.min[1] &&
+                       inner.min[2] >= node.bounds.min[2] && inner.max[0] <= node.bounds.max[0] &&
+                       inner.max[1] <= node.bounds.max[1] && inner.max[2] <= node.bounds.max[2];
+            };
+
+            if (node.is_leaf())
+            {
+                if (node.offset != next_triangle || node.offset + std::size_t{node.count} > triangles_.size())
+                {
+                    return false;
+                }
+                next_triangle += node.count;
+                return encloses(leaf_bounds(node));
+            }
+
+            if (!validate_node(next_node, next_triangle, depth + 1) || next_node != node.offset ||
+                !encloses(nodes_[index + 1].bounds) || !encloses(nodes_[node.offset].bounds))
+            {
+                return false;
+            }
+            return validate_node(next_node, next_triangle, depth + 1);
+        }
+
+        BuildOptions options_;
+        std::vector<Node> nodes_;
+        std::vector<std::array<std::uint32_t, 3>> triangles_;
+        std::vector<std::size_t> primitive_ids_;
+        std::vector<math::vec3> vertices_;
+    };
+}
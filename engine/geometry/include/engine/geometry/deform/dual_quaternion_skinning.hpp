@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <span>
+
+#include "engine/animation/rigging/rig_binding.hpp"
+#include "engine/geometry/api.hpp"
+#include "engine/math/transform.hpp"
+
+namespace engine::geometry::deform
+{
+    // Skinning transform split for dual-quaternion blending: the unit rotation `real` (w, x, y, z), the dual
+    // part `dual` = ½·translation·real, and the per-axis scale in `scale` (the fourth lane is padding). The
+    // three groups are contiguous so a blend is twelve packed multiply-adds, as for SkinningMatrix.
+    struct alignas(16) SkinningDualQuaternion
+    {
+        std::array<float, 4> real{1.0F, 0.0F, 0.0F, 0.0F};
+        std::array<float, 4> dual{0.0F, 0.0F, 0.0F, 0.0F};
+        std::array<float, 4> scale{1.0F, 1.0F, 1.0F, 0.0F};
+    };
+
+    [[nodiscard]] SkinningDualQuaternion to_skinning_dual_quaternion(const math::Transform<float>& transform) noexcept;
+
+    // Converts every transform once; `out_palette` must hold at least `skinning_transforms.size()` entries.
+    void build_dual_quaternion_palette(std::span<const math::Transform<float>> skinning_transforms,
+                                       std::span<SkinningDualQuaternion> out_palette);
+
+    // Dual-quaternion counterpart of apply_linear_blend_skinning, with the same inputs, threading, bounds and
+    // normal handling. Scale is blended linearly and applied in bind space before the blended rigid motion
+    // (two-phase skinning), so scaled joints still skin; shear is not representable. Each influence's rotation
+    // is flipped into the hemisphere of the vertex's first influence before blending.
+    void apply_dual_quaternion_skinning(const animation::RigBinding& binding,
+                                        std::span<const SkinningDualQuaternion> palette,
+                                        SurfaceMesh& mesh);
+
+    // Builds the palette from `skinning_transforms` and skins with it.
+    void apply_dual_quaternion_skinning(const animation::RigBinding& binding,
+                                        std::span<const math::Transform<float>> skinning_transforms,
+                                        SurfaceMesh& mesh);
+}
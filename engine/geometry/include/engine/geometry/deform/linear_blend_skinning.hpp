@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <span>
 
 #include "engine/animation/rigging/rig_binding.hpp"
@@ -8,8 +9,30 @@
 
 namespace engine::geometry::deform
 {
+    // Affine skinning transform as the top three rows of its 4×4 matrix, row-major: row r is
+    // rows[4r .. 4r + 3] and the translation is the last column. Blending twelve contiguous floats per
+    // influence maps onto packed multiply-adds, where a Transform would rebuild its rotation every time.
+    struct alignas(16) SkinningMatrix
+    {
+        std::array<float, 12> rows{1.0F, 0.0F, 0.0F, 0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 0.0F, 0.0F, 1.0F, 0.0F};
+    };
+
+    [[nodiscard]] SkinningMatrix to_skinning_matrix(const math::Transform<float>& transform) noexcept;
+
+    // Converts every transform once; `out_palette` must hold at least `skinning_transforms.size()` entries.
+    void build_skinning_palette(std::span<const math::Transform<float>> skinning_transforms,
+                                std::span<SkinningMatrix> out_palette);
+
+    // Skins rest_positions into positions across the worker pool and refreshes the bounds in the same pass.
+    // When the mesh has one rest normal per rest position, normals are skinned with the cofactor of each
+    // blended matrix (correct under non-uniform scale); otherwise they are recomputed from the new positions.
+    // Vertices without a valid influence keep their rest position and normal.
+    void apply_linear_blend_skinning(const animation::RigBinding& binding,
+                                     std::span<const SkinningMatrix> palette,
+                                     SurfaceMesh& mesh);
+
+    // Builds the palette from `skinning_transforms` and skins with it.
     void apply_linear_blend_skinning(const animation::RigBinding& binding,
                                      std::span<const math::Transform<float>> skinning_transforms,
                                      SurfaceMesh& mesh);
 }
-
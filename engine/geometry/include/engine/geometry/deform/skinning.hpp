@@ -0,0 +1,32 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "engine/animation/rigging/rig_binding.hpp"
+#include "engine/geometry/api.hpp"
+#include "engine/geometry/deform/dual_quaternion_skinning.hpp"
+#include "engine/geometry/deform/linear_blend_skinning.hpp"
+#include "engine/math/transform.hpp"
+
+namespace engine::geometry::deform
+{
+    // Palette storage for apply_skinning. Only the palette of the mesh's method is resized and filled, so a
+    // caller that keeps one per skinned mesh stops allocating after the first frame.
+    struct SkinningPalettes
+    {
+        std::vector<SkinningMatrix> matrices;
+        std::vector<SkinningDualQuaternion> dual_quaternions;
+    };
+
+    // Skins `mesh` with the technique selected by its `skinning_method`.
+    void apply_skinning(const animation::RigBinding& binding,
+                        std::span<const math::Transform<float>> skinning_transforms,
+                        SurfaceMesh& mesh);
+
+    // As above, building the palette into `palettes` instead of a temporary.
+    void apply_skinning(const animation::RigBinding& binding,
+                        std::span<const math::Transform<float>> skinning_transforms,
+                        SkinningPalettes& palettes,
+                        SurfaceMesh& mesh);
+}
@@ -62,6 +62,8 @@ namespace engine::geometry::graph {
 
         void reserve(std::size_t nvertices, std::size_t nedges);
 
+        // Drops deleted elements from every property in place; survivors keep their relative order and capacity
+        // is kept until free_memory().
         void garbage_collection();
 
         [[nodiscard]] std::size_t vertices_size() const noexcept { return vertex_props_.size(); }
@@ -134,6 +136,16 @@ namespace engine::geometry::graph {
             return VertexProperty<T>(vertex_props_.get_or_add<T>(name, default_value));
         }
 
+        template<class T>
+        [[nodiscard]] VertexProperty<T> get_vertex_property(const PropertyKey<T> &key) const {
+            return VertexProperty<T>(vertex_props_.get<T>(key));
+        }
+
+        template<class T>
+        [[nodiscard]] VertexProperty<T> vertex_property(const PropertyKey<T> &key, T default_value = T()) {
+            return VertexProperty<T>(vertex_props_.get_or_add<T>(key, default_value));
+        }
+
         template<class T>
         void remove_vertex_property(VertexProperty<T> &prop) {
             vertex_props_.remove(prop);
@@ -166,11 +178,31 @@ namespace engine::geometry::graph {
             return HalfedgeProperty<T>(halfedge_props_.get_or_add<T>(name, default_value));
         }
 
+        template<class T>
+        [[nodiscard]] HalfedgeProperty<T> get_halfedge_property(const PropertyKey<T> &key) const {
+            return HalfedgeProperty<T>(halfedge_props_.get<T>(key));
+        }
+
+        template<class T>
+        [[nodiscard]] HalfedgeProperty<T> halfedge_property(const PropertyKey<T> &key, T default_value = T()) {
+            return HalfedgeProperty<T>(halfedge_props_.get_or_add<T>(key, default_value));
+        }
+
         template<class T>
         [[nodiscard]] EdgeProperty<T> edge_property(const std::string &name, T default_value = T()) {
             return EdgeProperty<T>(edge_props_.get_or_add<T>(name, default_value));
         }
 
+        template<class T>
+        [[nodiscard]] EdgeProperty<T> get_edge_property(const PropertyKey<T> &key) const {
+            return EdgeProperty<T>(edge_props_.get<T>(key));
+        }
+
+        template<class T>
+        [[nodiscard]] EdgeProperty<T> edge_property(const PropertyKey<T> &key, T default_value = T()) {
+            return EdgeProperty<T>(edge_props_.get_or_add<T>(key, default_value));
+        }
+
         template<class T>
         void remove_halfedge_property(HalfedgeProperty<T> &prop) {
             halfedge_props_.remove(prop);
@@ -5,42 +5,74 @@
 #include "engine/geometry/properties/property_handle.hpp"
 #include "engine/geometry/shapes/aabb.hpp"
 #include "engine/geometry/utils/shape_interactions.hpp"
+#include "engine/geometry/utils/batched_queries.hpp"
 #include "engine/geometry/utils/bounded_heap.hpp"
+#include "engine/geometry/utils/query_scratch.hpp"
+#include "engine/geometry/utils/spatial_build.hpp"
+#include "engine/math/parallel.hpp"
 #include "engine/math/vector.hpp"
 
 #include <array>
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
-#include <functional>
-#include <queue>
 #include <limits>
 #include <numeric>
+#include <span>
 #include <utility>
 #include <vector>
 
 namespace engine::geometry
 {
+    // Static kd-tree over a snapshot of a position property.
+    //
+    // Nodes are 16-byte records stored depth-first, so an interior node's left child is the next record and
+    // only the right child is stored. Leaves reference a contiguous range of the leaf-ordered coordinate
+    // arrays, which are kept as SoA so leaf scans run as straight vectorisable loops. Nodes carry no bounds:
+    // traversals track the per-axis distance from the query to the current cell incrementally (Arya & Mount).
     class ENGINE_GEOMETRY_API KdTree
     {
     public:
-        struct Node
+        struct alignas(16) Node
         {
-            Aabb aabb{};
-            std::size_t first_point = 0;
-            std::size_t num_points = 0;
-            std::array<std::size_t, 2> children{};
-            std::uint8_t split_axis = 0U;
+            static constexpr std::uint32_t kLeaf = 3U;
+
             float split_position = 0.0f;
-            bool is_leaf = true;
+            // Interior: index of the right child. Leaf: first leaf-ordered point.
+            std::uint32_t offset = 0U;
+            // Leaf: number of points. Unused for interior nodes.
+            std::uint32_t count = 0U;
+            // Split axis, or kLeaf.
+            std::uint32_t axis = kLeaf;
+
+            [[nodiscard]] bool is_leaf() const noexcept { return axis == kLeaf; }
+        };
+        static_assert(sizeof(Node) == 16, "KdTree::Node must stay a 16-byte record");
 
-            Node()
-            {
-                children.fill(NodeHandle().index());
-            }
+        // Median splits the widest axis at the median point (balanced tree, fastest build); SurfaceAreaHeuristic
+        // picks the binned SAH plane over all three axes (tighter cells for range and ray-like queries).
+        enum class SplitPoint { Median, SurfaceAreaHeuristic };
+
+        // Early termination for query_knn_approximate(). With epsilon > 0 cells farther than
+        // (current k-th distance) / (1 + epsilon) are skipped, so the i-th result is within (1 + epsilon) of
+        // the true i-th nearest distance. max_leaves stops the search after that many leaf scans.
+        struct ApproximateKnn
+        {
+            float epsilon = 0.0f;
+            std::size_t max_leaves = std::numeric_limits<std::size_t>::max();
+        };
+
+        struct KnnStats
+        {
+            std::size_t leaves_visited = 0;
+            // Certified a posteriori bound: each returned distance is at most (1 + achieved_epsilon) times
+            // the true distance of the same rank. 0 when the result is exact, infinity when nothing can be
+            // guaranteed (fewer than k points found, or the budget stopped at a cell containing the query).
+            float achieved_epsilon = 0.0f;
         };
 
+        // Per-node user data, indexed by NodeHandle(i) for nodes()[i]; resized on every build.
         Nodes node_props_;
-        NodeProperty<Node> nodes;
 
         Property<math::vec3> points;
 
@@ -62,6 +94,18 @@ namespace engine::geometry
             return NodeProperty<T>(node_props_.get_or_add<T>(name, default_value));
         }
 
+        template <class T>
+        [[nodiscard]] NodeProperty<T> get_node_property(const PropertyKey<T>& key) const
+        {
+            return NodeProperty<T>(node_props_.get<T>(key));
+        }
+
+        template <class T>
+        [[nodiscard]] NodeProperty<T> node_property(const PropertyKey<T>& key, T default_value = T())
+        {
+            return NodeProperty<T>(node_props_.get_or_add<T>(key, default_value));
+        }
+
         template <class T>
         void remove_node_property(NodeProperty<T>& prop)
         {
@@ -74,10 +118,25 @@ namespace engine::geometry
 
         [[nodiscard]] std::size_t get_max_depth() const noexcept { return max_depth_; }
 
+        [[nodiscard]] SplitPoint get_split_point() const noexcept { return split_point_; }
+
+        // Original point index of every leaf-ordered slot.
         [[nodiscard]] const std::vector<std::size_t>& get_point_indices() const noexcept { return point_indices_; }
 
-        // Rebuild the tree from the supplied position property.
-        bool build(const Property<math::vec3>& positions, std::size_t max_points_per_leaf, std::size_t max_depth)
+        [[nodiscard]] std::span<const Node> nodes() const noexcept { return nodes_; }
+
+        [[nodiscard]] std::size_t node_count() const noexcept { return nodes_.size(); }
+
+        [[nodiscard]] const Aabb& bounds() const noexcept { return bounds_; }
+
+        // Rebuild the tree from the supplied position property. Coordinates are copied into leaf order, so
+        // later edits to `positions` require a rebuild. At most 2^32 - 1 points are supported.
+        //
+        // The top levels are split with data-parallel partition passes; once a range drops below
+        // kSubtreePoints its subtree is deferred and all deferred subtrees are built concurrently on the math
+        // worker pool. Split decisions only depend on the data, so the tree is identical for any thread count.
+        bool build(const Property<math::vec3>& positions, std::size_t max_points_per_leaf, std::size_t max_depth,
+                   SplitPoint split_point = SplitPoint::Median)
         {
             points = positions;
             if (!points)
@@ -87,287 +146,503 @@ namespace engine::geometry
 
             max_points_per_leaf_ = std::max<std::size_t>(1, max_points_per_leaf);
             max_depth_ = std::max<std::size_t>(1, max_depth);
+            split_point_ = split_point;
+
+            node_props_.clear();
+            nodes_.clear();
+            xs_.clear();
+            ys_.clear();
+            zs_.clear();
 
             const std::size_t num_points = points.vector().size();
-            if (num_points == 0)
+            if (num_points == 0 || num_points >= std::numeric_limits<std::uint32_t>::max())
             {
-                node_props_.clear();
                 point_indices_.clear();
                 return false;
             }
 
-            node_props_.clear();
-            node_props_.reserve(num_points * 2);
-
             point_indices_.resize(num_points);
             std::iota(point_indices_.begin(), point_indices_.end(), 0);
+            nodes_.reserve(2 * (num_points / max_points_per_leaf_) + 1);
 
-            nodes = add_node_property<Node>("n:nodes");
-            const NodeHandle root = create_node();
-            nodes[root].first_point = 0;
-            nodes[root].num_points = num_points;
-            nodes[root].aabb = compute_bounds(0, num_points);
-
-            // The root owns the entire index span and recursively partitions it.
-            build_node(root, 0, 0, num_points);
+            bounds_ = compute_bounds(0, num_points);
+            std::vector<Subtree> subtrees;
+            build_node(nodes_, &subtrees, 0, 0, num_points, bounds_);
+            math::parallel::parallel_for(0, subtrees.size(), 1, [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    Subtree& subtree = subtrees[i];
+                    build_node(subtree.nodes, nullptr, subtree.depth, subtree.begin, subtree.end, subtree.bounds);
+                }
+            });
+            splice_subtrees(subtrees);
+
+            xs_.resize(num_points);
+            ys_.resize(num_points);
+            zs_.resize(num_points);
+            const math::vec3* coords = points.span().data();
+            math::parallel::parallel_for(0, num_points, utils::kBuildGrain, [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    const math::vec3& p = coords[point_indices_[i]];
+                    xs_[i] = p[0];
+                    ys_[i] = p[1];
+                    zs_[i] = p[2];
+                }
+            });
+            node_props_.resize(nodes_.size());
             return true;
         }
 
         // Collect every point contained inside the axis-aligned query volume.
         void query(const Aabb& region, std::vector<std::size_t>& result) const
         {
+            QueryScratch scratch;
+            scratch.results.swap(result);
+            query(region, scratch);
+            result.swap(scratch.results);
+        }
+
+        // Collect all points whose Euclidean distance from the query point is below the radius.
+        void query_radius(const math::vec3& query_point, float radius, std::vector<std::size_t>& result) const
+        {
+            QueryScratch scratch;
+            scratch.results.swap(result);
+            query_radius(query_point, radius, scratch);
+            result.swap(scratch.results);
+        }
+
+        // Return the indices of the k closest points using a best-first traversal.
+        void query_knn(const math::vec3& query_point, std::size_t k, std::vector<std::size_t>& results) const
+        {
+            QueryScratch scratch;
+            scratch.results.swap(results);
+            query_knn(query_point, k, scratch);
+            results.swap(scratch.results);
+        }
+
+        // Return the index of the closest point, or max() if the tree is empty.
+        void query_nearest(const math::vec3& query_point, std::size_t& result) const
+        {
+            QueryScratch scratch;
+            result = query_nearest(query_point, scratch);
+        }
+
+        // Allocation-free variants: traversal state and results live in `scratch`, and the returned span
+        // aliases scratch.results.
+        std::span<const std::size_t> query(const Aabb& region, QueryScratch& scratch) const
+        {
+            auto& result = scratch.results;
             result.clear();
-            if (node_props_.empty()) return;
+            if (nodes_.empty()) return {};
 
-            std::vector<NodeHandle> stack{NodeHandle{0}};
+            auto& stack = scratch.node_stack;
+            stack.assign(1, 0);
             while (!stack.empty())
             {
-                const NodeHandle node_idx = stack.back();
+                const std::size_t index = stack.back();
                 stack.pop_back();
-                const Node& node = nodes[node_idx];
+                const Node& node = nodes_[index];
 
-                if (!Intersects(node.aabb, region))
+                if (node.is_leaf())
                 {
-                    continue;
-                }
-
-                if (node.is_leaf)
-                {
-                    for (std::size_t i = 0; i < node.num_points; ++i)
+                    std::array<std::uint8_t, kLeafBlock> inside{};
+                    for (std::size_t first = node.offset, end = first + node.count; first < end; first += kLeafBlock)
                     {
-                        const std::size_t pi = point_indices_[node.first_point + i];
-                        if (Contains(region, points[pi]))
+                        const std::size_t n = std::min(kLeafBlock, end - first);
+                        const float* x = xs_.data() + first;
+                        const float* y = ys_.data() + first;
+                        const float* z = zs_.data() + first;
+                        for (std::size_t j = 0; j < n; ++j)
                         {
-                            result.push_back(pi);
+                            inside[j] = static_cast<std::uint8_t>(
+                                (x[j] >= region.min[0]) & (x[j] <= region.max[0]) &
+                                (y[j] >= region.min[1]) & (y[j] <= region.max[1]) &
+                                (z[j] >= region.min[2]) & (z[j] <= region.max[2]));
                         }
-                    }
-                }
-                else
-                {
-                    for (const auto child_index : node.children)
-                    {
-                        const NodeHandle child(child_index);
-                        if (child.is_valid())
+                        for (std::size_t j = 0; j < n; ++j)
                         {
-                            stack.push_back(child);
+                            if (inside[j] != 0U)
+                            {
+                                result.push_back(point_indices_[first + j]);
+                            }
                         }
                     }
+                    continue;
+                }
+
+                if (region.max[node.axis] >= node.split_position)
+                {
+                    stack.push_back(node.offset);
+                }
+                if (region.min[node.axis] <= node.split_position)
+                {
+                    stack.push_back(index + 1);
                 }
             }
+            return result;
         }
 
-        // Collect all points whose Euclidean distance from the query point is below the radius.
-        void query_radius(const math::vec3& query_point, float radius, std::vector<std::size_t>& result) const
+        std::span<const std::size_t> query_radius(const math::vec3& query_point, float radius,
+                                                  QueryScratch& scratch) const
         {
+            auto& result = scratch.results;
             result.clear();
-            if (node_props_.empty() || radius < 0.0f) return;
+            if (nodes_.empty() || radius < 0.0f) return {};
 
-            const float radius_sq = radius * radius;
-            std::vector<NodeHandle> stack{NodeHandle{0}};
-            while (!stack.empty())
+            visit_radius(query_point, radius * radius, scratch, [&](std::size_t index, float)
             {
-                const NodeHandle node_idx = stack.back();
-                stack.pop_back();
-                const Node& node = nodes[node_idx];
+                result.push_back(index);
+            });
+            return result;
+        }
+
+        // The k closest points in ascending distance order.
+        std::span<const std::size_t> query_knn(const math::vec3& query_point, std::size_t k,
+                                               QueryScratch& scratch) const
+        {
+            auto& result = scratch.results;
+            result.clear();
+            if (nodes_.empty() || k == 0) return {};
+
+            knn_search(query_point, k, scratch, ApproximateKnn{});
+            for (const auto& neighbor : scratch.neighbors)
+            {
+                result.push_back(neighbor.second);
+            }
+            return result;
+        }
 
-                if (static_cast<float>(SquaredDistance(node.aabb, query_point)) > radius_sq)
+        // Index of the closest point (smallest index among equally close ones), or max() if the tree is empty.
+        [[nodiscard]] std::size_t query_nearest(const math::vec3& query_point, QueryScratch& scratch) const
+        {
+            std::size_t result = std::numeric_limits<std::size_t>::max();
+            if (nodes_.empty())
+            {
+                return result;
+            }
+
+            float best_dist_sq = std::numeric_limits<float>::infinity();
+            auto& pq = scratch.cells;
+            pq.assign(1, root_cell(query_point));
+
+            while (!pq.empty())
+            {
+                std::pop_heap(pq.begin(), pq.end(), TraversalCellGreater{});
+                TraversalCell cell = pq.back();
+                pq.pop_back();
+                if (cell.distance_sq > best_dist_sq)
                 {
-                    continue;
+                    break;
                 }
 
-                if (node.is_leaf)
+                while (!nodes_[cell.node].is_leaf())
                 {
-                    for (std::size_t i = 0; i < node.num_points; ++i)
+                    const TraversalCell far = split_cell(cell, query_point);
+                    if (far.distance_sq <= best_dist_sq)
                     {
-                        const std::size_t pi = point_indices_[node.first_point + i];
-                        const math::vec3 diff = points[pi] - query_point;
-                        if (math::length_squared(diff) <= radius_sq)
-                        {
-                            result.push_back(pi);
-                        }
+                        pq.push_back(far);
+                        std::push_heap(pq.begin(), pq.end(), TraversalCellGreater{});
                     }
                 }
-                else
+
+                scan_leaf(nodes_[cell.node], query_point, [&](std::size_t slot, float dist_sq)
                 {
-                    for (const auto child_index : node.children)
+                    const std::size_t pi = point_indices_[slot];
+                    if (dist_sq < best_dist_sq || (dist_sq == best_dist_sq && pi < result))
                     {
-                        const NodeHandle child(child_index);
-                        if (child.is_valid())
-                        {
-                            stack.push_back(child);
-                        }
+                        best_dist_sq = dist_sq;
+                        result = pi;
                     }
-                }
+                });
             }
+            return result;
         }
 
-        // Return the indices of the k closest points using a best-first traversal.
-        void query_knn(const math::vec3& query_point, std::size_t k, std::vector<std::size_t>& results) const
+        // k-nearest search with approximation controls; results go to `results` in ascending distance order.
+        KnnStats query_knn_approximate(const math::vec3& query_point, std::size_t k, const ApproximateKnn& options,
+                                       std::vector<std::size_t>& results) const
         {
-            results.clear();
-            if (node_props_.empty() || k == 0) return;
-
-            using QueueElement = std::pair<float, std::size_t>;
-            utils::BoundedHeap<QueueElement> heap(k);
+            QueryScratch scratch;
+            scratch.results.swap(results);
+            const KnnStats stats = query_knn_approximate(query_point, k, options, scratch);
+            results.swap(scratch.results);
+            return stats;
+        }
 
-            using Traversal = std::pair<float, NodeHandle>;
-            std::priority_queue<Traversal, std::vector<Traversal>, std::greater<>> pq;
+        // Allocation-free variant; the neighbours are left in scratch.results.
+        KnnStats query_knn_approximate(const math::vec3& query_point, std::size_t k, const ApproximateKnn& options,
+                                       QueryScratch& scratch) const
+        {
+            scratch.results.clear();
+            if (nodes_.empty() || k == 0) return {};
 
-            auto node_distance = [&](NodeHandle ni)
+            const KnnStats stats = knn_search(query_point, k, scratch, options);
+            for (const auto& neighbor : scratch.neighbors)
             {
-                return static_cast<float>(SquaredDistance(nodes[ni].aabb, query_point));
-            };
-            auto point_distance = [&](std::size_t pi)
-            {
-                const math::vec3 diff = points[pi] - query_point;
-                return math::length_squared(diff);
-            };
+                scratch.results.push_back(neighbor.second);
+            }
+            return stats;
+        }
 
-            constexpr NodeHandle root(0);
-            pq.emplace(node_distance(root), root);
-            float tau = std::numeric_limits<float>::infinity();
-            auto update_tau = [&]()
+        // Batched query_knn(): row q of `result` holds the k nearest points of queries[q] in ascending
+        // distance order. Queries are spread over the math worker pool in Morton order.
+        void query_knn_batch(std::span<const math::vec3> queries, std::size_t k, NeighborList& result) const
+        {
+            if (nodes_.empty() || k == 0)
             {
-                tau = (heap.size() == k) ? heap.top().first : std::numeric_limits<float>::infinity();
-            };
+                result.clear();
+                result.offsets.assign(queries.size() + 1, 0);
+                return;
+            }
 
-            while (!pq.empty())
+            utils::RunBatchedQueries(queries, result, [&](const math::vec3& query_point, QueryScratch& scratch,
+                                                          std::vector<std::size_t>& indices,
+                                                          std::vector<float>& distances_sq)
             {
-                const float node_dist = pq.top().first;
-                const NodeHandle node_idx = pq.top().second;
-                pq.pop();
-
-                if (heap.size() == k && node_dist > tau)
+                knn_search(query_point, k, scratch, ApproximateKnn{});
+                for (const auto& [dist_sq, index] : scratch.neighbors)
                 {
-                    break;
+                    indices.push_back(index);
+                    distances_sq.push_back(dist_sq);
                 }
+            });
+        }
 
-                const Node& node = nodes[node_idx];
-                if (node.is_leaf)
-                {
-                    for (std::size_t i = 0; i < node.num_points; ++i)
-                    {
-                        const std::size_t pi = point_indices_[node.first_point + i];
-                        const float dist = point_distance(pi);
-                        const QueueElement candidate(dist, pi);
-                        if (heap.size() < k || candidate < heap.top())
-                        {
-                            heap.push(candidate);
-                            update_tau();
-                        }
-                    }
-                }
-                else
-                {
-                    for (const auto child_index : node.children)
-                    {
-                        const NodeHandle child(child_index);
-                        if (!child.is_valid())
-                        {
-                            continue;
-                        }
-                        const float child_dist = node_distance(child);
-                        if (child_dist <= tau)
-                        {
-                            pq.emplace(child_dist, child);
-                        }
-                    }
-                }
+        // Batched query_radius(): row q of `result` holds every point within `radius` of queries[q], in the
+        // same order query_radius() reports them.
+        void query_radius_batch(std::span<const math::vec3> queries, float radius, NeighborList& result) const
+        {
+            if (nodes_.empty() || radius < 0.0f)
+            {
+                result.clear();
+                result.offsets.assign(queries.size() + 1, 0);
+                return;
             }
 
-            auto data = heap.get_sorted_data();
-            results.resize(data.size());
-            for (std::size_t i = 0; i < data.size(); ++i)
+            utils::RunBatchedQueries(queries, result, [&](const math::vec3& query_point, QueryScratch& scratch,
+                                                          std::vector<std::size_t>& indices,
+                                                          std::vector<float>& distances_sq)
+            {
+                visit_radius(query_point, radius * radius, scratch, [&](std::size_t index, float dist_sq)
+                {
+                    indices.push_back(index);
+                    distances_sq.push_back(dist_sq);
+                });
+            });
+        }
+
+        [[nodiscard]] bool validate_structure() const
+        {
+            if (nodes_.empty())
             {
-                results[i] = data[i].second;
+                return point_indices_.empty();
             }
+
+            std::uint32_t next_node = 0;
+            std::size_t next_point = 0;
+            return validate_node(next_node, next_point, bounds_) && next_node == nodes_.size() &&
+                   next_point == point_indices_.size();
         }
 
-        // Return the index of the closest point, or max() if the tree is empty.
-        void query_nearest(const math::vec3& query_point, std::size_t& result) const
+    private:
+        static constexpr std::size_t kLeafBlock = 16;
+
+        // The root together with the per-axis distances from the query to the tree bounds.
+        [[nodiscard]] TraversalCell root_cell(const math::vec3& query_point) const
         {
-            result = std::numeric_limits<std::size_t>::max();
-            if (node_props_.empty())
+            TraversalCell cell;
+            for (std::size_t axis = 0; axis < 3; ++axis)
             {
-                return;
+                cell.offsets[axis] = std::max({bounds_.min[axis] - query_point[axis],
+                                               query_point[axis] - bounds_.max[axis], 0.0f});
             }
+            cell.distance_sq = math::length_squared(cell.offsets);
+            return cell;
+        }
 
-            double best_dist_sq = std::numeric_limits<double>::max();
-            using Traversal = std::pair<float, NodeHandle>;
-            std::priority_queue<Traversal, std::vector<Traversal>, std::greater<>> pq;
+        // Moves `cell` to the child on the query's side of the split and returns the cell of the other child.
+        // The far cell's distance is recomputed from its offsets rather than updated incrementally, so it
+        // never exceeds the computed distance of any point inside it.
+        [[nodiscard]] TraversalCell split_cell(TraversalCell& cell, const math::vec3& query_point) const
+        {
+            const std::size_t index = cell.node;
+            const Node& node = nodes_[index];
+            const float diff = query_point[node.axis] - node.split_position;
+
+            TraversalCell far = cell;
+            far.offsets[node.axis] = diff < 0.0f ? -diff : diff;
+            far.distance_sq = math::length_squared(far.offsets);
+            if (diff < 0.0f)
+            {
+                cell.node = index + 1;
+                far.node = node.offset;
+            }
+            else
+            {
+                cell.node = node.offset;
+                far.node = index + 1;
+            }
+            return far;
+        }
 
-            auto node_distance = [&](NodeHandle ni)
+        // Invokes fn(slot, squared distance) for every point of a leaf. Distances are computed a block at a
+        // time from the SoA coordinates so the arithmetic vectorises independently of fn.
+        template <class Fn>
+        void scan_leaf(const Node& node, const math::vec3& query_point, Fn&& fn) const
+        {
+            std::array<float, kLeafBlock> dist_sq{};
+            for (std::size_t first = node.offset, end = first + node.count; first < end; first += kLeafBlock)
             {
-                return static_cast<float>(SquaredDistance(nodes[ni].aabb, query_point));
-            };
-            auto point_distance = [&](std::size_t pi)
+                const std::size_t n = std::min(kLeafBlock, end - first);
+                const float* x = xs_.data() + first;
+                const float* y = ys_.data() + first;
+                const float* z = zs_.data() + first;
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    const float dx = x[j] - query_point[0];
+                    const float dy = y[j] - query_point[1];
+                    const float dz = z[j] - query_point[2];
+                    dist_sq[j] = dx * dx + dy * dy + dz * dz;
+                }
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    fn(first + j, dist_sq[j]);
+                }
+            }
+        }
+
+        // Invokes fn(point index, squared distance) for every point within sqrt(radius_sq) of the query.
+        template <class Fn>
+        void visit_radius(const math::vec3& query_point, float radius_sq, QueryScratch& scratch, Fn&& fn) const
+        {
+            auto& stack = scratch.cells;
+            stack.assign(1, root_cell(query_point));
+            while (!stack.empty())
             {
-                const math::vec3 diff = points[pi] - query_point;
-                return static_cast<double>(math::length_squared(diff));
-            };
+                TraversalCell cell = stack.back();
+                stack.pop_back();
+                if (cell.distance_sq > radius_sq)
+                {
+                    continue;
+                }
+
+                // Descend towards the query; far cells within the radius are deferred.
+                while (!nodes_[cell.node].is_leaf())
+                {
+                    const TraversalCell far = split_cell(cell, query_point);
+                    if (far.distance_sq <= radius_sq)
+                    {
+                        stack.push_back(far);
+                    }
+                }
 
-            constexpr NodeHandle root(0);
-            pq.emplace(node_distance(root), root);
+                scan_leaf(nodes_[cell.node], query_point, [&](std::size_t slot, float dist_sq)
+                {
+                    if (dist_sq <= radius_sq)
+                    {
+                        fn(point_indices_[slot], dist_sq);
+                    }
+                });
+            }
+        }
 
+        // Leaves the k nearest (squared distance, point index) pairs in scratch.neighbors, ascending. Cells
+        // are skipped once they are farther than tau / (1 + epsilon)^2, tau being the squared k-th distance;
+        // the closest skipped or unvisited cell certifies the achieved error.
+        KnnStats knn_search(const math::vec3& query_point, std::size_t k, QueryScratch& scratch,
+                            const ApproximateKnn& options) const
+        {
+            auto& heap = scratch.neighbors;
+            auto& pq = scratch.cells;
+            heap.clear();
+            pq.assign(1, root_cell(query_point));
+
+            const float shrink = 1.0f / ((1.0f + options.epsilon) * (1.0f + options.epsilon));
+            constexpr float inf = std::numeric_limits<float>::infinity();
+            float tau = inf;
+            float bound = inf; // tau * shrink
+            float unexplored = inf; // smallest distance of a cell that was not scanned
+            KnnStats stats;
             while (!pq.empty())
             {
-                const float node_dist = pq.top().first;
-                const NodeHandle node_idx = pq.top().second;
-                pq.pop();
-
-                if (static_cast<double>(node_dist) >= best_dist_sq)
+                std::pop_heap(pq.begin(), pq.end(), TraversalCellGreater{});
+                TraversalCell cell = pq.back();
+                pq.pop_back();
+                if (cell.distance_sq > bound || stats.leaves_visited >= options.max_leaves)
                 {
+                    unexplored = std::min(unexplored, cell.distance_sq);
                     break;
                 }
 
-                const Node& node = nodes[node_idx];
-                if (node.is_leaf)
+                while (!nodes_[cell.node].is_leaf())
                 {
-                    for (std::size_t i = 0; i < node.num_points; ++i)
+                    const TraversalCell far = split_cell(cell, query_point);
+                    if (far.distance_sq <= bound)
                     {
-                        const std::size_t pi = point_indices_[node.first_point + i];
-                        const double dist_sq = point_distance(pi);
-                        if (dist_sq < best_dist_sq)
-                        {
-                            best_dist_sq = dist_sq;
-                            result = pi;
-                        }
+                        pq.push_back(far);
+                        std::push_heap(pq.begin(), pq.end(), TraversalCellGreater{});
+                    }
+                    else
+                    {
+                        unexplored = std::min(unexplored, far.distance_sq);
                     }
                 }
-                else
+
+                ++stats.leaves_visited;
+                scan_leaf(nodes_[cell.node], query_point, [&](std::size_t slot, float dist_sq)
                 {
-                    for (const auto child_index : node.children)
+                    const std::pair<float, std::size_t> candidate(dist_sq, point_indices_[slot]);
+                    if (heap.size() < k || candidate < heap.front())
                     {
-                        const NodeHandle child(child_index);
-                        if (!child.is_valid())
+                        utils::push_bounded(heap, k, candidate);
+                        if (heap.size() == k)
                         {
-                            continue;
-                        }
-                        const float child_dist = node_distance(child);
-                        if (static_cast<double>(child_dist) < best_dist_sq)
-                        {
-                            pq.emplace(child_dist, child);
+                            tau = heap.front().first;
+                            bound = tau * shrink;
                         }
                     }
-                }
+                });
             }
-        }
+            std::sort_heap(heap.begin(), heap.end());
 
-        [[nodiscard]] bool validate_structure() const
-        {
-            if (node_props_.empty())
+            if (unexplored == inf || (heap.size() == k && unexplored >= tau))
             {
-                return point_indices_.empty();
+                stats.achieved_epsilon = 0.0f;
+            }
+            else if (heap.size() < k || unexplored <= 0.0f)
+            {
+                stats.achieved_epsilon = inf;
+            }
+            else
+            {
+                stats.achieved_epsilon = std::sqrt(tau / unexplored) - 1.0f;
             }
-            return validate_node(NodeHandle{0});
+            return stats;
         }
 
-    private:
-        [[nodiscard]] NodeHandle create_node()
+        // Subtrees at most this large are built as independent tasks.
+        static constexpr std::size_t kSubtreePoints = 16384;
+        // Placeholder axis of a node whose subtree is still being built.
+        static constexpr std::uint32_t kDeferred = 4U;
+
+        struct Subtree
         {
-            node_props_.push_back();
-            return NodeHandle(node_props_.size() - 1);
-        }
+            std::size_t depth = 0;
+            std::size_t begin = 0;
+            std::size_t end = 0;
+            Aabb bounds{};
+            std::vector<Node> nodes;
+        };
+
+        struct Split
+        {
+            std::uint32_t axis = Node::kLeaf;
+            float position = 0.0f;
+            std::size_t mid = 0;
+        };
 
         [[nodiscard]] Aabb compute_bounds(std::size_t first, std::size_t count) const
         {
@@ -375,112 +650,262 @@ namespace engine::geometry
             {
                 return {};
             }
-
-            Aabb bounds = BoundingAabb(points[point_indices_[first]]);
-            for (std::size_t i = 1; i < count; ++i)
+            const math::vec3* coords = points.span().data();
+            const std::size_t* indices = point_indices_.data() + first;
+            return utils::ParallelBounds(count, [&](std::size_t i)
             {
-                const std::size_t pi = point_indices_[first + i];
-                Merge(bounds, points[pi]);
-            }
-            return bounds;
+                const math::vec3& p = coords[indices[i]];
+                return Aabb{.min = p, .max = p};
+            });
         }
 
-        void build_node(NodeHandle node_idx, std::size_t depth, std::size_t begin, std::size_t end)
+        void make_leaf(std::vector<Node>& out, std::size_t index, std::size_t begin, std::size_t end)
         {
-            Node& node = nodes[node_idx];
-            node.first_point = begin;
-            node.num_points = end - begin;
-            node.aabb = compute_bounds(begin, node.num_points);
+            Node& node = out[index];
+            node.axis = Node::kLeaf;
+            node.offset = static_cast<std::uint32_t>(begin);
+            node.count = static_cast<std::uint32_t>(end - begin);
+        }
+
+        // Appends the subtree for [begin, end) to `out` in depth-first order; `bounds` tightly encloses its
+        // points. With `subtrees`, small ranges are deferred as placeholders instead of recursed into.
+        void build_node(std::vector<Node>& out, std::vector<Subtree>* subtrees, std::size_t depth, std::size_t begin,
+                        std::size_t end, const Aabb& bounds)
+        {
+            const std::size_t index = out.size();
+            out.emplace_back();
 
-            if (depth >= max_depth_ || node.num_points <= max_points_per_leaf_)
+            const std::size_t count = end - begin;
+            if (depth >= max_depth_ || count <= max_points_per_leaf_)
             {
-                node.is_leaf = true;
+                make_leaf(out, index, begin, end);
+                return;
+            }
+            if (subtrees != nullptr && count <= kSubtreePoints)
+            {
+                out[index].axis = kDeferred;
+                out[index].offset = static_cast<std::uint32_t>(subtrees->size());
+                subtrees->push_back({depth, begin, end, bounds, {}});
                 return;
             }
 
-            const math::vec3 extent = Extent(node.aabb);
-            int axis = 0;
+            const Split split = split_point_ == SplitPoint::SurfaceAreaHeuristic
+                                    ? split_sah(begin, end, bounds)
+                                    : split_median(begin, end, bounds);
+            if (split.axis == Node::kLeaf)
+            {
+                make_leaf(out, index, begin, end);
+                return;
+            }
+
+            out[index].axis = split.axis;
+            out[index].split_position = split.position;
+            build_node(out, subtrees, depth + 1, begin, split.mid, compute_bounds(begin, split.mid - begin));
+            out[index].offset = static_cast<std::uint32_t>(out.size());
+            build_node(out, subtrees, depth + 1, split.mid, end, compute_bounds(split.mid, end - split.mid));
+        }
+
+        // Median of the widest axis. Large ranges locate the median's bucket with a parallel histogram, move
+        // the points below/inside/above it with a stable parallel partition and only select within the bucket.
+        [[nodiscard]] Split split_median(std::size_t begin, std::size_t end, const Aabb& bounds)
+        {
+            const math::vec3 extent = Extent(bounds);
+            std::uint32_t axis = 0;
             if (extent[1] > extent[0]) axis = 1;
             if (extent[2] > extent[axis]) axis = 2;
-
             if (extent[axis] <= std::numeric_limits<float>::epsilon())
             {
-                node.is_leaf = true;
-                return;
+                return {};
             }
 
-            const std::size_t count = node.num_points;
+            const std::size_t count = end - begin;
             const std::size_t mid = begin + count / 2;
+            const math::vec3* coords = points.span().data();
             auto comp = [&](std::size_t lhs, std::size_t rhs)
             {
-                return points[lhs][axis] < points[rhs][axis];
+                return coords[lhs][axis] < coords[rhs][axis];
             };
-            std::nth_element(point_indices_.begin() + begin, point_indices_.begin() + mid,
-                             point_indices_.begin() + end, comp);
 
-            const std::size_t left_count = mid - begin;
-            const std::size_t right_count = end - mid;
-            if (left_count == 0 || right_count == 0)
+            if (count > utils::kParallelBuildThreshold)
             {
-                node.is_leaf = true;
-                return;
-            }
-
-            node.is_leaf = false;
-            node.split_axis = static_cast<std::uint8_t>(axis);
-            const std::size_t median_index = point_indices_[mid];
-            node.split_position = points[median_index][axis];
+                constexpr std::size_t kBins = 1024;
+                using Histogram = std::array<std::uint32_t, kBins>;
+                const float lo = bounds.min[axis];
+                const float scale = static_cast<float>(kBins) / (bounds.max[axis] - lo);
+                const auto bin_of = [&](std::size_t pi)
+                {
+                    const float bin = (coords[pi][axis] - lo) * scale;
+                    return bin <= 0.0f ? std::size_t{0} : std::min(kBins - 1, static_cast<std::size_t>(bin));
+                };
 
-            const NodeHandle left_child = create_node();
-            nodes[node_idx].children[0] = left_child.index();
-            build_node(left_child, depth + 1, begin, mid);
+                const Histogram histogram = math::parallel::parallel_reduce(
+                    begin, end, utils::kBuildGrain * 4, Histogram{},
+                    [&](std::size_t first, std::size_t last)
+                    {
+                        Histogram local{};
+                        for (std::size_t i = first; i < last; ++i) ++local[bin_of(point_indices_[i])];
+                        return local;
+                    },
+                    [](Histogram lhs, const Histogram& rhs)
+                    {
+                        for (std::size_t b = 0; b < kBins; ++b) lhs[b] += rhs[b];
+                        return lhs;
+                    });
 
-            const NodeHandle right_child = create_node();
-            nodes[node_idx].children[1] = right_child.index();
-            build_node(right_child, depth + 1, mid, end);
+                std::size_t median_bin = 0;
+                for (std::size_t below = 0; below + histogram[median_bin] <= count / 2; ++median_bin)
+                {
+                    below += histogram[median_bin];
+                }
+                const auto starts = utils::StableBucketPartition<3>(
+                    std::span(point_indices_).subspan(begin, count), [&](std::size_t pi)
+                    {
+                        const std::size_t bin = bin_of(pi);
+                        return bin < median_bin ? 0 : (bin == median_bin ? 1 : 2);
+                    });
+                std::nth_element(point_indices_.begin() + begin + starts[1], point_indices_.begin() + mid,
+                                 point_indices_.begin() + begin + starts[2], comp);
+            }
+            else
+            {
+                std::nth_element(point_indices_.begin() + begin, point_indices_.begin() + mid,
+                                 point_indices_.begin() + end, comp);
+            }
+            return {axis, coords[point_indices_[mid]][axis], mid};
         }
 
-        [[nodiscard]] bool validate_node(NodeHandle node_idx) const
+        // Binned SAH over all axes. Points at or below the largest left-bin coordinate go left, which keeps
+        // the split plane exactly between the two halves. Falls back to the median if no plane separates them.
+        [[nodiscard]] Split split_sah(std::size_t begin, std::size_t end, const Aabb& bounds)
         {
-            const Node& node = nodes[node_idx];
-            if (node.first_point + node.num_points > point_indices_.size())
+            const std::size_t count = end - begin;
+            const math::vec3* coords = points.span().data();
+            const std::size_t* indices = point_indices_.data() + begin;
+            const auto candidates = utils::BinnedSah(
+                count, bounds,
+                [&](std::size_t i) { return coords[indices[i]]; },
+                [&](std::size_t i)
+                {
+                    const math::vec3& p = coords[indices[i]];
+                    return Aabb{.min = p, .max = p};
+                });
+
+            std::uint32_t axis = Node::kLeaf;
+            for (std::uint32_t a = 0; a < 3; ++a)
             {
-                return false;
+                if (candidates[a].bin != 0 && (axis == Node::kLeaf || candidates[a].cost < candidates[axis].cost))
+                {
+                    axis = a;
+                }
+            }
+            if (axis == Node::kLeaf)
+            {
+                return split_median(begin, end, bounds);
             }
 
-            if (node.is_leaf)
+            const float position = candidates[axis].left_centroid_max;
+            const auto goes_left = [&](std::size_t pi) { return coords[pi][axis] <= position; };
+            if (count > utils::kParallelBuildThreshold)
             {
-                return true;
+                utils::StableBucketPartition<2>(std::span(point_indices_).subspan(begin, count),
+                                                [&](std::size_t pi) { return goes_left(pi) ? 0 : 1; });
+            }
+            else
+            {
+                std::partition(point_indices_.begin() + begin, point_indices_.begin() + end, goes_left);
             }
+            return {axis, position, begin + candidates[axis].left_count};
+        }
 
-            const NodeHandle left(node.children[0]);
-            const NodeHandle right(node.children[1]);
-            if (!left.is_valid() || !right.is_valid())
+        // Replaces every deferred placeholder with its built subtree and renumbers right-child links.
+        void splice_subtrees(std::vector<Subtree>& subtrees)
+        {
+            if (subtrees.empty())
             {
-                return false;
+                return;
             }
 
-            const Node& left_node = nodes[left];
-            const Node& right_node = nodes[right];
+            std::vector<Node> top;
+            top.swap(nodes_);
+            std::size_t total = top.size();
+            for (const Subtree& subtree : subtrees) total += subtree.nodes.size() - 1;
+            nodes_.reserve(total);
 
-            if (left_node.first_point != node.first_point)
+            std::vector<std::uint32_t> remap(top.size());
+            for (std::size_t i = 0; i < top.size(); ++i)
             {
-                return false;
+                remap[i] = static_cast<std::uint32_t>(nodes_.size());
+                if (top[i].axis != kDeferred)
+                {
+                    nodes_.push_back(top[i]);
+                    continue;
+                }
+                const auto base = static_cast<std::uint32_t>(nodes_.size());
+                for (Node node : subtrees[top[i].offset].nodes)
+                {
+                    if (!node.is_leaf()) node.offset += base;
+                    nodes_.push_back(node);
+                }
             }
-            if (left_node.first_point + left_node.num_points != right_node.first_point)
+            for (std::size_t i = 0; i < top.size(); ++i)
+            {
+                if (top[i].axis < 3U)
+                {
+                    nodes_[remap[i]].offset = remap[top[i].offset];
+                }
+            }
+        }
+
+        // Checks depth-first numbering, contiguous leaf ranges in order, and that every point lies inside the
+        // cell carved out by its ancestors' split planes.
+        [[nodiscard]] bool validate_node(std::uint32_t& next_node, std::size_t& next_point, const Aabb& cell) const
+        {
+            if (next_node >= nodes_.size())
             {
                 return false;
             }
-            if (right_node.first_point + right_node.num_points != node.first_point + node.num_points)
+            const std::uint32_t index = next_node++;
+            const Node& node = nodes_[index];
+
+            if (node.is_leaf())
+            {
+                if (node.offset != next_point || node.offset + std::size_t{node.count} > point_indices_.size())
+                {
+                    return false;
+                }
+                next_point += node.count;
+                for (std::size_t slot = node.offset; slot < next_point; ++slot)
+                {
+                    const math::vec3 p{xs_[slot], ys_[slot], zs_[slot]};
+                    if (!Contains(cell, p) || p != points[point_indices_[slot]])
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            if (node.axis > 2U)
             {
                 return false;
             }
 
-            return validate_node(left) && validate_node(right);
+            Aabb left_cell = cell;
+            Aabb right_cell = cell;
+            left_cell.max[node.axis] = node.split_position;
+            right_cell.min[node.axis] = node.split_position;
+            return validate_node(next_node, next_point, left_cell) && next_node == node.offset &&
+                   validate_node(next_node, next_point, right_cell);
         }
 
         std::size_t max_points_per_leaf_ = 16;
         std::size_t max_depth_ = 24;
+        SplitPoint split_point_ = SplitPoint::Median;
+        std::vector<Node> nodes_;
+        Aabb bounds_{};
         std::vector<std::size_t> point_indices_;
+        std::vector<float> xs_;
+        std::vector<float> ys_;
+        std::vector<float> zs_;
     };
 }
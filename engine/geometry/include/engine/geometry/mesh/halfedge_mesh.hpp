@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/geometry/api.hpp"
+#include "engine/geometry/mesh/mesh_topology.hpp"
 #include "engine/geometry/properties/property_set.hpp"
 #include "engine/geometry/properties/property_handle.hpp"
 #include "engine/geometry/utils/iterators.hpp"
@@ -11,8 +12,10 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <optional>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
@@ -72,14 +75,31 @@ namespace engine::geometry::mesh
         [[nodiscard]] std::optional<FaceHandle> add_quad(VertexHandle v0, VertexHandle v1, VertexHandle v2,
                                                          VertexHandle v3);
 
+        // Replaces the mesh by the triangles `indices` (three vertex indices each, into `positions`) in one bulk
+        // pass: corners are bucketed in parallel by the smaller vertex of their edge, matched within each bucket
+        // and linked directly. The numbering of vertices, edges, halfedges and faces is that of add_vertex() for
+        // every position followed by add_triangle() for every triangle. Indices must be in range and triangles
+        // non-degenerate. Returns false and leaves the mesh empty when the triangles do not form an oriented
+        // manifold (an edge shared by more than two triangles or twice in one direction, or several fans meeting
+        // at a vertex); add_face() accepts some of those, so callers fall back to it.
+        [[nodiscard]] bool assign_triangles(std::span<const math::vec3> positions,
+                                            std::span<const std::uint32_t> indices);
+
         void clear();
 
         void free_memory();
 
         void reserve(std::size_t nvertices, std::size_t nedges, std::size_t nfaces);
 
+        // Drops deleted elements from every property in place. Survivors keep their relative order, so they get
+        // the indices freeze() reports for them. Capacity is kept for the next edit; free_memory() releases it.
         void garbage_collection();
 
+        // Collects garbage, then orders faces for locality as utils::PlanLocality, with polygons planned as
+        // triangle fans; vertices and edges are renumbered in the order the faces first walk them. Every property
+        // is permuted along, so handles taken before the call are stale.
+        void optimize_locality(const utils::LocalityOptions& options = {});
+
         [[nodiscard]] std::size_t vertices_size() const noexcept { return vertex_props_.size(); }
         [[nodiscard]] std::size_t halfedges_size() const noexcept { return halfedge_props_.size(); }
         [[nodiscard]] std::size_t edges_size() const noexcept { return edge_props_.size(); }
@@ -186,6 +206,18 @@ namespace engine::geometry::mesh
             return VertexProperty<T>(vertex_props_.get_or_add<T>(name, default_value));
         }
 
+        template <class T>
+        [[nodiscard]] VertexProperty<T> get_vertex_property(const PropertyKey<T>& key) const
+        {
+            return VertexProperty<T>(vertex_props_.get<T>(key));
+        }
+
+        template <class T>
+        [[nodiscard]] VertexProperty<T> vertex_property(const PropertyKey<T>& key, T default_value = T())
+        {
+            return VertexProperty<T>(vertex_props_.get_or_add<T>(key, default_value));
+        }
+
         template <class T>
         void remove_vertex_property(VertexProperty<T>& prop)
         {
@@ -224,12 +256,36 @@ namespace engine::geometry::mesh
             return HalfedgeProperty<T>(halfedge_props_.get_or_add<T>(name, default_value));
         }
 
+        template <class T>
+        [[nodiscard]] HalfedgeProperty<T> get_halfedge_property(const PropertyKey<T>& key) const
+        {
+            return HalfedgeProperty<T>(halfedge_props_.get<T>(key));
+        }
+
+        template <class T>
+        [[nodiscard]] HalfedgeProperty<T> halfedge_property(const PropertyKey<T>& key, T default_value = T())
+        {
+            return HalfedgeProperty<T>(halfedge_props_.get_or_add<T>(key, default_value));
+        }
+
         template <class T>
         [[nodiscard]] EdgeProperty<T> edge_property(const std::string& name, T default_value = T())
         {
             return EdgeProperty<T>(edge_props_.get_or_add<T>(name, default_value));
         }
 
+        template <class T>
+        [[nodiscard]] EdgeProperty<T> get_edge_property(const PropertyKey<T>& key) const
+        {
+            return EdgeProperty<T>(edge_props_.get<T>(key));
+        }
+
+        template <class T>
+        [[nodiscard]] EdgeProperty<T> edge_property(const PropertyKey<T>& key, T default_value = T())
+        {
+            return EdgeProperty<T>(edge_props_.get_or_add<T>(key, default_value));
+        }
+
         template <class T>
         void remove_halfedge_property(HalfedgeProperty<T>& prop)
         {
@@ -264,6 +320,18 @@ namespace engine::geometry::mesh
             return FaceProperty<T>(face_props_.get_or_add<T>(name, default_value));
         }
 
+        template <class T>
+        [[nodiscard]] FaceProperty<T> get_face_property(const PropertyKey<T>& key) const
+        {
+            return FaceProperty<T>(face_props_.get<T>(key));
+        }
+
+        template <class T>
+        [[nodiscard]] FaceProperty<T> face_property(const PropertyKey<T>& key, T default_value = T())
+        {
+            return FaceProperty<T>(face_props_.get_or_add<T>(key, default_value));
+        }
+
         template <class T>
         void remove_face_property(FaceProperty<T>& prop)
         {
@@ -392,9 +460,21 @@ namespace engine::geometry::mesh
 
         [[nodiscard]] bool has_garbage() const noexcept { return has_garbage_; }
 
+        // Immutable CSR snapshot of the current connectivity without deleted elements; see MeshTopology.
+        [[nodiscard]] MeshTopology freeze() const;
+
+        // Rebuilds `topology` in place, reusing its buffers, so re-freezing after edits stops allocating.
+        void freeze(MeshTopology& topology) const;
+
     private:
         void ensure_properties();
 
+        // Rewrites every connectivity reference through the old-to-new maps after the properties were compacted
+        // or permuted; halfedges move with their edge.
+        void remap_connectivity(std::span<const std::uint32_t> vertex_remap,
+                                std::span<const std::uint32_t> edge_remap,
+                                std::span<const std::uint32_t> face_remap);
+
         void adjust_outgoing_halfedge(VertexHandle v);
 
         void remove_edge_helper(HalfedgeHandle h);
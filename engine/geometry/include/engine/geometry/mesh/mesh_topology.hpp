@@ -0,0 +1,144 @@
+#pragma once
+
+#include "engine/geometry/api.hpp"
+#include "engine/geometry/properties/property_handle.hpp"
+#include "engine/math/parallel.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace engine::geometry::mesh
+{
+    class HalfedgeMeshInterface;
+
+    // CSR snapshot of the connectivity of a HalfedgeMeshInterface, produced by freeze(). Vertices and faces are
+    // renumbered densely in handle order with deleted elements dropped, and every adjacency list is one
+    // contiguous slice: the one-ring and the incident faces of a vertex in counter-clockwise order, the corners
+    // of a face in boundary order. Read-heavy passes (smoothing, curvature, Laplacian assembly) iterate these
+    // slices instead of circulating halfedges. The snapshot does not follow later edits of the mesh. It is
+    // immutable through its public API, so concurrent reads from any number of threads are safe; only
+    // freeze(topology), assignment and moves change it, and those must not overlap with readers.
+    class ENGINE_GEOMETRY_API MeshTopology
+    {
+    public:
+        static constexpr std::uint32_t kInvalidIndex = std::numeric_limits<std::uint32_t>::max();
+
+        // Elements handed to one task by parallel_for_vertices()/parallel_for_faces().
+        static constexpr std::size_t kGrain = 2048;
+
+        [[nodiscard]] std::size_t vertex_count() const noexcept { return vertex_handles_.size(); }
+        [[nodiscard]] std::size_t face_count() const noexcept { return face_handles_.size(); }
+
+        // Vertices sharing an edge with `v`.
+        [[nodiscard]] std::span<const std::uint32_t> vertex_vertices(std::uint32_t v) const noexcept
+        {
+            return row(vertex_vertex_offsets_, vertex_vertex_indices_, v);
+        }
+
+        // Faces incident to `v`; boundary gaps of the one-ring are skipped.
+        [[nodiscard]] std::span<const std::uint32_t> vertex_faces(std::uint32_t v) const noexcept
+        {
+            return row(vertex_face_offsets_, vertex_face_indices_, v);
+        }
+
+        [[nodiscard]] std::span<const std::uint32_t> face_vertices(std::uint32_t f) const noexcept
+        {
+            return row(face_vertex_offsets_, face_vertex_indices_, f);
+        }
+
+        [[nodiscard]] std::size_t valence(std::uint32_t v) const noexcept { return vertex_vertices(v).size(); }
+
+        // True for isolated vertices and vertices on a boundary loop, as HalfedgeMeshInterface::is_boundary.
+        [[nodiscard]] bool is_boundary(std::uint32_t v) const noexcept { return vertex_boundary_[v] != 0; }
+
+        [[nodiscard]] VertexHandle vertex_handle(std::uint32_t v) const noexcept { return vertex_handles_[v]; }
+        [[nodiscard]] FaceHandle face_handle(std::uint32_t f) const noexcept { return face_handles_[f]; }
+
+        // Snapshot index of a mesh handle, kInvalidIndex for deleted or out-of-range handles.
+        [[nodiscard]] std::uint32_t vertex_index(VertexHandle v) const noexcept
+        {
+            return v.is_valid() && v.index() < vertex_indices_.size() ? vertex_indices_[v.index()] : kInvalidIndex;
+        }
+
+        [[nodiscard]] std::uint32_t face_index(FaceHandle f) const noexcept
+        {
+            return f.is_valid() && f.index() < face_indices_.size() ? face_indices_[f.index()] : kInvalidIndex;
+        }
+
+        // Raw CSR arrays: row i of an adjacency is indices[offsets[i] .. offsets[i + 1]).
+        [[nodiscard]] std::span<const std::uint32_t> vertex_vertex_offsets() const noexcept
+        {
+            return vertex_vertex_offsets_;
+        }
+
+        [[nodiscard]] std::span<const std::uint32_t> vertex_vertex_indices() const noexcept
+        {
+            return vertex_vertex_indices_;
+        }
+
+        [[nodiscard]] std::span<const std::uint32_t> face_vertex_offsets() const noexcept
+        {
+            return face_vertex_offsets_;
+        }
+
+        [[nodiscard]] std::span<const std::uint32_t> face_vertex_indices() const noexcept
+        {
+            return face_vertex_indices_;
+        }
+
+        // Calls fn(v) for every vertex, spread over the math worker pool in chunks of `grain`. fn may run
+        // concurrently for different vertices, so it must only write state owned by its vertex.
+        template <class Fn>
+        void parallel_for_vertices(Fn&& fn, std::size_t grain = kGrain) const
+        {
+            math::parallel::parallel_for(0, vertex_count(), grain, [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t v = first; v < last; ++v)
+                {
+                    fn(static_cast<std::uint32_t>(v));
+                }
+            });
+        }
+
+        // As parallel_for_vertices(), for faces.
+        template <class Fn>
+        void parallel_for_faces(Fn&& fn, std::size_t grain = kGrain) const
+        {
+            math::parallel::parallel_for(0, face_count(), grain, [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t f = first; f < last; ++f)
+                {
+                    fn(static_cast<std::uint32_t>(f));
+                }
+            });
+        }
+
+    private:
+        friend class HalfedgeMeshInterface;
+
+        [[nodiscard]] static std::span<const std::uint32_t> row(const std::vector<std::uint32_t>& offsets,
+                                                                const std::vector<std::uint32_t>& indices,
+                                                                std::uint32_t i) noexcept
+        {
+            assert(i + 1 < offsets.size());
+            return {indices.data() + offsets[i], indices.data() + offsets[i + 1]};
+        }
+
+        std::vector<VertexHandle> vertex_handles_;
+        std::vector<FaceHandle> face_handles_;
+        std::vector<std::uint32_t> vertex_indices_;
+        std::vector<std::uint32_t> face_indices_;
+        std::vector<std::uint8_t> vertex_boundary_;
+
+        std::vector<std::uint32_t> vertex_vertex_offsets_;
+        std::vector<std::uint32_t> vertex_vertex_indices_;
+        std::vector<std::uint32_t> vertex_face_offsets_;
+        std::vector<std::uint32_t> vertex_face_indices_;
+        std::vector<std::uint32_t> face_vertex_offsets_;
+        std::vector<std::uint32_t> face_vertex_indices_;
+    };
+} // namespace engine::geometry::mesh
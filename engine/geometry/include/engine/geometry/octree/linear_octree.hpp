@@ -0,0 +1,625 @@
+#pragma once
+
+#include "engine/geometry/api.hpp"
+#include "engine/geometry/properties/property_set.hpp"
+#include "engine/geometry/shapes/aabb.hpp"
+#include "engine/geometry/utils/bounded_heap.hpp"
+#include "engine/geometry/utils/morton.hpp"
+#include "engine/geometry/utils/query_scratch.hpp"
+#include "engine/geometry/utils/radix_sort.hpp"
+#include "engine/geometry/utils/spatial_build.hpp"
+#include "engine/math/parallel.hpp"
+#include "engine/math/vector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace engine::geometry
+{
+    // Static linear octree over a snapshot of a position property.
+    //
+    // Points get 63-bit Morton codes on the cube around their bounds, are radix sorted in parallel and stored in
+    // that order, so every cell covers a contiguous range of the leaf-ordered arrays. A cell is subdivided iff it
+    // holds more than max_points_per_leaf points, i.e. iff some max_points_per_leaf + 1 consecutive codes share
+    // its prefix; a sliding-window maximum over the sorted codes therefore yields every point's leaf directly,
+    // and the hierarchy is assembled bottom-up one level at a time, all in O(n). Nodes are flat records stored
+    // level by level with contiguous children and keyed by their location code.
+    class ENGINE_GEOMETRY_API LinearOctree
+    {
+    public:
+        struct Node
+        {
+            Aabb bounds; // tight bounds of the node's points
+            // Location code: a 1 bit followed by the 3 * depth Morton bits of the cell.
+            std::uint64_t key = 1U;
+            // Leaf-ordered range of every point below the node.
+            std::uint32_t first_point = 0U;
+            std::uint32_t count = 0U;
+            // Children are the nodes [first_child, first_child + child_count); leaves have none.
+            std::uint32_t first_child = 0U;
+            std::uint32_t child_count = 0U;
+
+            [[nodiscard]] bool is_leaf() const noexcept { return child_count == 0U; }
+            [[nodiscard]] std::size_t depth() const noexcept { return (std::bit_width(key) - 1U) / 3U; }
+        };
+
+        Property<math::vec3> points;
+
+        [[nodiscard]] std::size_t get_max_points_per_leaf() const noexcept { return max_points_per_leaf_; }
+
+        [[nodiscard]] std::size_t get_max_depth() const noexcept { return max_depth_; }
+
+        // Original point index of every leaf-ordered slot.
+        [[nodiscard]] const std::vector<std::size_t>& get_point_indices() const noexcept { return point_indices_; }
+
+        // Coordinates in leaf (Morton) order.
+        [[nodiscard]] std::span<const math::vec3> leaf_points() const noexcept { return leaf_points_; }
+
+        [[nodiscard]] std::span<const Node> nodes() const noexcept { return nodes_; }
+
+        [[nodiscard]] std::size_t node_count() const noexcept { return nodes_.size(); }
+
+        // The cube the Morton grid spans.
+        [[nodiscard]] const Aabb& bounds() const noexcept { return bounds_; }
+
+        // Rebuild the tree from the supplied position property. Coordinates are copied into leaf order, so
+        // later edits to `positions` require a rebuild. max_depth is capped at utils::kMortonBits and at most
+        // 2^32 - 1 points are supported. Every pass only depends on the data, so the tree is identical for any
+        // thread count.
+        bool build(const Property<math::vec3>& positions, std::size_t max_points_per_leaf,
+                   std::size_t max_depth = utils::kMortonBits)
+        {
+            points = positions;
+            if (!points)
+            {
+                return false;
+            }
+
+            max_points_per_leaf_ = std::max<std::size_t>(1, max_points_per_leaf);
+            max_depth_ = std::min<std::size_t>(max_depth, utils::kMortonBits);
+            nodes_.clear();
+            leaf_points_.clear();
+
+            const std::size_t num_points = points.vector().size();
+            if (num_points == 0 || num_points >= std::numeric_limits<std::uint32_t>::max())
+            {
+                point_indices_.clear();
+                return false;
+            }
+
+            const math::vec3* coords = points.span().data();
+            const Aabb box = utils::ParallelBounds(num_points, [&](std::size_t i)
+            {
+                return Aabb{.min = coords[i], .max = coords[i]};
+            });
+            const math::vec3 extent = box.max - box.min;
+            const float side = std::max({extent[0], extent[1], extent[2]});
+            bounds_ = {.min = box.min, .max = box.min + math::vec3(side)};
+
+            std::vector<std::uint64_t> codes(num_points);
+            point_indices_.resize(num_points);
+            math::parallel::parallel_for(0, num_points, utils::kBuildGrain, [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    codes[i] = utils::MortonCode(coords[i], bounds_);
+                    point_indices_[i] = i;
+                }
+            });
+            utils::ParallelRadixSort(codes, point_indices_, 3 * utils::kMortonBits);
+
+            leaf_points_.resize(num_points);
+            math::parallel::parallel_for(0, num_points, utils::kBuildGrain, [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    leaf_points_[i] = coords[point_indices_[i]];
+                }
+            });
+
+            build_levels(codes);
+            return true;
+        }
+
+        // Collect every point contained inside the axis-aligned query volume.
+        void query(const Aabb& region, std::vector<std::size_t>& result) const
+        {
+            QueryScratch scratch;
+            scratch.results.swap(result);
+            query(region, scratch);
+            result.swap(scratch.results);
+        }
+
+        // Collect all points whose Euclidean distance from the query point is at most the radius.
+        void query_radius(const math::vec3& query_point, float radius, std::vector<std::size_t>& result) const
+        {
+            QueryScratch scratch;
+            scratch.results.swap(result);
+            query_radius(query_point, radius, scratch);
+            result.swap(scratch.results);
+        }
+
+        // Return the indices of the k closest points in ascending distance order.
+        void query_knn(const math::vec3& query_point, std::size_t k, std::vector<std::size_t>& results) const
+        {
+            QueryScratch scratch;
+            scratch.results.swap(results);
+            query_knn(query_point, k, scratch);
+            results.swap(scratch.results);
+        }
+
+        // Return the index of the closest point, or max() if the tree is empty.
+        void query_nearest(const math::vec3& query_point, std::size_t& result) const
+        {
+            QueryScratch scratch;
+            result = query_nearest(query_point, scratch);
+        }
+
+        // Allocation-free variants: traversal state and results live in `scratch`, and the returned span
+        // aliases scratch.results. Nodes inside the region are reported as whole ranges.
+        std::span<const std::size_t> query(const Aabb& region, QueryScratch& scratch) const
+        {
+            auto& result = scratch.results;
+            result.clear();
+            if (nodes_.empty()) return {};
+
+            auto& stack = scratch.node_stack;
+            stack.assign(1, 0);
+            while (!stack.empty())
+            {
+                const Node& node = nodes_[stack.back()];
+                stack.pop_back();
+                if (!overlaps(region, node.bounds))
+                {
+                    continue;
+                }
+
+                const auto first = point_indices_.begin() + node.first_point;
+                if (encloses(region, node.bounds))
+                {
+                    result.insert(result.end(), first, first + node.count);
+                    continue;
+                }
+                if (node.is_leaf())
+                {
+                    for (std::size_t slot = node.first_point; slot < node.first_point + node.count; ++slot)
+                    {
+                        if (encloses(region, leaf_points_[slot])) result.push_back(point_indices_[slot]);
+                    }
+                    continue;
+                }
+                for (std::uint32_t c = node.child_count; c-- > 0U;)
+                {
+                    stack.push_back(node.first_child + c);
+                }
+            }
+            return result;
+        }
+
+        std::span<const std::size_t> query_radius(const math::vec3& query_point, float radius,
+                                                  QueryScratch& scratch) const
+        {
+            auto& result = scratch.results;
+            result.clear();
+            if (nodes_.empty() || radius < 0.0f) return {};
+
+            const float radius_sq = radius * radius;
+            auto& stack = scratch.node_stack;
+            stack.assign(1, 0);
+            while (!stack.empty())
+            {
+                const Node& node = nodes_[stack.back()];
+                stack.pop_back();
+                if (squared_distance(node.bounds, query_point) > radius_sq)
+                {
+                    continue;
+                }
+                if (node.is_leaf())
+                {
+                    for (std::size_t slot = node.first_point; slot < node.first_point + node.count; ++slot)
+                    {
+                        const math::vec3 d = leaf_points_[slot] - query_point;
+                        if (d[0] * d[0] + d[1] * d[1] + d[2] * d[2] <= radius_sq)
+                        {
+                            result.push_back(point_indices_[slot]);
+                        }
+                    }
+                    continue;
+                }
+                for (std::uint32_t c = node.child_count; c-- > 0U;)
+                {
+                    stack.push_back(node.first_child + c);
+                }
+            }
+            return result;
+        }
+
+        // The k closest points in ascending distance order (smaller indices first among equal distances).
+        std::span<const std::size_t> query_knn(const math::vec3& query_point, std::size_t k,
+                                               QueryScratch& scratch) const
+        {
+            auto& result = scratch.results;
+            result.clear();
+            if (nodes_.empty() || k == 0) return {};
+
+            knn_search(query_point, k, scratch);
+            for (const auto& neighbor : scratch.neighbors)
+            {
+                result.push_back(neighbor.second);
+            }
+            return result;
+        }
+
+        // Index of the closest point (smallest index among equally close ones), or max() if the tree is empty.
+        [[nodiscard]] std::size_t query_nearest(const math::vec3& query_point, QueryScratch& scratch) const
+        {
+            if (nodes_.empty())
+            {
+                return std::numeric_limits<std::size_t>::max();
+            }
+            knn_search(query_point, 1, scratch);
+            return scratch.neighbors.front().second;
+        }
+
+        // Checks the level-by-level layout, that children refine their parent's cell and partition its range,
+        // the subdivision rule, and that every point lies in its leaf's cell and bounds.
+        [[nodiscard]] bool validate_structure() const
+        {
+            if (nodes_.empty())
+            {
+                return point_indices_.empty();
+            }
+            if (nodes_[0].key != 1U || nodes_[0].first_point != 0U || nodes_[0].count != point_indices_.size())
+            {
+                return false;
+            }
+
+            std::size_t next_child = 1;
+            for (std::size_t i = 0; i < nodes_.size(); ++i)
+            {
+                const Node& node = nodes_[i];
+                const std::size_t depth = node.depth();
+                if (depth > max_depth_ || node.count == 0U)
+                {
+                    return false;
+                }
+
+                if (node.is_leaf())
+                {
+                    if (node.count > max_points_per_leaf_ && depth != max_depth_)
+                    {
+                        return false;
+                    }
+                    const std::uint64_t cell = node.key ^ (std::uint64_t{1} << (3 * depth));
+                    for (std::size_t slot = node.first_point; slot < node.first_point + node.count; ++slot)
+                    {
+                        const math::vec3& p = leaf_points_[slot];
+                        const std::uint64_t code = utils::MortonCode(p, bounds_);
+                        if (code >> (3 * (utils::kMortonBits - depth)) != cell || !encloses(node.bounds, p) ||
+                            p != points[point_indices_[slot]])
+                        {
+                            return false;
+                        }
+                    }
+                    continue;
+                }
+
+                if (node.count <= max_points_per_leaf_ || depth == max_depth_ || node.first_child != next_child ||
+                    node.first_child + std::size_t{node.child_count} > nodes_.size() || node.child_count > 8U)
+                {
+                    return false;
+                }
+                next_child += node.child_count;
+
+                std::size_t next_point = node.first_point;
+                for (std::uint32_t c = 0; c < node.child_count; ++c)
+                {
+                    const Node& child = nodes_[node.first_child + c];
+                    if (child.key >> 3 != node.key || child.first_point != next_point ||
+                        !encloses(node.bounds, child.bounds))
+                    {
+                        return false;
+                    }
+                    next_point += child.count;
+                }
+                if (next_point != node.first_point + node.count)
+                {
+                    return false;
+                }
+            }
+            return next_child == nodes_.size();
+        }
+
+    private:
+        [[nodiscard]] static bool overlaps(const Aabb& a, const Aabb& b) noexcept
+        {
+            return a.min[0] <= b.max[0] && b.min[0] <= a.max[0] && a.min[1] <= b.max[1] && b.min[1] <= a.max[1] &&
+                   a.min[2] <= b.max[2] && b.min[2] <= a.max[2];
+        }
+
+        [[nodiscard]] static bool encloses(const Aabb& outer, const Aabb& inner) noexcept
+        {
+            return outer.min[0] <= inner.min[0] && inner.max[0] <= outer.max[0] && outer.min[1] <= inner.min[1] &&
+                   inner.max[1] <= outer.max[1] && outer.min[2] <= inner.min[2] && inner.max[2] <= outer.max[2];
+        }
+
+        [[nodiscard]] static bool encloses(const Aabb& outer, const math::vec3& p) noexcept
+        {
+            return outer.min[0] <= p[0] && p[0] <= outer.max[0] && outer.min[1] <= p[1] && p[1] <= outer.max[1] &&
+                   outer.min[2] <= p[2] && p[2] <= outer.max[2];
+        }
+
+        [[nodiscard]] static float squared_distance(const Aabb& box, const math::vec3& p) noexcept
+        {
+            float dist_sq = 0.0f;
+            for (std::size_t axis = 0; axis < 3; ++axis)
+            {
+                const float d = std::max({box.min[axis] - p[axis], 0.0f, p[axis] - box.max[axis]});
+                dist_sq += d * d;
+            }
+            return dist_sq;
+        }
+
+        // Starts of the runs of equal key(i) over [0, count), found with a parallel flag pass, per-chunk counts
+        // and a parallel write.
+        template <class KeyFn>
+        [[nodiscard]] static std::vector<std::uint32_t> run_starts(std::size_t count, KeyFn&& key)
+        {
+            std::vector<std::size_t> offsets(math::parallel::chunk_count(0, count, utils::kBuildGrain) + 1, 0);
+            const auto is_start = [&](std::size_t i) { return i == 0 || key(i) != key(i - 1); };
+            math::parallel::parallel_for(0, count, utils::kBuildGrain, [&](std::size_t first, std::size_t last)
+            {
+                std::size_t starts = 0;
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    starts += is_start(i) ? 1 : 0;
+                }
+                offsets[first / utils::kBuildGrain + 1] = starts;
+            });
+            for (std::size_t c = 1; c < offsets.size(); ++c)
+            {
+                offsets[c] += offsets[c - 1];
+            }
+
+            std::vector<std::uint32_t> result(offsets.back());
+            math::parallel::parallel_for(0, count, utils::kBuildGrain, [&](std::size_t first, std::size_t last)
+            {
+                std::size_t out = offsets[first / utils::kBuildGrain];
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    if (is_start(i)) result[out++] = static_cast<std::uint32_t>(i);
+                }
+            });
+            return result;
+        }
+
+        // Depth of the leaf holding each sorted code. A cell holds more than m points iff it contains a window of
+        // m + 1 consecutive codes, so the deepest subdivided cell around point i is the deepest common prefix of
+        // any window covering i; the window maxima come from the van Herk/Gil-Werman block scan.
+        [[nodiscard]] std::vector<std::uint8_t> leaf_depths(const std::vector<std::uint64_t>& codes) const
+        {
+            const std::size_t n = codes.size();
+            const std::size_t m = max_points_per_leaf_;
+            std::vector<std::uint8_t> depths(n, 0);
+            if (n <= m || max_depth_ == 0)
+            {
+                return depths;
+            }
+
+            // shared(t) = deepest depth below max_depth_ + 1 whose cell holds codes[t - m .. t], or -1 when the
+            // window leaves the array. Entry t of the padded sequence belongs to the window starting at t - m.
+            const auto shared = [&](std::size_t t) -> int
+            {
+                if (t < m || t >= n)
+                {
+                    return -1;
+                }
+                const std::uint64_t diff = codes[t - m] ^ codes[t];
+                const std::size_t common_bits = diff == 0 ? 3 * utils::kMortonBits
+                                                          : static_cast<std::size_t>(std::countl_zero(diff)) - 1;
+                return static_cast<int>(std::min(common_bits / 3, max_depth_));
+            };
+
+            // Point i is covered by the padded entries [i, i + m]: blocks of m + 1 entries give the window maximum
+            // as max(suffix maximum at i, prefix maximum at i + m).
+            const std::size_t block = m + 1;
+            const std::size_t padded = n + m;
+            std::vector<std::int8_t> prefix_max(padded);
+            std::vector<std::int8_t> suffix_max(padded);
+            const std::size_t block_count = (padded + block - 1) / block;
+            const std::size_t block_grain = std::max<std::size_t>(1, utils::kBuildGrain / block);
+            math::parallel::parallel_for(0, block_count, block_grain, [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t b = first; b < last; ++b)
+                {
+                    const std::size_t begin = b * block;
+                    const std::size_t end = std::min(begin + block, padded);
+                    int running = -1;
+                    for (std::size_t t = begin; t < end; ++t)
+                    {
+                        running = std::max(running, shared(t));
+                        prefix_max[t] = static_cast<std::int8_t>(running);
+                    }
+                    running = -1;
+                    for (std::size_t t = end; t-- > begin;)
+                    {
+                        running = std::max(running, shared(t));
+                        suffix_max[t] = static_cast<std::int8_t>(running);
+                    }
+                }
+            });
+
+            math::parallel::parallel_for(0, n, utils::kBuildGrain, [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    const int deepest = std::max<int>(suffix_max[i], prefix_max[i + m]);
+                    depths[i] = static_cast<std::uint8_t>(
+                        std::min<std::size_t>(static_cast<std::size_t>(deepest + 1), max_depth_));
+                }
+            });
+            return depths;
+        }
+
+        // Emits the leaves from the sorted codes, then creates each level's parents from the runs of the level
+        // below and merges them with that level's leaves, from max_depth_ up to the root.
+        void build_levels(const std::vector<std::uint64_t>& codes)
+        {
+            const std::size_t n = codes.size();
+            const std::vector<std::uint8_t> depths = leaf_depths(codes);
+            const auto location = [&](std::size_t i)
+            {
+                const std::size_t depth = depths[i];
+                return (std::uint64_t{1} << (3 * depth)) | (codes[i] >> (3 * (utils::kMortonBits - depth)));
+            };
+
+            const std::vector<std::uint32_t> leaf_starts = run_starts(n, location);
+            std::vector<std::vector<Node>> levels(max_depth_ + 1);
+            for (std::size_t l = 0; l < leaf_starts.size(); ++l)
+            {
+                Node leaf;
+                leaf.key = location(leaf_starts[l]);
+                leaf.first_point = leaf_starts[l];
+                leaf.count = (l + 1 < leaf_starts.size() ? leaf_starts[l + 1] : static_cast<std::uint32_t>(n)) -
+                    leaf_starts[l];
+                levels[leaf.depth()].push_back(leaf);
+            }
+
+            for (std::size_t depth = max_depth_; depth > 0; --depth)
+            {
+                const std::vector<Node>& level = levels[depth];
+                const std::vector<std::uint32_t> starts = run_starts(level.size(), [&](std::size_t i)
+                {
+                    return level[i].key >> 3;
+                });
+
+                std::vector<Node> parents(starts.size());
+                math::parallel::parallel_for(0, starts.size(), utils::kBuildGrain, [&](std::size_t first,
+                                                                                      std::size_t last)
+                {
+                    for (std::size_t p = first; p < last; ++p)
+                    {
+                        const std::uint32_t end = p + 1 < starts.size() ? starts[p + 1]
+                                                                        : static_cast<std::uint32_t>(level.size());
+                        const Node& last_child = level[end - 1];
+                        Node& parent = parents[p];
+                        parent.key = level[starts[p]].key >> 3;
+                        parent.first_point = level[starts[p]].first_point;
+                        parent.count = last_child.first_point + last_child.count - parent.first_point;
+                        parent.first_child = starts[p];
+                        parent.child_count = end - starts[p];
+                    }
+                });
+
+                std::vector<Node> merged(levels[depth - 1].size() + parents.size());
+                std::merge(levels[depth - 1].begin(), levels[depth - 1].end(), parents.begin(), parents.end(),
+                           merged.begin(), [](const Node& lhs, const Node& rhs) { return lhs.key < rhs.key; });
+                levels[depth - 1].swap(merged);
+            }
+
+            std::vector<std::size_t> base(levels.size() + 1, 0);
+            for (std::size_t depth = 0; depth < levels.size(); ++depth)
+            {
+                base[depth + 1] = base[depth] + levels[depth].size();
+            }
+            nodes_.resize(base.back());
+            for (std::size_t depth = levels.size(); depth-- > 0;)
+            {
+                const std::vector<Node>& level = levels[depth];
+                const std::size_t child_base = base[depth + 1];
+                math::parallel::parallel_for(0, level.size(), utils::kBuildGrain, [&](std::size_t first,
+                                                                                     std::size_t last)
+                {
+                    for (std::size_t i = first; i < last; ++i)
+                    {
+                        Node node = level[i];
+                        node.bounds = utils::EmptyAabb();
+                        if (node.is_leaf())
+                        {
+                            for (std::size_t slot = node.first_point; slot < node.first_point + node.count; ++slot)
+                            {
+                                utils::MergeInline(node.bounds, Aabb{.min = leaf_points_[slot],
+                                                                     .max = leaf_points_[slot]});
+                            }
+                        }
+                        else
+                        {
+                            node.first_child += static_cast<std::uint32_t>(child_base);
+                            for (std::uint32_t c = 0; c < node.child_count; ++c)
+                            {
+                                utils::MergeInline(node.bounds, nodes_[node.first_child + c].bounds);
+                            }
+                        }
+                        nodes_[base[depth] + i] = node;
+                    }
+                });
+            }
+        }
+
+        // Leaves the k nearest (squared distance, point index) pairs in scratch.neighbors, ascending.
+        void knn_search(const math::vec3& query_point, std::size_t k, QueryScratch& scratch) const
+        {
+            auto& heap = scratch.neighbors;
+            auto& pq = scratch.cells;
+            heap.clear();
+            pq.clear();
+            const auto push = [&](float dist_sq, std::size_t node)
+            {
+                pq.push_back({.distance_sq = dist_sq, .node = node});
+                std::push_heap(pq.begin(), pq.end(), TraversalCellGreater{});
+            };
+
+            push(squared_distance(nodes_[0].bounds, query_point), 0);
+            float tau = std::numeric_limits<float>::infinity();
+            while (!pq.empty())
+            {
+                std::pop_heap(pq.begin(), pq.end(), TraversalCellGreater{});
+                const TraversalCell cell = pq.back();
+                pq.pop_back();
+                if (cell.distance_sq > tau)
+                {
+                    break;
+                }
+
+                const Node& node = nodes_[cell.node];
+                if (node.is_leaf())
+                {
+                    for (std::size_t slot = node.first_point; slot < node.first_point + node.count; ++slot)
+                    {
+                        const math::vec3 d = leaf_points_[slot] - query_point;
+                        const std::pair<float, std::size_t> candidate{d[0] * d[0] + d[1] * d[1] + d[2] * d[2],
+                                                                      point_indices_[slot]};
+                        if (heap.size() < k || candidate < heap.front())
+                        {
+                            utils::push_bounded(heap, k, candidate);
+                            tau = heap.size() == k ? heap.front().first : std::numeric_limits<float>::infinity();
+                        }
+                    }
+                    continue;
+                }
+                for (std::uint32_t c = 0; c < node.child_count; ++c)
+                {
+                    const float dist_sq = squared_distance(nodes_[node.first_child + c].bounds, query_point);
+                    if (dist_sq <= tau)
+                    {
+                        push(dist_sq, node.first_child + c);
+                    }
+                }
+            }
+            std::sort_heap(heap.begin(), heap.end());
+        }
+
+        std::size_t max_points_per_leaf_ = 32;
+        std::size_t max_depth_ = utils::kMortonBits;
+        std::vector<Node> nodes_;
+        Aabb bounds_{};
+        std::vector<std::size_t> point_indices_;
+        std::vector<math::vec3> leaf_points_;
+    };
+}
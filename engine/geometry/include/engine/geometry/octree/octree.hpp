@@ -8,15 +8,20 @@
 #include "engine/geometry/shapes/sphere.hpp"
 #include "engine/geometry/utils/shape_interactions.hpp"
 
+#include "engine/geometry/utils/batched_queries.hpp"
 #include "engine/geometry/utils/bounded_heap.hpp"
+#include "engine/geometry/utils/query_scratch.hpp"
+#include "engine/geometry/utils/ray_packet.hpp"
+#include "engine/geometry/utils/spatial_build.hpp"
+#include "engine/math/parallel.hpp"
 #include "engine/math/vector.hpp"
 
 #include <array>
 #include <algorithm>
-#include <queue>
 #include <limits>
 #include <numeric>
 #include <iterator>
+#include <span>
 #include <utility>
 
 template <typename Shape>
@@ -72,7 +77,9 @@ namespace engine::geometry
             }
         };
 
-        enum class SplitPoint { Center, Mean, Median };
+        // SurfaceAreaHeuristic places each of the three planes at the binned SAH optimum of element centers
+        // along that axis.
+        enum class SplitPoint { Center, Mean, Median, SurfaceAreaHeuristic };
 
         struct SplitPolicy
         {
@@ -104,6 +111,18 @@ namespace engine::geometry
             return NodeProperty<T>(node_props_.get_or_add<T>(name, default_value));
         }
 
+        template <class T>
+        [[nodiscard]] NodeProperty<T> get_node_property(const PropertyKey<T>& key) const
+        {
+            return NodeProperty<T>(node_props_.get<T>(key));
+        }
+
+        template <class T>
+        [[nodiscard]] NodeProperty<T> node_property(const PropertyKey<T>& key, T default_value = T())
+        {
+            return NodeProperty<T>(node_props_.get_or_add<T>(key, default_value));
+        }
+
         template <class T>
         void remove_node_property(NodeProperty<T>& prop)
         {
@@ -133,6 +152,9 @@ namespace engine::geometry
             return element_indices;
         }
 
+        // The top levels are subdivided with data-parallel classification and partition passes; nodes with at
+        // most kSubtreeElements elements become independent tasks that are subdivided concurrently on the math
+        // worker pool and spliced back in task order, so the tree is identical for any thread count.
         bool build(const Property<Aabb>& aabbs, const SplitPolicy& policy, const std::size_t max_per_node,
                    const std::size_t max_depth)
         {
@@ -148,6 +170,7 @@ namespace engine::geometry
             max_octree_depth = max_depth;
 
             node_props_.clear(); // Clear previous state
+            reset_dynamic_state();
             const std::size_t num_elements = element_aabbs.vector().size();
 
             if (num_elements == 0)
@@ -159,15 +182,41 @@ namespace engine::geometry
             element_indices.resize(num_elements);
             std::iota(element_indices.begin(), element_indices.end(), 0);
 
-            nodes = add_node_property<Node>("n:nodes");
-
             // Create root node
-            const auto root_idx = create_node();
-            nodes[root_idx].first_element = 0;
-            nodes[root_idx].num_elements = num_elements;
-            nodes[root_idx].aabb = BoundingAabb(element_aabbs.span());
+            std::vector<Node> built(1);
+            built[0].first_element = 0;
+            built[0].num_elements = num_elements;
+            built[0].aabb = utils::ParallelBounds(num_elements, [&](std::size_t i) { return element_aabbs[i]; });
+
+            std::vector<Subtree> subtrees;
+            subdivide_volume(built, &subtrees, 0, 0);
+            math::parallel::parallel_for(0, subtrees.size(), 1, [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    Subtree& subtree = subtrees[i];
+                    subdivide_volume(subtree.nodes, nullptr, 0, subtree.depth);
+                }
+            });
 
-            subdivide_volume(root_idx, 0);
+            for (Subtree& subtree : subtrees)
+            {
+                // Local node 0 is the subtree root, which already has a slot; the rest are appended.
+                const std::size_t base = built.size() - 1;
+                for (Node& node : subtree.nodes)
+                {
+                    for (auto& child : node.children)
+                    {
+                        if (NodeHandle(child).is_valid()) child += base;
+                    }
+                }
+                built[subtree.root] = subtree.nodes.front();
+                built.insert(built.end(), std::next(subtree.nodes.begin()), subtree.nodes.end());
+            }
+
+            nodes = node_property(kNodesKey);
+            node_props_.resize(built.size());
+            std::move(built.begin(), built.end(), nodes.vector().begin());
             return true;
         }
 
@@ -176,461 +225,968 @@ namespace engine::geometry
             query<Ray>(query_shape, result);
         }
 
-        void query(const Aabb& query_shape, std::vector<size_t>& out) const
-        {
-            query<Aabb>(query_shape, out);
-        }
-
-        void query(const Sphere& query_shape, std::vector<size_t>& out) const
-        {
-            query<Sphere>(query_shape, out);
-        }
-
-        template <VolumetricSpatialQueryShape Shape>
-        void query(const Shape& query_shape, std::vector<size_t>& result) const
+        // Batched query_ray(): row r of `result` holds every element whose box rays[r] hits, ordered front to
+        // back by the squared distance from the ray origin to where the ray enters the box. Rays are traced as
+        // Width-wide packets of consecutive rays or as one stream per task (see RayBatchMode) with SIMD slab
+        // tests against node and element boxes.
+        template <std::size_t Width = kRayPacketWidth>
+        void query_ray_batch(std::span<const Ray> rays, NeighborList& result,
+                             RayBatchMode mode = RayBatchMode::Packet) const
         {
-            result.clear();
-            if (node_props_.empty()) return;
-
-            constexpr double eps = 0.0; // set to a small positive tolerance if you want numerical slack
-            const double query_volume = static_cast<double>(Volume(query_shape));
-
-            std::vector<NodeHandle> stack{NodeHandle{0}};
-            while (!stack.empty())
+            if (node_props_.empty())
             {
-                const NodeHandle node_idx = stack.back();
-                stack.pop_back();
-                const Node& node = nodes[node_idx];
-
-                if (!Intersects(node.aabb, query_shape)) continue;
-
-
-                const double node_volume = Volume(node.aabb);
-                const double strictly_larger = (query_volume > node_volume + eps);
+                result.clear();
+                result.offsets.assign(rays.size() + 1, 0);
+                return;
+            }
 
-                if (strictly_larger && Contains(query_shape, node.aabb))
+            constexpr float kInf = std::numeric_limits<float>::infinity();
+            const auto bounds_of = [&](std::uint32_t index) -> const Aabb& { return nodes[NodeHandle(index)].aabb; };
+            const auto push_children = [&](const Node& node, const auto& push)
+            {
+                if (node.is_leaf) return;
+                for (const auto ci : node.children)
                 {
-                    for (size_t i = 0; i < node.num_elements; ++i)
-                    {
-                        result.push_back(element_indices[node.first_element + i]);
-                    }
-                    continue;
+                    if (NodeHandle(ci).is_valid()) push(static_cast<std::uint32_t>(ci));
                 }
+            };
 
-                if (node.is_leaf)
+            utils::RunBatchedRayQueries(rays, result, [&](std::span<const Ray> task_rays, const auto& emit)
+            {
+                std::array<float, Width> entry;
+                if (mode == RayBatchMode::Stream)
                 {
-                    for (size_t i = 0; i < node.num_elements; ++i)
+                    RayStream stream;
+                    stream.assign(task_rays, kInf);
+                    RayStreamScratch scratch;
+                    utils::TraceRayStream<Width>(stream, 0, scratch, bounds_of,
+                                                 [&](std::uint32_t index, std::span<const std::uint32_t> ids,
+                                                     const auto& push)
                     {
-                        std::size_t ei = element_indices[node.first_element + i];
-                        if (Intersects(element_aabbs[ei], query_shape))
+                        const Node& node = nodes[NodeHandle(index)];
+                        for (std::size_t first = 0; first < ids.size(); first += Width)
                         {
-                            result.push_back(ei);
+                            const auto packet = stream.gather<Width>(ids.data() + first,
+                                                                     std::min(Width, ids.size() - first));
+                            for_each_own_element(index, node, [&](std::size_t ei)
+                            {
+                                const std::uint32_t hit = Intersects(element_aabbs[ei], packet, entry) & packet.active;
+                                utils::ForEachLane(hit, [&](std::size_t lane)
+                                {
+                                    const Ray& ray = task_rays[ids[first + lane]];
+                                    emit(ids[first + lane], ei,
+                                         entry[lane] * entry[lane] * math::length_squared(ray.direction));
+                                });
+                            });
                         }
-                    }
+                        push_children(node, push);
+                    });
+                    return;
                 }
-                else
+
+                std::vector<std::uint32_t> stack;
+                for (std::size_t first = 0; first < task_rays.size(); first += Width)
                 {
-                    for (size_t i = 0; i < node.num_straddlers; ++i)
+                    RayPacket<Width> packet;
+                    for (std::size_t lane = 0; lane < std::min(Width, task_rays.size() - first); ++lane)
                     {
-                        std::size_t ei = element_indices[node.first_element + i];
-                        if (Intersects(element_aabbs[ei], query_shape))
-                        {
-                            result.push_back(ei);
-                        }
+                        packet.set(lane, task_rays[first + lane], kInf);
                     }
-                    for (const auto ci : node.children)
+                    utils::TraceRayPacket(packet, 0, stack, bounds_of, [&](std::uint32_t index, std::uint32_t mask,
+                                                                           std::vector<std::uint32_t>& next)
                     {
-                        auto nhci = NodeHandle(ci);
-                        if (nhci.is_valid() &&
-                            Intersects(nodes[nhci].aabb, query_shape))
+                        const Node& node = nodes[NodeHandle(index)];
+                        for_each_own_element(index, node, [&](std::size_t ei)
                         {
-                            stack.push_back(nhci);
-                        }
-                    }
+                            utils::ForEachLane(Intersects(element_aabbs[ei], packet, entry) & mask, [&](std::size_t lane)
+                            {
+                                const Ray& ray = task_rays[first + lane];
+                                emit(first + lane, ei, entry[lane] * entry[lane] * math::length_squared(ray.direction));
+                            });
+                        });
+                        push_children(node, [&](std::uint32_t child) { next.push_back(child); });
+                    });
                 }
-            }
+            });
+        }
+
+        void query(const Aabb& query_shape, std::vector<size_t>& out) const
+        {
+            query<Aabb>(query_shape, out);
+        }
+
+        void query(const Sphere& query_shape, std::vector<size_t>& out) const
+        {
+            query<Sphere>(query_shape, out);
         }
 
         template <SpatialQueryShape Shape>
         void query(const Shape& query_shape, std::vector<size_t>& result) const
-            requires (!VolumetricSpatialQueryShape<Shape>)
         {
+            QueryScratch scratch;
+            scratch.results.swap(result);
+            query(query_shape, scratch);
+            result.swap(scratch.results);
+        }
+
+        // Allocation-free query: the traversal stack and results live in `scratch`, and the returned span
+        // aliases scratch.results. Nodes entirely inside a volumetric shape are reported without testing
+        // their elements.
+        template <SpatialQueryShape Shape>
+        std::span<const std::size_t> query(const Shape& query_shape, QueryScratch& scratch) const
+        {
+            auto& result = scratch.results;
             result.clear();
-            if (node_props_.empty()) return;
+            if (node_props_.empty()) return {};
+
+            constexpr double eps = 0.0; // set to a small positive tolerance if you want numerical slack
+            double query_volume = 0.0;
+            if constexpr (VolumetricSpatialQueryShape<Shape>)
+            {
+                query_volume = static_cast<double>(Volume(query_shape));
+            }
 
-            std::vector<NodeHandle> stack{NodeHandle{0}};
+            auto& stack = scratch.node_stack;
+            stack.assign(1, 0);
             while (!stack.empty())
             {
-                const NodeHandle node_idx = stack.back();
+                const NodeHandle node_idx(stack.back());
                 stack.pop_back();
                 const Node& node = nodes[node_idx];
 
                 if (!Intersects(node.aabb, query_shape)) continue;
 
-                if (node.is_leaf)
+                if constexpr (VolumetricSpatialQueryShape<Shape>)
                 {
-                    for (size_t i = 0; i < node.num_elements; ++i)
+                    const double node_volume = Volume(node.aabb);
+                    const double strictly_larger = (query_volume > node_volume + eps);
+
+                    if (strictly_larger && Contains(query_shape, node.aabb))
                     {
-                        std::size_t ei = element_indices[node.first_element + i];
-                        if (Intersects(element_aabbs[ei], query_shape))
+                        for_each_subtree_element(node_idx.index(), stack, [&](std::size_t ei)
                         {
                             result.push_back(ei);
-                        }
+                        });
+                        continue;
                     }
                 }
-                else
+
+                for_each_own_element(node_idx.index(), node, [&](std::size_t ei)
                 {
-                    for (size_t i = 0; i < node.num_straddlers; ++i)
+                    if (Intersects(element_aabbs[ei], query_shape))
                     {
-                        std::size_t ei = element_indices[node.first_element + i];
-                        if (Intersects(element_aabbs[ei], query_shape))
-                        {
-                            result.push_back(ei);
-                        }
+                        result.push_back(ei);
                     }
-                    for (const auto ci : node.children)
+                });
+                if (node.is_leaf) continue;
+
+                for (const auto ci : node.children)
+                {
+                    auto nhci = NodeHandle(ci);
+                    if (nhci.is_valid() && Intersects(nodes[nhci].aabb, query_shape))
                     {
-                        auto nhci = NodeHandle(ci);
-                        if (nhci.is_valid() && Intersects(nodes[nhci].aabb, query_shape))
-                        {
-                            stack.push_back(nhci);
-                        }
+                        stack.push_back(ci);
                     }
                 }
             }
+            return result;
         }
 
         void query_knn(const math::vec3& query_point, std::size_t k, std::vector<size_t>& results) const
         {
+            QueryScratch scratch;
+            scratch.results.swap(results);
+            query_knn(query_point, k, scratch);
+            results.swap(scratch.results);
+        }
+
+        // The k elements closest to the query point in ascending distance order.
+        std::span<const std::size_t> query_knn(const math::vec3& query_point, std::size_t k,
+                                               QueryScratch& scratch) const
+        {
+            auto& results = scratch.results;
             results.clear();
-            if (node_props_.empty() || k == 0) return;
+            if (node_props_.empty() || k == 0) return {};
 
-            using QueueElement = std::pair<float, std::size_t>;
-            utils::BoundedHeap<QueueElement> heap(k);
+            knn_search(query_point, k, scratch);
+            for (const auto& [d2, ei] : scratch.neighbors) results.push_back(ei);
+            return results;
+        }
 
-            using Trav = std::pair<float, NodeHandle>; // (node lower-bound d2, node index)
-            std::priority_queue<Trav, std::vector<Trav>, std::greater<>> pq;
+        // Batched query_knn(): row q of `result` holds the k elements closest to queries[q] in ascending
+        // distance order. Queries are spread over the math worker pool in Morton order.
+        void query_knn_batch(std::span<const math::vec3> queries, std::size_t k, NeighborList& result) const
+        {
+            if (node_props_.empty() || k == 0)
+            {
+                result.clear();
+                result.offsets.assign(queries.size() + 1, 0);
+                return;
+            }
 
-            constexpr NodeHandle root(0);
-            auto d2_node = [&](NodeHandle ni)
+            utils::RunBatchedQueries(queries, result, [&](const math::vec3& query_point, QueryScratch& scratch,
+                                                          std::vector<std::size_t>& indices,
+                                                          std::vector<float>& distances_sq)
             {
-                return static_cast<float>(SquaredDistance(nodes[ni].aabb, query_point));
-            };
-            auto d2_elem = [&](size_t ei)
+                knn_search(query_point, k, scratch);
+                for (const auto& [d2, ei] : scratch.neighbors)
+                {
+                    indices.push_back(ei);
+                    distances_sq.push_back(d2);
+                }
+            });
+        }
+
+        // Batched radius query: row q of `result` holds every element whose box lies within `radius` of
+        // queries[q], with its squared distance to the box.
+        void query_radius_batch(std::span<const math::vec3> queries, float radius, NeighborList& result) const
+        {
+            if (node_props_.empty() || radius < 0.0f)
             {
-                return static_cast<float>(SquaredDistance(element_aabbs[ei], query_point));
-            };
+                result.clear();
+                result.offsets.assign(queries.size() + 1, 0);
+                return;
+            }
 
-            pq.emplace(d2_node(root), root);
-            float tau = std::numeric_limits<float>::infinity();
-            auto update_tau = [&]()
+            utils::RunBatchedQueries(queries, result, [&](const math::vec3& query_point, QueryScratch& scratch,
+                                                          std::vector<std::size_t>& indices,
+                                                          std::vector<float>& distances_sq)
+            {
+                visit_radius(query_point, radius * radius, scratch, [&](std::size_t ei, float d2)
+                {
+                    indices.push_back(ei);
+                    distances_sq.push_back(d2);
+                });
+            });
+        }
+
+        void query_nearest(const math::vec3& query_point, std::size_t& result) const
+        {
+            QueryScratch scratch;
+            result = query_nearest(query_point, scratch);
+        }
+
+        // Index of the closest element (smallest index among equally close ones), or max() if empty.
+        [[nodiscard]] std::size_t query_nearest(const math::vec3& query_point, QueryScratch& scratch) const
+        {
+            std::size_t result = std::numeric_limits<size_t>::max();
+            if (node_props_.empty())
             {
-                tau = (heap.size() == k) ? heap.top().first : std::numeric_limits<float>::infinity();
+                return result;
+            }
+
+            double min_dist_sq = std::numeric_limits<double>::max();
+
+            auto& pq = scratch.cells;
+            const auto push = [&](float dist_sq, std::size_t node)
+            {
+                pq.push_back({.distance_sq = dist_sq, .node = node});
+                std::push_heap(pq.begin(), pq.end(), TraversalCellGreater{});
             };
+            pq.clear();
+            push(static_cast<float>(SquaredDistance(nodes[NodeHandle(0)].aabb, query_point)), 0);
 
             while (!pq.empty())
             {
-                auto [nd2, ni] = pq.top();
-                pq.pop();
+                std::pop_heap(pq.begin(), pq.end(), TraversalCellGreater{});
+                const float node_dist_sq = pq.back().distance_sq;
+                const NodeHandle node_idx(pq.back().node);
+                pq.pop_back();
 
-                // Global prune: the best remaining node is already worse than our kth best.
-                if (heap.size() == k && nd2 > tau) break;
+                // Equally distant nodes may still hold a tie with a smaller index.
+                if (node_dist_sq > min_dist_sq)
+                {
+                    break;
+                }
 
-                const Node& node = nodes[ni];
+                const Node& node = nodes[node_idx];
 
-                if (node.is_leaf)
+                // Leaves test all their elements, interior nodes only their straddlers.
+                for_each_own_element(node_idx.index(), node, [&](std::size_t elem_idx)
                 {
-                    for (size_t i = 0; i < node.num_elements; ++i)
+                    assert(elem_idx < element_aabbs.vector().size());
+                    const double elem_dist_sq = SquaredDistance(element_aabbs[elem_idx], query_point);
+
+                    if (elem_dist_sq < min_dist_sq || (elem_dist_sq == min_dist_sq && elem_idx < result))
                     {
-                        const std::size_t ei = element_indices[node.first_element + i];
-                        const QueueElement candidate{d2_elem(ei), ei};
-                        if (heap.size() < k || candidate < heap.top())
-                        {
-                            heap.push(candidate);
-                            update_tau();
-                        }
+                        min_dist_sq = elem_dist_sq;
+                        result = elem_idx;
                     }
-                }
-                else
+                });
+                if (node.is_leaf) continue;
+
+                for (const auto child_idx : node.children)
                 {
-                    // Score straddlers at this node
-                    for (size_t i = 0; i < node.num_straddlers; ++i)
+                    const auto nhci = NodeHandle(child_idx);
+                    if (nhci.is_valid())
                     {
-                        const std::size_t ei = element_indices[node.first_element + i];
-                        const QueueElement candidate{d2_elem(ei), ei};
-                        if (heap.size() < k || candidate < heap.top())
+                        const double child_dist_sq = SquaredDistance(nodes[nhci].aabb, query_point);
+                        if (child_dist_sq <= min_dist_sq)
                         {
-                            heap.push(candidate);
-                            update_tau();
+                            push(static_cast<float>(child_dist_sq), child_idx);
                         }
                     }
-                    // Push children best-first, pruned by current tau
-                    for (const auto ci : node.children)
-                    {
-                        const auto nhci = NodeHandle(ci);
-                        if (!nhci.is_valid()) continue;
-                        const float cd2 = d2_node(nhci);
-                        if (cd2 <= tau) pq.emplace(cd2, ci);
-                    }
                 }
             }
+            return result;
+        }
+
+        // Incremental updates relocate single elements instead of rebuilding. The first call attaches parent,
+        // depth and live-count node properties to the built tree; afterwards an operation only touches the nodes
+        // between the element's old and new place. Elements that leave their built slot (which is then left as
+        // kErasedElement until the next build()) are kept in intrusive per-node lists. Child boxes are loose: a
+        // child takes an element whose center it contains and that is at most half its size, growing to fit.
+        // Leaves split once they hold more than twice max_elements_per_node elements, and subtrees fold back
+        // into a leaf once they hold at most half of it.
+
+        // Adds element `element` of the element property, e.g. after appending its box. Returns false if the
+        // index is out of range or the element is already in the tree.
+        bool insert(std::size_t element)
+        {
+            if (!element_aabbs || element >= element_aabbs.vector().size())
+            {
+                return false;
+            }
+            enable_dynamic_updates();
+            if (element_node_[element] != kNone)
+            {
+                return false;
+            }
 
-            auto pairs = heap.get_sorted_data(); // ascending
-            results.resize(pairs.size());
-            for (size_t i = 0; i < pairs.size(); ++i) results[i] = pairs[i].second;
+            const Aabb box = element_aabbs[element];
+            utils::MergeInline(nodes[NodeHandle(0)].aabb, box);
+            link_element(element, descend(0, box));
+            return true;
         }
 
-        void query_nearest(const math::vec3& query_point, std::size_t& result) const
+        // Removes `element` from the tree; returns false if it is not in it.
+        bool erase(std::size_t element)
         {
-            result = std::numeric_limits<size_t>::max();
-            if (node_props_.empty())
+            if (!element_aabbs || node_props_.empty() || element >= element_aabbs.vector().size())
             {
-                return;
+                return false;
+            }
+            enable_dynamic_updates();
+            if (element_node_[element] == kNone)
+            {
+                return false;
             }
 
-            double min_dist_sq = std::numeric_limits<double>::max();
+            collapse_above(unlink_element(element));
+            return true;
+        }
+
+        // Stores `new_aabb` as the box of `element` and moves the element to the deepest node that takes it,
+        // searching up from its current node only as far as the first ancestor that still contains the box.
+        bool update(std::size_t element, const Aabb& new_aabb)
+        {
+            if (!element_aabbs || node_props_.empty() || element >= element_aabbs.vector().size())
+            {
+                return false;
+            }
+            enable_dynamic_updates();
+            const std::size_t current = element_node_[element];
+            if (current == kNone)
+            {
+                return false;
+            }
+
+            element_aabbs[element] = new_aabb;
+            std::size_t target = current;
+            while (target != 0 && !Contains(nodes[NodeHandle(target)].aabb, new_aabb))
+            {
+                target = node_parent_[NodeHandle(target)];
+            }
+            if (target == 0)
+            {
+                utils::MergeInline(nodes[NodeHandle(0)].aabb, new_aabb);
+            }
+            target = descend(target, new_aabb);
+            if (target == current)
+            {
+                return true;
+            }
 
-            using TraversalElement = std::pair<float, NodeHandle>;
-            std::priority_queue<TraversalElement, std::vector<TraversalElement>, std::greater<>> pq;
+            unlink_element(element);
+            link_element(element, target);
+            collapse_above(current);
+            return true;
+        }
 
-            constexpr auto root_idx = NodeHandle(0);
-            const double root_dist_sq = SquaredDistance(
-                nodes[root_idx].aabb, query_point);
-            pq.emplace(root_dist_sq, root_idx);
+        // Number of elements stored in the tree.
+        [[nodiscard]] std::size_t element_count() const noexcept
+        {
+            return dynamic_ ? live_elements_ : element_indices.size();
+        }
 
-            while (!pq.empty())
+        [[nodiscard]] bool validate_structure() const
+        {
+            if (node_props_.empty()) return element_indices.empty();
+            Aabb content;
+            std::size_t live = 0;
+            if (!validate_node(NodeHandle{0}, 0, content, live)) return false;
+            return !dynamic_ || live == live_elements_;
+        }
+
+        // Marks a slot of get_element_indices() whose element was erased or moved by an incremental update.
+        static constexpr std::size_t kErasedElement = std::numeric_limits<size_t>::max();
+
+    private:
+        static constexpr std::size_t kNone = std::numeric_limits<size_t>::max();
+
+        // Node property names, hashed at compile time; build() clears the node properties, so looking these up
+        // with node_property() always creates them fresh.
+        static constexpr PropertyKey<Node> kNodesKey{"n:nodes"};
+        static constexpr PropertyKey<std::size_t> kParentKey{"n:parent"};
+        static constexpr PropertyKey<std::size_t> kDepthKey{"n:depth"};
+        static constexpr PropertyKey<std::size_t> kLiveKey{"n:live"};
+        static constexpr PropertyKey<std::size_t> kLinkedKey{"n:linked"};
+
+        // Checks ranges and, after incremental updates, links and live counts of the subtree. `content` and
+        // `live` receive the bounds and number of its elements; the bounds must lie inside the node box.
+        [[nodiscard]] bool validate_node(NodeHandle node_idx, std::size_t depth, Aabb& content,
+                                         std::size_t& live) const
+        {
+            const Node& node = nodes[node_idx];
+            if (node.first_element > element_indices.size()) return false;
+            if (node.first_element + node.num_elements > element_indices.size()) return false;
+            if (node.is_leaf && node.num_straddlers != 0) return false;
+
+            bool linked_ok = true;
+            const std::size_t own = node.is_leaf ? node.num_elements : node.num_straddlers;
+            for (std::size_t i = 0; i < own; ++i)
+            {
+                const std::size_t ei = element_indices[node.first_element + i];
+                if (ei == kErasedElement) continue;
+                linked_ok &= !dynamic_ || (element_node_[ei] == node_idx.index() &&
+                    element_slot_[ei] == node.first_element + i);
+            }
+            if (dynamic_)
             {
-                const float node_dist_sq = pq.top().first;
-                const NodeHandle node_idx = pq.top().second;
-                pq.pop();
+                if (node_depth_[node_idx] != depth) return false;
+                std::size_t previous = kNone;
+                for (std::size_t ei = node_linked_[node_idx]; ei != kNone; ei = linked_next_[ei])
+                {
+                    linked_ok &= element_node_[ei] == node_idx.index() && element_slot_[ei] == kNone &&
+                        linked_prev_[ei] == previous;
+                    previous = ei;
+                }
+            }
+            if (!linked_ok) return false;
 
-                if (node_dist_sq >= min_dist_sq)
+            Aabb subtree_content = utils::EmptyAabb();
+            std::size_t subtree_live = 0;
+            for_each_own_element(node_idx.index(), node, [&](std::size_t ei)
+            {
+                utils::MergeInline(subtree_content, element_aabbs[ei]);
+                ++subtree_live;
+            });
+            if (!node.is_leaf)
+            {
+                std::size_t accumulated = node.first_element + node.num_straddlers;
+                std::size_t child_total = 0;
+                for (const auto ci : node.children)
                 {
-                    break;
+                    const auto nhci = NodeHandle(ci);
+                    if (!nhci.is_valid()) continue;
+
+                    const Node& child = nodes[nhci];
+                    if (child.first_element != accumulated) return false;
+                    if (child.num_elements == 0 && !dynamic_) return false;
+                    if (child.first_element + child.num_elements > node.first_element + node.num_elements) return false;
+                    if (dynamic_ && node_parent_[nhci] != node_idx.index()) return false;
+
+                    Aabb child_content;
+                    std::size_t child_live = 0;
+                    if (!validate_node(nhci, depth + 1, child_content, child_live)) return false;
+                    utils::MergeInline(subtree_content, child_content);
+                    subtree_live += child_live;
+
+                    accumulated += child.num_elements;
+                    child_total += child.num_elements;
                 }
 
-                const Node& node = nodes[node_idx];
+                if (accumulated != node.first_element + node.num_elements ||
+                    child_total + node.num_straddlers != node.num_elements)
+                {
+                    return false;
+                }
+            }
 
-                if (node.is_leaf)
+            if (dynamic_ && node_live_[node_idx] != subtree_live) return false;
+            content = subtree_content;
+            live = subtree_live;
+            return subtree_live == 0 || Contains(node.aabb, subtree_content);
+        }
+
+        // Calls fn(element) for the elements stored at the node itself: its slots of element_indices (the whole
+        // range of a leaf, the straddlers of an interior node) and its linked elements.
+        template <class Fn>
+        void for_each_own_element(std::size_t node_idx, const Node& node, Fn&& fn) const
+        {
+            const std::size_t count = node.is_leaf ? node.num_elements : node.num_straddlers;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const std::size_t ei = element_indices[node.first_element + i];
+                if (ei != kErasedElement) fn(ei);
+            }
+            if (!dynamic_) return;
+            for (std::size_t ei = node_linked_[NodeHandle(node_idx)]; ei != kNone; ei = linked_next_[ei])
+            {
+                fn(ei);
+            }
+        }
+
+        // Calls fn(element) for every element of the subtree. Linked elements are gathered with a depth-first
+        // walk that borrows the top of `stack` and leaves it as it was.
+        template <class Fn>
+        void for_each_subtree_element(std::size_t node_idx, std::vector<std::size_t>& stack, Fn&& fn) const
+        {
+            const Node& node = nodes[NodeHandle(node_idx)];
+            for (std::size_t i = 0; i < node.num_elements; ++i)
+            {
+                const std::size_t ei = element_indices[node.first_element + i];
+                if (ei != kErasedElement) fn(ei);
+            }
+            if (!dynamic_) return;
+
+            const std::size_t base = stack.size();
+            stack.push_back(node_idx);
+            while (stack.size() > base)
+            {
+                const NodeHandle ni(stack.back());
+                stack.pop_back();
+                for (std::size_t ei = node_linked_[ni]; ei != kNone; ei = linked_next_[ei])
                 {
-                    // This is a leaf, so process its elements.
-                    for (size_t i = 0; i < node.num_elements; ++i)
-                    {
-                        assert(node.first_element + i < element_indices.size());
-                        const std::size_t elem_idx = element_indices[node.first_element + i];
-                        assert(elem_idx < element_aabbs.vector().size());
-                        const double elem_dist_sq = SquaredDistance(element_aabbs[elem_idx], query_point);
+                    fn(ei);
+                }
+                if (nodes[ni].is_leaf) continue;
+                for (const auto ci : nodes[ni].children)
+                {
+                    if (NodeHandle(ci).is_valid()) stack.push_back(ci);
+                }
+            }
+        }
 
-                        if (elem_dist_sq < min_dist_sq)
-                        {
-                            min_dist_sq = elem_dist_sq;
-                            result = elem_idx;
-                        }
-                    }
+        void reset_dynamic_state()
+        {
+            dynamic_ = false;
+            live_elements_ = 0;
+            element_node_.clear();
+            element_slot_.clear();
+            linked_prev_.clear();
+            linked_next_.clear();
+            free_nodes_.clear();
+        }
+
+        // Sizes the per-element state to the element property and, on first use, records parent, depth, live
+        // count and slot of every node and element of the built tree.
+        void enable_dynamic_updates()
+        {
+            const std::size_t element_count = element_aabbs.vector().size();
+            if (element_node_.size() < element_count)
+            {
+                element_node_.resize(element_count, kNone);
+                element_slot_.resize(element_count, kNone);
+                linked_prev_.resize(element_count, kNone);
+                linked_next_.resize(element_count, kNone);
+            }
+            if (dynamic_) return;
+
+            dynamic_ = true;
+            if (node_props_.empty())
+            {
+                nodes = node_property(kNodesKey);
+                node_props_.resize(1);
+                nodes[NodeHandle(0)].aabb = utils::EmptyAabb();
+                nodes[NodeHandle(0)].first_element = element_indices.size();
+            }
+            node_parent_ = node_property(kParentKey, kNone);
+            node_depth_ = node_property(kDepthKey, std::size_t{0});
+            node_live_ = node_property(kLiveKey, std::size_t{0});
+            node_linked_ = node_property(kLinkedKey, kNone);
+
+            std::vector<std::size_t> stack{0};
+            while (!stack.empty())
+            {
+                const NodeHandle ni(stack.back());
+                stack.pop_back();
+                const Node& node = nodes[ni];
+                node_live_[ni] = node.num_elements;
+
+                const std::size_t own = node.is_leaf ? node.num_elements : node.num_straddlers;
+                for (std::size_t slot = node.first_element; slot < node.first_element + own; ++slot)
+                {
+                    element_node_[element_indices[slot]] = ni.index();
+                    element_slot_[element_indices[slot]] = slot;
                 }
-                else
+                if (node.is_leaf) continue;
+                for (const auto ci : node.children)
                 {
-                    for (size_t i = 0; i < node.num_straddlers; ++i)
-                    {
-                        assert(node.first_element + i < element_indices.size());
-                        const std::size_t elem_idx = element_indices[node.first_element + i];
-                        assert(elem_idx < element_aabbs.vector().size());
-                        const double elem_dist_sq = SquaredDistance(element_aabbs[elem_idx], query_point);
+                    const auto nhci = NodeHandle(ci);
+                    if (!nhci.is_valid()) continue;
+                    node_parent_[nhci] = ni.index();
+                    node_depth_[nhci] = node_depth_[ni] + 1;
+                    stack.push_back(ci);
+                }
+            }
+            live_elements_ = element_indices.size();
+        }
 
-                        if (elem_dist_sq < min_dist_sq)
-                        {
-                            min_dist_sq = elem_dist_sq;
-                            result = elem_idx;
-                        }
+        // Deepest node below `node_idx` (whose box contains `box`) that takes `box`. A child takes it when its box
+        // contains it, or loosely when it contains its center and is at least twice its size on every axis; a
+        // loose child box grows to fit.
+        [[nodiscard]] std::size_t descend(std::size_t node_idx, const Aabb& box)
+        {
+            const math::vec3 center = Center(box);
+            const math::vec3 size = box.max - box.min;
+            while (!nodes[NodeHandle(node_idx)].is_leaf)
+            {
+                std::size_t next = kNone;
+                for (const auto ci : nodes[NodeHandle(node_idx)].children)
+                {
+                    const auto nhci = NodeHandle(ci);
+                    if (!nhci.is_valid()) continue;
+                    const Aabb& child = nodes[nhci].aabb;
+                    if (Contains(child, box))
+                    {
+                        next = ci;
+                        break;
                     }
-                    // This is an internal node, so traverse to its children.
-                    for (const auto child_idx : node.children)
+                    const math::vec3 child_size = child.max - child.min;
+                    if (next == kNone && Contains(child, center) && size[0] <= 0.5f * child_size[0] &&
+                        size[1] <= 0.5f * child_size[1] && size[2] <= 0.5f * child_size[2])
                     {
-                        const auto nhci = NodeHandle(child_idx);
-                        if (nhci.is_valid())
-                        {
-                            const double child_dist_sq = SquaredDistance(nodes[nhci].aabb, query_point);
-                            if (child_dist_sq < min_dist_sq)
-                            {
-                                pq.emplace(child_dist_sq, child_idx);
-                            }
-                        }
+                        next = ci;
                     }
                 }
+                if (next == kNone) break;
+                utils::MergeInline(nodes[NodeHandle(next)].aabb, box);
+                node_idx = next;
             }
+            return node_idx;
         }
 
-        [[nodiscard]] bool validate_structure() const
+        void push_linked(std::size_t element, std::size_t node_idx)
         {
-            if (node_props_.empty()) return element_indices.empty();
-            return validate_node(NodeHandle{0});
+            std::size_t& head = node_linked_[NodeHandle(node_idx)];
+            linked_prev_[element] = kNone;
+            linked_next_[element] = head;
+            if (head != kNone) linked_prev_[head] = element;
+            head = element;
+            element_node_[element] = node_idx;
+            element_slot_[element] = kNone;
         }
 
-    private:
-        [[nodiscard]] bool validate_node(NodeHandle node_idx) const
+        // Takes `element` out of its node without touching live counts; a built slot is left as kErasedElement.
+        void detach(std::size_t element)
         {
-            const Node& node = nodes[node_idx];
-            if (node.first_element > element_indices.size()) return false;
-            if (node.first_element + node.num_elements > element_indices.size()) return false;
+            if (element_slot_[element] != kNone)
+            {
+                element_indices[element_slot_[element]] = kErasedElement;
+                element_slot_[element] = kNone;
+                return;
+            }
+            const std::size_t prev = linked_prev_[element];
+            const std::size_t next = linked_next_[element];
+            if (prev != kNone) linked_next_[prev] = next;
+            else node_linked_[NodeHandle(element_node_[element])] = next;
+            if (next != kNone) linked_prev_[next] = prev;
+        }
 
-            if (node.is_leaf)
+        // Stores `element` at `node_idx`, counts it up to the root and splits the node once the elements it
+        // holds itself exceed twice max_elements_per_node.
+        void link_element(std::size_t element, std::size_t node_idx)
+        {
+            push_linked(element, node_idx);
+            for (std::size_t ni = node_idx; ni != kNone; ni = node_parent_[NodeHandle(ni)])
             {
-                return node.num_straddlers == 0;
+                ++node_live_[NodeHandle(ni)];
             }
+            ++live_elements_;
 
-            std::size_t accumulated = node.first_element + node.num_straddlers;
-            std::size_t child_total = 0;
-            for (const auto ci : node.children)
+            // Only the crossing triggers a split, so nodes whose elements cannot be pushed down are not retried
+            // on every insert.
+            const Node& node = nodes[NodeHandle(node_idx)];
+            std::size_t own = node_live_[NodeHandle(node_idx)];
+            if (!node.is_leaf)
             {
-                const auto nhci = NodeHandle(ci);
-                if (!nhci.is_valid()) continue;
+                for (const auto ci : node.children)
+                {
+                    if (NodeHandle(ci).is_valid()) own -= node_live_[NodeHandle(ci)];
+                }
+            }
+            if (own == 2 * max_elements_per_node + 1 && node_depth_[NodeHandle(node_idx)] < max_octree_depth)
+            {
+                if (!node.is_leaf) fold_subtree(node_idx);
+                split_leaf(node_idx);
+            }
+        }
+
+        // Removes `element` from the tree and returns the node it was stored at.
+        std::size_t unlink_element(std::size_t element)
+        {
+            const std::size_t node_idx = element_node_[element];
+            detach(element);
+            element_node_[element] = kNone;
+            for (std::size_t ni = node_idx; ni != kNone; ni = node_parent_[NodeHandle(ni)])
+            {
+                --node_live_[NodeHandle(ni)];
+            }
+            --live_elements_;
+            return node_idx;
+        }
+
+        // Folds the highest ancestor of `node_idx` (or the node itself) whose subtree holds at most half of
+        // max_elements_per_node elements back into a leaf.
+        void collapse_above(std::size_t node_idx)
+        {
+            std::size_t fold = kNone;
+            for (std::size_t ni = node_idx; ni != kNone; ni = node_parent_[NodeHandle(ni)])
+            {
+                if (!nodes[NodeHandle(ni)].is_leaf && node_live_[NodeHandle(ni)] <= max_elements_per_node / 2)
+                {
+                    fold = ni;
+                }
+            }
+            if (fold != kNone) fold_subtree(fold);
+        }
 
-                const Node& child = nodes[nhci];
-                if (child.first_element != accumulated) return false;
-                if (child.num_elements == 0) return false;
-                if (child.first_element + child.num_elements > node.first_element + node.num_elements) return false;
-                if (!validate_node(nhci)) return false;
+        // Turns `node_idx` into a leaf holding every element of its subtree and frees the descendant nodes.
+        void fold_subtree(std::size_t node_idx)
+        {
+            Node& node = nodes[NodeHandle(node_idx)];
+            for (std::size_t slot = node.first_element + node.num_straddlers;
+                 slot < node.first_element + node.num_elements; ++slot)
+            {
+                if (element_indices[slot] != kErasedElement) element_node_[element_indices[slot]] = node_idx;
+            }
 
-                accumulated += child.num_elements;
-                child_total += child.num_elements;
+            std::vector<std::size_t> stack;
+            for (const auto ci : node.children)
+            {
+                if (NodeHandle(ci).is_valid()) stack.push_back(ci);
+            }
+            while (!stack.empty())
+            {
+                const NodeHandle ni(stack.back());
+                stack.pop_back();
+                for (std::size_t ei = node_linked_[ni]; ei != kNone;)
+                {
+                    const std::size_t next = linked_next_[ei];
+                    push_linked(ei, node_idx);
+                    ei = next;
+                }
+                for (const auto ci : nodes[ni].children)
+                {
+                    if (!nodes[ni].is_leaf && NodeHandle(ci).is_valid()) stack.push_back(ci);
+                }
+                nodes[ni] = Node();
+                node_linked_[ni] = kNone;
+                free_nodes_.push_back(ni.index());
             }
 
-            return accumulated == node.first_element + node.num_elements &&
-                child_total + node.num_straddlers == node.num_elements;
+            node.is_leaf = true;
+            node.num_straddlers = 0;
+            node.children.fill(NodeHandle().index());
         }
 
-        NodeHandle create_node()
+        // A node slot for a new child of `parent`, reusing folded nodes first.
+        [[nodiscard]] std::size_t allocate_node(std::size_t parent)
         {
-            node_props_.push_back();
-            return NodeHandle(node_props_.size() - 1);
+            std::size_t node_idx = node_props_.size();
+            if (!free_nodes_.empty())
+            {
+                node_idx = free_nodes_.back();
+                free_nodes_.pop_back();
+            }
+            else
+            {
+                node_props_.push_back();
+            }
+
+            const NodeHandle handle(node_idx);
+            nodes[handle] = Node();
+            node_parent_[handle] = parent;
+            node_depth_[handle] = node_depth_[NodeHandle(parent)] + 1;
+            node_live_[handle] = 0;
+            node_linked_[handle] = kNone;
+            return node_idx;
         }
 
-        void subdivide_volume(const NodeHandle node_idx, std::size_t depth)
+        // Gives a leaf octant children split at its center and moves each of its elements that one octant
+        // takes into that child. The leaf's slots become straddler slots; the children start with empty ranges
+        // at its end, and children that end up overfull are split in turn.
+        void split_leaf(std::size_t leaf)
         {
-            const Node& node = nodes[node_idx]; // We'll be modifying the node
+            const Aabb box = nodes[NodeHandle(leaf)].aabb;
+            const math::vec3 sp = Center(box);
+            const std::array<Aabb, 8> octant_aabbs = octant_boxes(box, sp);
 
-            if (depth >= max_octree_depth || node.num_elements <= max_elements_per_node)
+            std::vector<std::pair<std::size_t, std::size_t>> moves;
+            for_each_own_element(leaf, nodes[NodeHandle(leaf)], [&](std::size_t ei)
             {
-                nodes[node_idx].is_leaf = true;
-                return;
-            }
+                const std::size_t octant = classify(ei, sp, octant_aabbs);
+                if (octant != 8) moves.emplace_back(ei, octant);
+            });
+            if (moves.empty()) return;
 
-            math::vec3 sp = choose_split_point(node_idx);
+            {
+                Node& node = nodes[NodeHandle(leaf)];
+                node.is_leaf = false;
+                node.num_straddlers = node.num_elements;
+            }
+            for (const auto& [ei, octant] : moves)
+            {
+                std::size_t child = nodes[NodeHandle(leaf)].children[octant];
+                if (!NodeHandle(child).is_valid())
+                {
+                    child = allocate_node(leaf);
+                    Node& parent = nodes[NodeHandle(leaf)];
+                    Node& created = nodes[NodeHandle(child)];
+                    created.aabb = split_policy.tight_children ? utils::EmptyAabb() : octant_aabbs[octant];
+                    created.first_element = parent.first_element + parent.num_elements;
+                    created.num_elements = 0;
+                    parent.children[octant] = child;
+                }
+                detach(ei);
+                push_linked(ei, child);
+                ++node_live_[NodeHandle(child)];
+                utils::MergeInline(nodes[NodeHandle(child)].aabb, element_aabbs[ei]);
+            }
 
-            //Jitter/tighten the split point when it hits data
-            for (int ax = 0; ax < 3; ++ax)
+            for (const auto child : nodes[NodeHandle(leaf)].children)
             {
-                const float lo = node.aabb.min[ax], hi = node.aabb.max[ax];
-                float& s = sp[ax];
-                if (s <= lo || s >= hi) s = 0.5f * (lo + hi);
-                if (s == lo) s = std::nextafter(s, hi);
-                else if (s == hi) s = std::nextafter(s, lo);
+                const auto nhc = NodeHandle(child);
+                if (!nhc.is_valid()) continue;
+                if (split_policy.tight_children && split_policy.epsilon > 0.0f)
+                {
+                    const math::vec3 padding(split_policy.epsilon, split_policy.epsilon, split_policy.epsilon);
+                    nodes[nhc].aabb.min -= padding;
+                    nodes[nhc].aabb.max += padding;
+                }
+                if (node_live_[nhc] > 2 * max_elements_per_node && node_depth_[nhc] < max_octree_depth)
+                {
+                    split_leaf(child);
+                }
             }
+        }
 
+        [[nodiscard]] static std::array<Aabb, 8> octant_boxes(const Aabb& box, const math::vec3& sp)
+        {
             std::array<Aabb, 8> octant_aabbs;
             for (int j = 0; j < 8; ++j)
             {
                 math::vec3 child_min = {
-                    (j & 1) ? sp[0] : node.aabb.min[0], (j & 2) ? sp[1] : node.aabb.min[1],
-                    (j & 4) ? sp[2] : node.aabb.min[2]
+                    (j & 1) ? sp[0] : box.min[0], (j & 2) ? sp[1] : box.min[1],
+                    (j & 4) ? sp[2] : box.min[2]
                 };
                 math::vec3 child_max = {
-                    (j & 1) ? node.aabb.max[0] : sp[0], (j & 2) ? node.aabb.max[1] : sp[1],
-                    (j & 4) ? node.aabb.max[2] : sp[2]
+                    (j & 1) ? box.max[0] : sp[0], (j & 2) ? box.max[1] : sp[1],
+                    (j & 4) ? box.max[2] : sp[2]
                 };
                 octant_aabbs[j] = {.min = child_min, .max = child_max};
             }
+            return octant_aabbs;
+        }
 
-            std::array<std::vector<size_t>, 8> child_elements;
-            scratch_indices.clear();
-            scratch_indices.reserve(node.num_elements);
-            auto& straddlers = scratch_indices;
+        // Nodes with at most this many elements are subdivided as independent tasks.
+        static constexpr std::size_t kSubtreeElements = 16384;
 
-            for (size_t i = 0; i < node.num_elements; ++i)
+        struct Subtree
+        {
+            std::size_t root = 0;
+            std::size_t depth = 0;
+            std::vector<Node> nodes;
+        };
+
+        // Octant of `elem_idx` for the split point `sp`, or 8 when it straddles the planes.
+        [[nodiscard]] std::size_t classify(std::size_t elem_idx, const math::vec3& sp,
+                                           const std::array<Aabb, 8>& octant_aabbs) const
+        {
+            const auto& elem_aabb = element_aabbs[elem_idx];
+            const auto octant_of = [&](const math::vec3& p)
             {
-                std::size_t elem_idx = element_indices[node.first_element + i];
-                const auto& elem_aabb = element_aabbs[elem_idx];
-                int found_child = -1;
+                std::size_t code = 0;
+                code |= (p[0] >= sp[0]) ? 1 : 0;
+                code |= (p[1] >= sp[1]) ? 2 : 0;
+                code |= (p[2] >= sp[2]) ? 4 : 0;
+                return code;
+            };
 
-                if (elem_aabb.min == elem_aabb.max)
-                {
-                    const math::vec3& p = elem_aabb.min;
-                    // Element is a point. Directly assign it to one of the octants.
-                    int code = 0;
-                    code |= (p[0] >= sp[0]) ? 1 : 0;
-                    code |= (p[1] >= sp[1]) ? 2 : 0;
-                    code |= (p[2] >= sp[2]) ? 4 : 0;
-                    child_elements[code].push_back(elem_idx);
-                }
-                else
+            if (elem_aabb.min == elem_aabb.max)
+            {
+                // Element is a point. Directly assign it to one of the octants.
+                return octant_of(elem_aabb.min);
+            }
+
+            std::size_t found_child = 8;
+            for (std::size_t j = 0; j < 8; ++j)
+            {
+                if (Contains(octant_aabbs[j], elem_aabb))
                 {
-                    for (int j = 0; j < 8; ++j)
+                    if (found_child != 8)
                     {
-                        if (Contains(octant_aabbs[j], elem_aabb))
-                        {
-                            if (found_child == -1)
-                            {
-                                found_child = j;
-                            }
-                            else
-                            {
-                                // The element is contained in more than one child box, which shouldn't happen with this logic.
-                                // Treat as a straddler just in case of floating point issues.
-                                found_child = -1;
-                                break;
-                            }
-                        }
-                    }
-                    if (found_child != -1)
-                    {
-                        child_elements[found_child].push_back(elem_idx);
-                    }
-                    else
-                    {
-                        // Fallback: assign by center if we will tighten children;
-                        // otherwise keep as straddler to preserve correctness.
-                        if (split_policy.tight_children)
-                        {
-                            const math::vec3 c = Center(elem_aabb);
-                            int code = 0;
-                            code |= (c[0] >= sp[0]) ? 1 : 0;
-                            code |= (c[1] >= sp[1]) ? 2 : 0;
-                            code |= (c[2] >= sp[2]) ? 4 : 0;
-                            child_elements[code].push_back(elem_idx);
-                        }
-                        else
-                        {
-                            straddlers.push_back(elem_idx);
-                        }
+                        // Contained in more than one child box (only possible through floating point issues):
+                        // treat as a straddler.
+                        found_child = 8;
+                        break;
                     }
+                    found_child = j;
                 }
             }
+            if (found_child == 8 && split_policy.tight_children)
+            {
+                // Assign by center if we will tighten children; otherwise keep as straddler to preserve
+                // correctness.
+                return octant_of(Center(elem_aabb));
+            }
+            return found_child;
+        }
 
-            // If we couldn't push a significant number of elements down, it's better to stop and make this a leaf.
-            // This prevents creating child nodes with very few elements.
-            if (straddlers.size() == node.num_elements)
+        // Subdivides out[node_idx] and appends its descendants depth-first. With `subtrees`, nodes small enough
+        // to be built independently are recorded there (as a copy of the node) instead of recursed into.
+        void subdivide_volume(std::vector<Node>& out, std::vector<Subtree>* subtrees, std::size_t node_idx,
+                              std::size_t depth)
+        {
+            const Node node = out[node_idx];
+
+            if (depth >= max_octree_depth || node.num_elements <= max_elements_per_node)
             {
-                nodes[node_idx].is_leaf = true;
+                out[node_idx].is_leaf = true;
                 return;
             }
+            if (subtrees != nullptr && node.num_elements <= kSubtreeElements)
+            {
+                subtrees->push_back({node_idx, depth, {node}});
+                return;
+            }
+
+            math::vec3 sp = choose_split_point(node);
 
-            // This node is now an internal node. It stores nothing itself.
-            // Re-arrange the element_indices array.
-            std::size_t current_pos = node.first_element;
-            // First, place all the straddlers
-            for (size_t idx : straddlers)
+            //Jitter/tighten the split point when it hits data
+            for (int ax = 0; ax < 3; ++ax)
             {
-                element_indices[current_pos++] = idx;
+                const float lo = node.aabb.min[ax], hi = node.aabb.max[ax];
+                float& s = sp[ax];
+                if (s <= lo || s >= hi) s = 0.5f * (lo + hi);
+                if (s == lo) s = std::nextafter(s, hi);
+                else if (s == hi) s = std::nextafter(s, lo);
             }
-            // Then, place the elements for each child sequentially
-            std::array<size_t, 8> child_starts;
-            for (int i = 0; i < 8; ++i)
+
+            const std::array<Aabb, 8> octant_aabbs = octant_boxes(node.aabb, sp);
+
+            // Stable partition of the node's range: straddlers first, then the elements of each octant in order.
+            const auto starts = utils::StableBucketPartition<9>(
+                std::span(element_indices).subspan(node.first_element, node.num_elements),
+                [&](std::size_t elem_idx) { return (classify(elem_idx, sp, octant_aabbs) + 1) % 9; });
+            const std::size_t num_straddlers = starts[1];
+
+            // If we couldn't push any element down, it's better to stop and make this a leaf.
+            if (num_straddlers == node.num_elements)
             {
-                child_starts[i] = current_pos;
-                for (size_t idx : child_elements[i])
-                {
-                    element_indices[current_pos++] = idx;
-                }
+                out[node_idx].is_leaf = true;
+                return;
             }
 
             // --- This node is now officially an internal node ---
@@ -640,32 +1196,130 @@ namespace engine::geometry
             // Its children[] point to the new child nodes (created below)
             // We need to keep the straddlers at the start of the range for correct querying,
             // But we also still need to keep track of the total number of elements for early out. This is important!
-            nodes[node_idx].is_leaf = false;
-            nodes[node_idx].num_straddlers = straddlers.size();
+            out[node_idx].is_leaf = false;
+            out[node_idx].num_straddlers = num_straddlers;
 
             // Create children and recurse
-            for (int i = 0; i < 8; ++i)
+            for (std::size_t i = 0; i < 8; ++i)
             {
-                if (!child_elements[i].empty())
+                const std::size_t count = starts[i + 2] - starts[i + 1];
+                if (count == 0)
+                {
+                    continue;
+                }
+
+                const std::size_t child_idx = out.size();
+                out.emplace_back();
+                out[node_idx].children[i] = child_idx;
+
+                Node& child = out[child_idx];
+                child.first_element = node.first_element + starts[i + 1];
+                child.num_elements = count;
+                if (split_policy.tight_children)
                 {
-                    const auto child_node_handle = create_node();
-                    nodes[node_idx].children[i] = child_node_handle.index();
+                    const auto range = std::span(element_indices).subspan(child.first_element, count);
+                    child.aabb = tight_child_aabb(range.begin(), range.end(), split_policy.epsilon);
+                }
+                else
+                {
+                    child.aabb = octant_aabbs[i];
+                }
+
+                subdivide_volume(out, subtrees, child_idx, depth + 1);
+            }
+        }
 
-                    Node& child = nodes[child_node_handle];
-                    child.first_element = child_starts[i];
-                    child.num_elements = child_elements[i].size();
+        // Leaves the k nearest (squared distance, element index) pairs in scratch.neighbors, ascending.
+        void knn_search(const math::vec3& query_point, std::size_t k, QueryScratch& scratch) const
+        {
+            auto& heap = scratch.neighbors;
+            auto& pq = scratch.cells; // best-first by node lower-bound d2
+            heap.clear();
+            pq.clear();
+
+            auto d2_node = [&](NodeHandle ni)
+            {
+                return static_cast<float>(SquaredDistance(nodes[ni].aabb, query_point));
+            };
+            auto d2_elem = [&](size_t ei)
+            {
+                return static_cast<float>(SquaredDistance(element_aabbs[ei], query_point));
+            };
+            const auto push = [&](float d2, std::size_t node)
+            {
+                pq.push_back({.distance_sq = d2, .node = node});
+                std::push_heap(pq.begin(), pq.end(), TraversalCellGreater{});
+            };
+
+            push(d2_node(NodeHandle(0)), 0);
+            float tau = std::numeric_limits<float>::infinity();
 
-                    if (split_policy.tight_children)
+            while (!pq.empty())
+            {
+                std::pop_heap(pq.begin(), pq.end(), TraversalCellGreater{});
+                const float nd2 = pq.back().distance_sq;
+                const NodeHandle ni(pq.back().node);
+                pq.pop_back();
+
+                // Global prune: the best remaining node is already worse than our kth best.
+                if (heap.size() == k && nd2 > tau) break;
+
+                const Node& node = nodes[ni];
+
+                // Leaves score all their elements, interior nodes only their straddlers.
+                for_each_own_element(ni.index(), node, [&](std::size_t ei)
+                {
+                    const std::pair<float, std::size_t> candidate{d2_elem(ei), ei};
+                    if (heap.size() < k || candidate < heap.front())
                     {
-                        child.aabb = tight_child_aabb(child_elements[i].begin(), child_elements[i].end(),
-                                                      split_policy.epsilon);
+                        utils::push_bounded(heap, k, candidate);
+                        tau = (heap.size() == k) ? heap.front().first : std::numeric_limits<float>::infinity();
                     }
-                    else
+                });
+                if (node.is_leaf) continue;
+
+                // Push children best-first, pruned by current tau
+                for (const auto ci : node.children)
+                {
+                    const auto nhci = NodeHandle(ci);
+                    if (!nhci.is_valid()) continue;
+                    const float cd2 = d2_node(nhci);
+                    if (cd2 <= tau) push(cd2, ci);
+                }
+            }
+            std::sort_heap(heap.begin(), heap.end());
+        }
+
+        // Invokes fn(element index, squared distance) for every element box within sqrt(radius_sq) of the
+        // query point.
+        template <class Fn>
+        void visit_radius(const math::vec3& query_point, float radius_sq, QueryScratch& scratch, Fn&& fn) const
+        {
+            auto& stack = scratch.node_stack;
+            stack.assign(1, 0);
+            while (!stack.empty())
+            {
+                const NodeHandle ni(stack.back());
+                stack.pop_back();
+                const Node& node = nodes[ni];
+                if (static_cast<float>(SquaredDistance(node.aabb, query_point)) > radius_sq)
+                {
+                    continue;
+                }
+
+                for_each_own_element(ni.index(), node, [&](std::size_t ei)
+                {
+                    const auto d2 = static_cast<float>(SquaredDistance(element_aabbs[ei], query_point));
+                    if (d2 <= radius_sq)
                     {
-                        child.aabb = octant_aabbs[i];
+                        fn(ei, d2);
                     }
+                });
+                if (node.is_leaf) continue;
 
-                    subdivide_volume(child_node_handle, depth + 1);
+                for (auto it = node.children.rbegin(); it != node.children.rend(); ++it)
+                {
+                    if (NodeHandle(*it).is_valid()) stack.push_back(*it);
                 }
             }
         }
@@ -677,12 +1331,18 @@ namespace engine::geometry
             {
                 return fallback_center; // fallback; or pass node_idx and use aabbs[node_idx]
             }
-            math::vec3 acc(0.0f, 0.0f, 0.0f);
-            for (size_t i = 0; i < size; ++i)
-            {
-                const auto idx = element_indices[first + i];
-                acc += Center(element_aabbs[idx]);
-            }
+            const math::vec3 acc = math::parallel::parallel_reduce(
+                first, first + size, utils::kBuildGrain, math::vec3(0.0f, 0.0f, 0.0f),
+                [&](std::size_t begin, std::size_t end)
+                {
+                    math::vec3 partial(0.0f, 0.0f, 0.0f);
+                    for (std::size_t i = begin; i < end; ++i)
+                    {
+                        partial += Center(element_aabbs[element_indices[i]]);
+                    }
+                    return partial;
+                },
+                [](math::vec3 lhs, const math::vec3& rhs) { return lhs + rhs; });
             return acc / float(size);
         }
 
@@ -693,32 +1353,58 @@ namespace engine::geometry
             {
                 return fallback_center; // fallback; or pass node_idx and use aabbs[node_idx]
             }
-            std::vector<math::vec3> centers;
-            centers.reserve(size);
-            for (size_t i = 0; i < size; ++i)
+            // The three axes are independent selections.
+            math::vec3 median = fallback_center;
+            math::parallel::parallel_for(0, 3, 1, [&](std::size_t dim, std::size_t)
             {
-                centers.push_back(Center(element_aabbs[element_indices[first + i]]));
-            }
-            const std::size_t median_idx = centers.size() / 2;
-            auto kth = [](std::vector<math::vec3>& centers, std::size_t median_idx, int dim)
+                std::vector<float> coordinates(size);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    coordinates[i] = Center(element_aabbs[element_indices[first + i]])[dim];
+                }
+                const auto kth = coordinates.begin() + static_cast<std::ptrdiff_t>(size / 2);
+                std::nth_element(coordinates.begin(), kth, coordinates.end());
+                median[dim] = *kth;
+            });
+            return median;
+        }
+
+        [[nodiscard]] math::vec3 compute_sah_center(size_t first, std::size_t size,
+                                                    const math::vec3& fallback_center) const
+        {
+            const auto center_of = [&](std::size_t i) { return Center(element_aabbs[element_indices[first + i]]); };
+            const Aabb centroid_bounds = utils::ParallelBounds(size, [&](std::size_t i)
             {
-                std::nth_element(centers.begin(), centers.begin() + median_idx, centers.end(),
-                                 [dim](const auto& a, const auto& b) { return a[dim] < b[dim]; });
-                return centers[median_idx][dim];
-            };
-            return {kth(centers, median_idx, 0), kth(centers, median_idx, 1), kth(centers, median_idx, 2)};
+                const math::vec3 c = center_of(i);
+                return Aabb{.min = c, .max = c};
+            });
+            const auto candidates = utils::BinnedSah(size, centroid_bounds, center_of, [&](std::size_t i)
+            {
+                return element_aabbs[element_indices[first + i]];
+            });
+
+            math::vec3 split = fallback_center;
+            for (std::size_t axis = 0; axis < 3; ++axis)
+            {
+                if (candidates[axis].bin != 0)
+                {
+                    split[axis] = candidates[axis].position;
+                }
+            }
+            return split;
         }
 
-        [[nodiscard]] math::vec3 choose_split_point(NodeHandle node_idx) const
+        [[nodiscard]] math::vec3 choose_split_point(const Node& node) const
         {
-            const auto& node = nodes[node_idx];
-            const math::vec3 fallback_center = Center(nodes[node_idx].aabb);
+            const math::vec3 fallback_center = Center(node.aabb);
             switch (split_policy.split_point)
             {
             case SplitPoint::Mean: return compute_mean_center(node.first_element, node.num_elements,
                                                               fallback_center);
             case SplitPoint::Median: return compute_median_center(node.first_element, node.num_elements,
                                                                   fallback_center);
+            case SplitPoint::SurfaceAreaHeuristic: return compute_sah_center(node.first_element, node.num_elements,
+                                                                              fallback_center);
             case SplitPoint::Center:
             default: return fallback_center;
             }
@@ -733,10 +1419,28 @@ namespace engine::geometry
             }
 
             Aabb tight = element_aabbs[*begin];
-
-            for (auto it = std::next(begin); it != end; ++it)
+            const auto merge_serial = [&]()
+            {
+                for (auto it = std::next(begin); it != end; ++it)
+                {
+                    Merge(tight, element_aabbs[*it]);
+                }
+            };
+            if constexpr (std::random_access_iterator<FwdIt>)
+            {
+                const auto count = static_cast<std::size_t>(end - begin);
+                if (count > utils::kParallelBuildThreshold)
+                {
+                    tight = utils::ParallelBounds(count, [&](std::size_t i) { return element_aabbs[begin[i]]; });
+                }
+                else
+                {
+                    merge_serial();
+                }
+            }
+            else
             {
-                Merge(tight, element_aabbs[*it]);
+                merge_serial();
             }
 
             if (eps > 0.0f)
@@ -757,6 +1461,18 @@ namespace engine::geometry
         std::size_t max_octree_depth = 10;
         SplitPolicy split_policy;
         std::vector<size_t> element_indices;
-        std::vector<size_t> scratch_indices;
+
+        // Incremental update state, attached on the first insert()/erase()/update() and dropped by build().
+        bool dynamic_ = false;
+        std::size_t live_elements_ = 0;
+        NodeProperty<std::size_t> node_parent_;
+        NodeProperty<std::size_t> node_depth_;
+        NodeProperty<std::size_t> node_live_;   // elements in the subtree
+        NodeProperty<std::size_t> node_linked_; // head of the node's list of linked elements
+        std::vector<std::size_t> element_node_;
+        std::vector<std::size_t> element_slot_; // slot in element_indices, or kNone when linked
+        std::vector<std::size_t> linked_prev_;
+        std::vector<std::size_t> linked_next_;
+        std::vector<std::size_t> free_nodes_;
     };
 }
@@ -59,8 +59,14 @@ namespace engine::geometry::point_cloud
 
         void reserve(std::size_t nvertices);
 
+        // Drops deleted points from every property in place; survivors keep their relative order and capacity is
+        // kept until free_memory().
         void garbage_collection();
 
+        // Collects garbage, then sorts the points along `curve` so neighbours in space are neighbours in memory;
+        // every property is permuted along.
+        void optimize_locality(utils::SpaceFillingCurve curve = utils::SpaceFillingCurve::Hilbert);
+
         [[nodiscard]] std::size_t vertices_size() const noexcept { return vertex_props_.size(); }
 
         [[nodiscard]] std::size_t vertex_count() const noexcept { return vertices_size() - deleted_vertices_; }
@@ -89,6 +95,18 @@ namespace engine::geometry::point_cloud
             return VertexProperty<T>(vertex_props_.get_or_add<T>(name, default_value));
         }
 
+        template <class T>
+        [[nodiscard]] VertexProperty<T> get_vertex_property(const PropertyKey<T>& key) const
+        {
+            return VertexProperty<T>(vertex_props_.get<T>(key));
+        }
+
+        template <class T>
+        [[nodiscard]] VertexProperty<T> vertex_property(const PropertyKey<T>& key, T default_value = T())
+        {
+            return VertexProperty<T>(vertex_props_.get_or_add<T>(key, default_value));
+        }
+
         template <class T>
         void remove_vertex_property(VertexProperty<T>& prop)
         {
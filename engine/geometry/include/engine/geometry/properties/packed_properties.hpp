@@ -0,0 +1,61 @@
+#pragma once
+
+#include "engine/geometry/properties/property_set.hpp"
+#include "engine/math/packed.hpp"
+
+#include <string>
+#include <string_view>
+
+namespace engine::geometry
+{
+    // Stores the full-precision property `source` as `target` in its packed form (e.g. vec3 normals as
+    // math::oct_normal16, colours as Vector<unorm8, 4>, positions as math::hvec3). An existing `target` of the
+    // same packed type is overwritten. With `remove_source` the full-precision buffer is released, leaving
+    // only the packed copy resident. Returns an invalid property if `source` does not exist with type
+    // unpacked_t<Packed> or `target` exists with a different type.
+    template <class Packed>
+    Property<Packed> pack_property(PropertySet& set, std::string_view source, std::string target,
+                                   bool remove_source = false)
+    {
+        auto full = set.get<math::unpacked_t<Packed>>(source);
+        if (!full)
+        {
+            return Property<Packed>();
+        }
+        if (set.exists(target) && !set.get<Packed>(target))
+        {
+            return Property<Packed>();
+        }
+        auto packed = set.get_or_add<Packed>(std::move(target));
+        math::pack<Packed>(full.span(), packed.span());
+        if (remove_source)
+        {
+            set.remove(full);
+        }
+        return packed;
+    }
+
+    // Inverse of pack_property(): expands the packed property `source` into a full-precision `target`.
+    template <class Packed>
+    Property<math::unpacked_t<Packed>> unpack_property(PropertySet& set, std::string_view source, std::string target,
+                                                       bool remove_source = false)
+    {
+        using Unpacked = math::unpacked_t<Packed>;
+        auto packed = set.get<Packed>(source);
+        if (!packed)
+        {
+            return Property<Unpacked>();
+        }
+        if (set.exists(target) && !set.get<Unpacked>(target))
+        {
+            return Property<Unpacked>();
+        }
+        auto full = set.get_or_add<Unpacked>(std::move(target));
+        math::unpack<Packed>(packed.span(), full.span());
+        if (remove_source)
+        {
+            set.remove(packed);
+        }
+        return full;
+    }
+} // namespace engine::geometry
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace engine::geometry {
+
+// Minimum alignment of every property buffer: one cache line, enough for any SIMD load width we target.
+inline constexpr std::size_t kPropertyAlignment = 64;
+
+// Allocator of property buffers. It draws from a std::pmr::memory_resource (aligned operator new by default) at
+// kPropertyAlignment or more, and unlike std::pmr::polymorphic_allocator it follows its buffer through copies,
+// moves and swaps, so a detached or assigned buffer stays in the memory its registry chose.
+template <class T>
+class PropertyAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    PropertyAllocator() noexcept = default;
+
+    explicit PropertyAllocator(std::pmr::memory_resource* resource) noexcept
+        : resource_(resource != nullptr ? resource : std::pmr::new_delete_resource())
+    {
+    }
+
+    template <class U>
+    PropertyAllocator(const PropertyAllocator<U>& other) noexcept : resource_(other.resource())
+    {
+    }
+
+    [[nodiscard]] T* allocate(std::size_t n)
+    {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+        {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(resource_->allocate(n * sizeof(T), kAlignment));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept { resource_->deallocate(p, n * sizeof(T), kAlignment); }
+
+    [[nodiscard]] PropertyAllocator select_on_container_copy_construction() const noexcept { return *this; }
+
+    [[nodiscard]] std::pmr::memory_resource* resource() const noexcept { return resource_; }
+
+    template <class U>
+    [[nodiscard]] bool operator==(const PropertyAllocator<U>& other) const noexcept
+    {
+        return resource_ == other.resource() || resource_->is_equal(*other.resource());
+    }
+
+private:
+    static constexpr std::size_t kAlignment = std::max(alignof(T), kPropertyAlignment);
+
+    std::pmr::memory_resource* resource_{std::pmr::new_delete_resource()};
+};
+
+template <class T>
+using PropertyVector = std::vector<T, PropertyAllocator<T>>;
+
+// Backs allocations of at least `threshold` bytes with anonymous mappings aligned to 2 MiB huge pages, so full
+// passes over multi-gigabyte attributes are not dominated by TLB misses; smaller ones go to `upstream`. Pages are
+// requested with madvise(MADV_HUGEPAGE) (transparent huge pages), or first from the hugetlbfs pool with
+// MAP_HUGETLB when `use_hugetlb` is set, falling back to the former once the pool is exhausted. Only Linux maps
+// huge pages; elsewhere every allocation goes to `upstream`. Must outlive every buffer allocated from it.
+class HugePageResource final : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t kHugePageSize = std::size_t{2} << 20;
+
+    struct Options {
+        std::size_t threshold = kHugePageSize;
+        bool use_hugetlb = false;
+    };
+
+    HugePageResource() : HugePageResource(Options{}) {}
+    explicit HugePageResource(Options options,
+                              std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) noexcept;
+
+    [[nodiscard]] const Options& options() const noexcept { return options_; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    [[nodiscard]] bool maps(std::size_t bytes, std::size_t alignment) const noexcept;
+
+    Options options_;
+    std::pmr::memory_resource* upstream_;
+};
+
+} // namespace engine::geometry
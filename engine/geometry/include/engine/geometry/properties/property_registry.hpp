@@ -1,8 +1,14 @@
 #pragma once
 
+#include "engine/geometry/properties/property_memory.hpp"
+
+#include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
 #include <span>
 #include <string>
@@ -18,6 +24,34 @@ using PropertyId = std::size_t;
 
 class PropertyRegistry;
 
+// FNV-1a hash of a property name; PropertyRegistry indexes its properties by it.
+[[nodiscard]] constexpr std::uint64_t HashPropertyName(std::string_view name) noexcept
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char c : name)
+    {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Name of a property of type T with its hash computed at compile time, for hot-path lookups:
+//     inline constexpr PropertyKey<math::vec3> kNormal{"v:normal"};
+// Looking a key up skips hashing the name and is an O(1) probe plus one name and type comparison.
+template <class T>
+struct PropertyKey
+{
+    using value_type = T;
+
+    constexpr explicit PropertyKey(std::string_view key_name) noexcept
+        : name(key_name), hash(HashPropertyName(key_name))
+    {
+    }
+
+    std::string_view name;
+    std::uint64_t hash;
+};
+
 namespace detail {
 
 class PropertyStorageBase {
@@ -37,6 +71,15 @@ public:
     virtual void shrink_to_fit() = 0;
     virtual void push_back() = 0;
     virtual void swap(std::size_t i0, std::size_t i1) = 0;
+    // Keeps the `group` elements starting at group * kept[i] as those starting at group * i and drops the rest;
+    // `kept` must be strictly increasing. Halfedges compact in pairs by their edge this way.
+    virtual void compact(std::span<const std::uint32_t> kept, std::size_t group) = 0;
+    // Moves the `group` elements starting at group * order[i] to group * i; `order` must be a permutation of
+    // the groups.
+    virtual void permute(std::span<const std::uint32_t> order, std::size_t group) = 0;
+
+    // Moves the elements into a buffer drawn from `resource`.
+    virtual void rehome(std::pmr::memory_resource* resource) = 0;
 
     [[nodiscard]] virtual std::type_index type() const noexcept = 0;
 
@@ -44,26 +87,38 @@ protected:
     std::string name_;
 };
 
+// Elements live in a reference-counted buffer: clone() shares it, so copying a registry costs O(properties), and
+// the first mutable access through data() (or any resize, swap or compact) of a storage whose buffer is shared
+// detaches it with a private copy. Const access never copies. A reference or span taken from data() is only
+// private until the storage is cloned again; re-fetch it after copying the owner. The check costs a flag load per
+// mutable element access, so hot loops should take vector() or span() once rather than index through a handle.
 template <class T>
 class PropertyStorage final : public PropertyStorageBase {
 public:
-    PropertyStorage(std::string name, T default_value)
-        : PropertyStorageBase(std::move(name)), data_(), default_(std::move(default_value))
+    PropertyStorage(std::string name, T default_value, std::pmr::memory_resource* resource)
+        : PropertyStorageBase(std::move(name)),
+          data_(std::make_shared<PropertyVector<T>>(PropertyAllocator<T>(resource))),
+          default_(std::move(default_value))
     {
     }
 
     PropertyStorage(const PropertyStorage& other)
         : PropertyStorageBase(other.name()), data_(other.data_), default_(other.default_)
     {
+        other.shared_.store(true, std::memory_order_release);
+        shared_.store(true, std::memory_order_relaxed);
     }
 
     PropertyStorage& operator=(const PropertyStorage& other)
     {
         if (this != &other)
         {
+            std::lock_guard lock(detach_mutex_);
             name_ = other.name_;
             data_ = other.data_;
             default_ = other.default_;
+            other.shared_.store(true, std::memory_order_release);
+            shared_.store(true, std::memory_order_release);
         }
         return *this;
     }
@@ -73,28 +128,149 @@ public:
         return std::make_unique<PropertyStorage<T>>(*this);
     }
 
-    void reserve(std::size_t n) override { data_.reserve(n); }
-    void resize(std::size_t n) override { data_.resize(n, default_); }
-    void shrink_to_fit() override { data_.shrink_to_fit(); }
-    void push_back() override { data_.push_back(default_); }
+    void reserve(std::size_t n) override { data().reserve(n); }
+    void resize(std::size_t n) override { data().resize(n, default_); }
+    void shrink_to_fit() override { data().shrink_to_fit(); }
+    void push_back() override { data().push_back(default_); }
 
     void swap(std::size_t i0, std::size_t i1) override
     {
         using std::swap;
-        swap(data_[i0], data_[i1]);
+        auto& values = data();
+        swap(values[i0], values[i1]);
+    }
+
+    void compact(std::span<const std::uint32_t> kept, std::size_t group) override
+    {
+        if (shared())
+        {
+            // Gathering the survivors into a fresh buffer is the copy detaching would have made anyway.
+            const PropertyVector<T>& source = *data_;
+            auto compacted = std::make_shared<PropertyVector<T>>(source.get_allocator());
+            compacted->reserve(group * kept.size());
+            for (const std::uint32_t index : kept)
+            {
+                for (std::size_t j = 0; j < group; ++j)
+                {
+                    compacted->push_back(source[group * index + j]);
+                }
+            }
+            std::lock_guard lock(detach_mutex_);
+            data_ = std::move(compacted);
+            shared_.store(false, std::memory_order_release);
+            return;
+        }
+
+        // kept[i] >= i, so moving front to back never reads an element that was already overwritten.
+        auto& values = data();
+        for (std::size_t i = 0; i < kept.size(); ++i)
+        {
+            if (kept[i] != i)
+            {
+                for (std::size_t j = 0; j < group; ++j)
+                {
+                    values[group * i + j] = std::move(values[group * kept[i] + j]);
+                }
+            }
+        }
+        values.resize(group * kept.size(), default_);
+    }
+
+    void permute(std::span<const std::uint32_t> order, std::size_t group) override
+    {
+        // A permutation has no in-place order like compact's, so gather into a fresh buffer; a buffer nobody
+        // shares is moved from rather than copied.
+        PropertyVector<T>& source = *data_;
+        const bool moving = !shared();
+        auto permuted = std::make_shared<PropertyVector<T>>(source.get_allocator());
+        permuted->reserve(group * order.size());
+        for (const std::uint32_t index : order)
+        {
+            for (std::size_t j = 0; j < group; ++j)
+            {
+                if (moving)
+                {
+                    permuted->push_back(std::move(source[group * index + j]));
+                }
+                else
+                {
+                    permuted->push_back(source[group * index + j]);
+                }
+            }
+        }
+        std::lock_guard lock(detach_mutex_);
+        data_ = std::move(permuted);
+        shared_.store(false, std::memory_order_release);
+    }
+
+    void rehome(std::pmr::memory_resource* resource) override
+    {
+        const PropertyAllocator<T> allocator(resource);
+        if (data_->get_allocator() == allocator)
+        {
+            return;
+        }
+
+        std::shared_ptr<PropertyVector<T>> moved;
+        if (shared())
+        {
+            moved = std::make_shared<PropertyVector<T>>(data_->begin(), data_->end(), allocator);
+        }
+        else
+        {
+            moved = std::make_shared<PropertyVector<T>>(std::make_move_iterator(data_->begin()),
+                                                        std::make_move_iterator(data_->end()), allocator);
+        }
+        std::lock_guard lock(detach_mutex_);
+        data_ = std::move(moved);
+        shared_.store(false, std::memory_order_release);
     }
 
     [[nodiscard]] std::type_index type() const noexcept override { return typeid(T); }
 
-    [[nodiscard]] std::vector<T>& data() noexcept { return data_; }
-    [[nodiscard]] const std::vector<T>& data() const noexcept { return data_; }
+    [[nodiscard]] PropertyVector<T>& data()
+    {
+        if (shared_.load(std::memory_order_acquire))
+        {
+            detach();
+        }
+        return *data_;
+    }
+    [[nodiscard]] const PropertyVector<T>& data() const noexcept { return *data_; }
     [[nodiscard]] const T& default_value() const noexcept { return default_; }
 
+    // True while another storage still references this buffer.
+    [[nodiscard]] bool shared() const noexcept
+    {
+        return shared_.load(std::memory_order_acquire) && data_.use_count() > 1;
+    }
+
 private:
-    std::vector<T> data_;
+    // Serialised so that parallel writers racing to the first mutable access copy the buffer only once.
+    void detach()
+    {
+        std::lock_guard lock(detach_mutex_);
+        if (!shared_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        if (data_.use_count() > 1)
+        {
+            data_ = std::make_shared<PropertyVector<T>>(*data_);
+        }
+        shared_.store(false, std::memory_order_release);
+    }
+
+    std::shared_ptr<PropertyVector<T>> data_;
     T default_;
+    // Set when the buffer may be referenced by another storage; cleared once this one owns it alone.
+    mutable std::atomic<bool> shared_{false};
+    std::mutex detach_mutex_;
 };
 
+// Draws a fresh PropertyRegistry::generation() value.
+[[nodiscard]] std::uint64_t NextPropertyGeneration() noexcept;
+
 } // namespace detail
 
 template <class T>
@@ -105,13 +281,15 @@ class ConstPropertyBuffer;
 
 class PropertyRegistry {
 public:
-    PropertyRegistry() = default;
+    PropertyRegistry();
+    // Property buffers are drawn from `resource` (aligned operator new when null), which must outlive them.
+    explicit PropertyRegistry(std::pmr::memory_resource* resource);
     ~PropertyRegistry() = default;
 
     PropertyRegistry(const PropertyRegistry& other);
-    PropertyRegistry(PropertyRegistry&&) noexcept = default;
+    PropertyRegistry(PropertyRegistry&& other) noexcept;
     PropertyRegistry& operator=(const PropertyRegistry& other);
-    PropertyRegistry& operator=(PropertyRegistry&&) noexcept = default;
+    PropertyRegistry& operator=(PropertyRegistry&& other) noexcept;
 
     [[nodiscard]] std::size_t size() const noexcept { return size_; }
     [[nodiscard]] std::size_t property_count() const noexcept { return storages_.size(); }
@@ -124,9 +302,29 @@ public:
     void shrink_to_fit();
     void push_back();
     void swap(std::size_t i0, std::size_t i1);
+    // Compacts every property as PropertyStorageBase::compact, one property per task on the math worker pool.
+    void compact(std::span<const std::uint32_t> kept, std::size_t group = 1);
+    // Permutes every property as PropertyStorageBase::permute, one property per task.
+    void permute(std::span<const std::uint32_t> order, std::size_t group = 1);
+
+    [[nodiscard]] std::pmr::memory_resource* memory_resource() const noexcept { return resource_; }
+    // Moves every buffer into `resource`, one property per task, and allocates later properties from it. Copies
+    // of the registry keep the resource.
+    void set_memory_resource(std::pmr::memory_resource* resource);
+
+    // Changes whenever a property is added or removed, the registry is cleared, assigned or moved, and is
+    // unique across all registries, so a cached lookup is valid while the generation it was made at is current.
+    [[nodiscard]] std::uint64_t generation() const noexcept { return generation_; }
 
     [[nodiscard]] bool contains(std::string_view name) const;
     [[nodiscard]] std::optional<PropertyId> find(std::string_view name) const;
+    [[nodiscard]] std::optional<PropertyId> find(std::string_view name, std::uint64_t hash) const;
+
+    template <class T>
+    [[nodiscard]] std::optional<PropertyId> find(const PropertyKey<T>& key) const
+    {
+        return find(key.name, key.hash);
+    }
 
     template <class T>
     [[nodiscard]] std::optional<PropertyBuffer<T>> add(std::string name, T default_value = T());
@@ -143,9 +341,18 @@ public:
     template <class T>
     [[nodiscard]] std::optional<ConstPropertyBuffer<T>> get(PropertyId id) const;
 
+    template <class T>
+    [[nodiscard]] std::optional<PropertyBuffer<T>> get(const PropertyKey<T>& key);
+
+    template <class T>
+    [[nodiscard]] std::optional<ConstPropertyBuffer<T>> get(const PropertyKey<T>& key) const;
+
     template <class T>
     [[nodiscard]] PropertyBuffer<T> get_or_add(std::string name, T default_value = T());
 
+    template <class T>
+    [[nodiscard]] PropertyBuffer<T> get_or_add(const PropertyKey<T>& key, T default_value = T());
+
     template <class T>
     bool remove(PropertyBuffer<T>& handle);
 
@@ -161,7 +368,16 @@ private:
     template <class T>
     [[nodiscard]] const detail::PropertyStorage<T>* storage(PropertyId id) const noexcept;
 
+    // Inserts `id` into the open-addressed name index, growing it to keep the load at most one half.
+    void index(PropertyId id);
+    void rebuild_index();
+
     std::vector<std::unique_ptr<detail::PropertyStorageBase>> storages_;
+    // Name hash per property and a power-of-two table of id + 1 (0 = empty slot) probed linearly from the hash.
+    std::vector<std::uint64_t> hashes_;
+    std::vector<std::uint32_t> slots_;
+    std::uint64_t generation_;
+    std::pmr::memory_resource* resource_;
     std::size_t size_{0};
 };
 
@@ -178,12 +394,20 @@ public:
     }
     [[nodiscard]] explicit operator bool() const noexcept { return storage_ != nullptr; }
 
-    [[nodiscard]] std::vector<T>& vector() const noexcept
+    // Mutable access detaches a buffer shared with a copy of the registry (see detail::PropertyStorage).
+    [[nodiscard]] PropertyVector<T>& vector() const
     {
         assert(storage_ != nullptr);
         return storage_->data();
     }
 
+    // Read-only access that leaves a shared buffer shared.
+    [[nodiscard]] const PropertyVector<T>& const_vector() const noexcept
+    {
+        assert(storage_ != nullptr);
+        return std::as_const(*storage_).data();
+    }
+
     [[nodiscard]] decltype(auto) operator[](std::size_t index) const
     {
         assert(storage_ != nullptr);
@@ -193,11 +417,10 @@ public:
 
     [[nodiscard]] std::span<const T> span() const noexcept requires (!std::is_same_v<T, bool>)
     {
-        assert(storage_ != nullptr);
-        return std::span<T>(storage_->data());
+        return std::span<const T>(const_vector());
     }
 
-    [[nodiscard]] std::span<T> span() noexcept requires (!std::is_same_v<T, bool>)
+    [[nodiscard]] std::span<T> span() requires (!std::is_same_v<T, bool>)
     {
         assert(storage_ != nullptr);
         return std::span<T>(storage_->data());
@@ -205,8 +428,7 @@ public:
 
     [[nodiscard]] const T* data() const noexcept requires (!std::is_same_v<T, bool>)
     {
-        assert(storage_ != nullptr);
-        return storage_->data().data();
+        return const_vector().data();
     }
 
     void reset() noexcept
@@ -237,7 +459,7 @@ public:
     }
     [[nodiscard]] explicit operator bool() const noexcept { return storage_ != nullptr; }
 
-    [[nodiscard]] const std::vector<T>& vector() const noexcept
+    [[nodiscard]] const PropertyVector<T>& vector() const noexcept
     {
         assert(storage_ != nullptr);
         return storage_->data();
@@ -299,15 +521,19 @@ const detail::PropertyStorage<T>* PropertyRegistry::storage(PropertyId id) const
 template <class T>
 std::optional<PropertyBuffer<T>> PropertyRegistry::add(std::string name, T default_value)
 {
-    if (find(name).has_value())
+    const std::uint64_t hash = HashPropertyName(name);
+    if (find(name, hash).has_value())
     {
         return std::nullopt;
     }
 
-    auto storage = std::make_unique<detail::PropertyStorage<T>>(std::move(name), std::move(default_value));
+    auto storage = std::make_unique<detail::PropertyStorage<T>>(std::move(name), std::move(default_value), resource_);
     storage->resize(size_);
     auto* raw = storage.get();
     storages_.push_back(std::move(storage));
+    hashes_.push_back(hash);
+    index(storages_.size() - 1U);
+    generation_ = detail::NextPropertyGeneration();
     return PropertyBuffer<T>(storages_.size() - 1U, raw);
 }
 
@@ -351,6 +577,42 @@ std::optional<ConstPropertyBuffer<T>> PropertyRegistry::get(PropertyId id) const
     return std::nullopt;
 }
 
+template <class T>
+std::optional<PropertyBuffer<T>> PropertyRegistry::get(const PropertyKey<T>& key)
+{
+    if (auto id = find(key))
+    {
+        return get<T>(*id);
+    }
+    return std::nullopt;
+}
+
+template <class T>
+std::optional<ConstPropertyBuffer<T>> PropertyRegistry::get(const PropertyKey<T>& key) const
+{
+    if (auto id = find(key))
+    {
+        return get<T>(*id);
+    }
+    return std::nullopt;
+}
+
+template <class T>
+PropertyBuffer<T> PropertyRegistry::get_or_add(const PropertyKey<T>& key, T default_value)
+{
+    if (auto existing = get<T>(key))
+    {
+        return *existing;
+    }
+
+    auto created = add<T>(std::string(key.name), std::move(default_value));
+    if (created)
+    {
+        return std::move(*created);
+    }
+    return PropertyBuffer<T>();
+}
+
 template <class T>
 PropertyBuffer<T> PropertyRegistry::get_or_add(std::string name, T default_value)
 {
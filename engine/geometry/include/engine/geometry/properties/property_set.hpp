@@ -2,6 +2,10 @@
 
 #include "engine/geometry/properties/property_registry.hpp"
 
+#include <cassert>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -25,14 +29,19 @@ namespace engine::geometry
 
         [[nodiscard]] const std::string& name() const { return buffer_.name(); }
 
-        [[nodiscard]] decltype(auto) operator[](std::size_t index) const { return buffer_[index]; }
+        // Const access reads a buffer shared with a copied set in place; mutable access detaches it first.
+        [[nodiscard]] decltype(auto) operator[](std::size_t index) const
+        {
+            assert(index < buffer_.const_vector().size());
+            return buffer_.const_vector()[index];
+        }
         [[nodiscard]] decltype(auto) operator[](std::size_t index) { return buffer_[index]; }
 
-        [[nodiscard]] std::vector<T>& vector() { return buffer_.vector(); }
-        [[nodiscard]] const std::vector<T>& vector() const { return buffer_.vector(); }
+        [[nodiscard]] PropertyVector<T>& vector() { return buffer_.vector(); }
+        [[nodiscard]] const PropertyVector<T>& vector() const { return buffer_.const_vector(); }
 
-        [[nodiscard]] std::vector<T>& array() { return buffer_.vector(); }
-        [[nodiscard]] const std::vector<T>& array() const { return buffer_.vector(); }
+        [[nodiscard]] PropertyVector<T>& array() { return buffer_.vector(); }
+        [[nodiscard]] const PropertyVector<T>& array() const { return buffer_.const_vector(); }
 
         [[nodiscard]] std::span<T> span() { return buffer_.span(); }
         [[nodiscard]] std::span<const T> span() const { return buffer_.span(); }
@@ -69,6 +78,11 @@ namespace engine::geometry
     public:
         PropertySet() = default;
 
+        // See PropertyRegistry(std::pmr::memory_resource*).
+        explicit PropertySet(std::pmr::memory_resource* resource) : registry_(resource)
+        {
+        }
+
         [[nodiscard]] std::size_t size() const noexcept { return registry_.size(); }
 
         void clear();
@@ -76,6 +90,8 @@ namespace engine::geometry
         void resize(std::size_t n);
         void push_back();
         void swap(std::size_t i0, std::size_t i1);
+        void compact(std::span<const std::uint32_t> kept, std::size_t group = 1);
+        void permute(std::span<const std::uint32_t> order, std::size_t group = 1);
         void shrink_to_fit();
         bool empty() const;
 
@@ -94,6 +110,22 @@ namespace engine::geometry
         template <class T>
         [[nodiscard]] Property<T> get_or_add(std::string name, T default_value = T());
 
+        template <class T>
+        [[nodiscard]] Property<T> get(const PropertyKey<T>& key);
+
+        template <class T>
+        [[nodiscard]] Property<T> get(const PropertyKey<T>& key) const;
+
+        template <class T>
+        [[nodiscard]] Property<T> get_or_add(const PropertyKey<T>& key, T default_value = T());
+
+        [[nodiscard]] std::pmr::memory_resource* memory_resource() const noexcept { return registry_.memory_resource(); }
+        // See PropertyRegistry::set_memory_resource().
+        void set_memory_resource(std::pmr::memory_resource* resource) { registry_.set_memory_resource(resource); }
+
+        // See PropertyRegistry::generation().
+        [[nodiscard]] std::uint64_t generation() const noexcept { return registry_.generation(); }
+
         template <class T>
         void remove(Property<T>& property);
 
@@ -129,6 +161,16 @@ namespace engine::geometry
         registry_.swap(i0, i1);
     }
 
+    inline void PropertySet::compact(std::span<const std::uint32_t> kept, std::size_t group)
+    {
+        registry_.compact(kept, group);
+    }
+
+    inline void PropertySet::permute(std::span<const std::uint32_t> order, std::size_t group)
+    {
+        registry_.permute(order, group);
+    }
+
     inline void PropertySet::shrink_to_fit()
     {
         registry_.shrink_to_fit();
@@ -182,6 +224,28 @@ namespace engine::geometry
         return Property<T>(handle);
     }
 
+    template <class T>
+    inline Property<T> PropertySet::get(const PropertyKey<T>& key)
+    {
+        if (auto handle = registry_.get<T>(key))
+        {
+            return Property<T>(*handle);
+        }
+        return Property<T>();
+    }
+
+    template <class T>
+    inline Property<T> PropertySet::get(const PropertyKey<T>& key) const
+    {
+        return const_cast<PropertySet*>(this)->get<T>(key);
+    }
+
+    template <class T>
+    inline Property<T> PropertySet::get_or_add(const PropertyKey<T>& key, T default_value)
+    {
+        return Property<T>(registry_.get_or_add<T>(key, std::move(default_value)));
+    }
+
     template <class T>
     inline void PropertySet::remove(Property<T>& property)
     {
@@ -189,6 +253,46 @@ namespace engine::geometry
         property.reset();
     }
 
+    // A PropertyKey lookup that remembers its result. get() costs one compare while the set's generation (unique
+    // across sets) is unchanged and looks the key up again only after properties were added or removed, so it can
+    // sit inside loops that used to call get<T>(name) on every iteration.
+    template <class T>
+    class CachedProperty
+    {
+    public:
+        constexpr explicit CachedProperty(PropertyKey<T> key) noexcept : key_(key)
+        {
+        }
+
+        [[nodiscard]] const PropertyKey<T>& key() const noexcept { return key_; }
+
+        // Invalid Property when `set` has no property of this name and type.
+        [[nodiscard]] Property<T> get(const PropertySet& set)
+        {
+            if (generation_ != set.generation())
+            {
+                property_ = set.get<T>(key_);
+                generation_ = set.generation();
+            }
+            return property_;
+        }
+
+        [[nodiscard]] Property<T> get_or_add(PropertySet& set, T default_value = T())
+        {
+            if (generation_ != set.generation() || !property_)
+            {
+                property_ = set.get_or_add<T>(key_, std::move(default_value));
+                generation_ = set.generation();
+            }
+            return property_;
+        }
+
+    private:
+        PropertyKey<T> key_;
+        std::uint64_t generation_{0};
+        Property<T> property_;
+    };
+
     using MeshPropertySet [[deprecated("Use PropertySet instead")]] = PropertySet;
 
     using Vertices = PropertySet;
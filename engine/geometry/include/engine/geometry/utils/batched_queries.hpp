@@ -0,0 +1,183 @@
+#pragma once
+
+#include "engine/geometry/shapes/ray.hpp"
+#include "engine/geometry/utils/morton.hpp"
+#include "engine/geometry/utils/ray_packet.hpp"
+#include "engine/geometry/utils/query_scratch.hpp"
+#include "engine/math/parallel.hpp"
+#include "engine/math/vector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace engine::geometry
+{
+    // Flat (CSR) result of a batched neighbour query. The neighbours of query q are
+    // indices[offsets[q] .. offsets[q + 1]) with the matching squared distances.
+    struct NeighborList
+    {
+        std::vector<std::size_t> offsets{0};
+        std::vector<std::size_t> indices;
+        std::vector<float> distances_sq;
+
+        [[nodiscard]] std::size_t query_count() const noexcept
+        {
+            return offsets.empty() ? 0 : offsets.size() - 1;
+        }
+
+        [[nodiscard]] std::span<const std::size_t> neighbors(std::size_t query) const noexcept
+        {
+            return std::span(indices).subspan(offsets[query], offsets[query + 1] - offsets[query]);
+        }
+
+        [[nodiscard]] std::span<const float> squared_distances(std::size_t query) const noexcept
+        {
+            return std::span(distances_sq).subspan(offsets[query], offsets[query + 1] - offsets[query]);
+        }
+
+        void clear()
+        {
+            offsets.assign(1, 0);
+            indices.clear();
+            distances_sq.clear();
+        }
+    };
+} // namespace engine::geometry
+
+namespace engine::geometry::utils
+{
+    // Queries per task of a batched query.
+    inline constexpr std::size_t kQueryGrain = 256;
+
+    // Runs query(point, scratch, indices, distances_sq) for every point, appending each query's neighbours to
+    // the task-local buffers, and gathers the rows into `result` in input order. Queries are visited in Morton
+    // order so consecutive queries of a task walk the same part of the tree. Row contents only depend on
+    // the query, so the result is identical for any thread count.
+    template <class QueryFn>
+    void RunBatchedQueries(std::span<const math::vec3> queries, NeighborList& result, QueryFn&& query)
+    {
+        result.clear();
+        const std::size_t n = queries.size();
+        if (n == 0)
+        {
+            return;
+        }
+
+        struct Chunk
+        {
+            std::vector<std::size_t> counts;
+            std::vector<std::size_t> indices;
+            std::vector<float> distances_sq;
+            QueryScratch scratch;
+        };
+
+        const std::vector<std::size_t> order = MortonOrder(queries);
+        std::vector<Chunk> chunks(math::parallel::chunk_count(0, n, kQueryGrain));
+        math::parallel::parallel_for(0, n, kQueryGrain, [&](std::size_t first, std::size_t last)
+        {
+            Chunk& chunk = chunks[first / kQueryGrain];
+            chunk.counts.resize(last - first);
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const std::size_t before = chunk.indices.size();
+                query(queries[order[i]], chunk.scratch, chunk.indices, chunk.distances_sq);
+                chunk.counts[i - first] = chunk.indices.size() - before;
+            }
+        });
+
+        result.offsets.assign(n + 1, 0);
+        for (std::size_t c = 0; c < chunks.size(); ++c)
+        {
+            for (std::size_t j = 0; j < chunks[c].counts.size(); ++j)
+            {
+                result.offsets[order[c * kQueryGrain + j] + 1] = chunks[c].counts[j];
+            }
+        }
+        for (std::size_t q = 0; q < n; ++q)
+        {
+            result.offsets[q + 1] += result.offsets[q];
+        }
+
+        result.indices.resize(result.offsets[n]);
+        result.distances_sq.resize(result.offsets[n]);
+        math::parallel::parallel_for(0, n, kQueryGrain, [&](std::size_t first, std::size_t last)
+        {
+            const Chunk& chunk = chunks[first / kQueryGrain];
+            std::size_t source = 0;
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const std::size_t count = chunk.counts[i - first];
+                const std::size_t target = result.offsets[order[i]];
+                std::copy_n(chunk.indices.begin() + source, count, result.indices.begin() + target);
+                std::copy_n(chunk.distances_sq.begin() + source, count, result.distances_sq.begin() + target);
+                source += count;
+            }
+        });
+    }
+
+    // Ray counterpart of RunBatchedQueries(). trace(rays, emit) traces the rays of one task of kRayGrain
+    // consecutive rays and calls emit(ray, element, distance_sq) for every result, with `ray` indexing the
+    // task's span. Each row is ordered by distance, then element, so the result is identical for any thread
+    // count and either RayBatchMode.
+    template <class TraceFn>
+    void RunBatchedRayQueries(std::span<const Ray> rays, NeighborList& result, TraceFn&& trace)
+    {
+        result.clear();
+        const std::size_t n = rays.size();
+        result.offsets.assign(n + 1, 0);
+        if (n == 0)
+        {
+            return;
+        }
+
+        struct Entry
+        {
+            std::size_t ray;
+            float distance_sq;
+            std::size_t element;
+        };
+
+        std::vector<std::vector<Entry>> chunks(math::parallel::chunk_count(0, n, kRayGrain));
+        math::parallel::parallel_for(0, n, kRayGrain, [&](std::size_t first, std::size_t last)
+        {
+            auto& entries = chunks[first / kRayGrain];
+            trace(rays.subspan(first, last - first), [&](std::size_t ray, std::size_t element, float distance_sq)
+            {
+                entries.push_back({first + ray, distance_sq, element});
+            });
+            std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+            {
+                if (a.ray != b.ray) return a.ray < b.ray;
+                if (a.distance_sq != b.distance_sq) return a.distance_sq < b.distance_sq;
+                return a.element < b.element;
+            });
+        });
+
+        for (const auto& entries : chunks)
+        {
+            for (const Entry& entry : entries)
+            {
+                ++result.offsets[entry.ray + 1];
+            }
+        }
+        for (std::size_t r = 0; r < n; ++r)
+        {
+            result.offsets[r + 1] += result.offsets[r];
+        }
+
+        result.indices.resize(result.offsets[n]);
+        result.distances_sq.resize(result.offsets[n]);
+        math::parallel::parallel_for(0, n, kRayGrain, [&](std::size_t first, std::size_t)
+        {
+            std::size_t target = result.offsets[first];
+            for (const Entry& entry : chunks[first / kRayGrain])
+            {
+                result.indices[target] = entry.element;
+                result.distances_sq[target] = entry.distance_sq;
+                ++target;
+            }
+        });
+    }
+} // namespace engine::geometry::utils
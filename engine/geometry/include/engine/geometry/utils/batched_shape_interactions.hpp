@@ -0,0 +1,88 @@
+#pragma once
+
+#include "engine/geometry/api.hpp"
+#include "engine/math/vector.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace engine::geometry
+{
+    struct Aabb;
+    struct Plane;
+    struct Ray;
+    struct Sphere;
+
+    // Boxes in SoA form for the batched kernels below. Each kernel streams the coordinate arrays a block of
+    // boxes at a time and compiles to vector code over many boxes at once, which is what broadphase and culling
+    // loops want instead of one call per pair. The arrays are padded with empty boxes to whole blocks, so the
+    // block loops have a fixed trip count and need no scalar tail.
+    class ENGINE_GEOMETRY_API AabbSoa
+    {
+    public:
+        static constexpr std::size_t kBlockSize = 64;
+
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+        void clear() noexcept;
+
+        // New boxes are empty (min = +inf, max = -inf) until set.
+        void resize(std::size_t count);
+
+        void assign(std::span<const Aabb> boxes);
+
+        void push_back(const Aabb& box);
+
+        void set(std::size_t index, const Aabb& box) noexcept;
+
+        [[nodiscard]] Aabb get(std::size_t index) const noexcept;
+
+        // Per-axis coordinate arrays, each padded to a multiple of kBlockSize.
+        [[nodiscard]] const float* min(std::size_t axis) const noexcept { return min_[axis].data(); }
+
+        [[nodiscard]] const float* max(std::size_t axis) const noexcept { return max_[axis].data(); }
+
+    private:
+        std::array<std::vector<float>, 3> min_;
+        std::array<std::vector<float>, 3> max_;
+        std::size_t size_ = 0;
+    };
+
+    // Batched tests write one bit per box, box i to bit i % 64 of mask[i / 64], and return the number of set
+    // bits; bits past the last box are cleared. `mask` must hold at least MaskWordCount(boxes.size()) words.
+    [[nodiscard]] constexpr std::size_t MaskWordCount(std::size_t count) noexcept
+    {
+        return (count + AabbSoa::kBlockSize - 1) / AabbSoa::kBlockSize;
+    }
+
+    // Appends the indices of the set bits of `mask` to `indices` in increasing order.
+    ENGINE_GEOMETRY_API void AppendSetBits(std::span<const std::uint64_t> mask, std::vector<std::uint32_t>& indices);
+
+    // Boxes overlapping `query`; box i agrees with Intersects(query, boxes.get(i)).
+    ENGINE_GEOMETRY_API std::size_t Intersects(const Aabb& query, const AabbSoa& boxes,
+                                               std::span<std::uint64_t> mask) noexcept;
+
+    // Boxes within the sphere's radius of its center. Distances are taken in float, while Intersects(Sphere,
+    // Aabb) accumulates in double, so the two can disagree on boxes touching the sphere to within rounding.
+    ENGINE_GEOMETRY_API std::size_t Intersects(const Sphere& query, const AabbSoa& boxes,
+                                               std::span<std::uint64_t> mask) noexcept;
+
+    // Boxes the ray enters over [0, inf), as Intersects(Ray, Aabb). `entry`, when not empty, receives the
+    // distance along the ray at which each box is entered (0 for boxes containing the origin); entries of
+    // missed boxes are unspecified.
+    ENGINE_GEOMETRY_API std::size_t Intersects(const Ray& query, const AabbSoa& boxes, std::span<std::uint64_t> mask,
+                                               std::span<float> entry = {}) noexcept;
+
+    // Boxes not entirely on the negative side of any plane (SignedDistance < 0), i.e. the usual conservative
+    // frustum culling test for planes with inward normals: every box overlapping the convex region passes, and
+    // so can a box near a corner of the region that lies outside it.
+    ENGINE_GEOMETRY_API std::size_t IntersectsHalfspaces(std::span<const Plane> planes, const AabbSoa& boxes,
+                                                         std::span<std::uint64_t> mask) noexcept;
+
+    // Squared distance from `point` to every box, 0 inside; distance_sq must hold boxes.size() values.
+    ENGINE_GEOMETRY_API void SquaredDistance(const math::vec3& point, const AabbSoa& boxes,
+                                             std::span<float> distance_sq) noexcept;
+} // namespace engine::geometry
@@ -65,4 +65,20 @@ namespace engine::geometry::utils {
        std::size_t max_size_;
         std::vector<T> data_; // max-heap by operator< (largest at front)
     };
-}
\ No newline at end of file
+
+    // BoundedHeap::push() on caller-owned storage, for hot loops that reuse one buffer across queries.
+    // `heap` must be a max-heap by operator< holding at most max_size items.
+    template<typename T>
+    void push_bounded(std::vector<T>& heap, std::size_t max_size, const T& item) {
+        if (max_size == 0) return;
+
+        if (heap.size() < max_size) {
+            heap.push_back(item);
+            std::push_heap(heap.begin(), heap.end());
+        } else if (item < heap.front()) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = item;
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "engine/geometry/utils/spatial_build.hpp"
+#include "engine/math/parallel.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace engine::geometry::utils
+{
+    // Where the surviving elements of a container go when the deleted ones are squeezed out in order:
+    // remap[old] is the new index (kRemoved for deleted elements) and kept[new] the old one, ascending.
+    struct Compaction
+    {
+        static constexpr std::uint32_t kRemoved = std::numeric_limits<std::uint32_t>::max();
+
+        std::vector<std::uint32_t> remap;
+        std::vector<std::uint32_t> kept;
+    };
+
+    // Builds the Compaction that drops the elements flagged in `deleted`. Survivors are counted per chunk, the
+    // counts prefix-summed, and each chunk then numbers its own survivors, all in parallel.
+    template <class Allocator>
+    [[nodiscard]] Compaction PlanCompaction(const std::vector<bool, Allocator>& deleted)
+    {
+        const std::size_t count = deleted.size();
+        Compaction plan;
+        plan.remap.resize(count);
+        std::vector<std::uint32_t> offsets(math::parallel::chunk_count(0, count, kBuildGrain) + 1, 0);
+        math::parallel::parallel_for(0, count, kBuildGrain, [&](std::size_t first, std::size_t last)
+        {
+            std::uint32_t survivors = 0;
+            for (std::size_t i = first; i < last; ++i)
+            {
+                survivors += deleted[i] ? 0U : 1U;
+            }
+            offsets[first / kBuildGrain + 1] = survivors;
+        });
+        for (std::size_t chunk = 1; chunk < offsets.size(); ++chunk)
+        {
+            offsets[chunk] += offsets[chunk - 1];
+        }
+
+        plan.kept.resize(offsets.back());
+        math::parallel::parallel_for(0, count, kBuildGrain, [&](std::size_t first, std::size_t last)
+        {
+            std::uint32_t next = offsets[first / kBuildGrain];
+            for (std::size_t i = first; i < last; ++i)
+            {
+                if (deleted[i])
+                {
+                    plan.remap[i] = Compaction::kRemoved;
+                    continue;
+                }
+                plan.remap[i] = next;
+                plan.kept[next++] = static_cast<std::uint32_t>(i);
+            }
+        });
+        return plan;
+    }
+} // namespace engine::geometry::utils
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "engine/geometry/shapes/aabb.hpp"
+#include "engine/geometry/utils/morton.hpp"
+#include "engine/geometry/utils/radix_sort.hpp"
+#include "engine/geometry/utils/spatial_build.hpp"
+#include "engine/math/parallel.hpp"
+#include "engine/math/vector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <vector>
+
+namespace engine::geometry::utils
+{
+    // Index of the 21-bit cell (x, y, z) along the 3D Hilbert curve, 63 bits. Unlike the Morton curve, consecutive
+    // indices are always face-adjacent cells, so a sort by it never jumps across the domain. Uses Skilling's
+    // transpose form ("Programming the Hilbert curve", 2004): the axes are turned into the transposed index in
+    // place, whose bits are then interleaved with the first axis most significant.
+    [[nodiscard]] constexpr std::uint64_t HilbertEncode(std::uint32_t x, std::uint32_t y, std::uint32_t z) noexcept
+    {
+        constexpr std::uint32_t kTop = 1U << (kMortonBits - 1);
+        std::uint32_t axes[3] = {x & 0x1fffffU, y & 0x1fffffU, z & 0x1fffffU};
+
+        for (std::uint32_t q = kTop; q > 1; q >>= 1)
+        {
+            const std::uint32_t p = q - 1;
+            for (std::uint32_t& axis : axes)
+            {
+                if (axis & q)
+                {
+                    axes[0] ^= p;
+                }
+                else
+                {
+                    const std::uint32_t t = (axes[0] ^ axis) & p;
+                    axes[0] ^= t;
+                    axis ^= t;
+                }
+            }
+        }
+
+        axes[1] ^= axes[0];
+        axes[2] ^= axes[1];
+        std::uint32_t t = 0;
+        for (std::uint32_t q = kTop; q > 1; q >>= 1)
+        {
+            if (axes[2] & q)
+            {
+                t ^= q - 1;
+            }
+        }
+        for (std::uint32_t& axis : axes)
+        {
+            axis ^= t;
+        }
+        return MortonEncode(axes[2], axes[1], axes[0]);
+    }
+
+    // Hilbert index of `point` on the 2^21 grid spanning `bounds`; points outside are clamped to the grid.
+    [[nodiscard]] inline std::uint64_t HilbertCode(const math::vec3& point, const Aabb& bounds) noexcept
+    {
+        constexpr float kCells = static_cast<float>((1U << kMortonBits) - 1U);
+        std::uint32_t cell[3];
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            const float extent = bounds.max[axis] - bounds.min[axis];
+            const float t = extent > 0.0f ? (point[axis] - bounds.min[axis]) / extent : 0.0f;
+            cell[axis] = static_cast<std::uint32_t>(std::clamp(t, 0.0f, 1.0f) * kCells);
+        }
+        return HilbertEncode(cell[0], cell[1], cell[2]);
+    }
+
+    // Permutation visiting `points` along the Hilbert curve of their bounds; equal codes keep input order.
+    [[nodiscard]] inline std::vector<std::size_t> HilbertOrder(std::span<const math::vec3> points)
+    {
+        const Aabb bounds = ParallelBounds(points.size(), [&](std::size_t i)
+        {
+            return Aabb{.min = points[i], .max = points[i]};
+        });
+
+        std::vector<std::uint64_t> codes(points.size());
+        math::parallel::parallel_for(0, points.size(), kBuildGrain, [&](std::size_t first, std::size_t last)
+        {
+            for (std::size_t i = first; i < last; ++i)
+            {
+                codes[i] = HilbertCode(points[i], bounds);
+            }
+        });
+
+        std::vector<std::size_t> order(points.size());
+        std::iota(order.begin(), order.end(), 0);
+        ParallelRadixSort(codes, order, 3 * kMortonBits);
+        return order;
+    }
+} // namespace engine::geometry::utils
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "engine/geometry/export.hpp"
+#include "engine/math/vector.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace engine::geometry::utils
+{
+    enum class SpaceFillingCurve { Morton, Hilbert };
+
+    struct LocalityOptions
+    {
+        // Curve the vertices (and, for point clouds, the points) are sorted along.
+        SpaceFillingCurve curve = SpaceFillingCurve::Hilbert;
+        // Reorders triangles for a post-transform vertex cache with Tipsify; otherwise triangles only follow
+        // the curve.
+        bool optimize_vertex_cache = true;
+        // FIFO entries Tipsify plans for; 16 to 32 matches current GPUs.
+        std::uint32_t cache_size = 16;
+    };
+
+    // New-to-old permutations: new element i is old element vertices[i] (triangles[i]).
+    struct LocalityOrder
+    {
+        std::vector<std::uint32_t> vertices;
+        std::vector<std::uint32_t> triangles;
+    };
+
+    // Permutation visiting `points` along `curve`, as MortonOrder / HilbertOrder.
+    [[nodiscard]] ENGINE_GEOMETRY_API std::vector<std::uint32_t> SpatialOrder(std::span<const math::vec3> points,
+                                                                             SpaceFillingCurve curve);
+
+    // Tipsify (Sander, Nehab and Barczak, "Fast triangle reordering for vertex locality and reduced overdraw",
+    // 2007): emits the triangles around one vertex at a time, moving on to the neighbour that will still be
+    // cached once its remaining triangles are emitted, or to the most recently touched vertex after a dead end.
+    // Linear in the triangle count. Returns the new-to-old triangle order; every index must be below
+    // `vertex_count`.
+    [[nodiscard]] ENGINE_GEOMETRY_API std::vector<std::uint32_t> OptimizeVertexCache(
+        std::span<const std::uint32_t> indices, std::size_t vertex_count, std::uint32_t cache_size = 16);
+
+    // Vertex order in which the triangles, taken in `triangle_order`, first reference each vertex, so vertex
+    // fetches stream forward. Unreferenced vertices follow in index order.
+    [[nodiscard]] ENGINE_GEOMETRY_API std::vector<std::uint32_t> OptimizeVertexFetch(
+        std::span<const std::uint32_t> indices, std::span<const std::uint32_t> triangle_order,
+        std::size_t vertex_count);
+
+    // Average cache miss ratio (vertex transforms per triangle) of drawing `indices` through a FIFO cache of
+    // `cache_size` entries: 3 without reuse, about 0.5 for a well-ordered regular mesh.
+    [[nodiscard]] ENGINE_GEOMETRY_API double AverageCacheMissRatio(std::span<const std::uint32_t> indices,
+                                                                   std::size_t vertex_count,
+                                                                   std::uint32_t cache_size = 16);
+
+    // Full locality pass over a triangle mesh: triangles sorted along the curve of their vertices, then
+    // Tipsify-ordered when requested, then vertices renumbered in fetch order (unreferenced ones last, along the
+    // curve). Triangles with an index of `positions.size()` or more are moved to the end unchanged.
+    [[nodiscard]] ENGINE_GEOMETRY_API LocalityOrder PlanLocality(std::span<const math::vec3> positions,
+                                                                 std::span<const std::uint32_t> indices,
+                                                                 const LocalityOptions& options = {});
+
+    // Old-to-new inverse of a new-to-old permutation.
+    [[nodiscard]] ENGINE_GEOMETRY_API std::vector<std::uint32_t> InvertPermutation(
+        std::span<const std::uint32_t> order);
+} // namespace engine::geometry::utils
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "engine/geometry/shapes/aabb.hpp"
+#include "engine/geometry/utils/radix_sort.hpp"
+#include "engine/geometry/utils/spatial_build.hpp"
+#include "engine/math/parallel.hpp"
+#include "engine/math/vector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <vector>
+
+namespace engine::geometry::utils
+{
+    // Bits per axis of a 63-bit 3D Morton code.
+    inline constexpr std::uint32_t kMortonBits = 21;
+
+    // Spreads the low 21 bits of v so that bit i lands on bit 3 * i.
+    [[nodiscard]] constexpr std::uint64_t MortonExpandBits(std::uint64_t v) noexcept
+    {
+        v &= 0x1fffffULL;
+        v = (v | v << 32) & 0x1f00000000ffffULL;
+        v = (v | v << 16) & 0x1f0000ff0000ffULL;
+        v = (v | v << 8) & 0x100f00f00f00f00fULL;
+        v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+        v = (v | v << 2) & 0x1249249249249249ULL;
+        return v;
+    }
+
+    // Interleaves three 21-bit cell coordinates, x in the lowest bit.
+    [[nodiscard]] constexpr std::uint64_t MortonEncode(std::uint32_t x, std::uint32_t y, std::uint32_t z) noexcept
+    {
+        return MortonExpandBits(x) | (MortonExpandBits(y) << 1) | (MortonExpandBits(z) << 2);
+    }
+
+    // Morton code of `point` on the 2^21 grid spanning `bounds`; points outside are clamped to the grid.
+    [[nodiscard]] inline std::uint64_t MortonCode(const math::vec3& point, const Aabb& bounds) noexcept
+    {
+        constexpr float kCells = static_cast<float>((1U << kMortonBits) - 1U);
+        std::uint32_t cell[3];
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            const float extent = bounds.max[axis] - bounds.min[axis];
+            const float t = extent > 0.0f ? (point[axis] - bounds.min[axis]) / extent : 0.0f;
+            cell[axis] = static_cast<std::uint32_t>(std::clamp(t, 0.0f, 1.0f) * kCells);
+        }
+        return MortonEncode(cell[0], cell[1], cell[2]);
+    }
+
+    // Permutation visiting `points` along the Morton curve of their bounds; equal codes keep input order.
+    [[nodiscard]] inline std::vector<std::size_t> MortonOrder(std::span<const math::vec3> points)
+    {
+        const Aabb bounds = ParallelBounds(points.size(), [&](std::size_t i)
+        {
+            return Aabb{.min = points[i], .max = points[i]};
+        });
+
+        std::vector<std::uint64_t> codes(points.size());
+        math::parallel::parallel_for(0, points.size(), kBuildGrain, [&](std::size_t first, std::size_t last)
+        {
+            for (std::size_t i = first; i < last; ++i)
+            {
+                codes[i] = MortonCode(points[i], bounds);
+            }
+        });
+
+        std::vector<std::size_t> order(points.size());
+        std::iota(order.begin(), order.end(), 0);
+        ParallelRadixSort(codes, order, 3 * kMortonBits);
+        return order;
+    }
+} // namespace engine::geometry::utils
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "engine/math/vector.hpp"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace engine::geometry
+{
+    // A tree node queued by a traversal, with the squared distance from the query to its cell. Kd-trees also
+    // carry the per-axis offsets to the cell so child distances can be derived incrementally.
+    struct TraversalCell
+    {
+        float distance_sq = 0.0f;
+        math::vec3 offsets{};
+        std::size_t node = 0;
+    };
+
+    // Orders a std::*_heap of cells so the nearest one is on top.
+    struct TraversalCellGreater
+    {
+        bool operator()(const TraversalCell& lhs, const TraversalCell& rhs) const noexcept
+        {
+            return lhs.distance_sq > rhs.distance_sq;
+        }
+    };
+
+    // Reusable working memory for KdTree and Octree queries. Keep one per thread and pass it to the
+    // scratch overloads: buffers only grow, so queries stop allocating once they reach their peak sizes.
+    // Results returned as spans point into `results` and stay valid until the next query with this scratch.
+    struct QueryScratch
+    {
+        std::vector<std::size_t> node_stack;
+        std::vector<TraversalCell> cells;
+        // Max-heap of the best (squared distance, index) candidates of a k-nearest query.
+        std::vector<std::pair<float, std::size_t>> neighbors;
+        std::vector<std::size_t> results;
+    };
+} // namespace engine::geometry
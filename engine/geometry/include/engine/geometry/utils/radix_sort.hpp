@@ -0,0 +1,76 @@
+#pragma once
+
+#include "engine/geometry/utils/spatial_build.hpp"
+#include "engine/math/parallel.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace engine::geometry::utils
+{
+    // Stable LSD radix sort of keys[i] (with values[i] carried along) by their low `key_bits` bits, one byte
+    // per pass. Each pass histograms chunks in parallel, prefix-sums the counts in (digit, chunk) order and lets
+    // every chunk scatter into its own sub-ranges, so the result is identical for any thread count. Passes on
+    // a byte that all keys share are skipped.
+    template <class Value>
+    void ParallelRadixSort(std::vector<std::uint64_t>& keys, std::vector<Value>& values, unsigned key_bits = 64)
+    {
+        const std::size_t n = keys.size();
+        if (n < 2)
+        {
+            return;
+        }
+
+        using Histogram = std::array<std::size_t, 256>;
+        std::vector<std::uint64_t> keys_out(n);
+        std::vector<Value> values_out(n);
+        std::vector<Histogram> histograms(math::parallel::chunk_count(0, n, kBuildGrain));
+
+        for (unsigned shift = 0; shift < key_bits; shift += 8)
+        {
+            math::parallel::parallel_for(0, n, kBuildGrain, [&](std::size_t first, std::size_t last)
+            {
+                Histogram& histogram = histograms[first / kBuildGrain];
+                histogram.fill(0);
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    ++histogram[(keys[i] >> shift) & 0xffU];
+                }
+            });
+
+            std::size_t offset = 0;
+            bool shared_digit = false;
+            for (std::size_t digit = 0; digit < 256; ++digit)
+            {
+                const std::size_t digit_start = offset;
+                for (Histogram& histogram : histograms)
+                {
+                    const std::size_t count = histogram[digit];
+                    histogram[digit] = offset;
+                    offset += count;
+                }
+                shared_digit |= offset - digit_start == n;
+            }
+            if (shared_digit)
+            {
+                continue;
+            }
+
+            math::parallel::parallel_for(0, n, kBuildGrain, [&](std::size_t first, std::size_t last)
+            {
+                Histogram& cursor = histograms[first / kBuildGrain];
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    const std::size_t target = cursor[(keys[i] >> shift) & 0xffU]++;
+                    keys_out[target] = keys[i];
+                    values_out[target] = std::move(values[i]);
+                }
+            });
+            keys.swap(keys_out);
+            values.swap(values_out);
+        }
+    }
+} // namespace engine::geometry::utils
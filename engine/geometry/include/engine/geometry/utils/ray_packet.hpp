@@ -0,0 +1,411 @@
+#pragma once
+
+#include "engine/geometry/shapes/aabb.hpp"
+#include "engine/geometry/shapes/ray.hpp"
+#include "engine/geometry/shapes/triangle.hpp"
+#include "engine/geometry/utils/shape_interactions.hpp"
+#include "engine/math/vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <vector>
+
+namespace engine::geometry
+{
+    // How a batched ray query groups its rays. Packet traces fixed groups of consecutive rays together and
+    // pays off when neighbouring rays are coherent (camera rays, texel bundles sharing an origin). Stream keeps
+    // the SIMD lanes busy when rays are incoherent (bounced or random directions): structures that report every
+    // hit filter the whole stream node by node, closest/any-hit traversals give each lane its own ray and refill
+    // lanes as their rays finish.
+    enum class RayBatchMode { Packet, Stream };
+
+    // Lanes per packet; 8 fills an AVX register, 4 an SSE/NEON one.
+    inline constexpr std::size_t kRayPacketWidth = 8;
+
+    // Rays of a packet in SoA form. All per-lane loops run over fixed-size arrays so the compiler turns them
+    // into Width-wide vector code. Lanes without a ray keep t_max < 0 and never report a hit.
+    template <std::size_t Width>
+    struct RayPacket
+    {
+        static_assert(Width == 4 || Width == 8 || Width == 16, "ray packets are 4, 8 or 16 lanes wide");
+
+        using Lanes = std::array<float, Width>;
+
+        std::array<Lanes, 3> origin{};
+        std::array<Lanes, 3> direction{};
+        // 1 / direction, or 0 on axes the ray is parallel to (|direction| <= PARALLEL_EPSILON, as in
+        // Intersects(Aabb, Ray)).
+        std::array<Lanes, 3> inv_direction{};
+        // +inf on parallel axes, 0 elsewhere; added to the slab exit so parallel axes never bound the interval.
+        std::array<Lanes, 3> far_pad{};
+        // Per-lane end of the ray interval; traversals shrink it as hits are found.
+        Lanes t_max{};
+        // Lanes still being traced.
+        std::uint32_t active = 0;
+        // Lanes with at least one parallel axis, which need the origin-in-slab test.
+        std::uint32_t parallel_lanes = 0;
+
+        RayPacket()
+        {
+            t_max.fill(-1.0f);
+        }
+
+        void set(std::size_t lane, const Ray& ray, float ray_t_max) noexcept
+        {
+            for (std::size_t axis = 0; axis < 3; ++axis)
+            {
+                const float d = ray.direction[axis];
+                const bool is_parallel = std::abs(d) <= constants::PARALLEL_EPSILON;
+                origin[axis][lane] = ray.origin[axis];
+                direction[axis][lane] = d;
+                inv_direction[axis][lane] = is_parallel ? 0.0f : 1.0f / d;
+                far_pad[axis][lane] = is_parallel ? std::numeric_limits<float>::infinity() : 0.0f;
+                parallel_lanes |= static_cast<std::uint32_t>(is_parallel) << lane;
+            }
+            t_max[lane] = ray_t_max;
+            active |= std::uint32_t{1} << lane;
+        }
+
+        // Stops tracing a lane; it no longer passes any slab or triangle test.
+        void retire(std::size_t lane) noexcept
+        {
+            t_max[lane] = -1.0f;
+            active &= ~(std::uint32_t{1} << lane);
+        }
+    };
+
+    // Per-lane hit parameters written by Intersects(Triangle, RayPacket, ...).
+    template <std::size_t Width>
+    struct RayPacketHits
+    {
+        std::array<float, Width> t{};
+        std::array<float, Width> u{};
+        std::array<float, Width> v{};
+    };
+
+    // Slab test of every lane against `box` over [0, t_max]; returns the mask of lanes that hit and writes
+    // their entry distances. Agrees with Intersects(Aabb, Ray) lane by lane. Packets without parallel axes take
+    // a pure min/max path that compiles to Width-wide vector code; the others add the per-lane origin test.
+    template <std::size_t Width>
+    [[nodiscard]] std::uint32_t Intersects(const Aabb& box, const RayPacket<Width>& packet,
+                                           std::array<float, Width>& entry) noexcept
+    {
+        constexpr float kInf = std::numeric_limits<float>::infinity();
+        std::array<float, Width> t0{};
+        std::array<float, Width> t1 = packet.t_max;
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            const float lo = box.min[axis];
+            const float hi = box.max[axis];
+            const auto& origin = packet.origin[axis];
+            const auto& inv_direction = packet.inv_direction[axis];
+            const auto& far_pad = packet.far_pad[axis];
+            for (std::size_t lane = 0; lane < Width; ++lane)
+            {
+                const float a = (lo - origin[lane]) * inv_direction[lane];
+                const float b = (hi - origin[lane]) * inv_direction[lane];
+                t0[lane] = std::max(t0[lane], std::min(a, b));
+                t1[lane] = std::min(t1[lane], std::max(a, b) + far_pad[lane]);
+            }
+            if (packet.parallel_lanes == 0) continue;
+
+            for (std::size_t lane = 0; lane < Width; ++lane)
+            {
+                if (far_pad[lane] != 0.0f && (origin[lane] < lo || origin[lane] > hi))
+                {
+                    t0[lane] = kInf;
+                }
+            }
+        }
+
+        std::uint32_t mask = 0;
+        for (std::size_t lane = 0; lane < Width; ++lane)
+        {
+            mask |= static_cast<std::uint32_t>(t0[lane] <= t1[lane]) << lane;
+        }
+        entry = t0;
+        return mask;
+    }
+
+    // One box per lane in SoA form, for traversals where every lane sits at a different node.
+    template <std::size_t Width>
+    struct AabbLanes
+    {
+        std::array<std::array<float, Width>, 3> min{};
+        std::array<std::array<float, Width>, 3> max{};
+
+        void set(std::size_t lane, const Aabb& box) noexcept
+        {
+            for (std::size_t axis = 0; axis < 3; ++axis)
+            {
+                min[axis][lane] = box.min[axis];
+                max[axis][lane] = box.max[axis];
+            }
+        }
+    };
+
+    // Slab test of every lane against its own box; otherwise as Intersects(Aabb, RayPacket, entry).
+    template <std::size_t Width>
+    [[nodiscard]] std::uint32_t Intersects(const AabbLanes<Width>& boxes, const RayPacket<Width>& packet,
+                                           std::array<float, Width>& entry) noexcept
+    {
+        constexpr float kInf = std::numeric_limits<float>::infinity();
+        std::array<float, Width> t0{};
+        std::array<float, Width> t1 = packet.t_max;
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            const auto& lo = boxes.min[axis];
+            const auto& hi = boxes.max[axis];
+            const auto& origin = packet.origin[axis];
+            const auto& inv_direction = packet.inv_direction[axis];
+            const auto& far_pad = packet.far_pad[axis];
+            for (std::size_t lane = 0; lane < Width; ++lane)
+            {
+                const float a = (lo[lane] - origin[lane]) * inv_direction[lane];
+                const float b = (hi[lane] - origin[lane]) * inv_direction[lane];
+                t0[lane] = std::max(t0[lane], std::min(a, b));
+                t1[lane] = std::min(t1[lane], std::max(a, b) + far_pad[lane]);
+            }
+            if (packet.parallel_lanes == 0) continue;
+
+            for (std::size_t lane = 0; lane < Width; ++lane)
+            {
+                if (far_pad[lane] != 0.0f && (origin[lane] < lo[lane] || origin[lane] > hi[lane]))
+                {
+                    t0[lane] = kInf;
+                }
+            }
+        }
+
+        std::uint32_t mask = 0;
+        for (std::size_t lane = 0; lane < Width; ++lane)
+        {
+            mask |= static_cast<std::uint32_t>(t0[lane] <= t1[lane]) << lane;
+        }
+        entry = t0;
+        return mask;
+    }
+
+    // Moeller-Trumbore of every lane against one triangle, with the tolerances of Intersects(Ray, Triangle).
+    // Returns the mask of lanes hitting it with t in [0, t_max]; (u, v) weight the second and third corner.
+    template <std::size_t Width>
+    [[nodiscard]] std::uint32_t Intersects(const Triangle& triangle, const RayPacket<Width>& packet,
+                                           RayPacketHits<Width>& hits) noexcept
+    {
+        const math::vec3 e1 = triangle.b - triangle.a;
+        const math::vec3 e2 = triangle.c - triangle.a;
+        const float e1x = e1[0], e1y = e1[1], e1z = e1[2];
+        const float e2x = e2[0], e2y = e2[1], e2z = e2[2];
+        const float ax = triangle.a[0], ay = triangle.a[1], az = triangle.a[2];
+        // Results go to locals first: writing `hits` directly would need a runtime alias check against `packet`,
+        // which keeps the loop scalar.
+        RayPacketHits<Width> local;
+        std::array<std::int32_t, Width> lane_hit{};
+        for (std::size_t lane = 0; lane < Width; ++lane)
+        {
+            const float dx = packet.direction[0][lane];
+            const float dy = packet.direction[1][lane];
+            const float dz = packet.direction[2][lane];
+            const float px = dy * e2z - dz * e2y;
+            const float py = dz * e2x - dx * e2z;
+            const float pz = dx * e2y - dy * e2x;
+            const float det = e1x * px + e1y * py + e1z * pz;
+            const bool facing = std::abs(det) >= 1e-8f;
+            const float inv = 1.0f / (facing ? det : 1.0f);
+
+            const float tx = packet.origin[0][lane] - ax;
+            const float ty = packet.origin[1][lane] - ay;
+            const float tz = packet.origin[2][lane] - az;
+            const float u = (tx * px + ty * py + tz * pz) * inv;
+            const float qx = ty * e1z - tz * e1y;
+            const float qy = tz * e1x - tx * e1z;
+            const float qz = tx * e1y - ty * e1x;
+            const float v = (dx * qx + dy * qy + dz * qz) * inv;
+            const float t = (e2x * qx + e2y * qy + e2z * qz) * inv;
+
+            local.t[lane] = t;
+            local.u[lane] = u;
+            local.v[lane] = v;
+            // Non-short-circuit ands keep the loop free of branches.
+            lane_hit[lane] = facing & (u >= 0.0f) & (u <= 1.0f) & (v >= 0.0f) & (u + v <= 1.0f) & (t >= 0.0f) &
+                             (t <= packet.t_max[lane]);
+        }
+
+        hits = local;
+
+        std::uint32_t mask = 0;
+        for (std::size_t lane = 0; lane < Width; ++lane)
+        {
+            mask |= static_cast<std::uint32_t>(lane_hit[lane]) << lane;
+        }
+        return mask;
+    }
+
+    // Rays of a stream, one 64-byte record per ray so gathering a ray into a packet lane touches a single cache
+    // line; t_max is kept apart because traversals lower it while they run.
+    struct RayStream
+    {
+        struct alignas(64) Record
+        {
+            std::array<float, 3> origin;
+            std::array<float, 3> direction;
+            std::array<float, 3> inv_direction;
+            std::array<float, 3> far_pad;
+            std::uint32_t has_parallel_axis;
+        };
+
+        std::vector<Record> records;
+        std::vector<float> t_max;
+
+        [[nodiscard]] std::size_t size() const noexcept { return records.size(); }
+
+        [[nodiscard]] math::vec3 direction(std::size_t i) const noexcept
+        {
+            return {records[i].direction[0], records[i].direction[1], records[i].direction[2]};
+        }
+
+        void assign(std::span<const Ray> rays, float ray_t_max)
+        {
+            records.resize(rays.size());
+            RayPacket<4> packet;
+            for (std::size_t i = 0; i < rays.size(); ++i)
+            {
+                // Reuse the packet's per-lane setup so both paths classify parallel axes identically.
+                packet.parallel_lanes = 0;
+                packet.set(0, rays[i], ray_t_max);
+                Record& record = records[i];
+                for (std::size_t axis = 0; axis < 3; ++axis)
+                {
+                    record.origin[axis] = packet.origin[axis][0];
+                    record.direction[axis] = packet.direction[axis][0];
+                    record.inv_direction[axis] = packet.inv_direction[axis][0];
+                    record.far_pad[axis] = packet.far_pad[axis][0];
+                }
+                record.has_parallel_axis = packet.parallel_lanes;
+            }
+            t_max.assign(rays.size(), ray_t_max);
+        }
+
+        // Packet of the rays ids[0 .. count), count <= Width, in lane order.
+        template <std::size_t Width>
+        [[nodiscard]] RayPacket<Width> gather(const std::uint32_t* ids, std::size_t count) const noexcept
+        {
+            RayPacket<Width> packet;
+            for (std::size_t lane = 0; lane < count; ++lane)
+            {
+                const Record& record = records[ids[lane]];
+                for (std::size_t axis = 0; axis < 3; ++axis)
+                {
+                    packet.origin[axis][lane] = record.origin[axis];
+                    packet.direction[axis][lane] = record.direction[axis];
+                    packet.inv_direction[axis][lane] = record.inv_direction[axis];
+                    packet.far_pad[axis][lane] = record.far_pad[axis];
+                }
+                packet.t_max[lane] = t_max[ids[lane]];
+                packet.parallel_lanes |= record.has_parallel_axis << lane;
+            }
+            packet.active = (std::uint32_t{1} << count) - 1;
+            return packet;
+        }
+    };
+
+    // Reusable buffers of a ray stream traversal.
+    struct RayStreamScratch
+    {
+        struct Frame
+        {
+            std::uint32_t node;
+            std::uint32_t begin;
+            std::uint32_t end;
+        };
+
+        std::vector<std::uint32_t> ids;
+        std::vector<Frame> frames;
+    };
+} // namespace engine::geometry
+
+namespace engine::geometry::utils
+{
+    // Rays per task of a batched ray query. Streams are traced a task at a time, so this is also the stream
+    // length; it is a multiple of every packet width.
+    inline constexpr std::size_t kRayGrain = 512;
+
+    // Calls fn(lane) for every set bit of mask, lowest first.
+    template <class Fn>
+    void ForEachLane(std::uint32_t mask, Fn&& fn)
+    {
+        while (mask != 0)
+        {
+            fn(static_cast<std::size_t>(std::countr_zero(mask)));
+            mask &= mask - 1;
+        }
+    }
+
+    // Depth-first traversal of one packet. visit(node, mask, stack) is called for every node whose bounds
+    // (from bounds_of) some active lane hits; it handles the lanes in mask and pushes the children to
+    // descend into, the one to visit first last. Stops once no lane is active.
+    template <std::size_t Width, class BoundsFn, class VisitFn>
+    void TraceRayPacket(RayPacket<Width>& packet, std::uint32_t root, std::vector<std::uint32_t>& stack,
+                        BoundsFn&& bounds_of, VisitFn&& visit)
+    {
+        std::array<float, Width> entry;
+        stack.assign(1, root);
+        while (!stack.empty() && packet.active != 0)
+        {
+            const std::uint32_t node = stack.back();
+            stack.pop_back();
+            const std::uint32_t mask = Intersects(bounds_of(node), packet, entry) & packet.active;
+            if (mask != 0) visit(node, mask, stack);
+        }
+    }
+
+    // Depth-first traversal of all rays of a stream. Each node filters the rays that reached its
+    // parent against its own bounds a packet at a time, so the SIMD slab tests stay full even when the rays
+    // diverge. visit(node, ids, push) is called with the ids of the rays that hit the node (rays whose stream
+    // t_max has dropped below their entry are filtered out) and calls push(child) for the children to descend
+    // into, the one to visit first last.
+    template <std::size_t Width, class BoundsFn, class VisitFn>
+    void TraceRayStream(const RayStream& stream, std::uint32_t root, RayStreamScratch& scratch, BoundsFn&& bounds_of,
+                        VisitFn&& visit)
+    {
+        auto& ids = scratch.ids;
+        auto& frames = scratch.frames;
+        ids.resize(stream.size());
+        std::iota(ids.begin(), ids.end(), 0U);
+        frames.assign(1, {root, 0U, static_cast<std::uint32_t>(ids.size())});
+
+        std::array<float, Width> entry;
+        while (!frames.empty())
+        {
+            const RayStreamScratch::Frame frame = frames.back();
+            frames.pop_back();
+            // Everything past the frame's range belongs to subtrees that are already finished.
+            ids.resize(frame.end);
+
+            const Aabb& box = bounds_of(frame.node);
+            for (std::uint32_t first = frame.begin; first < frame.end; first += Width)
+            {
+                const std::size_t count = std::min<std::size_t>(Width, frame.end - first);
+                const auto packet = stream.gather<Width>(ids.data() + first, count);
+                ForEachLane(Intersects(box, packet, entry) & packet.active, [&](std::size_t lane)
+                {
+                    const std::uint32_t id = ids[first + lane];
+                    ids.push_back(id);
+                });
+            }
+            if (ids.size() == frame.end) continue;
+
+            const auto begin = frame.end;
+            const auto end = static_cast<std::uint32_t>(ids.size());
+            visit(frame.node, std::span<const std::uint32_t>(ids.data() + begin, end - begin),
+                  [&](std::uint32_t child) { frames.push_back({child, begin, end}); });
+        }
+    }
+} // namespace engine::geometry::utils
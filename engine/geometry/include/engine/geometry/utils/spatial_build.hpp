@@ -0,0 +1,271 @@
+#pragma once
+
+#include "engine/geometry/shapes/aabb.hpp"
+#include "engine/math/parallel.hpp"
+#include "engine/math/vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+// Data-parallel building blocks shared by the spatial tree builders. Work is split into chunks whose
+// boundaries depend only on the input size, and partial results are merged in chunk order, so every
+// function here produces the same output for any thread count.
+namespace engine::geometry::utils
+{
+    // Elements per chunk of the data-parallel build passes.
+    inline constexpr std::size_t kBuildGrain = 16384;
+
+    // Ranges below this size are partitioned serially; above it the chunked parallel passes pay off.
+    inline constexpr std::size_t kParallelBuildThreshold = 65536;
+
+    inline constexpr std::size_t kSahBins = 32;
+
+    [[nodiscard]] inline Aabb EmptyAabb() noexcept
+    {
+        constexpr float inf = std::numeric_limits<float>::infinity();
+        return {.min = math::vec3{inf}, .max = math::vec3{-inf}};
+    }
+
+    // Grows `box` to enclose `other` without the out-of-line Merge(), for per-element build loops.
+    inline void MergeInline(Aabb& box, const Aabb& other) noexcept
+    {
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            box.min[axis] = std::min(box.min[axis], other.min[axis]);
+            box.max[axis] = std::max(box.max[axis], other.max[axis]);
+        }
+    }
+
+    // Bounds of bounds_of(i) over [0, count); chunked and parallel above kParallelBuildThreshold.
+    template <class BoundsFn>
+    [[nodiscard]] Aabb ParallelBounds(std::size_t count, BoundsFn&& bounds_of)
+    {
+        const auto range_bounds = [&](std::size_t first, std::size_t last)
+        {
+            Aabb box = EmptyAabb();
+            for (std::size_t i = first; i < last; ++i)
+            {
+                MergeInline(box, bounds_of(i));
+            }
+            return box;
+        };
+        if (count <= kParallelBuildThreshold)
+        {
+            return range_bounds(0, count);
+        }
+        return math::parallel::parallel_reduce(0, count, kBuildGrain, EmptyAabb(), range_bounds,
+                                               [](Aabb lhs, const Aabb& rhs)
+                                               {
+                                                   MergeInline(lhs, rhs);
+                                                   return lhs;
+                                               });
+    }
+
+    // Stable counting sort of `values` by bucket_of(value) in [0, Buckets). Returns the start of every bucket
+    // followed by values.size().
+    template <std::size_t Buckets, class T, class BucketFn>
+    std::array<std::size_t, Buckets + 1> StableBucketPartition(std::span<T> values, BucketFn&& bucket_of)
+    {
+        static_assert(Buckets > 0 && Buckets <= 256);
+        const std::size_t n = values.size();
+        const std::size_t chunks = math::parallel::chunk_count(0, n, kBuildGrain);
+
+        std::vector<std::uint8_t> keys(n);
+        std::vector<std::array<std::size_t, Buckets>> cursors(chunks);
+        math::parallel::parallel_for(0, n, kBuildGrain, [&](std::size_t first, std::size_t last)
+        {
+            auto& counts = cursors[first / kBuildGrain];
+            counts.fill(0);
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const auto key = static_cast<std::uint8_t>(bucket_of(values[i]));
+                keys[i] = key;
+                ++counts[key];
+            }
+        });
+
+        std::array<std::size_t, Buckets + 1> starts{};
+        std::size_t running = 0;
+        for (std::size_t b = 0; b < Buckets; ++b)
+        {
+            starts[b] = running;
+            for (auto& counts : cursors)
+            {
+                const std::size_t count = counts[b];
+                counts[b] = running;
+                running += count;
+            }
+        }
+        starts[Buckets] = n;
+
+        std::vector<T> scratch(n);
+        math::parallel::parallel_for(0, n, kBuildGrain, [&](std::size_t first, std::size_t last)
+        {
+            auto& cursor = cursors[first / kBuildGrain];
+            for (std::size_t i = first; i < last; ++i)
+            {
+                scratch[cursor[keys[i]]++] = values[i];
+            }
+        });
+        math::parallel::parallel_for(0, n, kBuildGrain, [&](std::size_t first, std::size_t last)
+        {
+            std::copy(scratch.begin() + first, scratch.begin() + last, values.begin() + first);
+        });
+        return starts;
+    }
+
+    [[nodiscard]] inline std::size_t SahBin(float value, float lo, float scale) noexcept
+    {
+        const float bin = (value - lo) * scale;
+        return bin <= 0.0f ? 0 : std::min(kSahBins - 1, static_cast<std::size_t>(bin));
+    }
+
+    // Best binned SAH plane along one axis. Items whose SahBin() is below `bin` go left.
+    struct SahAxisSplit
+    {
+        std::size_t bin = 0; // 0 when the axis cannot be split
+        std::size_t left_count = 0;
+        double cost = std::numeric_limits<double>::infinity();
+        float position = 0.0f; // lower boundary of `bin`
+        float left_centroid_max = 0.0f; // largest centroid coordinate on the left
+    };
+
+    // Evaluates SA(left) * n_left + SA(right) * n_right at the kSahBins - 1 bin boundaries of every axis.
+    // `centroid_bounds` must enclose centroid_of(i) for all i in [0, count). Ties prefer the more balanced
+    // split.
+    template <class CentroidFn, class BoundsFn>
+    [[nodiscard]] std::array<SahAxisSplit, 3> BinnedSah(std::size_t count, const Aabb& centroid_bounds,
+                                                       CentroidFn&& centroid_of, BoundsFn&& bounds_of)
+    {
+        // Bin bounds are merged with plain min/max on the coordinates; this loop runs once per item and
+        // level, so it must not go through the out-of-line Aabb helpers.
+        struct Bin
+        {
+            std::size_t count = 0;
+            std::array<float, 3> lo{std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(),
+                                    std::numeric_limits<float>::infinity()};
+            std::array<float, 3> hi{-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+                                    -std::numeric_limits<float>::infinity()};
+            float centroid_max = -std::numeric_limits<float>::infinity();
+
+            void merge(const Bin& other) noexcept
+            {
+                count += other.count;
+                for (std::size_t k = 0; k < 3; ++k)
+                {
+                    lo[k] = std::min(lo[k], other.lo[k]);
+                    hi[k] = std::max(hi[k], other.hi[k]);
+                }
+                centroid_max = std::max(centroid_max, other.centroid_max);
+            }
+
+            [[nodiscard]] double area() const noexcept
+            {
+                if (count == 0) return 0.0;
+                const double dx = hi[0] - lo[0];
+                const double dy = hi[1] - lo[1];
+                const double dz = hi[2] - lo[2];
+                return 2.0 * (dx * dy + dy * dz + dz * dx);
+            }
+        };
+        using Bins = std::array<std::array<Bin, kSahBins>, 3>;
+
+        std::array<float, 3> lo{};
+        std::array<float, 3> scale{};
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            const float extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+            lo[axis] = centroid_bounds.min[axis];
+            scale[axis] = extent > 0.0f ? static_cast<float>(kSahBins) / extent : 0.0f;
+        }
+
+        const auto bin_range = [&](Bins& local, std::size_t first, std::size_t last)
+        {
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const math::vec3 c = centroid_of(i);
+                const Aabb box = bounds_of(i);
+                for (std::size_t axis = 0; axis < 3; ++axis)
+                {
+                    Bin& bin = local[axis][SahBin(c[axis], lo[axis], scale[axis])];
+                    ++bin.count;
+                    for (std::size_t k = 0; k < 3; ++k)
+                    {
+                        bin.lo[k] = std::min(bin.lo[k], box.min[k]);
+                        bin.hi[k] = std::max(bin.hi[k], box.max[k]);
+                    }
+                    bin.centroid_max = std::max(bin.centroid_max, c[axis]);
+                }
+            }
+        };
+
+        Bins bins{};
+        if (count <= kParallelBuildThreshold)
+        {
+            bin_range(bins, 0, count);
+        }
+        else
+        {
+            const std::size_t grain = kBuildGrain * 4;
+            std::vector<Bins> partials(math::parallel::chunk_count(0, count, grain));
+            math::parallel::parallel_for(0, count, grain, [&](std::size_t first, std::size_t last)
+            {
+                bin_range(partials[first / grain], first, last);
+            });
+            for (const Bins& partial : partials)
+            {
+                for (std::size_t axis = 0; axis < 3; ++axis)
+                {
+                    for (std::size_t b = 0; b < kSahBins; ++b) bins[axis][b].merge(partial[axis][b]);
+                }
+            }
+        }
+
+        std::array<SahAxisSplit, 3> result{};
+        const auto imbalance = [count](std::size_t l) { return l * 2 > count ? l * 2 - count : count - l * 2; };
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            if (scale[axis] == 0.0f)
+            {
+                continue;
+            }
+            const auto& axis_bins = bins[axis];
+            std::array<double, kSahBins> right_area{};
+            Bin right;
+            for (std::size_t b = kSahBins; b-- > 1;)
+            {
+                right.merge(axis_bins[b]);
+                right_area[b] = right.area();
+            }
+
+            SahAxisSplit& best = result[axis];
+            Bin left;
+            for (std::size_t b = 1; b < kSahBins; ++b)
+            {
+                left.merge(axis_bins[b - 1]);
+                const std::size_t right_count = count - left.count;
+                if (left.count == 0 || right_count == 0)
+                {
+                    continue;
+                }
+
+                const double cost = left.area() * static_cast<double>(left.count) +
+                                    right_area[b] * static_cast<double>(right_count);
+                if (cost < best.cost || (cost == best.cost && imbalance(left.count) < imbalance(best.left_count)))
+                {
+                    best.bin = b;
+                    best.left_count = left.count;
+                    best.cost = cost;
+                    best.position = lo[axis] + static_cast<float>(b) / scale[axis];
+                    best.left_centroid_max = left.centroid_max;
+                }
+            }
+        }
+        return result;
+    }
+} // namespace engine::geometry::utils
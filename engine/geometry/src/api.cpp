@@ -3,15 +3,23 @@
 #include "engine/geometry/mesh/halfedge_mesh.hpp"
 #include "engine/geometry/mesh/surface_mesh_conversion.hpp"
 
+#include "engine/math/parallel.hpp"
+
 #include <algorithm>
 #include <array>
 #include <filesystem>
 #include <limits>
+#include <stdexcept>
 
 namespace engine::geometry {
 
 namespace {
 
+// Work items per task: triangle and vertex passes do a cross product or a normalisation per item, the bounds
+// reduction only a min and a max.
+constexpr std::size_t kNormalGrain = 4096;
+constexpr std::size_t kBoundsGrain = 16384;
+
 [[nodiscard]] math::vec3 triangle_normal(
     const math::vec3& a,
     const math::vec3& b,
@@ -19,6 +27,131 @@ namespace {
     return math::normalize(math::cross(b - a, c - a));
 }
 
+[[nodiscard]] math::vec3 finish_vertex_normal(const math::vec3& sum) {
+    const float length_sq = math::dot(sum, sum);
+    return length_sq > 0.0F ? math::normalize(sum) : math::vec3{0.0F, 1.0F, 0.0F};
+}
+
+// Unchecked view of the triangles of a SurfaceMesh, so the hot loops index plain pointers rather than reloading
+// the mesh's vectors.
+struct TriangleView {
+    explicit TriangleView(const SurfaceMesh& mesh) noexcept
+        : positions(mesh.positions.data()),
+          indices(mesh.indices.data()),
+          vertex_count(mesh.positions.size()),
+          triangle_count(mesh.indices.size() / 3) {}
+
+    [[nodiscard]] bool in_range(std::size_t triangle) const noexcept {
+        return indices[3 * triangle] < vertex_count && indices[3 * triangle + 1] < vertex_count &&
+               indices[3 * triangle + 2] < vertex_count;
+    }
+
+    [[nodiscard]] math::vec3 normal(std::size_t triangle) const {
+        return triangle_normal(positions[indices[3 * triangle]],
+                               positions[indices[3 * triangle + 1]],
+                               positions[indices[3 * triangle + 2]]);
+    }
+
+    const math::vec3* positions;
+    const std::uint32_t* indices;
+    std::size_t vertex_count;
+    std::size_t triangle_count;
+};
+
+// Unit normal of every triangle, computed in parallel; entries of out-of-range triangles are left zero.
+[[nodiscard]] std::vector<math::vec3> triangle_normals(const TriangleView& view) {
+    std::vector<math::vec3> normals(view.triangle_count, math::vec3{0.0F, 0.0F, 0.0F});
+    math::parallel::parallel_for(0, view.triangle_count, kNormalGrain, [&](std::size_t first, std::size_t last) {
+        for (std::size_t triangle = first; triangle < last; ++triangle) {
+            if (view.in_range(triangle)) {
+                normals[triangle] = view.normal(triangle);
+            }
+        }
+    });
+    return normals;
+}
+
+void normalize_vertex_normals(std::span<math::vec3> normals, std::size_t first, std::size_t last) {
+    for (std::size_t vertex = first; vertex < last; ++vertex) {
+        normals[vertex] = finish_vertex_normal(normals[vertex]);
+    }
+}
+
+void check_adjacency(const SurfaceMesh& mesh, const VertexTriangleAdjacency& adjacency) {
+    if (adjacency.offsets.size() != mesh.positions.size() + 1) {
+        throw std::invalid_argument("vertex triangle adjacency does not match the mesh vertex count");
+    }
+}
+
+// Calls `visit` for every corner of every triangle around a dirty vertex: the vertices whose normal an edit of
+// the dirty ones changes, with repeats.
+template <class Visit>
+void for_each_affected_vertex(const TriangleView& view,
+                              const VertexTriangleAdjacency& adjacency,
+                              std::span<const std::uint32_t> dirty_vertices,
+                              Visit&& visit) {
+    for (const std::uint32_t dirty : dirty_vertices) {
+        if (dirty >= view.vertex_count) {
+            continue;
+        }
+        for (std::uint32_t k = adjacency.offsets[dirty]; k < adjacency.offsets[dirty + 1]; ++k) {
+            for (std::size_t corner = 0; corner < 3; ++corner) {
+                visit(view.indices[3 * std::size_t{adjacency.triangles[k]} + corner]);
+            }
+        }
+    }
+}
+
+// Regathers the normals of the distinct vertices `affected`. Triangle normals are recomputed per corner instead
+// of cached; the affected set is expected to be small.
+void update_vertex_normals(SurfaceMesh& mesh,
+                           const TriangleView& view,
+                           const VertexTriangleAdjacency& adjacency,
+                           std::span<const std::uint32_t> affected) {
+    math::parallel::parallel_for(0, affected.size(), kNormalGrain / 8, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const std::uint32_t vertex = affected[i];
+            math::vec3 sum{0.0F, 0.0F, 0.0F};
+            for (std::uint32_t k = adjacency.offsets[vertex]; k < adjacency.offsets[vertex + 1]; ++k) {
+                sum += view.normal(adjacency.triangles[k]);
+            }
+            mesh.normals[vertex] = finish_vertex_normal(sum);
+        }
+    });
+}
+
+// Min/max of a run of points. Four points are folded per step into twelve independent lanes so the compiler can
+// use packed min/max instructions, and the lanes are merged at the end.
+[[nodiscard]] Aabb bounds_of(const math::vec3* points, std::size_t count) noexcept {
+    constexpr std::size_t kPoints = 4;
+    std::array<float, 3 * kPoints> lo;
+    std::array<float, 3 * kPoints> hi;
+    lo.fill(std::numeric_limits<float>::max());
+    hi.fill(std::numeric_limits<float>::lowest());
+
+    std::size_t index = 0;
+    for (; index + kPoints <= count; index += kPoints) {
+        for (std::size_t lane = 0; lane < 3 * kPoints; ++lane) {
+            const float value = points[index + lane / 3][lane % 3];
+            lo[lane] = std::min(lo[lane], value);
+            hi[lane] = std::max(hi[lane], value);
+        }
+    }
+    for (; index < count; ++index) {
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            lo[axis] = std::min(lo[axis], points[index][axis]);
+            hi[axis] = std::max(hi[axis], points[index][axis]);
+        }
+    }
+
+    Aabb box{math::vec3{lo[0], lo[1], lo[2]}, math::vec3{hi[0], hi[1], hi[2]}};
+    for (std::size_t lane = 3; lane < 3 * kPoints; ++lane) {
+        box.min[lane % 3] = std::min(box.min[lane % 3], lo[lane]);
+        box.max[lane % 3] = std::max(box.max[lane % 3], hi[lane]);
+    }
+    return box;
+}
+
 }  // namespace
 
 std::string_view module_name() noexcept {
@@ -34,35 +167,138 @@ SurfaceMesh make_unit_quad() {
         math::vec3{-0.5F, 0.0F, 0.5F},
     };
     mesh.positions = mesh.rest_positions;
-    mesh.indices = {0, 1, 2, 0, 2, 3};
+    // Counter-clockwise seen from +Y, so the triangles face the +Y normals.
+    mesh.indices = {0, 2, 1, 0, 3, 2};
     mesh.normals.assign(mesh.positions.size(), math::vec3{0.0F, 1.0F, 0.0F});
+    mesh.rest_normals = mesh.normals;
     update_bounds(mesh);
     return mesh;
 }
 
 void recompute_vertex_normals(SurfaceMesh& mesh) {
-    mesh.normals.assign(mesh.positions.size(), math::vec3{0.0F, 0.0F, 0.0F});
-    for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
-        const auto ia = mesh.indices[i];
-        const auto ib = mesh.indices[i + 1];
-        const auto ic = mesh.indices[i + 2];
-        if (ia >= mesh.positions.size() || ib >= mesh.positions.size() || ic >= mesh.positions.size()) {
-            continue;
+    const TriangleView view(mesh);
+    mesh.normals.assign(view.vertex_count, math::vec3{0.0F, 0.0F, 0.0F});
+    math::vec3* sums = mesh.normals.data();
+
+    // The scatter has to add in triangle order to stay deterministic, so only the triangle normals and the final
+    // normalisation run in parallel. Without helper threads, computing each normal right where it is scattered
+    // saves the round trip through memory.
+    if (math::parallel::concurrency() <= 1) {
+        for (std::size_t triangle = 0; triangle < view.triangle_count; ++triangle) {
+            if (view.in_range(triangle)) {
+                const math::vec3 normal = view.normal(triangle);
+                sums[view.indices[3 * triangle]] += normal;
+                sums[view.indices[3 * triangle + 1]] += normal;
+                sums[view.indices[3 * triangle + 2]] += normal;
+            }
         }
-        const auto normal = triangle_normal(mesh.positions[ia], mesh.positions[ib], mesh.positions[ic]);
-        mesh.normals[ia] += normal;
-        mesh.normals[ib] += normal;
-        mesh.normals[ic] += normal;
-    }
-
-    for (auto& normal : mesh.normals) {
-        const float length_sq = math::dot(normal, normal);
-        if (length_sq > 0.0F) {
-            normal = math::normalize(normal);
-        } else {
-            normal = math::vec3{0.0F, 1.0F, 0.0F};
+    } else {
+        const std::vector<math::vec3> normals = triangle_normals(view);
+        for (std::size_t triangle = 0; triangle < view.triangle_count; ++triangle) {
+            if (view.in_range(triangle)) {
+                sums[view.indices[3 * triangle]] += normals[triangle];
+                sums[view.indices[3 * triangle + 1]] += normals[triangle];
+                sums[view.indices[3 * triangle + 2]] += normals[triangle];
+            }
         }
     }
+
+    math::parallel::parallel_for(0, mesh.normals.size(), kNormalGrain, [&](std::size_t first, std::size_t last) {
+        normalize_vertex_normals(mesh.normals, first, last);
+    });
+}
+
+VertexTriangleAdjacency build_vertex_triangle_adjacency(const SurfaceMesh& mesh) {
+    const TriangleView view(mesh);
+    VertexTriangleAdjacency adjacency;
+    adjacency.offsets.assign(view.vertex_count + 1, 0);
+    for (std::size_t triangle = 0; triangle < view.triangle_count; ++triangle) {
+        if (view.in_range(triangle)) {
+            for (std::size_t corner = 0; corner < 3; ++corner) {
+                ++adjacency.offsets[view.indices[3 * triangle + corner] + 1];
+            }
+        }
+    }
+    for (std::size_t vertex = 1; vertex < adjacency.offsets.size(); ++vertex) {
+        adjacency.offsets[vertex] += adjacency.offsets[vertex - 1];
+    }
+
+    // Filling in triangle order keeps every vertex's list ascending.
+    adjacency.triangles.resize(adjacency.offsets.back());
+    std::vector<std::uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (std::size_t triangle = 0; triangle < view.triangle_count; ++triangle) {
+        if (view.in_range(triangle)) {
+            for (std::size_t corner = 0; corner < 3; ++corner) {
+                adjacency.triangles[cursor[view.indices[3 * triangle + corner]]++] =
+                    static_cast<std::uint32_t>(triangle);
+            }
+        }
+    }
+    return adjacency;
+}
+
+void recompute_vertex_normals(SurfaceMesh& mesh, const VertexTriangleAdjacency& adjacency) {
+    check_adjacency(mesh, adjacency);
+    const std::vector<math::vec3> normals = triangle_normals(TriangleView(mesh));
+    mesh.normals.resize(mesh.positions.size());
+    const std::uint32_t* offsets = adjacency.offsets.data();
+    const std::uint32_t* triangles = adjacency.triangles.data();
+
+    // Summing each vertex's triangles in ascending order repeats the additions of the scatter exactly.
+    math::parallel::parallel_for(0, mesh.normals.size(), kNormalGrain, [&](std::size_t first, std::size_t last) {
+        for (std::size_t vertex = first; vertex < last; ++vertex) {
+            math::vec3 sum{0.0F, 0.0F, 0.0F};
+            for (std::uint32_t k = offsets[vertex]; k < offsets[vertex + 1]; ++k) {
+                sum += normals[triangles[k]];
+            }
+            mesh.normals[vertex] = finish_vertex_normal(sum);
+        }
+    });
+}
+
+void recompute_vertex_normals(SurfaceMesh& mesh,
+                              const VertexTriangleAdjacency& adjacency,
+                              std::span<const std::uint32_t> dirty_vertices) {
+    if (mesh.normals.size() != mesh.positions.size()) {
+        recompute_vertex_normals(mesh, adjacency);
+        return;
+    }
+    check_adjacency(mesh, adjacency);
+
+    const TriangleView view(mesh);
+    std::vector<std::uint32_t> affected;
+    for_each_affected_vertex(view, adjacency, dirty_vertices,
+                             [&](std::uint32_t vertex) { affected.push_back(vertex); });
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+    update_vertex_normals(mesh, view, adjacency, affected);
+}
+
+void recompute_vertex_normals(SurfaceMesh& mesh,
+                              const VertexTriangleAdjacency& adjacency,
+                              std::span<const std::uint32_t> dirty_vertices,
+                              NormalUpdateScratch& scratch) {
+    if (mesh.normals.size() != mesh.positions.size()) {
+        recompute_vertex_normals(mesh, adjacency);
+        return;
+    }
+    check_adjacency(mesh, adjacency);
+
+    const TriangleView view(mesh);
+    if (scratch.queued.size() < view.vertex_count) {
+        scratch.queued.resize(view.vertex_count, 0);
+    }
+    scratch.affected.clear();
+    for_each_affected_vertex(view, adjacency, dirty_vertices, [&](std::uint32_t vertex) {
+        if (scratch.queued[vertex] == 0) {
+            scratch.queued[vertex] = 1;
+            scratch.affected.push_back(vertex);
+        }
+    });
+    for (const std::uint32_t vertex : scratch.affected) {
+        scratch.queued[vertex] = 0;
+    }
+    update_vertex_normals(mesh, view, adjacency, scratch.affected);
 }
 
 void update_bounds(SurfaceMesh& mesh) {
@@ -73,15 +309,11 @@ void update_bounds(SurfaceMesh& mesh) {
         return;
     }
 
-    math::vec3 min_bounds{std::numeric_limits<float>::max()};
-    math::vec3 max_bounds{std::numeric_limits<float>::lowest()};
-    for (const auto& position : mesh.positions) {
-        for (std::size_t axis = 0; axis < 3; ++axis) {
-            min_bounds[axis] = std::min(min_bounds[axis], position[axis]);
-            max_bounds[axis] = std::max(max_bounds[axis], position[axis]);
-        }
-    }
-    mesh.bounds = Aabb{min_bounds, max_bounds};
+    const math::vec3* points = mesh.positions.data();
+    mesh.bounds = math::parallel::parallel_reduce(
+        0, mesh.positions.size(), kBoundsGrain, bounds_of(points, 0),
+        [&](std::size_t first, std::size_t last) { return bounds_of(points + first, last - first); },
+        [](const Aabb& lhs, const Aabb& rhs) { return Merge(lhs, rhs); });
 }
 
 void apply_uniform_translation(SurfaceMesh& mesh, const math::vec3& translation) {
@@ -92,6 +324,42 @@ void apply_uniform_translation(SurfaceMesh& mesh, const math::vec3& translation)
     update_bounds(mesh);
 }
 
+utils::LocalityOrder optimize_locality(SurfaceMesh& mesh, const utils::LocalityOptions& options) {
+    const std::vector<math::vec3>& planned = mesh.positions.empty() ? mesh.rest_positions : mesh.positions;
+    const std::size_t vertex_count = planned.size();
+    utils::LocalityOrder order = utils::PlanLocality(planned, mesh.indices, options);
+
+    const auto permute = [&](std::vector<math::vec3>& values) {
+        if (values.size() != vertex_count) {
+            return;
+        }
+        std::vector<math::vec3> permuted(vertex_count);
+        for (std::size_t i = 0; i < vertex_count; ++i) {
+            permuted[i] = values[order.vertices[i]];
+        }
+        values = std::move(permuted);
+    };
+    permute(mesh.rest_positions);
+    permute(mesh.rest_normals);
+    permute(mesh.positions);
+    permute(mesh.normals);
+
+    // Out-of-range indices stay as they are, so invalid triangles remain invalid.
+    const std::vector<std::uint32_t> remap = utils::InvertPermutation(order.vertices);
+    std::vector<std::uint32_t> indices(3 * order.triangles.size());
+    for (std::size_t i = 0; i < order.triangles.size(); ++i) {
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+            const std::uint32_t index = mesh.indices[3 * std::size_t{order.triangles[i]} + corner];
+            indices[3 * i + corner] = index < vertex_count ? remap[index] : index;
+        }
+    }
+    // A trailing partial triangle is not part of any triangle but is kept.
+    indices.insert(indices.end(), mesh.indices.begin() + static_cast<std::ptrdiff_t>(indices.size()),
+                   mesh.indices.end());
+    mesh.indices = std::move(indices);
+    return order;
+}
+
 math::vec3 centroid(const SurfaceMesh& mesh) {
     if (mesh.positions.empty()) {
         return math::vec3{0.0F, 0.0F, 0.0F};
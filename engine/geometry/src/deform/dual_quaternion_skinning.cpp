@@ -0,0 +1,152 @@
+#include "engine/geometry/deform/dual_quaternion_skinning.hpp"
+
+#include <stdexcept>
+
+#include "engine/geometry/api.hpp"
+#include "engine/math/transform.hpp"
+#include "skinning_kernel.hpp"
+
+namespace engine::geometry::deform
+{
+    namespace
+    {
+        [[nodiscard]] float dot4(const std::array<float, 4>& lhs, const std::array<float, 4>& rhs) noexcept
+        {
+            return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2] + lhs[3] * rhs[3];
+        }
+
+        // Weighted sum of the palette entries of the valid influences, each rotation taken in the hemisphere of
+        // the first one so opposite signs of the same rotation do not cancel. Returns false when no weight was
+        // accumulated, in which case the vertex keeps its rest pose; otherwise the scale in `blended` is
+        // weight-averaged and the rigid part is left unnormalised for to_matrix.
+        [[nodiscard]] bool blend_influences(const animation::VertexBinding& vertex,
+                                            std::span<const SkinningDualQuaternion> palette,
+                                            SkinningDualQuaternion& blended) noexcept
+        {
+            blended.real.fill(0.0F);
+            blended.dual.fill(0.0F);
+            blended.scale.fill(0.0F);
+            std::array<float, 4> pivot{};
+            for (std::uint8_t influence_index = 0; influence_index < vertex.influence_count; ++influence_index)
+            {
+                if (vertex.influences[influence_index].joint < palette.size())
+                {
+                    pivot = palette[vertex.influences[influence_index].joint].real;
+                    break;
+                }
+            }
+            float accumulated_weight = 0.0F;
+            for (std::uint8_t influence_index = 0; influence_index < vertex.influence_count; ++influence_index)
+            {
+                const auto& influence = vertex.influences[influence_index];
+                if (influence.joint >= palette.size())
+                {
+                    continue;
+                }
+                const auto& entry = palette[influence.joint];
+                const float signed_weight = dot4(entry.real, pivot) < 0.0F ? -influence.weight : influence.weight;
+                for (std::size_t k = 0; k < 4; ++k)
+                {
+                    blended.real[k] += signed_weight * entry.real[k];
+                    blended.dual[k] += signed_weight * entry.dual[k];
+                    blended.scale[k] += influence.weight * entry.scale[k];
+                }
+                accumulated_weight += influence.weight;
+            }
+
+            if (accumulated_weight <= 0.0F || dot4(blended.real, blended.real) <= 0.0F)
+            {
+                return false;
+            }
+            const float inv_weight = 1.0F / accumulated_weight;
+            for (float& scale : blended.scale)
+            {
+                scale *= inv_weight;
+            }
+            return true;
+        }
+
+        // Row-major 3×4 matrix (rotation · scale | translation) of a blended dual quaternion. Dividing by the
+        // squared norm of the real part normalises both parts at once, without a square root.
+        [[nodiscard]] detail::BlendedMatrix to_matrix(const SkinningDualQuaternion& q) noexcept
+        {
+            const auto [w, x, y, z] = q.real;
+            const auto [dw, dx, dy, dz] = q.dual;
+            const float s = 2.0F / dot4(q.real, q.real);
+            const float sx = q.scale[0];
+            const float sy = q.scale[1];
+            const float sz = q.scale[2];
+
+            // translation = 2·dual·conj(real) / |real|²
+            const float tx = s * (w * dx - dw * x + y * dz - z * dy);
+            const float ty = s * (w * dy - dw * y + z * dx - x * dz);
+            const float tz = s * (w * dz - dw * z + x * dy - y * dx);
+
+            return {(1.0F - s * (y * y + z * z)) * sx, s * (x * y - w * z) * sy, s * (x * z + w * y) * sz, tx,
+                    s * (x * y + w * z) * sx, (1.0F - s * (x * x + z * z)) * sy, s * (y * z - w * x) * sz, ty,
+                    s * (x * z - w * y) * sx, s * (y * z + w * x) * sy, (1.0F - s * (x * x + y * y)) * sz, tz};
+        }
+    } // namespace
+
+    SkinningDualQuaternion to_skinning_dual_quaternion(const math::Transform<float>& transform) noexcept
+    {
+        const math::quat rotation = math::normalize(transform.rotation);
+        const math::vec3 axis{rotation.x, rotation.y, rotation.z};
+        const math::vec3& t = transform.translation;
+        const math::vec3 dual = 0.5F * (rotation.w * t + math::cross(t, axis));
+
+        SkinningDualQuaternion result;
+        result.real = {rotation.w, rotation.x, rotation.y, rotation.z};
+        result.dual = {-0.5F * math::dot(t, axis), dual[0], dual[1], dual[2]};
+        result.scale = {transform.scale[0], transform.scale[1], transform.scale[2], 0.0F};
+        return result;
+    }
+
+    void build_dual_quaternion_palette(std::span<const math::Transform<float>> skinning_transforms,
+                                       std::span<SkinningDualQuaternion> out_palette)
+    {
+        if (out_palette.size() < skinning_transforms.size())
+        {
+            throw std::invalid_argument("out_palette span is too small for transform count");
+        }
+        for (std::size_t joint = 0; joint < skinning_transforms.size(); ++joint)
+        {
+            out_palette[joint] = to_skinning_dual_quaternion(skinning_transforms[joint]);
+        }
+    }
+
+    void apply_dual_quaternion_skinning(const animation::RigBinding& binding,
+                                        std::span<const SkinningDualQuaternion> palette,
+                                        SurfaceMesh& mesh)
+    {
+        if (palette.size() < binding.joints.size())
+        {
+            throw std::invalid_argument("palette span is too small for joint count");
+        }
+
+        detail::skin_mesh(binding, mesh, [&](const animation::VertexBinding& vertex, detail::BlendedMatrix& matrix)
+        {
+            SkinningDualQuaternion blended;
+            if (!blend_influences(vertex, palette, blended))
+            {
+                return false;
+            }
+            matrix = to_matrix(blended);
+            return true;
+        });
+    }
+
+    void apply_dual_quaternion_skinning(const animation::RigBinding& binding,
+                                        std::span<const math::Transform<float>> skinning_transforms,
+                                        SurfaceMesh& mesh)
+    {
+        if (skinning_transforms.size() < binding.joints.size())
+        {
+            throw std::invalid_argument("skinning_transforms span is too small for joint count");
+        }
+
+        std::vector<SkinningDualQuaternion> palette(skinning_transforms.size());
+        build_dual_quaternion_palette(skinning_transforms, palette);
+        apply_dual_quaternion_skinning(binding, palette, mesh);
+    }
+} // namespace engine::geometry::deform
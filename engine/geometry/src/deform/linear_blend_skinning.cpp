@@ -4,69 +4,93 @@
 
 #include "engine/geometry/api.hpp"
 #include "engine/math/transform.hpp"
+#include "skinning_kernel.hpp"
 
 namespace engine::geometry::deform
 {
     namespace
     {
-        [[nodiscard]] math::vec3 transform_vertex(const math::Transform<float>& transform,
-                                                  const math::vec3& position) noexcept
+        using detail::BlendedMatrix;
+
+        // Weighted sum of the palette entries of the valid influences. Returns false when no weight was
+        // accumulated, in which case the vertex keeps its rest pose.
+        [[nodiscard]] bool blend_influences(const animation::VertexBinding& vertex,
+                                            std::span<const SkinningMatrix> palette,
+                                            BlendedMatrix& blended) noexcept
         {
-            return math::transform_point(transform, position);
+            blended.fill(0.0F);
+            float accumulated_weight = 0.0F;
+            for (std::uint8_t influence_index = 0; influence_index < vertex.influence_count; ++influence_index)
+            {
+                const auto& influence = vertex.influences[influence_index];
+                if (influence.joint >= palette.size())
+                {
+                    continue;
+                }
+                const auto& rows = palette[influence.joint].rows;
+                for (std::size_t k = 0; k < blended.size(); ++k)
+                {
+                    blended[k] += influence.weight * rows[k];
+                }
+                accumulated_weight += influence.weight;
+            }
+            return accumulated_weight > 0.0F;
         }
     } // namespace
 
-    void apply_linear_blend_skinning(const animation::RigBinding& binding,
-                                     std::span<const math::Transform<float>> skinning_transforms,
-                                     SurfaceMesh& mesh)
+    SkinningMatrix to_skinning_matrix(const math::Transform<float>& transform) noexcept
     {
-        if (skinning_transforms.size() < binding.joints.size())
+        const math::mat4 matrix = math::to_matrix(transform);
+        SkinningMatrix result;
+        for (std::size_t row = 0; row < 3; ++row)
         {
-            throw std::invalid_argument("skinning_transforms span is too small for joint count");
+            for (std::size_t column = 0; column < 4; ++column)
+            {
+                result.rows[4 * row + column] = matrix[row][column];
+            }
         }
+        return result;
+    }
 
-        if (mesh.rest_positions.empty())
+    void build_skinning_palette(std::span<const math::Transform<float>> skinning_transforms,
+                                std::span<SkinningMatrix> out_palette)
+    {
+        if (out_palette.size() < skinning_transforms.size())
         {
-            mesh.positions.clear();
-            mesh.normals.clear();
-            update_bounds(mesh);
-            return;
+            throw std::invalid_argument("out_palette span is too small for transform count");
         }
-
-        mesh.positions.resize(mesh.rest_positions.size());
-
-        for (std::size_t vertex_index = 0; vertex_index < mesh.rest_positions.size(); ++vertex_index)
+        for (std::size_t joint = 0; joint < skinning_transforms.size(); ++joint)
         {
-            const auto& rest_position = mesh.rest_positions[vertex_index];
-            math::vec3 skinned_position{0.0F, 0.0F, 0.0F};
-            float accumulated_weight = 0.0F;
+            out_palette[joint] = to_skinning_matrix(skinning_transforms[joint]);
+        }
+    }
 
-            if (vertex_index < binding.vertices.size())
-            {
-                const auto& influences = binding.vertices[vertex_index];
-                for (std::uint8_t influence_index = 0; influence_index < influences.influence_count; ++influence_index)
-                {
-                    const auto& influence = influences.influences[influence_index];
-                    if (influence.joint >= skinning_transforms.size())
-                    {
-                        continue;
-                    }
-                    skinned_position += influence.weight *
-                        transform_vertex(skinning_transforms[influence.joint], rest_position);
-                    accumulated_weight += influence.weight;
-                }
-            }
+    void apply_linear_blend_skinning(const animation::RigBinding& binding,
+                                     std::span<const SkinningMatrix> palette,
+                                     SurfaceMesh& mesh)
+    {
+        if (palette.size() < binding.joints.size())
+        {
+            throw std::invalid_argument("palette span is too small for joint count");
+        }
 
-            if (accumulated_weight <= 0.0F)
-            {
-                skinned_position = rest_position;
-            }
+        detail::skin_mesh(binding, mesh, [&](const animation::VertexBinding& vertex, BlendedMatrix& blended)
+        {
+            return blend_influences(vertex, palette, blended);
+        });
+    }
 
-            mesh.positions[vertex_index] = skinned_position;
+    void apply_linear_blend_skinning(const animation::RigBinding& binding,
+                                     std::span<const math::Transform<float>> skinning_transforms,
+                                     SurfaceMesh& mesh)
+    {
+        if (skinning_transforms.size() < binding.joints.size())
+        {
+            throw std::invalid_argument("skinning_transforms span is too small for joint count");
         }
 
-        recompute_vertex_normals(mesh);
-        update_bounds(mesh);
+        std::vector<SkinningMatrix> palette(skinning_transforms.size());
+        build_skinning_palette(skinning_transforms, palette);
+        apply_linear_blend_skinning(binding, palette, mesh);
     }
 } // namespace engine::geometry::deform
-
@@ -0,0 +1,39 @@
+#include "engine/geometry/deform/skinning.hpp"
+
+#include <stdexcept>
+
+namespace engine::geometry::deform
+{
+    void apply_skinning(const animation::RigBinding& binding,
+                        std::span<const math::Transform<float>> skinning_transforms,
+                        SurfaceMesh& mesh)
+    {
+        SkinningPalettes palettes;
+        apply_skinning(binding, skinning_transforms, palettes, mesh);
+    }
+
+    void apply_skinning(const animation::RigBinding& binding,
+                        std::span<const math::Transform<float>> skinning_transforms,
+                        SkinningPalettes& palettes,
+                        SurfaceMesh& mesh)
+    {
+        if (skinning_transforms.size() < binding.joints.size())
+        {
+            throw std::invalid_argument("skinning_transforms span is too small for joint count");
+        }
+
+        switch (mesh.skinning_method)
+        {
+        case SkinningMethod::DualQuaternion:
+            palettes.dual_quaternions.resize(skinning_transforms.size());
+            build_dual_quaternion_palette(skinning_transforms, palettes.dual_quaternions);
+            apply_dual_quaternion_skinning(binding, palettes.dual_quaternions, mesh);
+            return;
+        case SkinningMethod::LinearBlend:
+            break;
+        }
+        palettes.matrices.resize(skinning_transforms.size());
+        build_skinning_palette(skinning_transforms, palettes.matrices);
+        apply_linear_blend_skinning(binding, palettes.matrices, mesh);
+    }
+} // namespace engine::geometry::deform
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+
+#include "engine/animation/rigging/rig_binding.hpp"
+#include "engine/geometry/api.hpp"
+#include "engine/math/parallel.hpp"
+
+// Vertex loop shared by the linear blend and dual-quaternion skinning kernels. Each technique only supplies how a
+// vertex's influences reduce to one 3×4 matrix; transforming, normal handling and bounds are done here once.
+namespace engine::geometry::deform::detail
+{
+    // Vertices per task; each one blends up to four palette entries and transforms a point and a normal.
+    inline constexpr std::size_t kSkinGrain = 1024;
+
+    // Row-major 3×4 matrix (linear part | translation) of a blended palette entry.
+    using BlendedMatrix = std::array<float, 12>;
+
+    [[nodiscard]] inline math::vec3 transform_position(const BlendedMatrix& m, const math::vec3& p) noexcept
+    {
+        return math::vec3{m[0] * p[0] + m[1] * p[1] + m[2] * p[2] + m[3],
+                          m[4] * p[0] + m[5] * p[1] + m[6] * p[2] + m[7],
+                          m[8] * p[0] + m[9] * p[1] + m[10] * p[2] + m[11]};
+    }
+
+    // Multiplies by the cofactor matrix det(M)·M^-T of the linear part, which keeps normals perpendicular to the
+    // skinned surface under non-uniform scale and flips them with mirroring, as recomputing would.
+    [[nodiscard]] inline math::vec3 transform_normal(const BlendedMatrix& m,
+                                                     const math::vec3& n,
+                                                     const math::vec3& fallback) noexcept
+    {
+        const math::vec3 a{m[0], m[4], m[8]};
+        const math::vec3 b{m[1], m[5], m[9]};
+        const math::vec3 c{m[2], m[6], m[10]};
+        const math::vec3 skinned = n[0] * math::cross(b, c) + n[1] * math::cross(c, a) + n[2] * math::cross(a, b);
+        return math::dot(skinned, skinned) > 0.0F ? math::normalize(skinned) : fallback;
+    }
+
+    // Skins rest_positions (and rest_normals when there is one per position) across the worker pool and refreshes
+    // the bounds. `blend(vertex_binding, matrix)` fills the vertex's matrix, or returns false to keep its rest pose.
+    template <typename Blend>
+    void skin_mesh(const animation::RigBinding& binding, SurfaceMesh& mesh, const Blend& blend)
+    {
+        if (mesh.rest_positions.empty())
+        {
+            mesh.positions.clear();
+            mesh.normals.clear();
+            update_bounds(mesh);
+            return;
+        }
+
+        const std::size_t vertex_count = mesh.rest_positions.size();
+        const bool skin_normals = mesh.rest_normals.size() == vertex_count;
+        mesh.positions.resize(vertex_count);
+        if (skin_normals)
+        {
+            mesh.normals.resize(vertex_count);
+        }
+
+        const std::size_t bound_count = std::min(vertex_count, binding.vertices.size());
+        const auto skin_range = [&](std::size_t first, std::size_t last)
+        {
+            math::vec3 lo{std::numeric_limits<float>::max()};
+            math::vec3 hi{std::numeric_limits<float>::lowest()};
+            BlendedMatrix blended;
+            for (std::size_t vertex = first; vertex < last; ++vertex)
+            {
+                const math::vec3& rest_position = mesh.rest_positions[vertex];
+                const bool skinned = vertex < bound_count && blend(binding.vertices[vertex], blended);
+                const math::vec3 position = skinned ? transform_position(blended, rest_position) : rest_position;
+                mesh.positions[vertex] = position;
+                if (skin_normals)
+                {
+                    const math::vec3& rest_normal = mesh.rest_normals[vertex];
+                    mesh.normals[vertex] = skinned ? transform_normal(blended, rest_normal, rest_normal) : rest_normal;
+                }
+                for (std::size_t axis = 0; axis < 3; ++axis)
+                {
+                    lo[axis] = std::min(lo[axis], position[axis]);
+                    hi[axis] = std::max(hi[axis], position[axis]);
+                }
+            }
+            return Aabb{lo, hi};
+        };
+
+        mesh.bounds = math::parallel::parallel_reduce(
+            0, vertex_count, kSkinGrain, skin_range(0, 0), skin_range,
+            [](const Aabb& lhs, const Aabb& rhs) { return Merge(lhs, rhs); });
+
+        if (!skin_normals)
+        {
+            recompute_vertex_normals(mesh);
+        }
+    }
+} // namespace engine::geometry::deform::detail
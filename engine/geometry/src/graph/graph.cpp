@@ -1,5 +1,11 @@
 #include "engine/geometry/graph/graph.hpp"
 
+#include "engine/geometry/utils/compaction.hpp"
+#include "engine/math/parallel.hpp"
+
+#include <cstdint>
+#include <vector>
+
 namespace engine::geometry::graph
 {
     GraphInterface::GraphInterface(Vertices& vertex_props,
@@ -537,102 +543,47 @@ namespace engine::geometry::graph
             return;
         }
 
-        auto nv = vertices_size();
-        auto ne = edges_size();
-        auto nh = halfedges_size();
-
-        VertexProperty<VertexHandle> vmap = add_vertex_property<VertexHandle>("v:garbage-collection");
-        HalfedgeProperty<HalfedgeHandle> hmap = add_halfedge_property<HalfedgeHandle>("h:garbage-collection");
+        const auto vertices = utils::PlanCompaction(vertex_deleted_.vector());
+        const auto edges = utils::PlanCompaction(edge_deleted_.vector());
+        vertex_props_.compact(vertices.kept);
+        halfedge_props_.compact(edges.kept, 2);
+        edge_props_.compact(edges.kept);
 
-        for (std::size_t i = 0; i < nv; ++i)
-        {
-            vmap[VertexHandle(static_cast<PropertyIndex>(i))] = VertexHandle(static_cast<PropertyIndex>(i));
-        }
-        for (std::size_t i = 0; i < nh; ++i)
+        // delete_vertex() and delete_edge() only flag elements, so survivors may still reference removed ones;
+        // those references become invalid handles.
+        const auto vmap = [&](VertexHandle v)
         {
-            hmap[HalfedgeHandle(static_cast<PropertyIndex>(i))] = HalfedgeHandle(static_cast<PropertyIndex>(i));
-        }
-
-        if (nv > 0)
+            return v.is_valid() ? VertexHandle(vertices.remap[v.index()]) : v;
+        };
+        const auto hmap = [&](HalfedgeHandle h)
         {
-            std::size_t i0 = 0;
-            std::size_t i1 = nv - 1;
-
-            while (true)
+            if (!h.is_valid() || edges.remap[h.index() >> 1] == utils::Compaction::kRemoved)
             {
-                while (!vertex_deleted_[VertexHandle(static_cast<PropertyIndex>(i0))] && i0 < i1)
-                {
-                    ++i0;
-                }
-                while (vertex_deleted_[VertexHandle(static_cast<PropertyIndex>(i1))] && i0 < i1)
-                {
-                    --i1;
-                }
-                if (i0 >= i1)
-                {
-                    break;
-                }
-
-                vertex_props_.swap(i0, i1);
+                return HalfedgeHandle();
             }
+            return HalfedgeHandle(2 * edges.remap[h.index() >> 1] + (h.index() & 1U));
+        };
 
-            nv = vertex_deleted_[VertexHandle(static_cast<PropertyIndex>(i0))] ? i0 : i0 + 1;
-        }
-
-        if (ne > 0)
+        constexpr std::size_t kGrain = 16384;
+        VertexConnectivity* vertex_halfedges = vertex_connectivity_.vector().data();
+        HalfedgeConnectivity* halfedges = halfedge_connectivity_.vector().data();
+        math::parallel::parallel_for(0, vertices.kept.size(), kGrain, [&](std::size_t first, std::size_t last)
         {
-            std::size_t i0 = 0;
-            std::size_t i1 = ne - 1;
-
-            while (true)
+            for (std::size_t i = first; i < last; ++i)
             {
-                while (!edge_deleted_[EdgeHandle(static_cast<PropertyIndex>(i0))] && i0 < i1)
-                {
-                    ++i0;
-                }
-                while (edge_deleted_[EdgeHandle(static_cast<PropertyIndex>(i1))] && i0 < i1)
-                {
-                    --i1;
-                }
-                if (i0 >= i1)
-                {
-                    break;
-                }
-
-                edge_props_.swap(i0, i1);
-                halfedge_props_.swap(2 * i0, 2 * i1);
-                halfedge_props_.swap(2 * i0 + 1, 2 * i1 + 1);
+                vertex_halfedges[i].halfedge = hmap(vertex_halfedges[i].halfedge);
             }
-
-            ne = edge_deleted_[EdgeHandle(static_cast<PropertyIndex>(i0))] ? i0 : i0 + 1;
-            nh = 2 * ne;
-        }
-
-        for (std::size_t i = 0; i < nv; ++i)
+        });
+        math::parallel::parallel_for(0, 2 * edges.kept.size(), kGrain, [&](std::size_t first, std::size_t last)
         {
-            auto v = VertexHandle(static_cast<PropertyIndex>(i));
-            if (!is_isolated(v))
+            for (std::size_t i = first; i < last; ++i)
             {
-                set_halfedge(v, hmap[halfedge(v)]);
+                auto& h = halfedges[i];
+                h.vertex = vmap(h.vertex);
+                h.next = hmap(h.next);
+                h.prev = hmap(h.prev);
             }
-        }
-
-        for (std::size_t i = 0; i < nh; ++i)
-        {
-            auto h = HalfedgeHandle(static_cast<PropertyIndex>(i));
-            set_vertex(h, vmap[to_vertex(h)]);
-            set_next_halfedge(h, hmap[next_halfedge(h)]);
-        }
-
-        remove_vertex_property(vmap);
-        remove_halfedge_property(hmap);
-
-        vertex_props_.resize(nv);
-        vertex_props_.shrink_to_fit();
-        halfedge_props_.resize(nh);
-        halfedge_props_.shrink_to_fit();
-        edge_props_.resize(ne);
-        edge_props_.shrink_to_fit();
+        });
 
         deleted_vertices_ = deleted_edges_ = 0;
         has_garbage_ = false;
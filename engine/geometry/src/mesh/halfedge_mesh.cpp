@@ -1,8 +1,23 @@
 #include "engine/geometry/mesh/halfedge_mesh.hpp"
 
+#include "engine/geometry/utils/compaction.hpp"
+#include "engine/geometry/utils/locality.hpp"
+#include "engine/math/parallel.hpp"
+
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <type_traits>
 
 namespace engine::geometry::mesh {
+    namespace {
+        // Elements per task of the bulk passes (assign_triangles, garbage_collection).
+        constexpr std::size_t kGrain = 16384;
+    } // namespace
+
     HalfedgeMeshInterface::HalfedgeMeshInterface(Vertices &vertex_props,
                                Halfedges &halfedge_props,
                                Edges &edge_props,
@@ -405,6 +420,188 @@ namespace engine::geometry::mesh {
         return f;
     }
 
+    bool HalfedgeMeshInterface::assign_triangles(std::span<const math::vec3> positions,
+                                                 std::span<const std::uint32_t> indices) {
+        constexpr std::uint32_t kNone = std::numeric_limits<std::uint32_t>::max();
+
+        clear();
+        const std::size_t nv = positions.size();
+        const std::size_t nc = indices.size();
+        assert(nc % 3 == 0 && nc < kNone);
+        const auto next_corner = [](std::size_t c) { return c % 3 == 2 ? c - 2 : c + 1; };
+        const auto prev_corner = [](std::size_t c) { return c % 3 == 0 ? c + 2 : c - 1; };
+
+        // Corner c runs from indices[c] to indices[next_corner(c)]. The corners are bucketed by the smaller vertex
+        // of their edge, each slot holding (larger vertex, corner); slots are claimed with atomic cursors, so the
+        // order within a bucket depends on scheduling until the bucket is sorted below.
+        std::vector<std::uint32_t> bucket_offsets(nv + 1, 0);
+        math::parallel::parallel_for(0, nc, kGrain, [&](std::size_t first, std::size_t last) {
+            for (std::size_t c = first; c < last; ++c) {
+                assert(indices[c] < nv && indices[c] != indices[next_corner(c)]);
+                const std::uint32_t low = std::min(indices[c], indices[next_corner(c)]);
+                std::atomic_ref<std::uint32_t>(bucket_offsets[low + 1]).fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+        std::partial_sum(bucket_offsets.begin(), bucket_offsets.end(), bucket_offsets.begin());
+        std::vector<std::uint64_t> slots(nc);
+        {
+            std::vector<std::uint32_t> cursors(bucket_offsets.begin(), bucket_offsets.end() - 1);
+            math::parallel::parallel_for(0, nc, kGrain, [&](std::size_t first, std::size_t last) {
+                for (std::size_t c = first; c < last; ++c) {
+                    const std::uint32_t a = indices[c];
+                    const std::uint32_t b = indices[next_corner(c)];
+                    const std::uint32_t slot = std::atomic_ref<std::uint32_t>(cursors[std::min(a, b)])
+                                                   .fetch_add(1, std::memory_order_relaxed);
+                    slots[slot] = (static_cast<std::uint64_t>(std::max(a, b)) << 32) | c;
+                }
+            });
+        }
+
+        // Sorting a bucket makes the corners of each of its edges adjacent and ascending. mate[c] is the corner
+        // running the same edge the other way (kNone on the boundary), the lower corner of an edge owns it, and
+        // an edge shared by more than two corners or twice in one direction is rejected.
+        std::vector<std::uint32_t> mate(nc, kNone);
+        std::vector<std::uint8_t> owner(nc, 0);
+        const std::size_t bad_edges = math::parallel::parallel_reduce(
+            0, nv, kGrain, std::size_t{0}, [&](std::size_t first, std::size_t last) {
+                std::size_t bad = 0;
+                for (std::size_t v = first; v < last; ++v) {
+                    const auto begin = slots.begin() + bucket_offsets[v];
+                    const auto end = slots.begin() + bucket_offsets[v + 1];
+                    std::sort(begin, end);
+                    const auto edge_of = [](std::uint64_t slot) { return slot >> 32; };
+                    for (auto it = begin; it != end;) {
+                        const auto c0 = static_cast<std::uint32_t>(*it);
+                        owner[c0] = 1;
+                        if (it + 1 == end || edge_of(it[1]) != edge_of(it[0])) {
+                            ++it;
+                            continue;
+                        }
+                        const auto c1 = static_cast<std::uint32_t>(it[1]);
+                        if ((it + 2 != end && edge_of(it[2]) == edge_of(it[0])) || indices[c0] == indices[c1]) {
+                            ++bad;
+                        }
+                        mate[c0] = c1;
+                        mate[c1] = c0;
+                        it += 2;
+                    }
+                }
+                return bad;
+            }, std::plus<>());
+        slots = {};
+        bucket_offsets = {};
+        if (bad_edges != 0) {
+            clear();
+            return false;
+        }
+
+        // Edges are numbered in the order their owning corners appear, which is the order add_face() creates them
+        // in, and the owner gets the halfedge 2e pointing the same way as the corner.
+        std::vector<std::uint32_t> corner_halfedge(nc);
+        std::vector<std::uint32_t> chunk_edges(math::parallel::chunk_count(0, nc, kGrain) + 1, 0);
+        math::parallel::parallel_for(0, nc, kGrain, [&](std::size_t first, std::size_t last) {
+            chunk_edges[first / kGrain + 1] =
+                static_cast<std::uint32_t>(std::count(owner.begin() + first, owner.begin() + last, 1));
+        });
+        std::partial_sum(chunk_edges.begin(), chunk_edges.end(), chunk_edges.begin());
+        math::parallel::parallel_for(0, nc, kGrain, [&](std::size_t first, std::size_t last) {
+            std::uint32_t e = chunk_edges[first / kGrain];
+            for (std::size_t c = first; c < last; ++c) {
+                if (owner[c]) {
+                    corner_halfedge[c] = 2 * e++;
+                }
+            }
+        });
+        math::parallel::parallel_for(0, nc, kGrain, [&](std::size_t first, std::size_t last) {
+            for (std::size_t c = first; c < last; ++c) {
+                if (!owner[c]) {
+                    corner_halfedge[c] = corner_halfedge[mate[c]] + 1;
+                }
+            }
+        });
+        const std::size_t ne = chunk_edges.back();
+
+        vertex_props_.resize(nv);
+        halfedge_props_.resize(2 * ne);
+        edge_props_.resize(ne);
+        face_props_.resize(nc / 3);
+
+        std::copy(positions.begin(), positions.end(), vertex_points_.vector().begin());
+        HalfedgeConnectivity *halfedges = halfedge_connectivity_.vector().data();
+        VertexConnectivity *vertex_halfedges = vertex_connectivity_.vector().data();
+        FaceConnectivity *face_halfedges = face_connectivity_.vector().data();
+
+        // Interior halfedges link within their triangle; the boundary halfedge opposite a corner without a mate
+        // only gets its vertex here and is linked around its hole below.
+        math::parallel::parallel_for(0, nc, kGrain, [&](std::size_t first, std::size_t last) {
+            for (std::size_t c = first; c < last; ++c) {
+                const std::size_t n = next_corner(c);
+                auto &h = halfedges[corner_halfedge[c]];
+                h.face = FaceHandle(static_cast<PropertyIndex>(c / 3));
+                h.vertex = VertexHandle(indices[n]);
+                h.next = HalfedgeHandle(corner_halfedge[n]);
+                h.prev = HalfedgeHandle(corner_halfedge[prev_corner(c)]);
+                if (mate[c] == kNone) {
+                    halfedges[corner_halfedge[c] ^ 1U].vertex = VertexHandle(indices[c]);
+                }
+                if (c % 3 == 2) {
+                    face_halfedges[c / 3].halfedge = HalfedgeHandle(corner_halfedge[c]);
+                }
+            }
+        });
+
+        // Every vertex leaves through its boundary halfedge if it has one and through the halfedge of its last
+        // corner otherwise: add_face() keeps a vertex on its boundary halfedge until the last face closes it. A
+        // second boundary halfedge leaving the same vertex means several fans meet there.
+        std::vector<std::uint32_t> boundary;
+        for (std::size_t c = 0; c < nc; ++c) {
+            auto &out = vertex_halfedges[indices[c]].halfedge;
+            if (!out.is_valid() || halfedges[out.index()].face.is_valid()) {
+                out = HalfedgeHandle(corner_halfedge[c]);
+            }
+            if (mate[c] == kNone) {
+                auto &boundary_out = vertex_halfedges[indices[next_corner(c)]].halfedge;
+                if (boundary_out.is_valid() && !halfedges[boundary_out.index()].face.is_valid()) {
+                    clear();
+                    return false;
+                }
+                boundary_out = HalfedgeHandle(corner_halfedge[c] ^ 1U);
+                boundary.push_back(corner_halfedge[c] ^ 1U);
+            }
+        }
+        math::parallel::parallel_for(0, boundary.size(), kGrain, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                const HalfedgeHandle next = vertex_halfedges[halfedges[boundary[i]].vertex.index()].halfedge;
+                halfedges[boundary[i]].next = next;
+                halfedges[next.index()].prev = HalfedgeHandle(boundary[i]);
+            }
+        });
+
+        // A vertex whose rotation misses some of its outgoing halfedges is pinched between several closed fans;
+        // the rotations of all vertices then cover fewer than all halfedges.
+        const std::size_t rotated = math::parallel::parallel_reduce(
+            0, nv, kGrain, std::size_t{0}, [&](std::size_t first, std::size_t last) {
+                std::size_t steps = 0;
+                for (std::size_t v = first; v < last; ++v) {
+                    const HalfedgeHandle start = vertex_halfedges[v].halfedge;
+                    if (!start.is_valid()) {
+                        continue;
+                    }
+                    PropertyIndex h = start.index();
+                    do {
+                        ++steps;
+                        h = halfedges[h ^ 1U].next.index();
+                    } while (h != start.index());
+                }
+                return steps;
+            }, std::plus<>());
+        if (rotated != 2 * ne) {
+            clear();
+            return false;
+        }
+        return true;
+    }
+
     std::size_t HalfedgeMeshInterface::valence(VertexHandle v) const {
         auto vv = vertices(v);
         return static_cast<std::size_t>(std::distance(vv.begin(), vv.end()));
@@ -1078,126 +1275,251 @@ namespace engine::geometry::mesh {
             return;
         }
 
-        auto nv = vertices_size();
-        auto ne = edges_size();
-        auto nh = halfedges_size();
-        auto nf = faces_size();
+        const auto vertices = utils::PlanCompaction(vertex_deleted_.vector());
+        const auto edges = utils::PlanCompaction(edge_deleted_.vector());
+        const auto faces = utils::PlanCompaction(face_deleted_.vector());
+        vertex_props_.compact(vertices.kept);
+        halfedge_props_.compact(edges.kept, 2);
+        edge_props_.compact(edges.kept);
+        face_props_.compact(faces.kept);
 
-        auto vmap = add_vertex_property<VertexHandle>("v:garbage-collection");
-        auto hmap = add_halfedge_property<HalfedgeHandle>("h:garbage-collection");
-        auto fmap = add_face_property<FaceHandle>("f:garbage-collection");
-        
-        for (std::size_t i = 0; i < nv; ++i) {
-            vmap[VertexHandle(i)] = VertexHandle(i);
-        }
-        for (std::size_t i = 0; i < nh; ++i) {
-            hmap[HalfedgeHandle(i)] = HalfedgeHandle(i);
-        }
-        for (std::size_t i = 0; i < nf; ++i) {
-            fmap[FaceHandle(i)] = FaceHandle(i);
-        }
+        // Surviving elements only reference surviving ones, so every valid handle has a new index.
+        remap_connectivity(vertices.remap, edges.remap, faces.remap);
 
-        if (nv > 0) {
-            std::size_t i0 = 0;
-            std::size_t i1 = nv - 1;
+        deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
+        has_garbage_ = false;
+    }
 
-            while (true) {
-                while (!vertex_deleted_[VertexHandle(i0)] && i0 < i1) {
-                    ++i0;
+    void HalfedgeMeshInterface::remap_connectivity(std::span<const std::uint32_t> vertex_remap,
+                                                   std::span<const std::uint32_t> edge_remap,
+                                                   std::span<const std::uint32_t> face_remap) {
+        const auto vmap = [&](VertexHandle v) { return VertexHandle(vertex_remap[v.index()]); };
+        const auto hmap = [&](HalfedgeHandle h) {
+            return HalfedgeHandle(2 * edge_remap[h.index() >> 1] + (h.index() & 1U));
+        };
+        const auto fmap = [&](FaceHandle f) { return FaceHandle(face_remap[f.index()]); };
+
+        VertexConnectivity *vertex_halfedges = vertex_connectivity_.vector().data();
+        HalfedgeConnectivity *halfedges = halfedge_connectivity_.vector().data();
+        FaceConnectivity *face_halfedges = face_connectivity_.vector().data();
+        math::parallel::parallel_for(0, vertices_size(), kGrain, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                if (vertex_halfedges[i].halfedge.is_valid()) {
+                    vertex_halfedges[i].halfedge = hmap(vertex_halfedges[i].halfedge);
                 }
-                while (vertex_deleted_[VertexHandle(i1)] && i0 < i1) {
-                    --i1;
-                }
-                if (i0 >= i1) {
-                    break;
+            }
+        });
+        math::parallel::parallel_for(0, halfedges_size(), kGrain, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                auto &h = halfedges[i];
+                h.vertex = vmap(h.vertex);
+                h.next = hmap(h.next);
+                h.prev = hmap(h.prev);
+                if (h.face.is_valid()) {
+                    h.face = fmap(h.face);
                 }
-
-                vertex_props_.swap(i0, i1);
             }
+        });
+        math::parallel::parallel_for(0, faces_size(), kGrain, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                face_halfedges[i].halfedge = hmap(face_halfedges[i].halfedge);
+            }
+        });
+    }
 
-            nv = vertex_deleted_[VertexHandle(i0)] ? i0 : i0 + 1;
+    void HalfedgeMeshInterface::optimize_locality(const utils::LocalityOptions &options) {
+        garbage_collection();
+
+        // Faces enter the planner as triangle fans and go where their first triangle lands.
+        std::vector<std::uint32_t> fans;
+        std::vector<std::uint32_t> fan_faces;
+        for (std::size_t f = 0; f < faces_size(); ++f) {
+            const HalfedgeHandle first = halfedge(FaceHandle(static_cast<PropertyIndex>(f)));
+            const VertexHandle apex = to_vertex(first);
+            HalfedgeHandle h = next_halfedge(first);
+            for (HalfedgeHandle following = next_halfedge(h); following != first; following = next_halfedge(h)) {
+                fans.insert(fans.end(), {apex.index(), to_vertex(h).index(), to_vertex(following).index()});
+                fan_faces.push_back(static_cast<std::uint32_t>(f));
+                h = following;
+            }
         }
+        const utils::LocalityOrder plan = utils::PlanLocality(positions(), fans, options);
 
-        if (ne > 0) {
-            std::size_t i0 = 0;
-            std::size_t i1 = ne - 1;
-
-            while (true) {
-                while (!edge_deleted_[EdgeHandle(i0)] && i0 < i1) {
-                    ++i0;
-                }
-                while (edge_deleted_[EdgeHandle(i1)] && i0 < i1) {
-                    --i1;
+        const auto first_uses = [](std::size_t size, auto &&visit) {
+            std::vector<std::uint8_t> placed(size, 0);
+            std::vector<std::uint32_t> order;
+            order.reserve(size);
+            visit([&](std::uint32_t i) {
+                if (placed[i] == 0) {
+                    placed[i] = 1;
+                    order.push_back(i);
                 }
-                if (i0 >= i1) {
-                    break;
+            });
+            for (std::size_t i = 0; i < size; ++i) {
+                if (placed[i] == 0) {
+                    order.push_back(static_cast<std::uint32_t>(i));
                 }
-
-                edge_props_.swap(i0, i1);
-                halfedge_props_.swap(2 * i0, 2 * i1);
-                halfedge_props_.swap(2 * i0 + 1, 2 * i1 + 1);
             }
+            return order;
+        };
+        const std::vector<std::uint32_t> face_order = first_uses(faces_size(), [&](auto &&place) {
+            for (const std::uint32_t triangle : plan.triangles) {
+                place(fan_faces[triangle]);
+            }
+        });
+        // Vertices and edges are numbered as the reordered faces first reach them, so walking the faces streams
+        // through both; the planner's vertex order only places the isolated vertices.
+        const auto walk_faces = [&](auto &&visit) {
+            for (const std::uint32_t f : face_order) {
+                const HalfedgeHandle first = halfedge(FaceHandle(f));
+                HalfedgeHandle h = first;
+                do {
+                    visit(h);
+                    h = next_halfedge(h);
+                } while (h != first);
+            }
+        };
+        const std::vector<std::uint32_t> vertex_order = first_uses(vertices_size(), [&](auto &&place) {
+            walk_faces([&](HalfedgeHandle h) { place(to_vertex(h).index()); });
+            for (const std::uint32_t v : plan.vertices) {
+                place(v);
+            }
+        });
+        const std::vector<std::uint32_t> edge_order = first_uses(edges_size(), [&](auto &&place) {
+            walk_faces([&](HalfedgeHandle h) { place(h.index() >> 1); });
+        });
+
+        vertex_props_.permute(vertex_order);
+        halfedge_props_.permute(edge_order, 2);
+        edge_props_.permute(edge_order);
+        face_props_.permute(face_order);
+        remap_connectivity(utils::InvertPermutation(vertex_order), utils::InvertPermutation(edge_order),
+                           utils::InvertPermutation(face_order));
+    }
 
-            ne = edge_deleted_[EdgeHandle(i0)] ? i0 : i0 + 1;
-            nh = 2 * ne;
-        }
-
-        if (nf > 0) {
-            std::size_t i0 = 0;
-            std::size_t i1 = nf - 1;
+    MeshTopology HalfedgeMeshInterface::freeze() const {
+        MeshTopology topology;
+        freeze(topology);
+        return topology;
+    }
 
-            while (true) {
-                while (!face_deleted_[FaceHandle(i0)] && i0 < i1) {
-                    ++i0;
+    void HalfedgeMeshInterface::freeze(MeshTopology &topology) const {
+        // Without garbage the numbering is the identity and the deleted flags need not be read.
+        const auto number = [this](std::size_t size, auto is_deleted, auto &handles, auto &indices) {
+            using Handle = typename std::decay_t<decltype(handles)>::value_type;
+            handles.clear();
+            indices.resize(size);
+            if (!has_garbage_) {
+                std::iota(indices.begin(), indices.end(), 0U);
+                handles.reserve(size);
+                for (std::size_t i = 0; i < size; ++i) {
+                    handles.emplace_back(static_cast<PropertyIndex>(i));
                 }
-                while (face_deleted_[FaceHandle(i1)] && i0 < i1) {
-                    --i1;
+                return;
+            }
+            for (std::size_t i = 0; i < size; ++i) {
+                const Handle handle(static_cast<PropertyIndex>(i));
+                if (is_deleted(handle)) {
+                    indices[i] = MeshTopology::kInvalidIndex;
+                } else {
+                    indices[i] = static_cast<std::uint32_t>(handles.size());
+                    handles.push_back(handle);
                 }
-                if (i0 >= i1) {
-                    break;
+            }
+        };
+        number(vertices_size(), [this](VertexHandle v) { return is_deleted(v); }, topology.vertex_handles_,
+               topology.vertex_indices_);
+        number(faces_size(), [this](FaceHandle f) { return is_deleted(f); }, topology.face_handles_,
+               topology.face_indices_);
+
+        // The walks below read the connectivity arrays directly; ccw rotation is opposite(prev(h)).
+        const HalfedgeConnectivity *halfedges = halfedge_connectivity_.vector().data();
+        const VertexConnectivity *vertex_halfedges = vertex_connectivity_.vector().data();
+        const FaceConnectivity *face_halfedges = face_connectivity_.vector().data();
+        const auto ccw = [halfedges](PropertyIndex h) { return halfedges[h].prev.index() ^ 1U; };
+
+        const std::size_t nv = topology.vertex_count();
+        const std::size_t nf = topology.face_count();
+        auto &vv_offsets = topology.vertex_vertex_offsets_;
+        auto &vf_offsets = topology.vertex_face_offsets_;
+        auto &fv_offsets = topology.face_vertex_offsets_;
+        vv_offsets.assign(nv + 1, 0);
+        vf_offsets.assign(nv + 1, 0);
+        fv_offsets.assign(nf + 1, 0);
+        topology.vertex_boundary_.resize(nv);
+
+        // Row sizes first, so that after the prefix sums every row can be filled independently.
+        math::parallel::parallel_for(0, nv, MeshTopology::kGrain, [&](std::size_t first, std::size_t last) {
+            for (std::size_t v = first; v < last; ++v) {
+                const PropertyIndex start = vertex_halfedges[topology.vertex_handles_[v].index()].halfedge.index();
+                // Matches is_boundary(VertexHandle): the outgoing halfedge of a boundary vertex is a boundary one.
+                topology.vertex_boundary_[v] =
+                    start == kInvalidPropertyIndex || !halfedges[start].face.is_valid() ? 1U : 0U;
+                if (start == kInvalidPropertyIndex) {
+                    continue;
                 }
-
-                face_props_.swap(i0, i1);
+                std::uint32_t ring = 0;
+                std::uint32_t faces = 0;
+                PropertyIndex h = start;
+                do {
+                    ++ring;
+                    faces += halfedges[h].face.is_valid() ? 1U : 0U;
+                    h = ccw(h);
+                } while (h != start);
+                vv_offsets[v + 1] = ring;
+                vf_offsets[v + 1] = faces;
             }
-
-            nf = face_deleted_[FaceHandle(i0)] ? i0 : i0 + 1;
-        }
-
-        for (std::size_t i = 0; i < nv; ++i) {
-            auto v = VertexHandle(i);
-            if (!is_isolated(v)) {
-                set_halfedge(v, hmap[halfedge(v)]);
+        });
+        math::parallel::parallel_for(0, nf, MeshTopology::kGrain, [&](std::size_t first, std::size_t last) {
+            for (std::size_t f = first; f < last; ++f) {
+                const PropertyIndex start = face_halfedges[topology.face_handles_[f].index()].halfedge.index();
+                std::uint32_t corners = 0;
+                PropertyIndex h = start;
+                do {
+                    ++corners;
+                    h = halfedges[h].next.index();
+                } while (h != start);
+                fv_offsets[f + 1] = corners;
             }
-        }
-
-        for (std::size_t i = 0; i < nh; ++i) {
-            auto h = HalfedgeHandle(i);
-            set_vertex(h, vmap[to_vertex(h)]);
-            set_next_halfedge(h, hmap[next_halfedge(h)]);
-            if (!is_boundary(h)) {
-                set_face(h, fmap[face(h)]);
+        });
+        std::partial_sum(vv_offsets.begin(), vv_offsets.end(), vv_offsets.begin());
+        std::partial_sum(vf_offsets.begin(), vf_offsets.end(), vf_offsets.begin());
+        std::partial_sum(fv_offsets.begin(), fv_offsets.end(), fv_offsets.begin());
+        topology.vertex_vertex_indices_.resize(vv_offsets.back());
+        topology.vertex_face_indices_.resize(vf_offsets.back());
+        topology.face_vertex_indices_.resize(fv_offsets.back());
+
+        // Rows follow the circulators: counter-clockwise from halfedge(v), corners from halfedge(f).
+        const std::uint32_t *vertex_indices = topology.vertex_indices_.data();
+        const std::uint32_t *face_indices = topology.face_indices_.data();
+        math::parallel::parallel_for(0, nv, MeshTopology::kGrain, [&](std::size_t first, std::size_t last) {
+            for (std::size_t v = first; v < last; ++v) {
+                const PropertyIndex start = vertex_halfedges[topology.vertex_handles_[v].index()].halfedge.index();
+                if (start == kInvalidPropertyIndex) {
+                    continue;
+                }
+                std::uint32_t *ring = topology.vertex_vertex_indices_.data() + vv_offsets[v];
+                std::uint32_t *faces = topology.vertex_face_indices_.data() + vf_offsets[v];
+                PropertyIndex h = start;
+                do {
+                    *ring++ = vertex_indices[halfedges[h].vertex.index()];
+                    if (const FaceHandle f = halfedges[h].face; f.is_valid()) {
+                        *faces++ = face_indices[f.index()];
+                    }
+                    h = ccw(h);
+                } while (h != start);
             }
-        }
-
-        for (std::size_t i = 0; i < nf; ++i) {
-            auto f = FaceHandle(i);
-            set_halfedge(f, hmap[halfedge(f)]);
-        }
-
-        remove_vertex_property(vmap);
-        remove_halfedge_property(hmap);
-        remove_face_property(fmap);
-
-        vertex_props_.resize(nv);
-        vertex_props_.shrink_to_fit();
-        halfedge_props_.resize(nh);
-        halfedge_props_.shrink_to_fit();
-        edge_props_.resize(ne);
-        edge_props_.shrink_to_fit();
-        face_props_.resize(nf);
-        face_props_.shrink_to_fit();
-
-        deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
-        has_garbage_ = false;
+        });
+        math::parallel::parallel_for(0, nf, MeshTopology::kGrain, [&](std::size_t first, std::size_t last) {
+            for (std::size_t f = first; f < last; ++f) {
+                const PropertyIndex start = face_halfedges[topology.face_handles_[f].index()].halfedge.index();
+                std::uint32_t *corners = topology.face_vertex_indices_.data() + fv_offsets[f];
+                PropertyIndex h = start;
+                do {
+                    *corners++ = vertex_indices[halfedges[h].vertex.index()];
+                    h = halfedges[h].next.index();
+                } while (h != start);
+            }
+        });
     }
 } // namespace engine::geometry
@@ -1,5 +1,7 @@
 #include "engine/geometry/mesh/surface_mesh_conversion.hpp"
+#include "engine/math/parallel.hpp"
 
+#include <functional>
 #include <limits>
 #include <stdexcept>
 #include <vector>
@@ -8,6 +10,8 @@ namespace engine::geometry::mesh
 {
     namespace
     {
+        constexpr std::size_t kValidationGrain = 16384;
+
         [[nodiscard]] bool is_valid_triangle(const SurfaceMesh& surface, std::size_t base_index)
         {
             const auto i0 = surface.indices[base_index];
@@ -31,7 +35,31 @@ namespace engine::geometry::mesh
             throw std::runtime_error("SurfaceMesh indices are not a multiple of three; only triangles are supported");
         }
 
+        // Well-formed input takes the bulk path; anything else is replayed face by face so the errors (and the
+        // meshes add_face() still accepts) stay exactly those of the incremental build.
         const std::size_t triangle_count = surface.indices.size() / 3U;
+        const std::size_t malformed = math::parallel::parallel_reduce(
+            0, triangle_count, kValidationGrain, std::size_t{0}, [&](std::size_t first, std::size_t last)
+            {
+                std::size_t count = 0;
+                for (std::size_t triangle = first; triangle < last; ++triangle)
+                {
+                    const std::size_t base_index = triangle * 3U;
+                    if (surface.indices[base_index] >= surface.positions.size() ||
+                        surface.indices[base_index + 1U] >= surface.positions.size() ||
+                        surface.indices[base_index + 2U] >= surface.positions.size() ||
+                        !is_valid_triangle(surface, base_index))
+                    {
+                        ++count;
+                    }
+                }
+                return count;
+            }, std::plus<>());
+        if (malformed == 0U && mesh.assign_triangles(surface.positions, surface.indices))
+        {
+            return;
+        }
+
         mesh.reserve(surface.positions.size(), triangle_count * 3U, triangle_count);
 
         std::vector<VertexHandle> vertex_handles;
@@ -138,6 +166,7 @@ namespace engine::geometry::mesh
         {
             surface.normals.assign(surface.positions.size(), math::vec3{0.0F, 0.0F, 0.0F});
             recompute_vertex_normals(surface);
+            surface.rest_normals = surface.normals;
         }
 
         update_bounds(surface);
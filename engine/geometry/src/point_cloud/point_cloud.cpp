@@ -1,5 +1,8 @@
 #include "engine/geometry/point_cloud/point_cloud.hpp"
 
+#include "engine/geometry/utils/compaction.hpp"
+#include "engine/geometry/utils/locality.hpp"
+
 #include <string>
 #include <string_view>
 
@@ -116,40 +119,16 @@ namespace engine::geometry::point_cloud {
             return;
         }
 
-        auto nv = vertices_size();
-
-        VertexProperty<VertexHandle> vmap = add_vertex_property<VertexHandle>("v:garbage-collection");
-        for (std::size_t i = 0; i < nv; ++i) {
-            vmap[VertexHandle(static_cast<PropertyIndex>(i))] = VertexHandle(static_cast<PropertyIndex>(i));
-        }
-
-        if (nv > 0) {
-            std::size_t i0 = 0;
-            std::size_t i1 = nv - 1;
-
-            while (true) {
-                while (!vertex_deleted_[VertexHandle(static_cast<PropertyIndex>(i0))] && i0 < i1) {
-                    ++i0;
-                }
-                while (vertex_deleted_[VertexHandle(static_cast<PropertyIndex>(i1))] && i0 < i1) {
-                    --i1;
-                }
-                if (i0 >= i1) {
-                    break;
-                }
-
-                vertex_props_.swap(i0, i1);
-            }
-
-            nv = vertex_deleted_[VertexHandle(static_cast<PropertyIndex>(i0))] ? i0 : i0 + 1;
-        }
-
-        remove_vertex_property(vmap);
-
-        vertex_props_.resize(nv);
-        vertex_props_.shrink_to_fit();
+        // Points reference nothing, so compacting the properties is all there is to it.
+        const auto vertices = utils::PlanCompaction(vertex_deleted_.vector());
+        vertex_props_.compact(vertices.kept);
 
         deleted_vertices_ = 0;
         has_garbage_ = false;
     }
+
+    void PointCloudInterface::optimize_locality(utils::SpaceFillingCurve curve) {
+        garbage_collection();
+        vertex_props_.permute(utils::SpatialOrder(positions(), curve));
+    }
 } // namespace engine::geometry
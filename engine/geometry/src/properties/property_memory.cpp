@@ -0,0 +1,107 @@
+#include "engine/geometry/properties/property_memory.hpp"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include <cstdint>
+
+namespace engine::geometry {
+
+namespace {
+
+[[nodiscard]] constexpr std::size_t RoundUpToHugePage(std::size_t bytes) noexcept
+{
+    return (bytes + HugePageResource::kHugePageSize - 1) & ~(HugePageResource::kHugePageSize - 1);
+}
+
+#if defined(__linux__)
+// mmap only promises page alignment, so map one extra huge page and trim the unaligned head and the tail.
+[[nodiscard]] void* MapAligned(std::size_t length)
+{
+    const std::size_t padded = length + HugePageResource::kHugePageSize;
+    void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    const auto address = reinterpret_cast<std::uintptr_t>(raw);
+    const auto aligned = RoundUpToHugePage(address);
+    const std::size_t head = aligned - address;
+    if (head != 0)
+    {
+        munmap(raw, head);
+    }
+    munmap(reinterpret_cast<void*>(aligned + length), padded - head - length);
+    return reinterpret_cast<void*>(aligned);
+}
+#endif
+
+} // namespace
+
+HugePageResource::HugePageResource(Options options, std::pmr::memory_resource* upstream) noexcept
+    : options_(options), upstream_(upstream != nullptr ? upstream : std::pmr::new_delete_resource())
+{
+}
+
+bool HugePageResource::maps(std::size_t bytes, std::size_t alignment) const noexcept
+{
+#if defined(__linux__)
+    return bytes >= options_.threshold && alignment <= kHugePageSize;
+#else
+    (void)bytes;
+    (void)alignment;
+    return false;
+#endif
+}
+
+void* HugePageResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (!maps(bytes, alignment))
+    {
+        return upstream_->allocate(bytes, alignment);
+    }
+
+#if defined(__linux__)
+    const std::size_t length = RoundUpToHugePage(bytes);
+    if (options_.use_hugetlb)
+    {
+        void* pages = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (pages != MAP_FAILED)
+        {
+            return pages;
+        }
+    }
+
+    void* pages = MapAligned(length);
+    if (pages == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    madvise(pages, length, MADV_HUGEPAGE);
+    return pages;
+#else
+    return upstream_->allocate(bytes, alignment);
+#endif
+}
+
+void HugePageResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{
+    if (!maps(bytes, alignment))
+    {
+        upstream_->deallocate(p, bytes, alignment);
+        return;
+    }
+
+#if defined(__linux__)
+    munmap(p, RoundUpToHugePage(bytes));
+#endif
+}
+
+bool HugePageResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+} // namespace engine::geometry
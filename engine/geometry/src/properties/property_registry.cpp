@@ -1,12 +1,32 @@
 #include "engine/geometry/properties/property_registry.hpp"
+#include "engine/math/parallel.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cassert>
 
 namespace engine::geometry {
 
+std::uint64_t detail::NextPropertyGeneration() noexcept
+{
+    static std::atomic<std::uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+PropertyRegistry::PropertyRegistry() : PropertyRegistry(nullptr)
+{
+}
+
+PropertyRegistry::PropertyRegistry(std::pmr::memory_resource* resource)
+    : generation_(detail::NextPropertyGeneration()),
+      resource_(resource != nullptr ? resource : std::pmr::new_delete_resource())
+{
+}
+
 PropertyRegistry::PropertyRegistry(const PropertyRegistry& other)
-    : storages_(), size_(other.size_)
+    : storages_(), hashes_(other.hashes_), slots_(other.slots_), generation_(detail::NextPropertyGeneration()),
+      resource_(other.resource_), size_(other.size_)
 {
     storages_.reserve(other.storages_.size());
     for (const auto& storage : other.storages_)
@@ -15,6 +35,13 @@ PropertyRegistry::PropertyRegistry(const PropertyRegistry& other)
     }
 }
 
+PropertyRegistry::PropertyRegistry(PropertyRegistry&& other) noexcept
+    : storages_(std::move(other.storages_)), hashes_(std::move(other.hashes_)), slots_(std::move(other.slots_)),
+      generation_(detail::NextPropertyGeneration()), resource_(other.resource_), size_(other.size_)
+{
+    other.clear();
+}
+
 PropertyRegistry& PropertyRegistry::operator=(const PropertyRegistry& other)
 {
     if (this == &other)
@@ -28,7 +55,28 @@ PropertyRegistry& PropertyRegistry::operator=(const PropertyRegistry& other)
     {
         storages_.push_back(storage->clone());
     }
+    hashes_ = other.hashes_;
+    slots_ = other.slots_;
+    generation_ = detail::NextPropertyGeneration();
+    resource_ = other.resource_;
+    size_ = other.size_;
+    return *this;
+}
+
+PropertyRegistry& PropertyRegistry::operator=(PropertyRegistry&& other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    storages_ = std::move(other.storages_);
+    hashes_ = std::move(other.hashes_);
+    slots_ = std::move(other.slots_);
+    generation_ = detail::NextPropertyGeneration();
+    resource_ = other.resource_;
     size_ = other.size_;
+    other.clear();
     return *this;
 }
 
@@ -46,6 +94,9 @@ std::vector<std::string> PropertyRegistry::property_names() const
 void PropertyRegistry::clear()
 {
     storages_.clear();
+    hashes_.clear();
+    slots_.clear();
+    generation_ = detail::NextPropertyGeneration();
     size_ = 0;
 }
 
@@ -97,6 +148,43 @@ void PropertyRegistry::swap(std::size_t i0, std::size_t i1)
     }
 }
 
+void PropertyRegistry::compact(std::span<const std::uint32_t> kept, std::size_t group)
+{
+    assert(group * kept.size() <= size_);
+    math::parallel::parallel_for(0, storages_.size(), 1, [&](std::size_t first, std::size_t last)
+    {
+        for (std::size_t id = first; id < last; ++id)
+        {
+            storages_[id]->compact(kept, group);
+        }
+    });
+    size_ = group * kept.size();
+}
+
+void PropertyRegistry::permute(std::span<const std::uint32_t> order, std::size_t group)
+{
+    assert(group * order.size() == size_);
+    math::parallel::parallel_for(0, storages_.size(), 1, [&](std::size_t first, std::size_t last)
+    {
+        for (std::size_t id = first; id < last; ++id)
+        {
+            storages_[id]->permute(order, group);
+        }
+    });
+}
+
+void PropertyRegistry::set_memory_resource(std::pmr::memory_resource* resource)
+{
+    resource_ = resource != nullptr ? resource : std::pmr::new_delete_resource();
+    math::parallel::parallel_for(0, storages_.size(), 1, [&](std::size_t first, std::size_t last)
+    {
+        for (std::size_t id = first; id < last; ++id)
+        {
+            storages_[id]->rehome(resource_);
+        }
+    });
+}
+
 bool PropertyRegistry::contains(std::string_view name) const
 {
     return find(name).has_value();
@@ -104,9 +192,21 @@ bool PropertyRegistry::contains(std::string_view name) const
 
 std::optional<PropertyId> PropertyRegistry::find(std::string_view name) const
 {
-    for (PropertyId id = 0; id < storages_.size(); ++id)
+    return find(name, HashPropertyName(name));
+}
+
+std::optional<PropertyId> PropertyRegistry::find(std::string_view name, std::uint64_t hash) const
+{
+    if (slots_.empty())
     {
-        if (storages_[id]->name() == name)
+        return std::nullopt;
+    }
+
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t slot = hash & mask; slots_[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const PropertyId id = slots_[slot] - 1U;
+        if (hashes_[id] == hash && storages_[id]->name() == name)
         {
             return id;
         }
@@ -114,6 +214,38 @@ std::optional<PropertyId> PropertyRegistry::find(std::string_view name) const
     return std::nullopt;
 }
 
+void PropertyRegistry::index(PropertyId id)
+{
+    if (2 * storages_.size() > slots_.size())
+    {
+        rebuild_index();
+        return;
+    }
+
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t slot = hashes_[id] & mask;
+    while (slots_[slot] != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    slots_[slot] = static_cast<std::uint32_t>(id + 1U);
+}
+
+void PropertyRegistry::rebuild_index()
+{
+    slots_.assign(std::max<std::size_t>(std::bit_ceil(2 * storages_.size()), 8), 0);
+    const std::size_t mask = slots_.size() - 1;
+    for (PropertyId id = 0; id < storages_.size(); ++id)
+    {
+        std::size_t slot = hashes_[id] & mask;
+        while (slots_[slot] != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = static_cast<std::uint32_t>(id + 1U);
+    }
+}
+
 bool PropertyRegistry::remove(PropertyId id)
 {
     if (id >= storages_.size())
@@ -121,7 +253,11 @@ bool PropertyRegistry::remove(PropertyId id)
         return false;
     }
 
+    // Later ids shift down by one, so the index is rebuilt rather than patched.
     storages_.erase(storages_.begin() + static_cast<std::ptrdiff_t>(id));
+    hashes_.erase(hashes_.begin() + static_cast<std::ptrdiff_t>(id));
+    rebuild_index();
+    generation_ = detail::NextPropertyGeneration();
     return true;
 }
 
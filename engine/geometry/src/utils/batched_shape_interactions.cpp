@@ -0,0 +1,284 @@
+#include "engine/geometry/utils/batched_shape_interactions.hpp"
+#include "engine/geometry/shapes.hpp"
+#include "engine/geometry/utils/shape_interactions.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace engine::geometry
+{
+    namespace
+    {
+        constexpr std::size_t kBlockSize = AabbSoa::kBlockSize;
+        constexpr float kInf = std::numeric_limits<float>::infinity();
+
+        using Block = std::array<std::uint8_t, kBlockSize>;
+
+        // Bit j of the result is block[j]; bits of the padding lanes past `count` boxes from `first` are cleared.
+        std::uint64_t PackBlock(const Block& block, std::size_t first, std::size_t count) noexcept
+        {
+            std::uint64_t bits = 0;
+            for (std::size_t j = 0; j < kBlockSize; ++j)
+            {
+                bits |= static_cast<std::uint64_t>(block[j]) << j;
+            }
+            const std::size_t valid = count - first;
+            return valid < kBlockSize ? bits & ((std::uint64_t{1} << valid) - 1) : bits;
+        }
+
+        // Evaluates hit(i) for every box a block at a time and packs the results into mask words. The block loop
+        // has a fixed trip count and writes a local byte array, so it vectorises over the SoA arrays hit() reads
+        // without alias checks or a scalar tail.
+        template <class HitFn>
+        std::size_t WriteMask(std::size_t count, std::span<std::uint64_t> mask, const HitFn& hit) noexcept
+        {
+            assert(mask.size() >= MaskWordCount(count));
+            Block block;
+            std::size_t hits = 0;
+            for (std::size_t word = 0; word < MaskWordCount(count); ++word)
+            {
+                const std::size_t first = word * kBlockSize;
+                for (std::size_t j = 0; j < kBlockSize; ++j)
+                {
+                    block[j] = static_cast<std::uint8_t>(hit(first + j));
+                }
+                mask[word] = PackBlock(block, first, count);
+                hits += static_cast<std::size_t>(std::popcount(mask[word]));
+            }
+            return hits;
+        }
+
+        // Coordinate arrays of a set of boxes, hoisted so kernels index plain pointers.
+        struct BoxArrays
+        {
+            const float* min_x;
+            const float* min_y;
+            const float* min_z;
+            const float* max_x;
+            const float* max_y;
+            const float* max_z;
+
+            explicit BoxArrays(const AabbSoa& boxes) noexcept
+                : min_x(boxes.min(0)), min_y(boxes.min(1)), min_z(boxes.min(2)),
+                  max_x(boxes.max(0)), max_y(boxes.max(1)), max_z(boxes.max(2))
+            {
+            }
+        };
+    } // namespace
+
+    void AabbSoa::clear() noexcept
+    {
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            min_[axis].clear();
+            max_[axis].clear();
+        }
+        size_ = 0;
+    }
+
+    void AabbSoa::resize(std::size_t count)
+    {
+        const std::size_t padded = MaskWordCount(count) * kBlockSize;
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            // Boxes dropped by a shrink may sit in the kept padding; reset them to empty first.
+            if (count < size_)
+            {
+                std::fill(min_[axis].begin() + count, min_[axis].begin() + std::min(size_, padded), kInf);
+                std::fill(max_[axis].begin() + count, max_[axis].begin() + std::min(size_, padded), -kInf);
+            }
+            min_[axis].resize(padded, kInf);
+            max_[axis].resize(padded, -kInf);
+        }
+        size_ = count;
+    }
+
+    void AabbSoa::assign(std::span<const Aabb> boxes)
+    {
+        clear();
+        resize(boxes.size());
+        for (std::size_t i = 0; i < boxes.size(); ++i)
+        {
+            set(i, boxes[i]);
+        }
+    }
+
+    void AabbSoa::push_back(const Aabb& box)
+    {
+        resize(size_ + 1);
+        set(size_ - 1, box);
+    }
+
+    void AabbSoa::set(std::size_t index, const Aabb& box) noexcept
+    {
+        assert(index < size_);
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            min_[axis][index] = box.min[axis];
+            max_[axis][index] = box.max[axis];
+        }
+    }
+
+    Aabb AabbSoa::get(std::size_t index) const noexcept
+    {
+        assert(index < size_);
+        return {{min_[0][index], min_[1][index], min_[2][index]}, {max_[0][index], max_[1][index], max_[2][index]}};
+    }
+
+    void AppendSetBits(std::span<const std::uint64_t> mask, std::vector<std::uint32_t>& indices)
+    {
+        for (std::size_t word = 0; word < mask.size(); ++word)
+        {
+            for (std::uint64_t bits = mask[word]; bits != 0; bits &= bits - 1)
+            {
+                indices.push_back(static_cast<std::uint32_t>(word * kBlockSize +
+                                                             static_cast<std::size_t>(std::countr_zero(bits))));
+            }
+        }
+    }
+
+    std::size_t Intersects(const Aabb& query, const AabbSoa& boxes, std::span<std::uint64_t> mask) noexcept
+    {
+        const BoxArrays b(boxes);
+        const float lo_x = query.min[0], lo_y = query.min[1], lo_z = query.min[2];
+        const float hi_x = query.max[0], hi_y = query.max[1], hi_z = query.max[2];
+        return WriteMask(boxes.size(), mask, [&](std::size_t i)
+        {
+            // Non-short-circuit ands keep the block loop free of branches.
+            return (b.min_x[i] <= hi_x) & (lo_x <= b.max_x[i]) &
+                   (b.min_y[i] <= hi_y) & (lo_y <= b.max_y[i]) &
+                   (b.min_z[i] <= hi_z) & (lo_z <= b.max_z[i]);
+        });
+    }
+
+    std::size_t Intersects(const Sphere& query, const AabbSoa& boxes, std::span<std::uint64_t> mask) noexcept
+    {
+        const BoxArrays b(boxes);
+        const float cx = query.center[0], cy = query.center[1], cz = query.center[2];
+        const float radius_sq = query.radius * query.radius;
+        return WriteMask(boxes.size(), mask, [&](std::size_t i)
+        {
+            const float dx = std::max(std::max(b.min_x[i] - cx, 0.0f), cx - b.max_x[i]);
+            const float dy = std::max(std::max(b.min_y[i] - cy, 0.0f), cy - b.max_y[i]);
+            const float dz = std::max(std::max(b.min_z[i] - cz, 0.0f), cz - b.max_z[i]);
+            return dx * dx + dy * dy + dz * dz <= radius_sq;
+        });
+    }
+
+    std::size_t Intersects(const Ray& query, const AabbSoa& boxes, std::span<std::uint64_t> mask,
+                           std::span<float> entry) noexcept
+    {
+        assert(entry.empty() || entry.size() >= boxes.size());
+        assert(mask.size() >= MaskWordCount(boxes.size()));
+        const BoxArrays b(boxes);
+
+        // Axes the ray is parallel to get a zero inverse, which pins their slab to [0, 0]; the +inf pad on the
+        // exit and the origin-in-slab test then stand in for the slab, as in Intersects(Aabb, Ray).
+        std::array<float, 3> o{};
+        std::array<float, 3> inv{};
+        std::array<float, 3> pad{};
+        // Set for the axes the ray crosses, whose origin-in-slab test is skipped.
+        std::array<bool, 3> crossing{};
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            const float d = query.direction[axis];
+            const bool parallel = std::abs(d) <= constants::PARALLEL_EPSILON;
+            o[axis] = query.origin[axis];
+            crossing[axis] = !parallel;
+            inv[axis] = parallel ? 0.0f : 1.0f / d;
+            pad[axis] = parallel ? kInf : 0.0f;
+        }
+
+        Block block;
+        std::array<float, kBlockSize> block_entry;
+        std::size_t hits = 0;
+        for (std::size_t word = 0; word < MaskWordCount(boxes.size()); ++word)
+        {
+            const std::size_t first = word * kBlockSize;
+            for (std::size_t j = 0; j < kBlockSize; ++j)
+            {
+                const std::size_t i = first + j;
+                const float x0 = (b.min_x[i] - o[0]) * inv[0];
+                const float x1 = (b.max_x[i] - o[0]) * inv[0];
+                const float y0 = (b.min_y[i] - o[1]) * inv[1];
+                const float y1 = (b.max_y[i] - o[1]) * inv[1];
+                const float z0 = (b.min_z[i] - o[2]) * inv[2];
+                const float z1 = (b.max_z[i] - o[2]) * inv[2];
+                const float t_enter = std::max(std::max(std::min(x0, x1), std::min(y0, y1)),
+                                               std::max(std::min(z0, z1), 0.0f));
+                const float t_exit = std::min(std::min(std::max(x0, x1) + pad[0], std::max(y0, y1) + pad[1]),
+                                              std::max(z0, z1) + pad[2]);
+                const bool in_slabs = (crossing[0] | ((b.min_x[i] <= o[0]) & (o[0] <= b.max_x[i]))) &
+                                      (crossing[1] | ((b.min_y[i] <= o[1]) & (o[1] <= b.max_y[i]))) &
+                                      (crossing[2] | ((b.min_z[i] <= o[2]) & (o[2] <= b.max_z[i])));
+                block[j] = static_cast<std::uint8_t>(in_slabs & (t_enter <= t_exit));
+                block_entry[j] = t_enter;
+            }
+            mask[word] = PackBlock(block, first, boxes.size());
+            hits += static_cast<std::size_t>(std::popcount(mask[word]));
+            if (!entry.empty())
+            {
+                std::copy_n(block_entry.begin(), std::min(kBlockSize, boxes.size() - first), entry.begin() + first);
+            }
+        }
+        return hits;
+    }
+
+    std::size_t IntersectsHalfspaces(std::span<const Plane> planes, const AabbSoa& boxes,
+                                     std::span<std::uint64_t> mask) noexcept
+    {
+        assert(mask.size() >= MaskWordCount(boxes.size()));
+        Block block;
+        std::size_t hits = 0;
+        for (std::size_t word = 0; word < MaskWordCount(boxes.size()); ++word)
+        {
+            const std::size_t first = word * kBlockSize;
+            std::uint64_t bits = ~std::uint64_t{0};
+            // Planes are applied block by block so the block stays in cache, and a block whose boxes are all
+            // culled skips the remaining planes.
+            for (std::size_t p = 0; p < planes.size() && bits != 0; ++p)
+            {
+                // Only the corner furthest along the normal matters; picking its arrays per plane keeps the loop
+                // a plain multiply-add over three of the six arrays.
+                const float nx = planes[p].normal[0], ny = planes[p].normal[1], nz = planes[p].normal[2];
+                const float d = planes[p].distance;
+                const float* px = (nx >= 0.0f ? boxes.max(0) : boxes.min(0)) + first;
+                const float* py = (ny >= 0.0f ? boxes.max(1) : boxes.min(1)) + first;
+                const float* pz = (nz >= 0.0f ? boxes.max(2) : boxes.min(2)) + first;
+                for (std::size_t j = 0; j < kBlockSize; ++j)
+                {
+                    block[j] = static_cast<std::uint8_t>(nx * px[j] + ny * py[j] + nz * pz[j] + d >= 0.0f);
+                }
+                bits &= PackBlock(block, first, boxes.size());
+            }
+            const std::size_t valid = boxes.size() - first;
+            mask[word] = valid < kBlockSize ? bits & ((std::uint64_t{1} << valid) - 1) : bits;
+            hits += static_cast<std::size_t>(std::popcount(mask[word]));
+        }
+        return hits;
+    }
+
+    void SquaredDistance(const math::vec3& point, const AabbSoa& boxes, std::span<float> distance_sq) noexcept
+    {
+        assert(distance_sq.size() >= boxes.size());
+        const BoxArrays b(boxes);
+        const float px = point[0], py = point[1], pz = point[2];
+        std::array<float, kBlockSize> block;
+        for (std::size_t first = 0; first < boxes.size(); first += kBlockSize)
+        {
+            for (std::size_t j = 0; j < kBlockSize; ++j)
+            {
+                const std::size_t i = first + j;
+                const float dx = std::max(std::max(b.min_x[i] - px, 0.0f), px - b.max_x[i]);
+                const float dy = std::max(std::max(b.min_y[i] - py, 0.0f), py - b.max_y[i]);
+                const float dz = std::max(std::max(b.min_z[i] - pz, 0.0f), pz - b.max_z[i]);
+                block[j] = dx * dx + dy * dy + dz * dz;
+            }
+            std::copy_n(block.begin(), std::min(kBlockSize, boxes.size() - first), distance_sq.begin() + first);
+        }
+    }
+} // namespace engine::geometry
@@ -0,0 +1,295 @@
+#include "engine/geometry/utils/locality.hpp"
+
+#include "engine/geometry/utils/hilbert.hpp"
+#include "engine/geometry/utils/morton.hpp"
+#include "engine/geometry/utils/radix_sort.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace engine::geometry::utils
+{
+    namespace
+    {
+        constexpr std::uint32_t kNone = std::numeric_limits<std::uint32_t>::max();
+
+        // Triangles around every vertex in CSR form; a triangle is listed once per corner.
+        struct VertexTriangles
+        {
+            std::vector<std::uint32_t> offsets;
+            std::vector<std::uint32_t> triangles;
+        };
+
+        [[nodiscard]] VertexTriangles BuildVertexTriangles(std::span<const std::uint32_t> indices,
+                                                           std::size_t vertex_count)
+        {
+            VertexTriangles adjacency;
+            adjacency.offsets.assign(vertex_count + 1, 0);
+            for (const std::uint32_t index : indices)
+            {
+                ++adjacency.offsets[index + 1];
+            }
+            for (std::size_t v = 1; v <= vertex_count; ++v)
+            {
+                adjacency.offsets[v] += adjacency.offsets[v - 1];
+            }
+            adjacency.triangles.resize(indices.size());
+            std::vector<std::uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+            for (std::size_t corner = 0; corner < indices.size(); ++corner)
+            {
+                adjacency.triangles[cursor[indices[corner]]++] = static_cast<std::uint32_t>(corner / 3);
+            }
+            return adjacency;
+        }
+    } // namespace
+
+    std::vector<std::uint32_t> SpatialOrder(std::span<const math::vec3> points, SpaceFillingCurve curve)
+    {
+        const std::vector<std::size_t> order =
+            curve == SpaceFillingCurve::Morton ? MortonOrder(points) : HilbertOrder(points);
+        return {order.begin(), order.end()};
+    }
+
+    std::vector<std::uint32_t> OptimizeVertexCache(std::span<const std::uint32_t> indices,
+                                                   std::size_t vertex_count,
+                                                   std::uint32_t cache_size)
+    {
+        const std::size_t triangle_count = indices.size() / 3;
+        const VertexTriangles adjacency = BuildVertexTriangles(indices.first(3 * triangle_count), vertex_count);
+
+        std::vector<std::uint32_t> live(vertex_count);
+        for (std::size_t v = 0; v < vertex_count; ++v)
+        {
+            live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+        }
+
+        // A vertex is in the cache while fewer than cache_size misses happened since its own.
+        std::vector<std::int64_t> cache_time(vertex_count, 0);
+        std::int64_t time = std::int64_t{cache_size} + 1;
+        const auto in_cache = [&](std::uint32_t v) { return time - cache_time[v] <= cache_size; };
+
+        std::vector<std::uint8_t> emitted(triangle_count, 0);
+        std::vector<std::uint32_t> dead_ends;
+        std::vector<std::uint32_t> candidates;
+        std::vector<std::uint32_t> order;
+        order.reserve(triangle_count);
+        std::size_t cursor = 0;
+
+        // After a dead end resume at the most recently touched vertex with work left, else scan forward.
+        const auto skip_dead_end = [&]() -> std::uint32_t
+        {
+            while (!dead_ends.empty())
+            {
+                const std::uint32_t v = dead_ends.back();
+                dead_ends.pop_back();
+                if (live[v] > 0)
+                {
+                    return v;
+                }
+            }
+            for (; cursor < vertex_count; ++cursor)
+            {
+                if (live[cursor] > 0)
+                {
+                    return static_cast<std::uint32_t>(cursor);
+                }
+            }
+            return kNone;
+        };
+
+        for (std::uint32_t fan = skip_dead_end(); fan != kNone;)
+        {
+            candidates.clear();
+            for (std::uint32_t k = adjacency.offsets[fan]; k < adjacency.offsets[fan + 1]; ++k)
+            {
+                const std::uint32_t triangle = adjacency.triangles[k];
+                if (emitted[triangle] != 0)
+                {
+                    continue;
+                }
+                emitted[triangle] = 1;
+                order.push_back(triangle);
+                for (std::size_t corner = 0; corner < 3; ++corner)
+                {
+                    const std::uint32_t v = indices[3 * std::size_t{triangle} + corner];
+                    dead_ends.push_back(v);
+                    candidates.push_back(v);
+                    --live[v];
+                    if (!in_cache(v))
+                    {
+                        cache_time[v] = time++;
+                    }
+                }
+            }
+
+            // Prefer the neighbour that will still be cached after its remaining triangles are emitted and
+            // that entered the cache earliest; neighbours that would be evicted meanwhile rank lowest.
+            std::uint32_t next = kNone;
+            std::int64_t best = -1;
+            for (const std::uint32_t v : candidates)
+            {
+                if (live[v] == 0)
+                {
+                    continue;
+                }
+                const std::int64_t age = time - cache_time[v];
+                const std::int64_t priority = age + 2 * std::int64_t{live[v]} <= cache_size ? age : 0;
+                if (priority > best)
+                {
+                    best = priority;
+                    next = v;
+                }
+            }
+            fan = next != kNone ? next : skip_dead_end();
+        }
+        return order;
+    }
+
+    std::vector<std::uint32_t> OptimizeVertexFetch(std::span<const std::uint32_t> indices,
+                                                   std::span<const std::uint32_t> triangle_order,
+                                                   std::size_t vertex_count)
+    {
+        std::vector<std::uint8_t> placed(vertex_count, 0);
+        std::vector<std::uint32_t> order;
+        order.reserve(vertex_count);
+        for (const std::uint32_t triangle : triangle_order)
+        {
+            for (std::size_t corner = 0; corner < 3; ++corner)
+            {
+                const std::uint32_t v = indices[3 * std::size_t{triangle} + corner];
+                if (v < vertex_count && placed[v] == 0)
+                {
+                    placed[v] = 1;
+                    order.push_back(v);
+                }
+            }
+        }
+        for (std::size_t v = 0; v < vertex_count; ++v)
+        {
+            if (placed[v] == 0)
+            {
+                order.push_back(static_cast<std::uint32_t>(v));
+            }
+        }
+        return order;
+    }
+
+    double AverageCacheMissRatio(std::span<const std::uint32_t> indices,
+                                 std::size_t vertex_count,
+                                 std::uint32_t cache_size)
+    {
+        const std::size_t triangle_count = indices.size() / 3;
+        if (triangle_count == 0)
+        {
+            return 0.0;
+        }
+
+        // Entry time of each vertex; with FIFO replacement it is cached while fewer than cache_size vertices
+        // entered after it.
+        constexpr std::uint64_t kNever = std::numeric_limits<std::uint64_t>::max();
+        std::vector<std::uint64_t> entered(vertex_count, kNever);
+        std::uint64_t misses = 0;
+        for (const std::uint32_t v : indices.first(3 * triangle_count))
+        {
+            if (v >= vertex_count)
+            {
+                ++misses;
+                continue;
+            }
+            if (entered[v] == kNever || misses - entered[v] > cache_size)
+            {
+                entered[v] = misses++;
+            }
+        }
+        return static_cast<double>(misses) / static_cast<double>(triangle_count);
+    }
+
+    LocalityOrder PlanLocality(std::span<const math::vec3> positions,
+                               std::span<const std::uint32_t> indices,
+                               const LocalityOptions& options)
+    {
+        const std::size_t vertex_count = positions.size();
+        const std::size_t triangle_count = indices.size() / 3;
+        const std::vector<std::uint32_t> spatial = SpatialOrder(positions, options.curve);
+        const std::vector<std::uint32_t> rank = InvertPermutation(spatial);
+
+        // Sort the valid triangles by the curve position of their earliest corner.
+        std::vector<std::uint64_t> keys;
+        std::vector<std::uint32_t> sorted;
+        std::vector<std::uint32_t> invalid;
+        keys.reserve(triangle_count);
+        sorted.reserve(triangle_count);
+        for (std::size_t t = 0; t < triangle_count; ++t)
+        {
+            const std::uint32_t a = indices[3 * t];
+            const std::uint32_t b = indices[3 * t + 1];
+            const std::uint32_t c = indices[3 * t + 2];
+            if (a >= vertex_count || b >= vertex_count || c >= vertex_count)
+            {
+                invalid.push_back(static_cast<std::uint32_t>(t));
+                continue;
+            }
+            keys.push_back(std::min({rank[a], rank[b], rank[c]}));
+            sorted.push_back(static_cast<std::uint32_t>(t));
+        }
+        ParallelRadixSort(keys, sorted, 32);
+
+        LocalityOrder order;
+        if (options.optimize_vertex_cache)
+        {
+            // Tipsify on curve-ranked vertex ids, so its forward scan after a dead end also follows the curve.
+            std::vector<std::uint32_t> ranked(3 * sorted.size());
+            for (std::size_t i = 0; i < sorted.size(); ++i)
+            {
+                for (std::size_t corner = 0; corner < 3; ++corner)
+                {
+                    ranked[3 * i + corner] = rank[indices[3 * std::size_t{sorted[i]} + corner]];
+                }
+            }
+            order.triangles = OptimizeVertexCache(ranked, vertex_count, options.cache_size);
+            for (std::uint32_t& triangle : order.triangles)
+            {
+                triangle = sorted[triangle];
+            }
+        }
+        else
+        {
+            order.triangles = std::move(sorted);
+        }
+
+        std::vector<std::uint8_t> placed(vertex_count, 0);
+        order.vertices.reserve(vertex_count);
+        for (const std::uint32_t triangle : order.triangles)
+        {
+            for (std::size_t corner = 0; corner < 3; ++corner)
+            {
+                const std::uint32_t v = indices[3 * std::size_t{triangle} + corner];
+                if (placed[v] == 0)
+                {
+                    placed[v] = 1;
+                    order.vertices.push_back(v);
+                }
+            }
+        }
+        for (const std::uint32_t v : spatial)
+        {
+            if (placed[v] == 0)
+            {
+                order.vertices.push_back(v);
+            }
+        }
+
+        order.triangles.insert(order.triangles.end(), invalid.begin(), invalid.end());
+        return order;
+    }
+
+    std::vector<std::uint32_t> InvertPermutation(std::span<const std::uint32_t> order)
+    {
+        std::vector<std::uint32_t> inverse(order.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            inverse[order[i]] = static_cast<std::uint32_t>(i);
+        }
+        return inverse;
+    }
+} // namespace engine::geometry::utils
@@ -0,0 +1,322 @@
+#include <gtest/gtest.h>
+
+#include "engine/geometry/api.hpp"
+#include "engine/geometry/bvh/bvh.hpp"
+#include "engine/geometry/mesh/halfedge_mesh.hpp"
+#include "engine/geometry/random.hpp"
+#include "engine/geometry/shapes/sphere.hpp"
+#include "engine/geometry/utils/shape_interactions.hpp"
+#include "engine/math/vector.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace geo = engine::geometry;
+namespace math = engine::math;
+
+namespace
+{
+    using Rng = geo::RandomEngine;
+
+    // A wavy height-field grid plus a cloud of small random triangles, so the tree mixes large coherent
+    // regions with scattered clutter.
+    geo::SurfaceMesh make_test_mesh(std::size_t grid, std::size_t scattered, Rng& rng)
+    {
+        geo::SurfaceMesh mesh;
+        for (std::size_t y = 0; y <= grid; ++y)
+        {
+            for (std::size_t x = 0; x <= grid; ++x)
+            {
+                const float fx = static_cast<float>(x) / static_cast<float>(grid) * 2.0f - 1.0f;
+                const float fy = static_cast<float>(y) / static_cast<float>(grid) * 2.0f - 1.0f;
+                mesh.positions.push_back({fx, fy, 0.1f * std::sin(4.0f * fx) * std::cos(3.0f * fy)});
+            }
+        }
+        for (std::uint32_t y = 0; y < grid; ++y)
+        {
+            for (std::uint32_t x = 0; x < grid; ++x)
+            {
+                const std::uint32_t i = y * static_cast<std::uint32_t>(grid + 1) + x;
+                const std::uint32_t stride = static_cast<std::uint32_t>(grid + 1);
+                mesh.indices.insert(mesh.indices.end(), {i, i + 1, i + stride + 1, i, i + stride + 1, i + stride});
+            }
+        }
+
+        std::uniform_real_distribution<float> center(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> offset(-0.05f, 0.05f);
+        for (std::size_t t = 0; t < scattered; ++t)
+        {
+            const math::vec3 c(center(rng), center(rng), center(rng) * 0.5f + 0.3f);
+            const auto base = static_cast<std::uint32_t>(mesh.positions.size());
+            for (int k = 0; k < 3; ++k)
+            {
+                mesh.positions.push_back(c + math::vec3(offset(rng), offset(rng), offset(rng)));
+            }
+            mesh.indices.insert(mesh.indices.end(), {base, base + 1, base + 2});
+        }
+        mesh.rest_positions = mesh.positions;
+        return mesh;
+    }
+
+    geo::Triangle triangle_of(const geo::SurfaceMesh& mesh, std::size_t t)
+    {
+        return {mesh.positions[mesh.indices[3 * t]], mesh.positions[mesh.indices[3 * t + 1]],
+                mesh.positions[mesh.indices[3 * t + 2]]};
+    }
+
+    geo::Ray random_ray(Rng& rng)
+    {
+        std::uniform_real_distribution<float> dist(-1.5f, 1.5f);
+        const math::vec3 origin(dist(rng), dist(rng), 1.5f + std::abs(dist(rng)));
+        const math::vec3 target(dist(rng) * 0.8f, dist(rng) * 0.8f, dist(rng) * 0.2f);
+        return {origin, math::normalize(target - origin)};
+    }
+
+    void expect_matches_brute_force(const geo::Bvh& bvh, const geo::SurfaceMesh& mesh, Rng& rng)
+    {
+        const std::size_t triangle_count = mesh.indices.size() / 3;
+        for (int q = 0; q < 200; ++q)
+        {
+            const geo::Ray ray = random_ray(rng);
+            float best_t = std::numeric_limits<float>::infinity();
+            for (std::size_t t = 0; t < triangle_count; ++t)
+            {
+                geo::Result result{};
+                if (geo::Intersects(ray, triangle_of(mesh, t), &result) && result.t >= 0.0f)
+                {
+                    best_t = std::min(best_t, result.t);
+                }
+            }
+
+            geo::Bvh::RayHit hit;
+            const bool found = bvh.closest_hit(ray, hit);
+            ASSERT_EQ(found, std::isfinite(best_t));
+            EXPECT_EQ(bvh.any_hit(ray), found);
+            if (!found) continue;
+            EXPECT_NEAR(hit.t, best_t, 1e-4f);
+            ASSERT_LT(hit.primitive, triangle_count);
+            const geo::Triangle triangle = triangle_of(mesh, hit.primitive);
+            const math::vec3 barycentric_point =
+                triangle.a * (1.0f - hit.u - hit.v) + triangle.b * hit.u + triangle.c * hit.v;
+            EXPECT_LT(math::length(barycentric_point - (ray.origin + ray.direction * hit.t)), 1e-4f);
+
+            EXPECT_FALSE(bvh.any_hit(ray, best_t * 0.999f));
+            EXPECT_TRUE(bvh.any_hit(ray, best_t * 1.001f));
+        }
+
+        std::uniform_real_distribution<float> dist(-1.3f, 1.3f);
+        for (int q = 0; q < 100; ++q)
+        {
+            const math::vec3 p(dist(rng), dist(rng), dist(rng));
+            double best = std::numeric_limits<double>::infinity();
+            for (std::size_t t = 0; t < triangle_count; ++t)
+            {
+                best = std::min(best, geo::SquaredDistance(triangle_of(mesh, t), p));
+            }
+            geo::Bvh::ClosestPointResult closest;
+            ASSERT_TRUE(bvh.closest_point(p, closest));
+            EXPECT_NEAR(closest.distance_sq, best, 1e-5);
+            EXPECT_NEAR(geo::SquaredDistance(triangle_of(mesh, closest.primitive), p), best, 1e-5);
+
+            const geo::Aabb box{.min = p - math::vec3(0.2f), .max = p + math::vec3(0.2f)};
+            const geo::Sphere sphere{.center = p, .radius = 0.25f};
+            std::vector<std::size_t> expected_box;
+            std::vector<std::size_t> expected_sphere;
+            for (std::size_t t = 0; t < triangle_count; ++t)
+            {
+                if (geo::Intersects(triangle_of(mesh, t), box)) expected_box.push_back(t);
+                if (geo::Intersects(triangle_of(mesh, t), sphere)) expected_sphere.push_back(t);
+            }
+            std::vector<std::size_t> actual;
+            bvh.query(box, actual);
+            EXPECT_EQ(actual, expected_box);
+            bvh.query(sphere, actual);
+            EXPECT_EQ(actual, expected_sphere);
+        }
+    }
+}
+
+TEST(Bvh, QueriesMatchBruteForce)
+{
+    Rng rng(5);
+    const geo::SurfaceMesh mesh = make_test_mesh(24, 400, rng);
+    for (const std::size_t max_leaf : {1u, 4u, 16u})
+    {
+        geo::Bvh bvh;
+        ASSERT_TRUE(bvh.build(mesh, {.max_triangles_per_leaf = max_leaf}));
+        ASSERT_TRUE(bvh.validate_structure());
+        EXPECT_EQ(bvh.triangle_count(), mesh.indices.size() / 3);
+        for (const auto& node : bvh.nodes())
+        {
+            EXPECT_LE(node.count, std::max<std::size_t>(max_leaf, 1));
+        }
+        expect_matches_brute_force(bvh, mesh, rng);
+    }
+}
+
+TEST(Bvh, RefitTracksDeformedVertices)
+{
+    Rng rng(17);
+    geo::SurfaceMesh mesh = make_test_mesh(16, 200, rng);
+    geo::Bvh bvh;
+    ASSERT_TRUE(bvh.build(mesh, {}));
+    const std::size_t node_count = bvh.node_count();
+
+    std::uniform_real_distribution<float> jitter(-0.03f, 0.03f);
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        for (std::size_t i = 0; i < mesh.positions.size(); ++i)
+        {
+            const math::vec3& rest = mesh.rest_positions[i];
+            mesh.positions[i] = rest + math::vec3(0.2f * rest[1] * static_cast<float>(frame), jitter(rng),
+                                                  0.3f * rest[0] * static_cast<float>(frame));
+        }
+        ASSERT_TRUE(bvh.refit(mesh));
+        EXPECT_EQ(bvh.node_count(), node_count);
+        ASSERT_TRUE(bvh.validate_structure());
+        expect_matches_brute_force(bvh, mesh, rng);
+    }
+
+    mesh.positions.pop_back();
+    EXPECT_FALSE(bvh.refit(mesh));
+}
+
+TEST(Bvh, RejectsInvalidInputAndHandlesDegenerateTriangles)
+{
+    geo::Bvh bvh;
+    const std::vector<math::vec3> positions{{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+    EXPECT_FALSE(bvh.build(positions, std::vector<std::uint32_t>{0, 1}, {}));
+    EXPECT_FALSE(bvh.build(positions, std::vector<std::uint32_t>{0, 1, 3}, {}));
+    EXPECT_FALSE(bvh.build(positions, std::vector<std::uint32_t>{}, {}));
+    EXPECT_EQ(bvh.node_count(), 0u);
+    geo::Bvh::RayHit hit;
+    EXPECT_FALSE(bvh.closest_hit({{0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}}, hit));
+
+    // Many copies of the same triangle: centroids coincide, so the build must still bound leaf sizes.
+    std::vector<std::uint32_t> indices;
+    for (int i = 0; i < 50; ++i)
+    {
+        indices.insert(indices.end(), {0, 1, 2});
+    }
+    ASSERT_TRUE(bvh.build(positions, indices, {.max_triangles_per_leaf = 4}));
+    ASSERT_TRUE(bvh.validate_structure());
+    for (const auto& node : bvh.nodes())
+    {
+        EXPECT_LE(node.count, 4u);
+    }
+    ASSERT_TRUE(bvh.closest_hit({{0.25f, 0.25f, 1.0f}, {0.0f, 0.0f, -1.0f}}, hit));
+    EXPECT_FLOAT_EQ(hit.t, 1.0f);
+    EXPECT_EQ(hit.primitive, 0u);
+
+    // Axis-aligned rays have zero direction components on two axes.
+    EXPECT_TRUE(bvh.any_hit({{0.25f, 0.25f, -1.0f}, {0.0f, 0.0f, 1.0f}}));
+    EXPECT_FALSE(bvh.any_hit({{2.0f, 0.25f, 1.0f}, {0.0f, 0.0f, -1.0f}}));
+}
+
+TEST(Bvh, BuildsFromHalfedgeMeshFaces)
+{
+    geo::Mesh mesh;
+    std::vector<geo::VertexHandle> vertices;
+    for (int y = 0; y <= 3; ++y)
+    {
+        for (int x = 0; x <= 3; ++x)
+        {
+            vertices.push_back(mesh.interface.add_vertex({static_cast<float>(x), static_cast<float>(y), 0.0f}));
+        }
+    }
+    for (int y = 0; y < 3; ++y)
+    {
+        for (int x = 0; x < 3; ++x)
+        {
+            const int i = y * 4 + x;
+            ASSERT_TRUE(mesh.interface.add_quad(vertices[i], vertices[i + 1], vertices[i + 5], vertices[i + 4]));
+        }
+    }
+
+    geo::Bvh bvh;
+    ASSERT_TRUE(bvh.build(mesh.interface, {.max_triangles_per_leaf = 2}));
+    ASSERT_TRUE(bvh.validate_structure());
+    EXPECT_EQ(bvh.triangle_count(), 18u);
+
+    geo::Bvh::RayHit hit;
+    ASSERT_TRUE(bvh.closest_hit({{1.5f, 2.5f, 1.0f}, {0.0f, 0.0f, -1.0f}}, hit));
+    EXPECT_FLOAT_EQ(hit.t, 1.0f);
+    EXPECT_EQ(hit.primitive, 7u);
+
+    std::vector<std::size_t> faces;
+    bvh.query(geo::Aabb{.min = {0.9f, 0.9f, -0.1f}, .max = {1.1f, 1.1f, 0.1f}}, faces);
+    EXPECT_EQ(faces, (std::vector<std::size_t>{0, 1, 3, 4}));
+
+    mesh.interface.positions()[vertices[5].index()] = {1.0f, 1.0f, 0.5f};
+    ASSERT_TRUE(bvh.refit(mesh.interface));
+    geo::Bvh::ClosestPointResult closest;
+    ASSERT_TRUE(bvh.closest_point({1.0f, 1.0f, 1.0f}, closest));
+    EXPECT_NEAR(closest.distance_sq, 0.25f, 1e-6f);
+}
+
+TEST(Bvh, BatchedRayQueriesMatchSingleRays)
+{
+    Rng rng(23);
+    const geo::SurfaceMesh mesh = make_test_mesh(32, 600, rng);
+    geo::Bvh bvh;
+    ASSERT_TRUE(bvh.build(mesh, {}));
+
+    // A coherent pinhole fan followed by incoherent random rays; the count spans several tasks and ends on
+    // a partial packet.
+    std::vector<geo::Ray> rays;
+    for (int y = 0; y < 30; ++y)
+    {
+        for (int x = 0; x < 30; ++x)
+        {
+            const math::vec3 target(static_cast<float>(x) / 15.0f - 1.0f, static_cast<float>(y) / 15.0f - 1.0f, 0.0f);
+            rays.push_back({math::vec3(0.1f, -0.2f, 2.0f), math::normalize(target - math::vec3(0.1f, -0.2f, 2.0f))});
+        }
+    }
+    for (int i = 0; i < 503; ++i) rays.push_back(random_ray(rng));
+    rays.push_back({{0.3f, 0.3f, 2.0f}, {0.0f, 0.0f, -1.0f}});
+    rays.push_back({{-2.0f, 0.2f, 0.0f}, {1.0f, 0.0f, 0.0f}});
+
+    for (const float t_max : {std::numeric_limits<float>::infinity(), 1.9f})
+    {
+        std::vector<geo::Bvh::RayHit> expected(rays.size());
+        std::vector<std::uint8_t> expected_occluded(rays.size());
+        for (std::size_t i = 0; i < rays.size(); ++i)
+        {
+            bvh.closest_hit(rays[i], expected[i], t_max);
+            expected_occluded[i] = bvh.any_hit(rays[i], t_max) ? 1 : 0;
+        }
+
+        const auto check = [&](const std::vector<geo::Bvh::RayHit>& hits, const std::vector<std::uint8_t>& occluded)
+        {
+            for (std::size_t i = 0; i < rays.size(); ++i)
+            {
+                ASSERT_EQ(hits[i].primitive, expected[i].primitive) << "ray " << i;
+                EXPECT_EQ(occluded[i], expected_occluded[i]) << "ray " << i;
+                if (expected[i].primitive == std::numeric_limits<std::size_t>::max())
+                {
+                    EXPECT_EQ(hits[i].t, t_max);
+                    continue;
+                }
+                EXPECT_NEAR(hits[i].t, expected[i].t, 1e-5f);
+                EXPECT_NEAR(hits[i].u, expected[i].u, 1e-4f);
+                EXPECT_NEAR(hits[i].v, expected[i].v, 1e-4f);
+            }
+        };
+
+        std::vector<geo::Bvh::RayHit> hits(rays.size());
+        std::vector<std::uint8_t> occluded(rays.size());
+        for (const auto mode : {geo::RayBatchMode::Packet, geo::RayBatchMode::Stream})
+        {
+            bvh.closest_hit_batch(rays, hits, mode, t_max);
+            bvh.any_hit_batch(rays, occluded, mode, t_max);
+            check(hits, occluded);
+            bvh.closest_hit_batch<4>(rays, hits, mode, t_max);
+            bvh.any_hit_batch<4>(rays, occluded, mode, t_max);
+            check(hits, occluded);
+        }
+    }
+}
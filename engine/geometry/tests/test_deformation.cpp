@@ -1,9 +1,13 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 #include <vector>
 
 #include <gtest/gtest.h>
 
 #include "engine/animation/deformation/linear_blend_skinning.hpp"
 #include "engine/geometry/deform/linear_blend_skinning.hpp"
+#include "engine/geometry/deform/skinning.hpp"
 
 namespace engine::geometry
 {
@@ -69,5 +73,278 @@ namespace engine::geometry
         EXPECT_NEAR(mesh.positions[2][0], -1.0F, 1.0e-3F);
         EXPECT_NEAR(mesh.positions[2][1], 2.0F, 1.0e-3F);
     }
-}
 
+    TEST(LinearBlendSkinning, PaletteSkinsPositionsNormalsAndBounds)
+    {
+        SurfaceMesh mesh = make_unit_quad();
+        ASSERT_EQ(mesh.rest_normals.size(), mesh.rest_positions.size());
+
+        const math::Transform<float> stretch{
+            math::vec3{2.0F, 1.0F, 0.5F},
+            math::normalize(math::angle_axis(math::radians(30.0F), math::vec3{0.0F, 0.0F, 1.0F})),
+            math::vec3{1.0F, -2.0F, 0.5F}};
+        const math::Transform<float> lift{
+            math::vec3{1.0F, 1.0F, 1.0F},
+            math::normalize(math::angle_axis(math::radians(-45.0F), math::vec3{1.0F, 0.0F, 0.0F})),
+            math::vec3{0.0F, 3.0F, 0.0F}};
+        const std::vector<math::Transform<float>> skin{stretch, lift};
+
+        animation::RigBinding binding{};
+        binding.joints.resize(skin.size());
+        binding.resize_vertices(mesh.rest_positions.size());
+        ASSERT_TRUE(binding.vertices[0].add_influence(0U, 1.0F));
+        ASSERT_TRUE(binding.vertices[1].add_influence(0U, 1.0F));
+        ASSERT_TRUE(binding.vertices[2].add_influence(0U, 0.25F));
+        ASSERT_TRUE(binding.vertices[2].add_influence(1U, 0.75F));
+        // Vertex 3 has no influences and keeps its rest pose.
+
+        std::vector<deform::SkinningMatrix> palette(skin.size());
+        deform::build_skinning_palette(skin, palette);
+        deform::apply_linear_blend_skinning(binding, palette, mesh);
+
+        ASSERT_EQ(mesh.positions.size(), 4U);
+        ASSERT_EQ(mesh.normals.size(), 4U);
+        for (std::size_t vertex = 0; vertex < 3; ++vertex)
+        {
+            math::vec3 expected{0.0F, 0.0F, 0.0F};
+            const auto& influences = binding.vertices[vertex];
+            for (std::uint8_t i = 0; i < influences.influence_count; ++i)
+            {
+                expected += influences.influences[i].weight *
+                    math::transform_point(skin[influences.influences[i].joint], mesh.rest_positions[vertex]);
+            }
+            for (std::size_t axis = 0; axis < 3; ++axis)
+            {
+                EXPECT_NEAR(mesh.positions[vertex][axis], expected[axis], 1.0e-5F);
+            }
+        }
+        EXPECT_EQ(mesh.positions[3], mesh.rest_positions[3]);
+        EXPECT_EQ(mesh.normals[3], mesh.rest_normals[3]);
+
+        // Under non-uniform scale the normal must stay perpendicular to the deformed tangent plane.
+        const math::vec3 expected_normal = math::normalize(
+            math::cross(math::transform_vector(stretch, math::vec3{0.0F, 0.0F, 1.0F}),
+                        math::transform_vector(stretch, math::vec3{1.0F, 0.0F, 0.0F})));
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            EXPECT_NEAR(mesh.normals[0][axis], expected_normal[axis], 1.0e-5F);
+        }
+
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            float lo = mesh.positions[0][axis];
+            float hi = mesh.positions[0][axis];
+            for (const auto& position : mesh.positions)
+            {
+                lo = std::min(lo, position[axis]);
+                hi = std::max(hi, position[axis]);
+            }
+            EXPECT_EQ(mesh.bounds.min[axis], lo);
+            EXPECT_EQ(mesh.bounds.max[axis], hi);
+        }
+
+        SurfaceMesh from_transforms = make_unit_quad();
+        deform::apply_linear_blend_skinning(binding, skin, from_transforms);
+        EXPECT_EQ(from_transforms.positions, mesh.positions);
+        EXPECT_EQ(from_transforms.normals, mesh.normals);
+
+        EXPECT_THROW(deform::apply_linear_blend_skinning(binding, std::span(palette).first(1), mesh),
+                     std::invalid_argument);
+    }
+
+    TEST(LinearBlendSkinning, RigidSkinningKeepsUnitQuadNormalsConsistentWithWinding)
+    {
+        SurfaceMesh rest = make_unit_quad();
+        rest.positions = rest.rest_positions;
+        recompute_vertex_normals(rest);
+        ASSERT_EQ(rest.normals.size(), rest.rest_normals.size());
+        for (std::size_t vertex = 0; vertex < rest.normals.size(); ++vertex)
+        {
+            for (std::size_t axis = 0; axis < 3; ++axis)
+            {
+                EXPECT_NEAR(rest.rest_normals[vertex][axis], rest.normals[vertex][axis], 1.0e-6F);
+            }
+        }
+
+        const math::Transform<float> joint{
+            math::vec3{1.0F, 1.0F, 1.0F},
+            math::normalize(math::angle_axis(math::radians(50.0F), math::normalize(math::vec3{0.3F, 1.0F, -2.0F}))),
+            math::vec3{2.0F, -1.0F, 0.5F}};
+        const std::vector<math::Transform<float>> skin{joint};
+
+        animation::RigBinding binding{};
+        binding.joints.resize(skin.size());
+        binding.resize_vertices(rest.rest_positions.size());
+        for (auto& vertex : binding.vertices)
+        {
+            ASSERT_TRUE(vertex.add_influence(0U, 1.0F));
+        }
+
+        for (const auto method : {SkinningMethod::LinearBlend, SkinningMethod::DualQuaternion})
+        {
+            SurfaceMesh mesh = make_unit_quad();
+            mesh.skinning_method = method;
+            deform::apply_skinning(binding, skin, mesh);
+
+            SurfaceMesh recomputed = mesh;
+            recompute_vertex_normals(recomputed);
+            for (std::size_t vertex = 0; vertex < mesh.normals.size(); ++vertex)
+            {
+                for (std::size_t axis = 0; axis < 3; ++axis)
+                {
+                    EXPECT_NEAR(mesh.normals[vertex][axis], recomputed.normals[vertex][axis], 1.0e-5F);
+                }
+            }
+        }
+    }
+
+    TEST(DualQuaternionSkinning, MatchesRigidTransformsAndIgnoresQuaternionSign)
+    {
+        SurfaceMesh mesh = make_unit_quad();
+        mesh.skinning_method = SkinningMethod::DualQuaternion;
+
+        const math::quat rotation =
+            math::normalize(math::angle_axis(math::radians(70.0F), math::normalize(math::vec3{1.0F, 2.0F, -0.5F})));
+        const math::Transform<float> joint{math::vec3{1.5F, 0.5F, 2.0F}, rotation, math::vec3{-1.0F, 4.0F, 2.5F}};
+        math::Transform<float> flipped = joint;
+        flipped.rotation = math::quat{-rotation.w, -rotation.x, -rotation.y, -rotation.z};
+        const std::vector<math::Transform<float>> skin{joint, flipped};
+
+        animation::RigBinding binding{};
+        binding.joints.resize(skin.size());
+        binding.resize_vertices(mesh.rest_positions.size());
+        ASSERT_TRUE(binding.vertices[0].add_influence(0U, 1.0F));
+        ASSERT_TRUE(binding.vertices[1].add_influence(1U, 1.0F));
+        ASSERT_TRUE(binding.vertices[2].add_influence(0U, 0.5F));
+        ASSERT_TRUE(binding.vertices[2].add_influence(1U, 0.5F));
+        ASSERT_TRUE(binding.vertices[3].add_influence(1U, 0.3F));
+        ASSERT_TRUE(binding.vertices[3].add_influence(0U, 0.7F));
+
+        deform::apply_skinning(binding, skin, mesh);
+
+        SurfaceMesh linear = make_unit_quad();
+        std::vector<deform::SkinningMatrix> matrices(skin.size());
+        deform::build_skinning_palette(skin, matrices);
+        animation::RigBinding rigid{};
+        rigid.joints.resize(1);
+        rigid.resize_vertices(linear.rest_positions.size());
+        for (auto& vertex : rigid.vertices)
+        {
+            ASSERT_TRUE(vertex.add_influence(0U, 1.0F));
+        }
+        deform::apply_linear_blend_skinning(rigid, matrices, linear);
+
+        ASSERT_EQ(mesh.positions.size(), 4U);
+        for (std::size_t vertex = 0; vertex < mesh.positions.size(); ++vertex)
+        {
+            const math::vec3 expected = math::transform_point(joint, mesh.rest_positions[vertex]);
+            for (std::size_t axis = 0; axis < 3; ++axis)
+            {
+                EXPECT_NEAR(mesh.positions[vertex][axis], expected[axis], 1.0e-4F);
+                EXPECT_NEAR(mesh.normals[vertex][axis], linear.normals[vertex][axis], 1.0e-5F);
+            }
+        }
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            EXPECT_NEAR(mesh.bounds.min[axis], linear.bounds.min[axis], 1.0e-4F);
+            EXPECT_NEAR(mesh.bounds.max[axis], linear.bounds.max[axis], 1.0e-4F);
+        }
+
+        std::vector<deform::SkinningDualQuaternion> palette(skin.size());
+        deform::build_dual_quaternion_palette(skin, palette);
+        EXPECT_THROW(deform::apply_dual_quaternion_skinning(binding, std::span(palette).first(1), mesh),
+                     std::invalid_argument);
+    }
+
+    TEST(Skinning, DispatchWithCallerPalettesMatchesEachMethod)
+    {
+        const math::Transform<float> stretch{
+            math::vec3{1.0F, 2.0F, 1.0F},
+            math::normalize(math::angle_axis(math::radians(40.0F), math::vec3{0.0F, 1.0F, 0.0F})),
+            math::vec3{0.5F, 1.0F, -1.0F}};
+        const math::Transform<float> bend{
+            math::vec3{1.0F, 1.0F, 1.0F},
+            math::normalize(math::angle_axis(math::radians(-70.0F), math::vec3{1.0F, 0.0F, 0.0F})),
+            math::vec3{0.0F, 2.0F, 0.0F}};
+        const std::vector<math::Transform<float>> skin{stretch, bend};
+
+        SurfaceMesh rest = make_unit_quad();
+        animation::RigBinding binding{};
+        binding.joints.resize(skin.size());
+        binding.resize_vertices(rest.rest_positions.size());
+        for (std::size_t vertex = 0; vertex < binding.vertices.size(); ++vertex)
+        {
+            const float weight = 0.25F * static_cast<float>(vertex);
+            ASSERT_TRUE(binding.vertices[vertex].add_influence(0U, 1.0F - weight));
+            if (weight > 0.0F)
+            {
+                ASSERT_TRUE(binding.vertices[vertex].add_influence(1U, weight));
+            }
+        }
+
+        deform::SkinningPalettes palettes;
+        for (const auto method : {SkinningMethod::LinearBlend, SkinningMethod::DualQuaternion})
+        {
+            SurfaceMesh expected = rest;
+            if (method == SkinningMethod::DualQuaternion)
+            {
+                deform::apply_dual_quaternion_skinning(binding, skin, expected);
+            }
+            else
+            {
+                deform::apply_linear_blend_skinning(binding, skin, expected);
+            }
+
+            SurfaceMesh mesh = rest;
+            mesh.skinning_method = method;
+            deform::apply_skinning(binding, skin, palettes, mesh);
+            EXPECT_EQ(mesh.positions, expected.positions);
+            EXPECT_EQ(mesh.normals, expected.normals);
+
+            // A second frame reuses the palette filled by the first.
+            const auto storage = [&]()
+            {
+                return method == SkinningMethod::DualQuaternion
+                           ? static_cast<const void*>(palettes.dual_quaternions.data())
+                           : static_cast<const void*>(palettes.matrices.data());
+            };
+            const void* first_frame = storage();
+            deform::apply_skinning(binding, skin, palettes, mesh);
+            EXPECT_EQ(storage(), first_frame);
+        }
+        EXPECT_EQ(palettes.matrices.size(), skin.size());
+        EXPECT_EQ(palettes.dual_quaternions.size(), skin.size());
+
+        SurfaceMesh mesh = rest;
+        EXPECT_THROW(deform::apply_skinning(binding, std::span(skin).first(1), palettes, mesh), std::invalid_argument);
+    }
+
+    TEST(DualQuaternionSkinning, PreservesVolumeUnderTwist)
+    {
+        // A point one unit off the x axis, split evenly between an unrotated joint and one twisted 170° about
+        // that axis: linear blending pulls it almost onto the axis, dual quaternions keep it on the circle.
+        SurfaceMesh mesh{};
+        mesh.rest_positions = {math::vec3{0.0F, 1.0F, 0.0F}};
+        const std::vector<math::Transform<float>> skin{
+            math::Transform<float>::Identity(),
+            math::Transform<float>{math::vec3{1.0F, 1.0F, 1.0F},
+                                   math::normalize(math::angle_axis(math::radians(170.0F),
+                                                                    math::vec3{1.0F, 0.0F, 0.0F})),
+                                   math::vec3{0.0F, 0.0F, 0.0F}}};
+
+        animation::RigBinding binding{};
+        binding.joints.resize(skin.size());
+        binding.resize_vertices(1);
+        ASSERT_TRUE(binding.vertices[0].add_influence(0U, 0.5F));
+        ASSERT_TRUE(binding.vertices[0].add_influence(1U, 0.5F));
+
+        const auto radius = [](const math::vec3& p) { return std::sqrt(p[1] * p[1] + p[2] * p[2]); };
+
+        deform::apply_linear_blend_skinning(binding, skin, mesh);
+        EXPECT_LT(radius(mesh.positions[0]), 0.1F);
+
+        deform::apply_dual_quaternion_skinning(binding, skin, mesh);
+        EXPECT_NEAR(radius(mesh.positions[0]), 1.0F, 1.0e-5F);
+        EXPECT_NEAR(mesh.positions[0][0], 0.0F, 1.0e-6F);
+    }
+}
@@ -2,6 +2,10 @@
 
 #include "engine/geometry/graph/graph.hpp"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 namespace geo = engine::geometry;
 namespace graph_ns = engine::geometry::graph;
 
@@ -129,3 +133,82 @@ TEST(Graph, CopyIndependence) {
     EXPECT_EQ(assigned.interface.vertex_count(), original.interface.vertex_count());
     EXPECT_EQ(assigned.interface.edge_count(), original.interface.edge_count());
 }
+
+TEST(Graph, GarbageCollectionKeepsSurvivorOrderAndRemapsConnectivity) {
+    geo::Graph graph;
+    auto& interface = graph.interface;
+    std::vector<geo::VertexHandle> vertices;
+    for (int i = 0; i < 6; ++i) {
+        vertices.push_back(interface.add_vertex({static_cast<float>(i), 0.0F, 0.0F}));
+    }
+    auto tag = interface.add_edge_property<int>("e:tag", -1);
+    const std::pair<int, int> ends[] = {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 5}, {1, 4}, {2, 5}};
+    for (const auto& [a, b] : ends) {
+        const auto h = interface.add_edge(vertices[static_cast<std::size_t>(a)], vertices[static_cast<std::size_t>(b)]);
+        ASSERT_TRUE(h.is_valid());
+        tag[interface.edge(h)] = 10 * a + b;
+    }
+
+    interface.delete_vertex(vertices[2]);
+    interface.delete_edge(geo::EdgeHandle(1));
+    interface.delete_edge(geo::EdgeHandle(2));
+    interface.delete_edge(geo::EdgeHandle(6));
+    ASSERT_TRUE(interface.has_garbage());
+
+    // A halfedge is named by its edge tag and direction; references to removed halfedges are named -1.
+    const auto name = [&](geo::HalfedgeHandle h) {
+        if (!h.is_valid() || interface.is_deleted(h)) {
+            return -1;
+        }
+        return 2 * tag[interface.edge(h)] + static_cast<int>(h.index() & 1U);
+    };
+    struct HalfedgeRecord {
+        int self;
+        int next;
+        int prev;
+        float to_x;
+    };
+    const auto records = [&]() {
+        std::vector<HalfedgeRecord> result;
+        for (std::size_t i = 0; i < interface.halfedges_size(); ++i) {
+            const geo::HalfedgeHandle h(static_cast<geo::PropertyIndex>(i));
+            if (!interface.is_deleted(h)) {
+                result.push_back({name(h), name(interface.next_halfedge(h)), name(interface.prev_halfedge(h)),
+                                  interface.position(interface.to_vertex(h))[0]});
+            }
+        }
+        return result;
+    };
+    const std::vector<HalfedgeRecord> before = records();
+    ASSERT_TRUE(std::any_of(before.begin(), before.end(), [](const HalfedgeRecord& r) { return r.next == -1; }));
+    std::vector<int> outgoing_before;
+    for (const int i : {0, 1, 3, 4, 5}) {
+        outgoing_before.push_back(name(interface.halfedge(vertices[static_cast<std::size_t>(i)])));
+    }
+
+    interface.garbage_collection();
+
+    EXPECT_FALSE(interface.has_garbage());
+    ASSERT_EQ(interface.vertices_size(), 5U);
+    ASSERT_EQ(interface.edges_size(), 4U);
+    ASSERT_EQ(interface.halfedges_size(), 8U);
+    const float xs[] = {0.0F, 1.0F, 3.0F, 4.0F, 5.0F};
+    for (std::size_t i = 0; i < 5; ++i) {
+        const geo::VertexHandle v(static_cast<geo::PropertyIndex>(i));
+        EXPECT_FLOAT_EQ(interface.position(v)[0], xs[i]);
+        EXPECT_EQ(name(interface.halfedge(v)), outgoing_before[i]);
+    }
+    const int tags[] = {1, 34, 45, 14};
+    for (std::size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(tag[geo::EdgeHandle(static_cast<geo::PropertyIndex>(i))], tags[i]);
+    }
+
+    const std::vector<HalfedgeRecord> after = records();
+    ASSERT_EQ(after.size(), before.size());
+    for (std::size_t i = 0; i < after.size(); ++i) {
+        EXPECT_EQ(after[i].self, before[i].self);
+        EXPECT_EQ(after[i].next, before[i].next);
+        EXPECT_EQ(after[i].prev, before[i].prev);
+        EXPECT_FLOAT_EQ(after[i].to_x, before[i].to_x);
+    }
+}
@@ -2,6 +2,10 @@
 
 #include "engine/geometry/mesh/halfedge_mesh.hpp"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 namespace geo = engine::geometry;
 
 namespace
@@ -173,3 +177,315 @@ TEST(HalfedgeMesh, CopyIndependence)
     EXPECT_EQ(assigned.interface.face_count(), original.interface.face_count());
     EXPECT_EQ(assigned.interface.vertex_count(), original.interface.vertex_count());
 }
+
+TEST(HalfedgeMesh, CopySharesBuffersUntilWritten)
+{
+    auto fixture = MakeTriangleMesh();
+    const geo::Mesh copy(fixture.mesh);
+    const auto& original = std::as_const(fixture.mesh.interface);
+
+    EXPECT_EQ(copy.interface.positions().data(), original.positions().data());
+    EXPECT_FLOAT_EQ(copy.interface.position(fixture.v1)[0], 1.0F);
+    EXPECT_EQ(copy.interface.positions().data(), original.positions().data());
+
+    fixture.mesh.interface.position(fixture.v1)[0] = 3.0F;
+    EXPECT_NE(copy.interface.positions().data(), original.positions().data());
+    EXPECT_FLOAT_EQ(copy.interface.position(fixture.v1)[0], 1.0F);
+    EXPECT_FLOAT_EQ(original.position(fixture.v1)[0], 3.0F);
+}
+
+TEST(HalfedgeMesh, FreezeBuildsCompactAdjacencyMatchingCirculators)
+{
+    // 4x4 vertex grid of quads split into triangles, one quad left open and one triangle deleted afterwards.
+    geo::Mesh mesh;
+    auto& interface = mesh.interface;
+    std::vector<geo::VertexHandle> grid;
+    for (int y = 0; y < 4; ++y)
+    {
+        for (int x = 0; x < 4; ++x)
+        {
+            grid.push_back(interface.add_vertex({static_cast<float>(x), static_cast<float>(y), 0.0F}));
+        }
+    }
+    const geo::VertexHandle isolated = interface.add_vertex({9.0F, 9.0F, 0.0F});
+    std::vector<geo::FaceHandle> faces;
+    for (int y = 0; y < 3; ++y)
+    {
+        for (int x = 0; x < 3; ++x)
+        {
+            if (x == 1 && y == 1)
+            {
+                continue;
+            }
+            const auto v = [&](int dx, int dy) { return grid[static_cast<std::size_t>((y + dy) * 4 + x + dx)]; };
+            faces.push_back(*interface.add_triangle(v(0, 0), v(1, 0), v(1, 1)));
+            faces.push_back(*interface.add_triangle(v(0, 0), v(1, 1), v(0, 1)));
+        }
+    }
+    const geo::FaceHandle deleted = faces[5];
+    interface.delete_face(deleted);
+    ASSERT_TRUE(interface.has_garbage());
+
+    const geo::mesh::MeshTopology topology = interface.freeze();
+    ASSERT_EQ(topology.vertex_count(), interface.vertex_count());
+    ASSERT_EQ(topology.face_count(), interface.face_count());
+    EXPECT_EQ(topology.face_index(deleted), geo::mesh::MeshTopology::kInvalidIndex);
+
+    std::uint32_t expected_vertex = 0;
+    for (const geo::VertexHandle v : interface.vertices())
+    {
+        const std::uint32_t index = topology.vertex_index(v);
+        ASSERT_EQ(index, expected_vertex++);
+        EXPECT_EQ(topology.vertex_handle(index), v);
+        EXPECT_EQ(topology.is_boundary(index), interface.is_boundary(v));
+
+        std::vector<geo::VertexHandle> ring;
+        for (const std::uint32_t n : topology.vertex_vertices(index))
+        {
+            ring.push_back(topology.vertex_handle(n));
+        }
+        std::vector<geo::VertexHandle> expected_ring;
+        if (!interface.is_isolated(v))
+        {
+            for (const geo::VertexHandle n : interface.vertices(v))
+            {
+                expected_ring.push_back(n);
+            }
+        }
+        EXPECT_EQ(ring, expected_ring);
+        EXPECT_EQ(topology.valence(index), interface.valence(v));
+
+        std::vector<geo::FaceHandle> incident;
+        for (const std::uint32_t f : topology.vertex_faces(index))
+        {
+            incident.push_back(topology.face_handle(f));
+        }
+        std::vector<geo::FaceHandle> expected_incident;
+        if (!interface.is_isolated(v))
+        {
+            for (const geo::FaceHandle f : interface.faces(v))
+            {
+                expected_incident.push_back(f);
+            }
+        }
+        EXPECT_EQ(incident, expected_incident);
+    }
+    EXPECT_TRUE(topology.is_boundary(topology.vertex_index(isolated)));
+    EXPECT_TRUE(topology.vertex_vertices(topology.vertex_index(isolated)).empty());
+
+    for (const geo::FaceHandle f : interface.faces())
+    {
+        const std::uint32_t index = topology.face_index(f);
+        ASSERT_NE(index, geo::mesh::MeshTopology::kInvalidIndex);
+        std::vector<geo::VertexHandle> corners;
+        for (const std::uint32_t v : topology.face_vertices(index))
+        {
+            corners.push_back(topology.vertex_handle(v));
+        }
+        std::vector<geo::VertexHandle> expected_corners;
+        for (const geo::VertexHandle v : interface.vertices(f))
+        {
+            expected_corners.push_back(v);
+        }
+        EXPECT_EQ(corners, expected_corners);
+    }
+
+    std::vector<std::size_t> valences(topology.vertex_count());
+    topology.parallel_for_vertices([&](std::uint32_t v) { valences[v] = topology.valence(v); }, 3);
+    std::size_t total = 0;
+    for (const std::size_t valence : valences)
+    {
+        total += valence;
+    }
+    EXPECT_EQ(total, topology.vertex_vertex_indices().size());
+
+    // Re-freezing into the same snapshot after an edit matches a fresh one.
+    geo::mesh::MeshTopology reused = topology;
+    interface.delete_face(faces[0]);
+    interface.freeze(reused);
+    const geo::mesh::MeshTopology fresh = interface.freeze();
+    ASSERT_EQ(reused.vertex_count(), fresh.vertex_count());
+    ASSERT_EQ(reused.face_count(), fresh.face_count());
+    EXPECT_TRUE(std::ranges::equal(reused.vertex_vertex_offsets(), fresh.vertex_vertex_offsets()));
+    EXPECT_TRUE(std::ranges::equal(reused.vertex_vertex_indices(), fresh.vertex_vertex_indices()));
+    EXPECT_TRUE(std::ranges::equal(reused.face_vertex_offsets(), fresh.face_vertex_offsets()));
+    EXPECT_TRUE(std::ranges::equal(reused.face_vertex_indices(), fresh.face_vertex_indices()));
+    for (std::uint32_t v = 0; v < fresh.vertex_count(); ++v)
+    {
+        EXPECT_TRUE(std::ranges::equal(reused.vertex_faces(v), fresh.vertex_faces(v)));
+        EXPECT_EQ(reused.is_boundary(v), fresh.is_boundary(v));
+    }
+}
+
+TEST(HalfedgeMesh, GarbageCollectionKeepsSurvivorOrderAndConnectivity)
+{
+    geo::Mesh mesh;
+    auto& interface = mesh.interface;
+    std::vector<geo::VertexHandle> grid;
+    for (int y = 0; y < 5; ++y)
+    {
+        for (int x = 0; x < 5; ++x)
+        {
+            grid.push_back(interface.add_vertex({static_cast<float>(x), static_cast<float>(y), 0.0F}));
+        }
+    }
+    auto tag = interface.add_face_property<int>("f:tag", -1);
+    std::vector<geo::FaceHandle> faces;
+    for (int y = 0; y < 4; ++y)
+    {
+        for (int x = 0; x < 4; ++x)
+        {
+            const auto v = [&](int dx, int dy) { return grid[static_cast<std::size_t>((y + dy) * 5 + x + dx)]; };
+            faces.push_back(*interface.add_triangle(v(0, 0), v(1, 0), v(1, 1)));
+            faces.push_back(*interface.add_triangle(v(0, 0), v(1, 1), v(0, 1)));
+            tag[faces[faces.size() - 2]] = static_cast<int>(faces.size()) - 2;
+            tag[faces.back()] = static_cast<int>(faces.size()) - 1;
+        }
+    }
+    interface.delete_vertex(grid[12]);
+    interface.delete_face(faces[0]);
+    interface.delete_face(faces[31]);
+    ASSERT_TRUE(interface.has_garbage());
+
+    // freeze() numbers survivors in handle order, which is the order garbage collection must keep them in.
+    const geo::mesh::MeshTopology before = interface.freeze();
+    std::vector<int> tags;
+    std::vector<float> xs;
+    for (std::uint32_t f = 0; f < before.face_count(); ++f)
+    {
+        tags.push_back(tag[before.face_handle(f)]);
+    }
+    for (std::uint32_t v = 0; v < before.vertex_count(); ++v)
+    {
+        const auto& p = interface.position(before.vertex_handle(v));
+        xs.push_back(p[0] + 10.0F * p[1]);
+    }
+
+    interface.garbage_collection();
+    EXPECT_FALSE(interface.has_garbage());
+    ASSERT_EQ(interface.vertices_size(), before.vertex_count());
+    ASSERT_EQ(interface.faces_size(), before.face_count());
+    EXPECT_EQ(interface.edges_size(), interface.edge_count());
+
+    for (std::uint32_t f = 0; f < before.face_count(); ++f)
+    {
+        EXPECT_EQ(tag[geo::FaceHandle(f)], tags[f]);
+    }
+    for (std::uint32_t v = 0; v < before.vertex_count(); ++v)
+    {
+        const auto& p = interface.position(geo::VertexHandle(v));
+        EXPECT_FLOAT_EQ(p[0] + 10.0F * p[1], xs[v]);
+    }
+    for (const geo::HalfedgeHandle h : interface.halfedges())
+    {
+        EXPECT_EQ(interface.prev_halfedge(interface.next_halfedge(h)), h);
+        EXPECT_NE(interface.from_vertex(h), interface.to_vertex(h));
+    }
+
+    const geo::mesh::MeshTopology after = interface.freeze();
+    EXPECT_TRUE(std::ranges::equal(after.vertex_vertex_offsets(), before.vertex_vertex_offsets()));
+    EXPECT_TRUE(std::ranges::equal(after.vertex_vertex_indices(), before.vertex_vertex_indices()));
+    EXPECT_TRUE(std::ranges::equal(after.face_vertex_indices(), before.face_vertex_indices()));
+}
+
+TEST(HalfedgeMesh, OptimizeLocalityRenumbersWithoutChangingTheSurface)
+{
+    geo::Mesh mesh;
+    auto& interface = mesh.interface;
+    constexpr int kSide = 9;
+    auto id = interface.add_vertex_property<int>("v:id", -1);
+    std::vector<geo::VertexHandle> grid(kSide * kSide);
+    // Vertices are inserted in a scrambled order so the initial numbering has no locality.
+    for (int i = 0; i < kSide * kSide; ++i)
+    {
+        const int cell = (i * 31) % (kSide * kSide);
+        grid[static_cast<std::size_t>(cell)] = interface.add_vertex(
+            {static_cast<float>(cell % kSide), static_cast<float>(cell / kSide), 0.0F});
+        id[grid[static_cast<std::size_t>(cell)]] = cell;
+    }
+
+    // Quads and triangle pairs mixed, tagged with their lowest corner.
+    auto tag = interface.add_face_property<int>("f:tag", -1);
+    for (int y = 0; y + 1 < kSide; ++y)
+    {
+        for (int x = 0; x + 1 < kSide; ++x)
+        {
+            const auto v = [&](int dx, int dy) { return grid[static_cast<std::size_t>((y + dy) * kSide + x + dx)]; };
+            if ((x + y) % 3 == 0)
+            {
+                tag[*interface.add_quad(v(0, 0), v(1, 0), v(1, 1), v(0, 1))] = y * kSide + x;
+            }
+            else
+            {
+                tag[*interface.add_triangle(v(0, 0), v(1, 0), v(1, 1))] = y * kSide + x;
+                tag[*interface.add_triangle(v(0, 0), v(1, 1), v(0, 1))] = -(y * kSide + x);
+            }
+        }
+    }
+    auto edge_key = interface.add_edge_property<int>("e:key", -1);
+    for (const geo::EdgeHandle e : interface.edges())
+    {
+        const int a = id[interface.from_vertex(interface.halfedge(e, 0))];
+        const int b = id[interface.to_vertex(interface.halfedge(e, 0))];
+        edge_key[e] = std::min(a, b) * 1000 + std::max(a, b);
+    }
+
+    const auto face_corners = [&](geo::FaceHandle f)
+    {
+        std::vector<int> corners;
+        for (const geo::VertexHandle v : interface.vertices(f))
+        {
+            corners.push_back(id[v]);
+        }
+        std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+        return corners;
+    };
+    std::vector<std::pair<int, std::vector<int>>> before;
+    for (const geo::FaceHandle f : interface.faces())
+    {
+        before.emplace_back(tag[f], face_corners(f));
+    }
+    const std::size_t edge_count = interface.edge_count();
+
+    interface.optimize_locality();
+
+    ASSERT_EQ(interface.vertices_size(), static_cast<std::size_t>(kSide * kSide));
+    ASSERT_EQ(interface.faces_size(), before.size());
+    ASSERT_EQ(interface.edges_size(), edge_count);
+    for (const geo::VertexHandle v : interface.vertices())
+    {
+        const auto& p = interface.position(v);
+        EXPECT_EQ(id[v], static_cast<int>(p[0]) + kSide * static_cast<int>(p[1]));
+    }
+    for (const geo::EdgeHandle e : interface.edges())
+    {
+        const int a = id[interface.from_vertex(interface.halfedge(e, 0))];
+        const int b = id[interface.to_vertex(interface.halfedge(e, 0))];
+        EXPECT_EQ(edge_key[e], std::min(a, b) * 1000 + std::max(a, b));
+    }
+    for (const geo::HalfedgeHandle h : interface.halfedges())
+    {
+        EXPECT_EQ(interface.prev_halfedge(interface.next_halfedge(h)), h);
+        EXPECT_EQ(interface.opposite_halfedge(interface.opposite_halfedge(h)), h);
+    }
+
+    std::vector<std::pair<int, std::vector<int>>> after;
+    for (const geo::FaceHandle f : interface.faces())
+    {
+        after.emplace_back(tag[f], face_corners(f));
+    }
+    std::sort(before.begin(), before.end());
+    std::sort(after.begin(), after.end());
+    EXPECT_EQ(after, before);
+
+    // Vertices are numbered in the order the new face order first touches them.
+    int next_new = 0;
+    for (const geo::FaceHandle f : interface.faces())
+    {
+        for (const geo::VertexHandle v : interface.vertices(f))
+        {
+            EXPECT_LE(static_cast<int>(v.index()), next_new);
+            next_new = std::max(next_new, static_cast<int>(v.index()) + 1);
+        }
+    }
+}
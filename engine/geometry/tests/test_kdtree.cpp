@@ -3,9 +3,11 @@
 #include "engine/geometry/kdtree/kdtree.hpp"
 #include "engine/geometry/properties/property_set.hpp"
 #include "engine/geometry/random.hpp"
+#include "engine/math/parallel.hpp"
 #include "engine/math/vector.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <random>
 #include <vector>
@@ -92,7 +94,7 @@ TEST(KdTree, QueryAabbMatchesBruteForce)
 
     geo::PropertySet elements;
     auto position_property = elements.add<math::vec3>("e:position", {});
-    position_property.vector() = pts;
+    position_property.vector().assign(pts.begin(), pts.end());
 
     geo::KdTree tree;
     ASSERT_TRUE(tree.build(position_property, 16, 24));
@@ -125,7 +127,7 @@ TEST(KdTree, QueryRadiusMatchesBruteForce)
 
     geo::PropertySet elements;
     auto position_property = elements.add<math::vec3>("e:position", {});
-    position_property.vector() = pts;
+    position_property.vector().assign(pts.begin(), pts.end());
 
     geo::KdTree tree;
     ASSERT_TRUE(tree.build(position_property, 12, 32));
@@ -156,7 +158,7 @@ TEST(KdTree, QueryKnnMatchesBruteForce)
 
     geo::PropertySet elements;
     auto position_property = elements.add<math::vec3>("e:position", {});
-    position_property.vector() = pts;
+    position_property.vector().assign(pts.begin(), pts.end());
 
     geo::KdTree tree;
     ASSERT_TRUE(tree.build(position_property, 10, 32));
@@ -185,7 +187,7 @@ TEST(KdTree, QueryNearestMatchesBruteForce)
 
     geo::PropertySet elements;
     auto position_property = elements.add<math::vec3>("e:position", {});
-    position_property.vector() = pts;
+    position_property.vector().assign(pts.begin(), pts.end());
 
     geo::KdTree tree;
     ASSERT_TRUE(tree.build(position_property, 8, 32));
@@ -210,3 +212,287 @@ TEST(KdTree, QueryNearestMatchesBruteForce)
         EXPECT_EQ(actual, expected);
     }
 }
+
+TEST(KdTree, FlattenedLayoutIsDepthFirstAndLeafOrdered)
+{
+    Rng rng(5);
+    const auto pts = generate_points(2000, rng);
+
+    geo::PropertySet elements;
+    auto position_property = elements.add<math::vec3>("e:position", {});
+    position_property.vector().assign(pts.begin(), pts.end());
+
+    geo::KdTree tree;
+    ASSERT_TRUE(tree.build(position_property, 8, 32));
+    ASSERT_TRUE(tree.validate_structure());
+    static_assert(sizeof(geo::KdTree::Node) == 16 && alignof(geo::KdTree::Node) == 16);
+
+    // Leaves visited in node order cover the leaf-ordered point slots back to back.
+    std::size_t next_slot = 0;
+    std::size_t leaves = 0;
+    for (const auto& node : tree.nodes())
+    {
+        if (node.is_leaf())
+        {
+            EXPECT_EQ(node.offset, next_slot);
+            EXPECT_LE(node.count, 8u);
+            next_slot += node.count;
+            ++leaves;
+        }
+    }
+    EXPECT_EQ(next_slot, pts.size());
+    EXPECT_EQ(tree.node_count(), 2 * leaves - 1);
+
+    auto sorted = tree.get_point_indices();
+    std::sort(sorted.begin(), sorted.end());
+    for (std::size_t i = 0; i < sorted.size(); ++i)
+    {
+        ASSERT_EQ(sorted[i], i);
+    }
+
+    // Node properties follow the flattened node array.
+    auto visits = tree.add_node_property<int>("n:visits", 0);
+    EXPECT_EQ(visits.vector().size(), tree.node_count());
+}
+
+TEST(KdTree, CoincidentPointsFormSingleLeaf)
+{
+    geo::PropertySet elements;
+    auto position_property = elements.add<math::vec3>("e:position", {});
+    position_property.vector().assign(100, math::vec3{0.5f, -0.25f, 2.0f});
+
+    geo::KdTree tree;
+    ASSERT_TRUE(tree.build(position_property, 4, 16));
+    ASSERT_TRUE(tree.validate_structure());
+    EXPECT_EQ(tree.node_count(), 1u);
+
+    std::vector<std::size_t> hits;
+    tree.query_radius({0.5f, -0.25f, 2.0f}, 0.0f, hits);
+    EXPECT_EQ(hits.size(), 100u);
+    tree.query_knn({0.0f, 0.0f, 0.0f}, 3, hits);
+    EXPECT_EQ(hits, (std::vector<std::size_t>{0, 1, 2}));
+
+    std::size_t nearest = 0;
+    tree.query_nearest({1.0f, 1.0f, 1.0f}, nearest);
+    EXPECT_EQ(nearest, 0u);
+}
+
+TEST(KdTree, SurfaceAreaSplitsMatchBruteForce)
+{
+    Rng rng(77);
+    const auto pts = generate_points(3000, rng);
+
+    geo::PropertySet elements;
+    auto position_property = elements.add<math::vec3>("e:position", {});
+    position_property.vector().assign(pts.begin(), pts.end());
+
+    geo::KdTree tree;
+    ASSERT_TRUE(tree.build(position_property, 6, 32, geo::KdTree::SplitPoint::SurfaceAreaHeuristic));
+    ASSERT_TRUE(tree.validate_structure());
+    EXPECT_EQ(tree.get_split_point(), geo::KdTree::SplitPoint::SurfaceAreaHeuristic);
+
+    std::vector<std::size_t> actual;
+    for (int i = 0; i < 32; ++i)
+    {
+        const math::vec3 query = random_point(rng);
+        tree.query_radius(query, 0.2f, actual);
+        std::sort(actual.begin(), actual.end());
+        EXPECT_EQ(actual, brute_force_radius(pts, query, 0.2f));
+
+        tree.query_knn(query, 7, actual);
+        std::sort(actual.begin(), actual.end());
+        EXPECT_EQ(actual, brute_force_knn(pts, query, 7));
+    }
+}
+
+TEST(KdTree, ParallelBuildIsDeterministic)
+{
+    // Large enough for the histogram-based top-level partition and many independently built subtrees.
+    Rng rng(31);
+    const auto pts = generate_points(70000, rng);
+
+    geo::PropertySet elements;
+    auto position_property = elements.add<math::vec3>("e:position", {});
+    position_property.vector().assign(pts.begin(), pts.end());
+
+    for (auto split : {geo::KdTree::SplitPoint::Median, geo::KdTree::SplitPoint::SurfaceAreaHeuristic})
+    {
+        engine::math::parallel::set_max_concurrency(1);
+        geo::KdTree serial;
+        ASSERT_TRUE(serial.build(position_property, 16, 32, split));
+        engine::math::parallel::set_max_concurrency(0);
+        geo::KdTree parallel;
+        ASSERT_TRUE(parallel.build(position_property, 16, 32, split));
+
+        ASSERT_TRUE(parallel.validate_structure());
+        EXPECT_EQ(parallel.get_point_indices(), serial.get_point_indices());
+        ASSERT_EQ(parallel.node_count(), serial.node_count());
+        for (std::size_t i = 0; i < serial.node_count(); ++i)
+        {
+            const auto& a = parallel.nodes()[i];
+            const auto& b = serial.nodes()[i];
+            ASSERT_EQ(a.axis, b.axis);
+            ASSERT_EQ(a.offset, b.offset);
+            ASSERT_EQ(a.count, b.count);
+            ASSERT_EQ(a.split_position, b.split_position);
+        }
+
+        std::vector<std::size_t> actual;
+        const math::vec3 query{0.1f, -0.2f, 0.3f};
+        parallel.query_knn(query, 12, actual);
+        std::sort(actual.begin(), actual.end());
+        EXPECT_EQ(actual, brute_force_knn(pts, query, 12));
+    }
+}
+
+TEST(KdTree, BatchedQueriesMatchSingleQueries)
+{
+    Rng rng(47);
+    const auto pts = generate_points(4000, rng);
+    const auto queries = generate_points(1500, rng);
+
+    geo::PropertySet elements;
+    auto position_property = elements.add<math::vec3>("e:position", {});
+    position_property.vector().assign(pts.begin(), pts.end());
+
+    geo::KdTree tree;
+    ASSERT_TRUE(tree.build(position_property, 8, 24));
+
+    geo::NeighborList knn;
+    tree.query_knn_batch(queries, 6, knn);
+    geo::NeighborList radius;
+    tree.query_radius_batch(queries, 0.2f, radius);
+    ASSERT_EQ(knn.query_count(), queries.size());
+    ASSERT_EQ(radius.query_count(), queries.size());
+
+    std::vector<std::size_t> expected;
+    for (std::size_t q = 0; q < queries.size(); ++q)
+    {
+        tree.query_knn(queries[q], 6, expected);
+        const auto row = knn.neighbors(q);
+        ASSERT_EQ(std::vector<std::size_t>(row.begin(), row.end()), expected);
+        for (std::size_t j = 0; j < row.size(); ++j)
+        {
+            EXPECT_FLOAT_EQ(knn.squared_distances(q)[j], math::length_squared(pts[row[j]] - queries[q]));
+        }
+
+        tree.query_radius(queries[q], 0.2f, expected);
+        const auto within = radius.neighbors(q);
+        ASSERT_EQ(std::vector<std::size_t>(within.begin(), within.end()), expected);
+        for (const float d2 : radius.squared_distances(q))
+        {
+            EXPECT_LE(d2, 0.2f * 0.2f);
+        }
+    }
+
+    tree.query_knn_batch({}, 6, knn);
+    EXPECT_EQ(knn.query_count(), 0U);
+    EXPECT_TRUE(knn.indices.empty());
+}
+
+TEST(KdTree, ScratchQueriesReuseBuffersAfterWarmUp)
+{
+    Rng rng(53);
+    const auto pts = generate_points(3000, rng);
+    const auto queries = generate_points(200, rng);
+
+    geo::PropertySet elements;
+    auto position_property = elements.add<math::vec3>("e:position", {});
+    position_property.vector().assign(pts.begin(), pts.end());
+
+    geo::KdTree tree;
+    ASSERT_TRUE(tree.build(position_property, 8, 24));
+
+    geo::QueryScratch scratch;
+    const auto run_all = [&]()
+    {
+        std::vector<std::size_t> expected;
+        for (const auto& q : queries)
+        {
+            const geo::Aabb region{.min = q - math::vec3{0.2f}, .max = q + math::vec3{0.2f}};
+            tree.query(region, expected);
+            auto hits = tree.query(region, scratch);
+            EXPECT_EQ(std::vector<std::size_t>(hits.begin(), hits.end()), expected);
+
+            tree.query_radius(q, 0.25f, expected);
+            hits = tree.query_radius(q, 0.25f, scratch);
+            EXPECT_EQ(std::vector<std::size_t>(hits.begin(), hits.end()), expected);
+
+            tree.query_knn(q, 10, expected);
+            hits = tree.query_knn(q, 10, scratch);
+            EXPECT_EQ(std::vector<std::size_t>(hits.begin(), hits.end()), expected);
+
+            std::size_t nearest = 0;
+            tree.query_nearest(q, nearest);
+            EXPECT_EQ(tree.query_nearest(q, scratch), nearest);
+        }
+    };
+
+    run_all();
+    const auto* stack = scratch.node_stack.data();
+    const auto* cells = scratch.cells.data();
+    const auto* neighbors = scratch.neighbors.data();
+    const auto* results = scratch.results.data();
+    run_all();
+    EXPECT_EQ(scratch.node_stack.data(), stack);
+    EXPECT_EQ(scratch.cells.data(), cells);
+    EXPECT_EQ(scratch.neighbors.data(), neighbors);
+    EXPECT_EQ(scratch.results.data(), results);
+}
+
+TEST(KdTree, ApproximateKnnHonoursErrorBoundAndLeafBudget)
+{
+    Rng rng(71);
+    const auto pts = generate_points(8000, rng);
+    const auto queries = generate_points(60, rng);
+
+    geo::PropertySet elements;
+    auto position_property = elements.add<math::vec3>("e:position", {});
+    position_property.vector().assign(pts.begin(), pts.end());
+
+    geo::KdTree tree;
+    ASSERT_TRUE(tree.build(position_property, 8, 32));
+
+    constexpr std::size_t k = 8;
+    std::vector<float> exact_d2;
+    const auto check_ranks = [&](const math::vec3& q, const std::vector<std::size_t>& approx, float epsilon)
+    {
+        ASSERT_EQ(approx.size(), k);
+        for (std::size_t i = 0; i < k; ++i)
+        {
+            const float d = std::sqrt(math::length_squared(pts[approx[i]] - q));
+            EXPECT_LE(d, (1.0f + epsilon) * std::sqrt(exact_d2[i]) * (1.0f + 1e-5f) + 1e-6f);
+        }
+    };
+
+    geo::QueryScratch scratch;
+    std::vector<std::size_t> approx;
+    std::size_t exact_leaves = 0;
+    std::size_t approx_leaves = 0;
+    for (const auto& q : queries)
+    {
+        exact_d2.clear();
+        for (const auto i : brute_force_knn(pts, q, k)) exact_d2.push_back(math::length_squared(pts[i] - q));
+        std::sort(exact_d2.begin(), exact_d2.end());
+
+        const auto exact_stats = tree.query_knn_approximate(q, k, {}, approx);
+        EXPECT_EQ(exact_stats.achieved_epsilon, 0.0f);
+        tree.query_knn(q, k, scratch);
+        EXPECT_EQ(approx, std::vector<std::size_t>(scratch.results.begin(), scratch.results.end()));
+        exact_leaves += exact_stats.leaves_visited;
+
+        const auto stats = tree.query_knn_approximate(q, k, {.epsilon = 0.5f}, approx);
+        EXPECT_LE(stats.achieved_epsilon, 0.5f);
+        check_ranks(q, approx, stats.achieved_epsilon);
+        approx_leaves += stats.leaves_visited;
+
+        const auto budget = tree.query_knn_approximate(q, k, {.max_leaves = 2}, scratch);
+        EXPECT_LE(budget.leaves_visited, 2U);
+        if (std::isfinite(budget.achieved_epsilon))
+        {
+            check_ranks(q, std::vector<std::size_t>(scratch.results.begin(), scratch.results.end()),
+                        budget.achieved_epsilon);
+        }
+    }
+    EXPECT_LT(approx_leaves, exact_leaves);
+}
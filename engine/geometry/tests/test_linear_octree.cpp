@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include "engine/geometry/octree/linear_octree.hpp"
+#include "engine/geometry/properties/property_set.hpp"
+#include "engine/geometry/random.hpp"
+#include "engine/geometry/utils/radix_sort.hpp"
+#include "engine/geometry/utils/shape_interactions.hpp"
+#include "engine/math/vector.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace geo = engine::geometry;
+namespace math = engine::math;
+
+namespace
+{
+    using Rng = geo::RandomEngine;
+
+    // Uniform points plus a few tight clusters, so leaves end up at very different depths.
+    std::vector<math::vec3> generate_clustered_points(std::size_t count, Rng& rng)
+    {
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        std::normal_distribution<float> spread(0.0f, 1e-3f);
+        std::vector<math::vec3> points(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (i % 3 == 0)
+            {
+                const float center = 0.25f * static_cast<float>(i % 4);
+                points[i] = {center + spread(rng), center + spread(rng), -center + spread(rng)};
+            }
+            else
+            {
+                points[i] = {dist(rng), dist(rng), dist(rng)};
+            }
+        }
+        return points;
+    }
+
+    std::vector<std::pair<float, std::size_t>> brute_force_distances(const std::vector<math::vec3>& points,
+                                                                     const math::vec3& query)
+    {
+        std::vector<std::pair<float, std::size_t>> distances;
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            distances.emplace_back(math::length_squared(points[i] - query), i);
+        }
+        std::sort(distances.begin(), distances.end());
+        return distances;
+    }
+}
+
+TEST(RadixSort, MatchesStableSortOnKeysWithDuplicates)
+{
+    Rng rng(3);
+    std::uniform_int_distribution<std::uint64_t> dist(0, (std::uint64_t{1} << 40) - 1);
+    std::vector<std::uint64_t> keys(50000);
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        keys[i] = i % 5 == 0 ? keys[i / 2] : dist(rng);
+    }
+    std::vector<std::size_t> values(keys.size());
+    std::iota(values.begin(), values.end(), 0);
+
+    std::vector<std::size_t> expected = values;
+    std::stable_sort(expected.begin(), expected.end(), [&](std::size_t a, std::size_t b) { return keys[a] < keys[b]; });
+
+    geo::utils::ParallelRadixSort(keys, values, 40);
+    EXPECT_EQ(values, expected);
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+}
+
+TEST(LinearOctree, QueriesMatchBruteForce)
+{
+    Rng rng(11);
+    const auto points = generate_clustered_points(6000, rng);
+    geo::PropertySet props;
+    auto positions = props.add<math::vec3>("v:position", math::vec3(0.0f));
+    positions.vector().assign(points.begin(), points.end());
+
+    std::uniform_real_distribution<float> dist(-1.2f, 1.2f);
+    for (const std::size_t max_points : {1u, 8u, 64u})
+    {
+        geo::LinearOctree tree;
+        ASSERT_TRUE(tree.build(positions, max_points));
+        ASSERT_TRUE(tree.validate_structure());
+
+        for (int q = 0; q < 40; ++q)
+        {
+            const math::vec3 p(dist(rng), dist(rng), dist(rng));
+            const auto distances = brute_force_distances(points, p);
+
+            const geo::Aabb region{.min = p - math::vec3(0.3f), .max = p + math::vec3(0.3f)};
+            std::vector<std::size_t> expected;
+            for (std::size_t i = 0; i < points.size(); ++i)
+            {
+                if (geo::Contains(region, points[i])) expected.push_back(i);
+            }
+            std::vector<std::size_t> actual;
+            tree.query(region, actual);
+            std::sort(actual.begin(), actual.end());
+            EXPECT_EQ(actual, expected);
+
+            expected.clear();
+            for (const auto& [d2, i] : distances)
+            {
+                if (d2 <= 0.4f * 0.4f) expected.push_back(i);
+            }
+            std::sort(expected.begin(), expected.end());
+            tree.query_radius(p, 0.4f, actual);
+            std::sort(actual.begin(), actual.end());
+            EXPECT_EQ(actual, expected);
+
+            tree.query_knn(p, 7, actual);
+            ASSERT_EQ(actual.size(), 7u);
+            for (std::size_t i = 0; i < actual.size(); ++i)
+            {
+                EXPECT_EQ(actual[i], distances[i].second);
+            }
+
+            std::size_t nearest = 0;
+            tree.query_nearest(p, nearest);
+            EXPECT_EQ(nearest, distances.front().second);
+        }
+    }
+}
+
+TEST(LinearOctree, HandlesDegenerateInputs)
+{
+    geo::PropertySet props;
+    auto positions = props.add<math::vec3>("v:position", math::vec3(0.0f));
+
+    geo::LinearOctree tree;
+    EXPECT_FALSE(tree.build(positions, 4));
+    EXPECT_TRUE(tree.validate_structure());
+
+    // Coincident points cannot be separated: subdivision stops at max_depth with one overfull leaf.
+    positions.vector().assign(50, math::vec3(0.5f, -2.0f, 3.0f));
+    ASSERT_TRUE(tree.build(positions, 4, 6));
+    ASSERT_TRUE(tree.validate_structure());
+    EXPECT_EQ(tree.node_count(), 7u);
+    EXPECT_EQ(tree.nodes().back().count, 50u);
+
+    // A single leaf holds everything while it fits.
+    Rng rng(5);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    positions.vector().resize(10);
+    for (auto& p : positions.vector()) p = {dist(rng), dist(rng), dist(rng)};
+    ASSERT_TRUE(tree.build(positions, 16));
+    ASSERT_TRUE(tree.validate_structure());
+    EXPECT_EQ(tree.node_count(), 1u);
+
+    std::vector<std::size_t> all;
+    tree.query(tree.bounds(), all);
+    std::sort(all.begin(), all.end());
+    std::vector<std::size_t> expected(10);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(all, expected);
+}
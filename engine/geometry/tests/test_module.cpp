@@ -1,6 +1,17 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 #include "engine/geometry/api.hpp"
+#include "engine/geometry/utils/hilbert.hpp"
 
 TEST(GeometryModule, ModuleNameMatchesNamespace) {
     EXPECT_EQ(engine::geometry::module_name(), "geometry");
@@ -33,3 +44,228 @@ TEST(GeometryModule, UpdateBoundsZeroesEmptyMeshes) {
         EXPECT_FLOAT_EQ(mesh.bounds.max[axis], 0.0F);
     }
 }
+
+namespace {
+
+engine::geometry::SurfaceMesh make_wavy_grid(std::uint32_t cells) {
+    engine::geometry::SurfaceMesh mesh;
+    const std::uint32_t row = cells + 1;
+    for (std::uint32_t y = 0; y <= cells; ++y) {
+        for (std::uint32_t x = 0; x <= cells; ++x) {
+            const float fx = static_cast<float>(x);
+            const float fy = static_cast<float>(y);
+            mesh.positions.emplace_back(fx, 0.25F * std::sin(0.37F * fx) * std::cos(0.23F * fy), fy);
+        }
+    }
+    for (std::uint32_t y = 0; y < cells; ++y) {
+        for (std::uint32_t x = 0; x < cells; ++x) {
+            const std::uint32_t a = y * row + x;
+            mesh.indices.insert(mesh.indices.end(), {a, a + row + 1, a + 1, a, a + row, a + row + 1});
+        }
+    }
+    // An out-of-range triangle and an isolated vertex exercise the skip and the +Y fallback.
+    mesh.indices.insert(mesh.indices.end(), {0U, 1U, 1000000U});
+    mesh.positions.emplace_back(0.0F, 5.0F, 0.0F);
+    return mesh;
+}
+
+// The serial scatter the parallel updates have to reproduce.
+std::vector<engine::math::vec3> reference_normals(const engine::geometry::SurfaceMesh& mesh) {
+    std::vector<engine::math::vec3> normals(mesh.positions.size(), engine::math::vec3{0.0F, 0.0F, 0.0F});
+    for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        const auto ia = mesh.indices[i];
+        const auto ib = mesh.indices[i + 1];
+        const auto ic = mesh.indices[i + 2];
+        if (ia >= normals.size() || ib >= normals.size() || ic >= normals.size()) {
+            continue;
+        }
+        const auto& a = mesh.positions[ia];
+        const auto normal =
+            engine::math::normalize(engine::math::cross(mesh.positions[ib] - a, mesh.positions[ic] - a));
+        normals[ia] += normal;
+        normals[ib] += normal;
+        normals[ic] += normal;
+    }
+    for (auto& normal : normals) {
+        normal = engine::math::dot(normal, normal) > 0.0F ? engine::math::normalize(normal)
+                                                          : engine::math::vec3{0.0F, 1.0F, 0.0F};
+    }
+    return normals;
+}
+
+}  // namespace
+
+TEST(GeometryModule, ParallelAndIncrementalNormalsMatchSerialScatter) {
+    auto mesh = make_wavy_grid(120);
+    const auto adjacency = engine::geometry::build_vertex_triangle_adjacency(mesh);
+    ASSERT_EQ(adjacency.offsets.size(), mesh.positions.size() + 1);
+    EXPECT_EQ(adjacency.triangles.size(), 3U * 120U * 120U * 2U);
+
+    engine::geometry::recompute_vertex_normals(mesh);
+    EXPECT_EQ(mesh.normals, reference_normals(mesh));
+    EXPECT_EQ(mesh.normals.back(), (engine::math::vec3{0.0F, 1.0F, 0.0F}));
+
+    mesh.normals.clear();
+    engine::geometry::recompute_vertex_normals(mesh, adjacency);
+    EXPECT_EQ(mesh.normals, reference_normals(mesh));
+
+    std::vector<std::uint32_t> dirty;
+    for (std::uint32_t v = 0; v < mesh.positions.size(); v += 97) {
+        mesh.positions[v][1] += 0.5F;
+        dirty.push_back(v);
+    }
+    dirty.push_back(7U);
+    dirty.push_back(7U);
+    engine::geometry::recompute_vertex_normals(mesh, adjacency, dirty);
+    EXPECT_EQ(mesh.normals, reference_normals(mesh));
+
+    // Reused scratch must come back clean after every update.
+    engine::geometry::NormalUpdateScratch scratch;
+    for (const std::uint32_t first : {3U, 11U}) {
+        dirty.clear();
+        for (std::uint32_t v = first; v < mesh.positions.size(); v += 53) {
+            mesh.positions[v][1] -= 0.25F;
+            dirty.push_back(v);
+        }
+        dirty.push_back(first);
+        engine::geometry::recompute_vertex_normals(mesh, adjacency, dirty, scratch);
+        EXPECT_EQ(mesh.normals, reference_normals(mesh));
+        EXPECT_TRUE(std::all_of(scratch.queued.begin(), scratch.queued.end(), [](std::uint8_t q) { return q == 0; }));
+    }
+
+    auto other = engine::geometry::make_unit_quad();
+    EXPECT_THROW(engine::geometry::recompute_vertex_normals(other, adjacency), std::invalid_argument);
+}
+
+TEST(GeometryModule, ParallelBoundsMatchSerialMinMax) {
+    engine::geometry::SurfaceMesh mesh;
+    for (std::uint32_t i = 0; i < 100003U; ++i) {
+        const float t = static_cast<float>(i);
+        mesh.positions.emplace_back(std::sin(t) * t, std::cos(0.5F * t) - 0.001F * t, std::fmod(t * 0.618F, 37.0F));
+    }
+    engine::geometry::update_bounds(mesh);
+
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        float lo = mesh.positions.front()[axis];
+        float hi = lo;
+        for (const auto& position : mesh.positions) {
+            lo = std::min(lo, position[axis]);
+            hi = std::max(hi, position[axis]);
+        }
+        EXPECT_EQ(mesh.bounds.min[axis], lo);
+        EXPECT_EQ(mesh.bounds.max[axis], hi);
+    }
+}
+
+TEST(GeometryModule, HilbertCurveStepsBetweenFaceNeighbours) {
+    std::vector<std::pair<std::uint64_t, std::array<std::uint32_t, 3>>> cells;
+    for (std::uint32_t z = 0; z < 4; ++z) {
+        for (std::uint32_t y = 0; y < 4; ++y) {
+            for (std::uint32_t x = 0; x < 4; ++x) {
+                cells.push_back({engine::geometry::utils::HilbertEncode(x, y, z), {x, y, z}});
+            }
+        }
+    }
+    std::sort(cells.begin(), cells.end());
+    for (std::size_t i = 0; i < cells.size(); ++i) {
+        EXPECT_EQ(cells[i].first, i);
+        if (i > 0) {
+            std::uint32_t step = 0;
+            for (std::size_t axis = 0; axis < 3; ++axis) {
+                const auto a = cells[i].second[axis];
+                const auto b = cells[i - 1].second[axis];
+                step += a > b ? a - b : b - a;
+            }
+            EXPECT_EQ(step, 1U);
+        }
+    }
+}
+
+TEST(GeometryModule, AverageCacheMissRatioCountsFifoMisses) {
+    using engine::geometry::utils::AverageCacheMissRatio;
+    const std::vector<std::uint32_t> repeated{0, 1, 2, 0, 1, 2};
+    // Three entries still hold the first triangle; two have evicted each vertex before it comes back.
+    EXPECT_DOUBLE_EQ(AverageCacheMissRatio(repeated, 3, 3), 1.5);
+    EXPECT_DOUBLE_EQ(AverageCacheMissRatio(repeated, 3, 2), 3.0);
+
+    // Vertex 3 enters fourth and evicts vertex 0 only, so vertex 2 still hits after 0 is reloaded; the
+    // out-of-range index always misses.
+    const std::vector<std::uint32_t> shifted{0, 1, 2, 1, 2, 3, 0, 2, 7};
+    EXPECT_DOUBLE_EQ(AverageCacheMissRatio(shifted, 4, 3), 6.0 / 3.0);
+}
+
+TEST(GeometryModule, OptimizeLocalityLowersCacheMissesAndKeepsTriangles) {
+    auto mesh = make_wavy_grid(40);
+    const std::size_t vertex_count = mesh.positions.size();
+    const std::size_t triangle_count = mesh.indices.size() / 3;
+
+    // Scramble vertices and triangles, keeping the out-of-range triangle last.
+    std::vector<std::uint32_t> scramble(vertex_count);
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        scramble[v] = static_cast<std::uint32_t>((v * 769U) % vertex_count);
+    }
+    std::vector<engine::math::vec3> positions(vertex_count);
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        positions[scramble[v]] = mesh.positions[v];
+    }
+    mesh.positions = positions;
+    std::vector<std::uint32_t> indices;
+    for (std::size_t i = 0; i + 1 < triangle_count; ++i) {
+        const std::size_t t = (i * 101U) % (triangle_count - 1);
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+            indices.push_back(scramble[mesh.indices[3 * t + corner]]);
+        }
+    }
+    indices.insert(indices.end(), mesh.indices.end() - 3, mesh.indices.end());
+    indices[indices.size() - 3] = scramble[indices[indices.size() - 3]];
+    indices[indices.size() - 2] = scramble[indices[indices.size() - 2]];
+    mesh.indices = indices;
+    mesh.normals.assign(vertex_count, engine::math::vec3{0.0F, 1.0F, 0.0F});
+    mesh.normals[scramble[vertex_count - 1]] = engine::math::vec3{1.0F, 0.0F, 0.0F};
+
+    // Triangles as position triples starting at their smallest corner, so winding is compared too.
+    const auto triangles = [](const engine::geometry::SurfaceMesh& m) {
+        std::vector<std::array<float, 9>> result;
+        for (std::size_t t = 0; t + 1 < m.indices.size() / 3; ++t) {
+            std::array<engine::math::vec3, 3> corners{};
+            for (std::size_t corner = 0; corner < 3; ++corner) {
+                corners[corner] = m.positions[m.indices[3 * t + corner]];
+            }
+            const auto less = [](const engine::math::vec3& a, const engine::math::vec3& b) {
+                return std::make_tuple(a[0], a[1], a[2]) < std::make_tuple(b[0], b[1], b[2]);
+            };
+            std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end(), less), corners.end());
+            std::array<float, 9> flat{};
+            for (std::size_t k = 0; k < 9; ++k) {
+                flat[k] = corners[k / 3][k % 3];
+            }
+            result.push_back(flat);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    const auto before = triangles(mesh);
+    const std::span<const std::uint32_t> valid(mesh.indices.data(), mesh.indices.size() - 3);
+    const double scrambled_acmr = engine::geometry::utils::AverageCacheMissRatio(valid, vertex_count);
+
+    const auto order = engine::geometry::optimize_locality(mesh);
+
+    ASSERT_EQ(order.vertices.size(), vertex_count);
+    ASSERT_EQ(order.triangles.size(), triangle_count);
+    EXPECT_EQ(order.triangles.back(), triangle_count - 1);
+    std::vector<std::uint32_t> sorted = order.vertices;
+    std::sort(sorted.begin(), sorted.end());
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        EXPECT_EQ(sorted[v], v);
+    }
+
+    EXPECT_EQ(triangles(mesh), before);
+    EXPECT_EQ(mesh.indices.back(), 1000000U);
+    EXPECT_EQ(mesh.positions.back(), (engine::math::vec3{0.0F, 5.0F, 0.0F}));
+    EXPECT_EQ(mesh.normals.back(), (engine::math::vec3{1.0F, 0.0F, 0.0F}));
+
+    const std::span<const std::uint32_t> reordered(mesh.indices.data(), mesh.indices.size() - 3);
+    const double optimized_acmr = engine::geometry::utils::AverageCacheMissRatio(reordered, vertex_count);
+    EXPECT_LT(optimized_acmr, 0.5 * scrambled_acmr);
+    EXPECT_LT(optimized_acmr, 0.8);
+}
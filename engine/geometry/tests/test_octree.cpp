@@ -4,6 +4,7 @@
 #include "engine/geometry/properties/property_set.hpp"
 #include "engine/geometry/utils/shape_interactions.hpp"
 #include "engine/geometry/shapes.hpp"
+#include "engine/math/parallel.hpp"
 #include "engine/math/vector.hpp"
 
 #include <algorithm>
@@ -68,14 +69,15 @@ namespace
         return distances;
     }
 
-    std::array<geo::Octree::SplitPolicy, 6> test_policies()
+    std::array<geo::Octree::SplitPolicy, 8> test_policies()
     {
-        std::array<geo::Octree::SplitPolicy, 6> policies{};
+        std::array<geo::Octree::SplitPolicy, 8> policies{};
         std::size_t idx = 0;
         for (auto split_point : {
                  geo::Octree::SplitPoint::Center,
                  geo::Octree::SplitPoint::Mean,
-                 geo::Octree::SplitPoint::Median })
+                 geo::Octree::SplitPoint::Median,
+                 geo::Octree::SplitPoint::SurfaceAreaHeuristic })
         {
             for (bool tight : {false, true})
             {
@@ -102,7 +104,7 @@ namespace
 
         geo::PropertySet elements;
         auto aabb_property = elements.add<geo::Aabb>("e:aabb", {});
-        aabb_property.vector() = boxes;
+        aabb_property.vector().assign(boxes.begin(), boxes.end());
 
         const auto policies = test_policies();
 
@@ -239,7 +241,7 @@ TEST(Octree, QueryKnnMatchesBruteForce)
 
     geo::PropertySet elements;
     auto aabb_property = elements.add<geo::Aabb>("e:aabb", {});
-    aabb_property.vector() = boxes;
+    aabb_property.vector().assign(boxes.begin(), boxes.end());
 
     const auto policies = test_policies();
 
@@ -289,7 +291,7 @@ TEST(Octree, QueryNearestMatchesBruteForce)
 
     geo::PropertySet elements;
     auto aabb_property = elements.add<geo::Aabb>("e:aabb", {});
-    aabb_property.vector() = boxes;
+    aabb_property.vector().assign(boxes.begin(), boxes.end());
 
     const auto policies = test_policies();
 
@@ -313,3 +315,373 @@ TEST(Octree, QueryNearestMatchesBruteForce)
         }
     }
 }
+
+TEST(Octree, ParallelBuildIsDeterministic)
+{
+    // Large enough for parallel top-level passes and many independently built subtrees.
+    Rng rng(2024);
+    std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+    std::vector<geo::Aabb> boxes(70000);
+    for (auto& box : boxes)
+    {
+        const math::vec3 p{coord(rng), coord(rng), coord(rng)};
+        box = {.min = p, .max = p + math::vec3{0.05f}};
+    }
+
+    geo::PropertySet elements;
+    auto aabb_property = elements.add<geo::Aabb>("e:aabb", {});
+    aabb_property.vector().assign(boxes.begin(), boxes.end());
+
+    for (const auto& policy : test_policies())
+    {
+        // Tight children add the parallel bounds pass on top of the loose build, so they cover both.
+        if (!policy.tight_children)
+        {
+            continue;
+        }
+        engine::math::parallel::set_max_concurrency(1);
+        geo::Octree serial;
+        ASSERT_TRUE(serial.build(aabb_property, policy, 16, 12));
+        engine::math::parallel::set_max_concurrency(0);
+        geo::Octree parallel;
+        ASSERT_TRUE(parallel.build(aabb_property, policy, 16, 12));
+
+        ASSERT_TRUE(parallel.validate_structure());
+        EXPECT_EQ(parallel.get_element_indices(), serial.get_element_indices());
+        ASSERT_EQ(parallel.nodes.vector().size(), serial.nodes.vector().size());
+        for (std::size_t i = 0; i < serial.nodes.vector().size(); ++i)
+        {
+            const auto& a = parallel.nodes.vector()[i];
+            const auto& b = serial.nodes.vector()[i];
+            ASSERT_EQ(a.children, b.children);
+            ASSERT_EQ(a.first_element, b.first_element);
+            ASSERT_EQ(a.num_elements, b.num_elements);
+            ASSERT_EQ(a.num_straddlers, b.num_straddlers);
+        }
+
+        const geo::Aabb region{.min = math::vec3{-10.0f}, .max = math::vec3{12.5f}};
+        std::vector<std::size_t> actual;
+        parallel.query(region, actual);
+        std::sort(actual.begin(), actual.end());
+        EXPECT_EQ(actual, brute_force_intersection(boxes, region));
+    }
+}
+
+TEST(Octree, BatchedQueriesMatchBruteForce)
+{
+    Rng rng(61);
+    const auto boxes = generate_random_aabbs(400, rng);
+
+    geo::PropertySet elements;
+    auto aabb_property = elements.add<geo::Aabb>("e:aabb", {});
+    aabb_property.vector().assign(boxes.begin(), boxes.end());
+
+    geo::Octree tree;
+    ASSERT_TRUE(tree.build(aabb_property, test_policies()[5], 8, 12));
+
+    std::uniform_real_distribution<float> point_dist(-15.0f, 15.0f);
+    std::vector<math::vec3> queries(600);
+    for (auto& q : queries) q = math::vec3(point_dist(rng), point_dist(rng), point_dist(rng));
+
+    constexpr std::size_t k = 5;
+    constexpr float radius = 3.0f;
+    geo::NeighborList knn;
+    tree.query_knn_batch(queries, k, knn);
+    geo::NeighborList within;
+    tree.query_radius_batch(queries, radius, within);
+    ASSERT_EQ(knn.query_count(), queries.size());
+    ASSERT_EQ(within.query_count(), queries.size());
+
+    for (std::size_t q = 0; q < queries.size(); ++q)
+    {
+        const auto distances = brute_force_distances(boxes, queries[q]);
+
+        std::vector<std::size_t> expected;
+        for (std::size_t i = 0; i < k; ++i) expected.push_back(distances[i].second);
+        const auto row = knn.neighbors(q);
+        EXPECT_EQ(std::vector<std::size_t>(row.begin(), row.end()), expected);
+        for (std::size_t i = 0; i < k; ++i) EXPECT_FLOAT_EQ(knn.squared_distances(q)[i], distances[i].first);
+
+        expected.clear();
+        for (const auto& [d2, index] : distances)
+        {
+            if (d2 <= radius * radius) expected.push_back(index);
+        }
+        const auto hits = within.neighbors(q);
+        std::vector<std::size_t> actual(hits.begin(), hits.end());
+        std::sort(actual.begin(), actual.end());
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(actual, expected);
+    }
+}
+
+TEST(Octree, BatchedRayQueriesMatchBruteForce)
+{
+    Rng rng(71);
+    const auto boxes = generate_random_aabbs(300, rng);
+
+    geo::PropertySet elements;
+    auto aabb_property = elements.add<geo::Aabb>("e:aabb", {});
+    aabb_property.vector().assign(boxes.begin(), boxes.end());
+
+    geo::Octree tree;
+    ASSERT_TRUE(tree.build(aabb_property, test_policies()[0], 8, 12));
+
+    // More rays than one task holds, with a few axis-aligned ones that exercise the parallel-slab path.
+    std::vector<geo::Ray> rays(1100);
+    for (auto& ray : rays) geo::Random(ray, rng);
+    for (std::size_t i = 0; i < rays.size(); i += 37)
+    {
+        rays[i].direction = math::vec3(0.0f);
+        rays[i].direction[i % 3] = i % 2 == 0 ? 1.0f : -1.0f;
+    }
+
+    const auto check = [&](const geo::NeighborList& result)
+    {
+        ASSERT_EQ(result.query_count(), rays.size());
+        for (std::size_t r = 0; r < rays.size(); ++r)
+        {
+            std::vector<std::pair<float, std::size_t>> expected;
+            for (std::size_t i = 0; i < boxes.size(); ++i)
+            {
+                geo::Result hit{};
+                if (geo::Intersects(boxes[i], rays[r], &hit))
+                {
+                    expected.emplace_back(hit.t_min * hit.t_min * math::length_squared(rays[r].direction), i);
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+
+            const auto row = result.neighbors(r);
+            ASSERT_EQ(row.size(), expected.size());
+            for (std::size_t i = 0; i < row.size(); ++i)
+            {
+                EXPECT_EQ(row[i], expected[i].second);
+                EXPECT_NEAR(result.squared_distances(r)[i], expected[i].first, 1e-4f * (1.0f + expected[i].first));
+            }
+        }
+    };
+
+    geo::NeighborList result;
+    tree.query_ray_batch(rays, result);
+    check(result);
+    tree.query_ray_batch(rays, result, geo::RayBatchMode::Stream);
+    check(result);
+    tree.query_ray_batch<4>(rays, result, geo::RayBatchMode::Packet);
+    check(result);
+    tree.query_ray_batch<4>(rays, result, geo::RayBatchMode::Stream);
+    check(result);
+}
+
+TEST(Octree, ScratchQueriesReuseBuffersAfterWarmUp)
+{
+    Rng rng(67);
+    const auto boxes = generate_random_aabbs(300, rng);
+
+    geo::PropertySet elements;
+    auto aabb_property = elements.add<geo::Aabb>("e:aabb", {});
+    aabb_property.vector().assign(boxes.begin(), boxes.end());
+
+    geo::Octree tree;
+    ASSERT_TRUE(tree.build(aabb_property, test_policies()[2], 6, 12));
+
+    std::uniform_real_distribution<float> point_dist(-15.0f, 15.0f);
+    std::vector<math::vec3> queries(150);
+    for (auto& q : queries) q = math::vec3(point_dist(rng), point_dist(rng), point_dist(rng));
+
+    geo::QueryScratch scratch;
+    const auto run_all = [&]()
+    {
+        std::vector<std::size_t> expected;
+        for (const auto& q : queries)
+        {
+            const geo::Sphere sphere{.center = q, .radius = 4.0f};
+            tree.query(sphere, expected);
+            auto hits = tree.query(sphere, scratch);
+            EXPECT_EQ(std::vector<std::size_t>(hits.begin(), hits.end()), expected);
+
+            const geo::Ray ray{.origin = q, .direction = math::vec3{0.0f, 0.0f, 1.0f}};
+            tree.query(ray, expected);
+            hits = tree.query(ray, scratch);
+            EXPECT_EQ(std::vector<std::size_t>(hits.begin(), hits.end()), expected);
+
+            tree.query_knn(q, 6, expected);
+            hits = tree.query_knn(q, 6, scratch);
+            EXPECT_EQ(std::vector<std::size_t>(hits.begin(), hits.end()), expected);
+
+            std::size_t nearest = 0;
+            tree.query_nearest(q, nearest);
+            EXPECT_EQ(tree.query_nearest(q, scratch), nearest);
+        }
+    };
+
+    run_all();
+    const auto* stack = scratch.node_stack.data();
+    const auto* cells = scratch.cells.data();
+    const auto* neighbors = scratch.neighbors.data();
+    const auto* results = scratch.results.data();
+    run_all();
+    EXPECT_EQ(scratch.node_stack.data(), stack);
+    EXPECT_EQ(scratch.cells.data(), cells);
+    EXPECT_EQ(scratch.neighbors.data(), neighbors);
+    EXPECT_EQ(scratch.results.data(), results);
+}
+
+namespace
+{
+    std::size_t reachable_nodes(const geo::Octree& tree)
+    {
+        std::size_t count = 0;
+        std::vector<std::size_t> stack{0};
+        while (!stack.empty())
+        {
+            const auto& node = tree.nodes[geo::NodeHandle(stack.back())];
+            stack.pop_back();
+            ++count;
+            for (const auto child : node.children)
+            {
+                if (geo::NodeHandle(child).is_valid()) stack.push_back(child);
+            }
+        }
+        return count;
+    }
+}
+
+TEST(Octree, IncrementalUpdatesMatchBruteForce)
+{
+    for (const auto& policy : {test_policies()[0], test_policies()[5], test_policies()[7]})
+    {
+        Rng rng(71);
+        geo::PropertySet elements;
+        auto aabb_property = elements.add<geo::Aabb>("e:aabb", {});
+        const auto boxes = generate_random_aabbs(400, rng);
+        aabb_property.vector().assign(boxes.begin(), boxes.end());
+        std::vector<bool> live(400, true);
+
+        geo::Octree tree;
+        ASSERT_TRUE(tree.build(aabb_property, policy, 6, 12));
+
+        std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+        std::uniform_real_distribution<float> point_dist(-15.0f, 15.0f);
+        std::uniform_int_distribution<int> coin(0, 9);
+        for (int frame = 0; frame < 6; ++frame)
+        {
+            for (std::size_t i = 0; i < live.size(); ++i)
+            {
+                if (!live[i] || coin(rng) > 2) continue;
+                geo::Aabb box = aabb_property[i];
+                if (coin(rng) == 0)
+                {
+                    geo::Random(box, rng); // teleport
+                }
+                else
+                {
+                    const math::vec3 offset(jitter(rng), jitter(rng), jitter(rng));
+                    box.min += offset;
+                    box.max += offset;
+                }
+                ASSERT_TRUE(tree.update(i, box));
+            }
+            for (std::size_t i = frame; i < live.size(); i += 23)
+            {
+                EXPECT_EQ(tree.erase(i), bool(live[i]));
+                live[i] = false;
+            }
+            for (int n = 0; n < 20; ++n)
+            {
+                elements.push_back();
+                geo::Random(aabb_property[live.size()], rng);
+                ASSERT_TRUE(tree.insert(live.size()));
+                EXPECT_FALSE(tree.insert(live.size()));
+                live.push_back(true);
+            }
+            ASSERT_TRUE(tree.validate_structure());
+            EXPECT_EQ(tree.element_count(), static_cast<std::size_t>(std::count(live.begin(), live.end(), true)));
+
+            const auto& boxes = aabb_property.vector();
+            for (int q = 0; q < 10; ++q)
+            {
+                const math::vec3 p(point_dist(rng), point_dist(rng), point_dist(rng));
+                const geo::Aabb region{.min = p - math::vec3(4.0f), .max = p + math::vec3(4.0f)};
+                const geo::Sphere sphere{.center = p, .radius = 6.0f};
+
+                std::vector<std::size_t> expected_region;
+                std::vector<std::size_t> expected_sphere;
+                std::vector<std::pair<float, std::size_t>> distances;
+                for (std::size_t i = 0; i < boxes.size(); ++i)
+                {
+                    if (!live[i]) continue;
+                    if (geo::Intersects(boxes[i], region)) expected_region.push_back(i);
+                    if (geo::Intersects(boxes[i], sphere)) expected_sphere.push_back(i);
+                    distances.emplace_back(static_cast<float>(geo::SquaredDistance(boxes[i], p)), i);
+                }
+                std::sort(distances.begin(), distances.end());
+
+                std::vector<std::size_t> actual;
+                tree.query(region, actual);
+                std::sort(actual.begin(), actual.end());
+                EXPECT_EQ(actual, expected_region);
+                tree.query(sphere, actual);
+                std::sort(actual.begin(), actual.end());
+                EXPECT_EQ(actual, expected_sphere);
+
+                tree.query_knn(p, 5, actual);
+                ASSERT_EQ(actual.size(), 5u);
+                for (std::size_t i = 0; i < actual.size(); ++i)
+                {
+                    EXPECT_FLOAT_EQ(static_cast<float>(geo::SquaredDistance(boxes[actual[i]], p)),
+                                    distances[i].first);
+                }
+                std::size_t nearest = 0;
+                tree.query_nearest(p, nearest);
+                EXPECT_EQ(nearest, distances.front().second);
+            }
+        }
+    }
+}
+
+TEST(Octree, IncrementalUpdatesSplitAndFoldLazily)
+{
+    Rng rng(73);
+    geo::PropertySet elements;
+    auto aabb_property = elements.add<geo::Aabb>("e:aabb", {});
+
+    geo::Octree tree;
+    EXPECT_FALSE(tree.build(aabb_property, test_policies()[0], 4, 8));
+    EXPECT_FALSE(tree.erase(0));
+
+    std::uniform_real_distribution<float> point_dist(-10.0f, 10.0f);
+    for (std::size_t i = 0; i < 300; ++i)
+    {
+        elements.push_back();
+        const math::vec3 p(point_dist(rng), point_dist(rng), point_dist(rng));
+        aabb_property[i] = geo::Aabb{.min = p, .max = p + math::vec3(0.05f)};
+        ASSERT_TRUE(tree.insert(i));
+    }
+    ASSERT_TRUE(tree.validate_structure());
+    const std::size_t grown = reachable_nodes(tree);
+    EXPECT_GT(grown, 8u);
+
+    for (std::size_t i = 0; i < 298; ++i)
+    {
+        ASSERT_TRUE(tree.erase(i));
+        EXPECT_FALSE(tree.erase(i));
+    }
+    ASSERT_TRUE(tree.validate_structure());
+    EXPECT_EQ(tree.element_count(), 2u);
+    EXPECT_EQ(reachable_nodes(tree), 1u);
+
+    std::vector<std::size_t> remaining;
+    tree.query_knn(math::vec3(0.0f), 10, remaining);
+    std::sort(remaining.begin(), remaining.end());
+    EXPECT_EQ(remaining, (std::vector<std::size_t>{298, 299}));
+
+    // Folded nodes are reused when the tree grows again.
+    const std::size_t allocated = tree.node_props_.size();
+    for (std::size_t i = 0; i < 298; ++i)
+    {
+        ASSERT_TRUE(tree.insert(i));
+    }
+    ASSERT_TRUE(tree.validate_structure());
+    EXPECT_EQ(tree.node_props_.size(), allocated);
+}
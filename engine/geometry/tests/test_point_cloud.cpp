@@ -3,7 +3,10 @@
 #include "engine/geometry/point_cloud/point_cloud.hpp"
 #include "engine/geometry/octree/octree.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
+#include <vector>
 
 namespace geo = engine::geometry;
 
@@ -41,6 +44,72 @@ TEST(PointCloud, StoresPointsAndProperties)
     EXPECT_FLOAT_EQ(refreshed_intensity[p2], 0.0F);
 }
 
+TEST(PointCloud, GarbageCollectionKeepsSurvivorOrder)
+{
+    geo::PointCloud cloud;
+    auto intensity = cloud.interface.add_vertex_property<float>("p:intensity", 0.0F);
+    for (int i = 0; i < 10; ++i)
+    {
+        const auto v = cloud.interface.add_vertex({static_cast<float>(i), 0.0F, 0.0F});
+        intensity[v] = static_cast<float>(i) * 0.5F;
+    }
+    for (const int i : {0, 3, 4, 9})
+    {
+        cloud.interface.delete_vertex(geo::VertexHandle(static_cast<geo::PropertyIndex>(i)));
+    }
+
+    cloud.interface.garbage_collection();
+
+    ASSERT_EQ(cloud.interface.vertices_size(), 6U);
+    EXPECT_EQ(cloud.interface.vertex_count(), 6U);
+    const float expected[] = {1.0F, 2.0F, 5.0F, 6.0F, 7.0F, 8.0F};
+    for (geo::PropertyIndex i = 0; i < 6; ++i)
+    {
+        const geo::VertexHandle v(i);
+        EXPECT_FALSE(cloud.interface.is_deleted(v));
+        EXPECT_FLOAT_EQ(cloud.interface.position(v)[0], expected[i]);
+        EXPECT_FLOAT_EQ(intensity[v], expected[i] * 0.5F);
+    }
+}
+
+TEST(PointCloud, OptimizeLocalityKeepsPropertiesWithTheirPoints)
+{
+    geo::PointCloud cloud;
+    auto id = cloud.interface.add_vertex_property<int>("p:id", -1);
+    // Points on a 8x8x8 lattice inserted in a scrambled order.
+    for (int i = 0; i < 512; ++i)
+    {
+        const int cell = (i * 37) % 512;
+        const auto v = cloud.interface.add_vertex(
+            {static_cast<float>(cell % 8), static_cast<float>((cell / 8) % 8), static_cast<float>(cell / 64)});
+        id[v] = cell;
+    }
+    cloud.interface.delete_vertex(geo::VertexHandle(5));
+
+    cloud.interface.optimize_locality();
+
+    ASSERT_EQ(cloud.interface.vertices_size(), 511U);
+    std::vector<int> seen;
+    float walk = 0.0F;
+    for (geo::PropertyIndex i = 0; i < 511; ++i)
+    {
+        const geo::VertexHandle v(i);
+        const auto& p = cloud.interface.position(v);
+        EXPECT_EQ(id[v], static_cast<int>(p[0]) + 8 * static_cast<int>(p[1]) + 64 * static_cast<int>(p[2]));
+        seen.push_back(id[v]);
+        if (i > 0)
+        {
+            const auto& q = cloud.interface.position(geo::VertexHandle(i - 1));
+            walk += std::abs(p[0] - q[0]) + std::abs(p[1] - q[1]) + std::abs(p[2] - q[2]);
+        }
+    }
+    // Walking the points in storage order now mostly steps between lattice neighbours.
+    EXPECT_LT(walk, 1.5F * 511.0F);
+    std::sort(seen.begin(), seen.end());
+    EXPECT_EQ(std::unique(seen.begin(), seen.end()), seen.end());
+    EXPECT_FALSE(std::binary_search(seen.begin(), seen.end(), (5 * 37) % 512));
+}
+
 TEST(PointCloud, RoundTripsAsciiPLY)
 {
     geo::PointCloud cloud;
@@ -1,10 +1,17 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <numeric>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "engine/geometry/properties/packed_properties.hpp"
+#include "engine/geometry/properties/property_memory.hpp"
 #include "engine/geometry/properties/property_registry.hpp"
+#include "engine/math/parallel.hpp"
 
 namespace geo = engine::geometry;
 
@@ -77,3 +84,277 @@ TEST(PropertyRegistry, AddGetAndDefaults)
     EXPECT_EQ(registry.property_count(), 0u);
 }
 
+TEST(PropertyRegistry, TypedKeysMatchNameLookup)
+{
+    constexpr geo::PropertyKey<float> kWeight("weight");
+    static_assert(kWeight.hash == geo::HashPropertyName("weight"));
+
+    geo::PropertyRegistry registry;
+    registry.resize(2);
+    for (int i = 0; i < 64; ++i)
+    {
+        ASSERT_TRUE(registry.add<int>("filler:" + std::to_string(i), i).has_value());
+    }
+    auto weights = registry.get_or_add(kWeight, 0.5f);
+    EXPECT_EQ(registry.find(kWeight), registry.find("weight"));
+    EXPECT_EQ(registry.get(kWeight)->id(), weights.id());
+    EXPECT_TRUE(!registry.get(geo::PropertyKey<double>("weight")).has_value());
+    EXPECT_TRUE(!registry.get(geo::PropertyKey<float>("missing")).has_value());
+
+    // Removing properties must not lose the ones that probed past them.
+    for (int i = 0; i < 64; i += 2)
+    {
+        EXPECT_TRUE(registry.remove(*registry.find("filler:" + std::to_string(i))));
+    }
+    for (int i = 0; i < 64; ++i)
+    {
+        EXPECT_EQ(registry.contains("filler:" + std::to_string(i)), i % 2 == 1);
+    }
+    auto weights_again = registry.get(kWeight);
+    ASSERT_TRUE(weights_again.has_value());
+    EXPECT_FLOAT_EQ((*weights_again)[1], 0.5f);
+
+    const auto before = registry.generation();
+    const geo::PropertyRegistry copy = registry;
+    EXPECT_NE(copy.generation(), registry.generation());
+    EXPECT_EQ(registry.generation(), before);
+    registry.resize(8);
+    EXPECT_EQ(registry.generation(), before);
+    registry.clear();
+    EXPECT_NE(registry.generation(), before);
+    EXPECT_TRUE(copy.get(kWeight).has_value());
+}
+
+TEST(PropertySet, CachedPropertyFollowsAddAndRemove)
+{
+    geo::CachedProperty<float> weights(geo::PropertyKey<float>("weight"));
+    geo::PropertySet set;
+    set.resize(3);
+    EXPECT_FALSE(weights.get(set));
+
+    auto added = weights.get_or_add(set, 2.0f);
+    ASSERT_TRUE(added);
+    EXPECT_FLOAT_EQ(weights.get(set)[2], 2.0f);
+
+    set.remove(added);
+    EXPECT_FALSE(weights.get(set));
+    EXPECT_TRUE(set.add<float>("weight", 4.0f));
+    ASSERT_TRUE(weights.get(set));
+    EXPECT_FLOAT_EQ(weights.get(set)[0], 4.0f);
+
+    // The cache is tied to the set it resolved against, not to a look-alike copy.
+    geo::PropertySet other = set;
+    other.get<float>("weight")[0] = 8.0f;
+    EXPECT_FLOAT_EQ(weights.get(other)[0], 8.0f);
+    EXPECT_FLOAT_EQ(weights.get(set)[0], 4.0f);
+}
+
+TEST(PropertySet, CopiesShareBuffersUntilWritten)
+{
+    geo::PropertySet original;
+    auto values = original.add<int>("value", 0);
+    auto flags = original.add<bool>("flag", false);
+    original.resize(50000);
+    std::iota(values.vector().begin(), values.vector().end(), 0);
+
+    geo::PropertySet copy = original;
+    auto copy_values = copy.get<int>("value");
+    auto copy_flags = copy.get<bool>("flag");
+    const auto& const_values = std::as_const(values);
+    const auto& const_copy_values = std::as_const(copy_values);
+    EXPECT_EQ(const_copy_values.vector().data(), const_values.vector().data());
+    EXPECT_EQ(const_copy_values[49999], 49999);
+
+    // Writers racing to the first mutable access detach the buffer exactly once.
+    engine::math::parallel::parallel_for(0, copy.size(), 1024, [&](std::size_t first, std::size_t last)
+    {
+        for (std::size_t i = first; i < last; ++i)
+        {
+            copy_values[i] *= 2;
+        }
+    });
+    EXPECT_NE(const_copy_values.vector().data(), const_values.vector().data());
+    EXPECT_EQ(const_values[10], 10);
+    EXPECT_EQ(const_copy_values[10], 20);
+
+    // Compacting a shared buffer gathers the survivors without touching the other owner.
+    const std::vector<std::uint32_t> kept{1, 3, 4};
+    copy.compact(kept);
+    EXPECT_EQ(copy.size(), 3u);
+    EXPECT_EQ(copy_values[2], 8);
+    EXPECT_EQ(copy_flags.vector().size(), 3u);
+    EXPECT_EQ(flags.vector().size(), 50000u);
+    EXPECT_EQ(const_values[4], 4);
+
+    // The original is the only owner now, so writing to it no longer copies.
+    const int* before = const_values.vector().data();
+    values[0] = -1;
+    EXPECT_EQ(const_values.vector().data(), before);
+}
+
+TEST(PropertySet, PermuteGathersGroupsWithoutTouchingSharedCopies)
+{
+    geo::PropertySet original;
+    auto values = original.add<int>("value", 0);
+    auto flags = original.add<bool>("flag", false);
+    original.resize(6);
+    std::iota(values.vector().begin(), values.vector().end(), 0);
+    flags[1] = true;
+
+    geo::PropertySet copy = original;
+    auto copy_values = copy.get<int>("value");
+    auto copy_flags = copy.get<bool>("flag");
+
+    // Pairs of elements move together, as halfedges do with their edge.
+    const std::vector<std::uint32_t> pairs{2, 0, 1};
+    copy.permute(pairs, 2);
+    ASSERT_EQ(copy.size(), 6u);
+    const int expected[] = {4, 5, 0, 1, 2, 3};
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        EXPECT_EQ(copy_values[i], expected[i]);
+    }
+    EXPECT_TRUE(copy_flags[3]);
+    EXPECT_FALSE(copy_flags[1]);
+
+    EXPECT_EQ(std::as_const(values)[0], 0);
+    EXPECT_TRUE(std::as_const(flags)[1]);
+
+    const std::vector<std::uint32_t> reversed{5, 4, 3, 2, 1, 0};
+    original.permute(reversed);
+    EXPECT_EQ(std::as_const(values)[0], 5);
+    EXPECT_TRUE(std::as_const(flags)[4]);
+}
+
+namespace
+{
+class CountingResource final : public std::pmr::memory_resource
+{
+public:
+    std::size_t live_bytes = 0;
+    std::size_t allocations = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        live_bytes += bytes;
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        live_bytes -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+bool IsAligned(const void* p, std::size_t alignment)
+{
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+} // namespace
+
+TEST(PropertySet, BuffersAreCacheLineAlignedAndFollowTheirResource)
+{
+    geo::PropertySet defaults;
+    auto bytes = defaults.add<char>("byte", 'x');
+    auto points = defaults.add<engine::math::vec3>("point");
+    for (std::size_t n : {1u, 37u, 1000u})
+    {
+        defaults.resize(n);
+        EXPECT_TRUE(IsAligned(bytes.vector().data(), geo::kPropertyAlignment));
+        EXPECT_TRUE(IsAligned(points.vector().data(), geo::kPropertyAlignment));
+    }
+
+    CountingResource counting;
+    geo::PropertySet set(&counting);
+    auto values = set.add<int>("value", 3);
+    set.resize(100);
+    EXPECT_EQ(set.memory_resource(), &counting);
+    EXPECT_GE(counting.live_bytes, 100 * sizeof(int));
+
+    // Copies and their detached buffers stay in the resource.
+    geo::PropertySet copy = set;
+    EXPECT_EQ(copy.memory_resource(), &counting);
+    const std::size_t before = counting.allocations;
+    copy.get<int>("value")[0] = 4;
+    EXPECT_EQ(counting.allocations, before + 1);
+
+    CountingResource other;
+    set.set_memory_resource(&other);
+    EXPECT_EQ(values.vector().size(), 100u);
+    EXPECT_EQ(values[99], 3);
+    EXPECT_GE(other.live_bytes, 100 * sizeof(int));
+    EXPECT_TRUE(set.add<float>("later"));
+    EXPECT_GE(other.allocations, 2u);
+
+    copy.clear();
+    set.clear();
+    EXPECT_EQ(counting.live_bytes, 0u);
+    EXPECT_EQ(other.live_bytes, 0u);
+}
+
+TEST(PropertySet, HugePageResourceMapsLargeBuffers)
+{
+    CountingResource small;
+    geo::HugePageResource huge({.threshold = std::size_t{1} << 20}, &small);
+    geo::PropertySet set(&huge);
+    auto large = set.add<float>("large", 1.0f);
+    auto flags = set.add<std::uint8_t>("flag", 1);
+    set.resize(std::size_t{1} << 19);
+
+    EXPECT_FLOAT_EQ(large[(std::size_t{1} << 19) - 1], 1.0f);
+    large[12345] = 2.0f;
+    EXPECT_FLOAT_EQ(large[12345], 2.0f);
+    EXPECT_EQ(flags[0], 1);
+#if defined(__linux__)
+    EXPECT_TRUE(IsAligned(large.vector().data(), geo::HugePageResource::kHugePageSize));
+    EXPECT_EQ(small.live_bytes, std::size_t{1} << 19);
+#endif
+
+    set.clear();
+    EXPECT_EQ(small.live_bytes, 0u);
+}
+
+TEST(PropertySet, PackedPropertiesRoundTrip)
+{
+    geo::PropertySet vertices;
+    vertices.resize(4);
+    auto normals = vertices.add<engine::math::vec3>("v:normal");
+    auto colors = vertices.add<engine::math::vec4>("v:color");
+    normals[0] = {0.0F, 0.0F, 1.0F};
+    normals[1] = {0.0F, -1.0F, 0.0F};
+    const engine::math::vec3 oblique = engine::math::normalize(engine::math::vec3{1.0F, 2.0F, -3.0F});
+    normals[2] = oblique;
+    normals[3] = {-1.0F, 0.0F, 0.0F};
+    for (std::size_t i = 0; i < 4; ++i) colors[i] = {0.25F * static_cast<float>(i), 0.5F, 1.0F, 1.0F};
+
+    auto packed_normals = geo::pack_property<engine::math::oct_normal16>(vertices, "v:normal", "v:normal_oct", true);
+    ASSERT_TRUE(packed_normals);
+    EXPECT_FALSE(vertices.exists("v:normal"));
+    using rgba8 = engine::math::Vector<engine::math::unorm8, 4>;
+    ASSERT_TRUE(geo::pack_property<rgba8>(vertices, "v:color", "v:color8"));
+
+    // Packed buffers follow the set like any other property.
+    vertices.push_back();
+    vertices.swap(0, 3);
+    EXPECT_EQ(packed_normals.vector().size(), 5u);
+
+    auto restored = geo::unpack_property<engine::math::oct_normal16>(vertices, "v:normal_oct", "v:normal");
+    ASSERT_TRUE(restored);
+    EXPECT_EQ(restored[3], (engine::math::vec3{0.0F, 0.0F, 1.0F}));
+    EXPECT_EQ(restored[0], (engine::math::vec3{-1.0F, 0.0F, 0.0F}));
+    EXPECT_NEAR(engine::math::dot(restored[2], oblique), 1.0F, 1e-6F);
+
+    auto colors8 = vertices.get<rgba8>("v:color8");
+    EXPECT_EQ(colors8[2][0].bits, 128);
+    EXPECT_EQ(colors8[2][2].bits, 255);
+
+    // Missing source or a target of another type leaves the set untouched.
+    EXPECT_FALSE(geo::pack_property<engine::math::hvec3>(vertices, "v:missing", "v:half"));
+    EXPECT_FALSE(geo::pack_property<engine::math::oct_normal16>(vertices, "v:normal", "v:color"));
+    EXPECT_FALSE(vertices.exists("v:half"));
+}
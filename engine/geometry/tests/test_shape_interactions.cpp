@@ -1,8 +1,13 @@
 #include <gtest/gtest.h>
 
 #include "engine/geometry/shapes.hpp"
+#include "engine/geometry/utils/batched_shape_interactions.hpp"
 #include "engine/geometry/utils/shape_interactions.hpp"
 
+#include <cstdint>
+#include <random>
+#include <vector>
+
 namespace engine::geometry
 {
     TEST(ShapeInteractionsSphere, CylinderIntersection)
@@ -944,5 +949,127 @@ namespace engine::geometry
         EXPECT_TRUE(Intersects(box1, box2));
         EXPECT_TRUE(Intersects(box2, box1)); // Symmetry
     }
+
+    namespace
+    {
+        AabbSoa RandomBoxes(std::size_t count, RandomEngine& rng)
+        {
+            std::uniform_real_distribution<float> center(-10.0f, 10.0f);
+            std::uniform_real_distribution<float> extent(0.0f, 1.5f);
+            AabbSoa boxes;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const math::vec3 c{center(rng), center(rng), center(rng)};
+                const math::vec3 e{extent(rng), extent(rng), extent(rng)};
+                boxes.push_back(Aabb{c - e, c + e});
+            }
+            return boxes;
+        }
+
+        // Checks every mask bit against `expected(i)` and the returned count against the set bits.
+        template <class Expected>
+        void ExpectMask(const std::vector<std::uint64_t>& mask, std::size_t count, std::size_t hits,
+                        const Expected& expected)
+        {
+            std::vector<std::uint32_t> indices;
+            AppendSetBits(mask, indices);
+            EXPECT_EQ(indices.size(), hits);
+            std::size_t next = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const bool hit = next < indices.size() && indices[next] == i;
+                next += hit;
+                EXPECT_EQ(hit, expected(i)) << "box " << i;
+            }
+            EXPECT_EQ(next, indices.size()) << "bits set past the last box";
+        }
+    } // namespace
+
+    TEST(BatchedShapeInteractions, AabbAndSphereMatchScalarTests)
+    {
+        RandomEngine rng(7);
+        const AabbSoa boxes = RandomBoxes(1001, rng);
+        std::vector<std::uint64_t> mask(MaskWordCount(boxes.size()));
+        std::uniform_real_distribution<float> coord(-10.0f, 10.0f);
+        for (int trial = 0; trial < 10; ++trial)
+        {
+            const math::vec3 c{coord(rng), coord(rng), coord(rng)};
+            const Aabb box{c - math::vec3{2.0f, 1.0f, 3.0f}, c + math::vec3{1.0f, 2.0f, 0.5f}};
+            ExpectMask(mask, boxes.size(), Intersects(box, boxes, mask),
+                       [&](std::size_t i) { return Intersects(box, boxes.get(i)); });
+
+            const Sphere sphere{c, 2.5f};
+            ExpectMask(mask, boxes.size(), Intersects(sphere, boxes, mask),
+                       [&](std::size_t i) { return Intersects(sphere, boxes.get(i)); });
+        }
+    }
+
+    TEST(BatchedShapeInteractions, RayMatchesScalarTestIncludingParallelAxes)
+    {
+        RandomEngine rng(11);
+        const AabbSoa boxes = RandomBoxes(777, rng);
+        std::vector<std::uint64_t> mask(MaskWordCount(boxes.size()));
+        std::vector<float> entry(boxes.size());
+        std::uniform_real_distribution<float> coord(-10.0f, 10.0f);
+        for (int trial = 0; trial < 12; ++trial)
+        {
+            Ray ray{{coord(rng), coord(rng), coord(rng)}, {coord(rng), coord(rng), coord(rng)}};
+            if (trial % 3 == 1) ray.direction = {0.0f, coord(rng), 0.0f};
+            if (trial % 3 == 2) ray.direction = {coord(rng), 0.0f, coord(rng)};
+
+            ExpectMask(mask, boxes.size(), Intersects(ray, boxes, mask),
+                       [&](std::size_t i) { return Intersects(ray, boxes.get(i)); });
+            Intersects(ray, boxes, mask, entry);
+            for (std::size_t i = 0; i < boxes.size(); ++i)
+            {
+                Result result{};
+                if (Intersects(ray, boxes.get(i), &result))
+                {
+                    EXPECT_NEAR(entry[i], result.t_min, 1e-4f * (1.0f + result.t_min));
+                }
+            }
+        }
+    }
+
+    TEST(BatchedShapeInteractions, HalfspacesCullBoxesOutsideAnyPlane)
+    {
+        RandomEngine rng(3);
+        const AabbSoa boxes = RandomBoxes(300, rng);
+        std::vector<std::uint64_t> mask(MaskWordCount(boxes.size()));
+
+        // Inward-facing planes of the box [-4, 4]^3, with one face tilted.
+        const std::vector<Plane> planes{
+            {{1.0f, 0.0f, 0.0f}, 4.0f}, {{-1.0f, 0.0f, 0.0f}, 4.0f}, {{0.0f, 1.0f, 0.0f}, 4.0f},
+            {{0.0f, -1.0f, 0.0f}, 4.0f}, {{0.0f, 0.6f, 0.8f}, 4.0f}, {{0.0f, 0.0f, -1.0f}, 4.0f},
+        };
+        const std::size_t hits = IntersectsHalfspaces(planes, boxes, mask);
+        ExpectMask(mask, boxes.size(), hits, [&](std::size_t i)
+        {
+            for (const Plane& plane : planes)
+            {
+                bool outside = true;
+                for (const math::vec3& corner : GetCorners(boxes.get(i))) outside &= SignedDistance(plane, corner) < 0.0f;
+                if (outside) return false;
+            }
+            return true;
+        });
+        EXPECT_GT(hits, 0u);
+        EXPECT_LT(hits, boxes.size());
+        EXPECT_EQ(IntersectsHalfspaces({}, boxes, mask), boxes.size());
+    }
+
+    TEST(BatchedShapeInteractions, SquaredDistanceMatchesScalar)
+    {
+        RandomEngine rng(5);
+        const AabbSoa boxes = RandomBoxes(130, rng);
+        std::vector<float> distance_sq(boxes.size());
+        const math::vec3 point{1.0f, -2.0f, 0.5f};
+        SquaredDistance(point, boxes, distance_sq);
+        for (std::size_t i = 0; i < boxes.size(); ++i)
+        {
+            const double expected = SquaredDistance(boxes.get(i), point);
+            EXPECT_NEAR(distance_sq[i], expected, 1e-4 * (1.0 + expected));
+        }
+    }
 } // namespace engine::geometry
 
@@ -3,6 +3,9 @@
 #include "engine/geometry/api.hpp"
 #include "engine/geometry/mesh/surface_mesh_conversion.hpp"
 
+#include <cstdint>
+#include <vector>
+
 namespace geo = engine::geometry;
 
 TEST(SurfaceMeshConversion, RoundTripPreservesTopology)
@@ -73,3 +76,125 @@ TEST(SurfaceMeshConversion, ThrowsWhenHalfedgeReferencesDeletedVertex)
     EXPECT_THROW(static_cast<void>(geo::mesh::build_surface_mesh_from_halfedge(container.interface)), std::runtime_error);
 }
 
+namespace
+{
+    // Triangulated n x n grid of quads with the quad at (hole, hole) left out, so the mesh has an outer and an
+    // inner boundary loop.
+    geo::SurfaceMesh make_grid_with_hole(std::uint32_t n, std::uint32_t hole)
+    {
+        geo::SurfaceMesh surface;
+        for (std::uint32_t y = 0; y <= n; ++y)
+        {
+            for (std::uint32_t x = 0; x <= n; ++x)
+            {
+                surface.positions.push_back(engine::math::vec3{static_cast<float>(x), static_cast<float>(y), 0.0F});
+            }
+        }
+        for (std::uint32_t y = 0; y < n; ++y)
+        {
+            for (std::uint32_t x = 0; x < n; ++x)
+            {
+                if (x == hole && y == hole)
+                {
+                    continue;
+                }
+                const std::uint32_t v = y * (n + 1) + x;
+                surface.indices.insert(surface.indices.end(), {v, v + 1, v + n + 2, v, v + n + 2, v + n + 1});
+            }
+        }
+        return surface;
+    }
+
+    void build_incrementally(const geo::SurfaceMesh& surface, geo::mesh::HalfedgeMeshInterface& mesh)
+    {
+        std::vector<geo::VertexHandle> vertices;
+        for (const auto& position : surface.positions)
+        {
+            vertices.push_back(mesh.add_vertex(position));
+        }
+        for (std::size_t i = 0; i < surface.indices.size(); i += 3)
+        {
+            ASSERT_TRUE(mesh.add_triangle(vertices[surface.indices[i]], vertices[surface.indices[i + 1]],
+                                          vertices[surface.indices[i + 2]]).has_value());
+        }
+    }
+} // namespace
+
+TEST(SurfaceMeshConversion, BulkBuildMatchesIncrementalConstruction)
+{
+    const geo::SurfaceMesh surface = make_grid_with_hole(12, 4);
+
+    geo::Mesh bulk;
+    geo::mesh::build_halfedge_from_surface_mesh(surface, bulk.interface);
+    geo::Mesh incremental;
+    build_incrementally(surface, incremental.interface);
+
+    const auto& a = bulk.interface;
+    const auto& b = incremental.interface;
+    ASSERT_EQ(a.vertices_size(), b.vertices_size());
+    ASSERT_EQ(a.halfedges_size(), b.halfedges_size());
+    ASSERT_EQ(a.edges_size(), b.edges_size());
+    ASSERT_EQ(a.faces_size(), b.faces_size());
+
+    for (std::size_t i = 0; i < a.halfedges_size(); ++i)
+    {
+        const geo::HalfedgeHandle h(static_cast<geo::PropertyIndex>(i));
+        EXPECT_EQ(a.to_vertex(h), b.to_vertex(h));
+        EXPECT_EQ(a.face(h), b.face(h));
+        EXPECT_EQ(a.next_halfedge(h), b.next_halfedge(h));
+        EXPECT_EQ(a.prev_halfedge(h), b.prev_halfedge(h));
+    }
+    for (std::size_t i = 0; i < a.faces_size(); ++i)
+    {
+        const geo::FaceHandle f(static_cast<geo::PropertyIndex>(i));
+        EXPECT_EQ(a.halfedge(f), b.halfedge(f));
+    }
+    for (std::size_t i = 0; i < a.vertices_size(); ++i)
+    {
+        const geo::VertexHandle v(static_cast<geo::PropertyIndex>(i));
+        EXPECT_EQ(a.position(v)[0], surface.positions[i][0]);
+        EXPECT_EQ(a.is_boundary(v), b.is_boundary(v));
+        EXPECT_EQ(a.valence(v), b.valence(v));
+        EXPECT_EQ(a.halfedge(v), b.halfedge(v));
+        EXPECT_EQ(a.from_vertex(a.halfedge(v)), v);
+        if (b.is_boundary(v))
+        {
+            EXPECT_FALSE(a.face(a.halfedge(v)).is_valid());
+        }
+    }
+}
+
+TEST(SurfaceMeshConversion, BulkBuildFallsBackForPinchedVertices)
+{
+    // Two triangles sharing only vertex 0: add_face() accepts the pinch, so the bulk path must hand it over.
+    geo::SurfaceMesh surface;
+    surface.positions = {engine::math::vec3{0.0F, 0.0F, 0.0F}, engine::math::vec3{1.0F, 0.0F, 0.0F},
+                         engine::math::vec3{1.0F, 1.0F, 0.0F}, engine::math::vec3{-1.0F, 0.0F, 0.0F},
+                         engine::math::vec3{-1.0F, -1.0F, 0.0F}};
+    surface.indices = {0U, 1U, 2U, 0U, 3U, 4U};
+
+    geo::Mesh container;
+    ASSERT_NO_THROW(geo::mesh::build_halfedge_from_surface_mesh(surface, container.interface));
+    EXPECT_EQ(container.interface.faces_size(), 2U);
+    EXPECT_EQ(container.interface.edges_size(), 6U);
+}
+
+TEST(SurfaceMeshConversion, BulkBuildRejectsNonManifoldEdges)
+{
+    geo::SurfaceMesh surface;
+    surface.positions = {engine::math::vec3{0.0F, 0.0F, 0.0F}, engine::math::vec3{1.0F, 0.0F, 0.0F},
+                         engine::math::vec3{0.0F, 1.0F, 0.0F}, engine::math::vec3{0.0F, -1.0F, 0.0F},
+                         engine::math::vec3{0.0F, 0.0F, 1.0F}};
+
+    geo::Mesh container;
+    surface.indices = {0U, 1U, 2U, 1U, 0U, 3U, 0U, 1U, 4U};
+    EXPECT_THROW(geo::mesh::build_halfedge_from_surface_mesh(surface, container.interface), std::runtime_error);
+
+    // Both triangles run edge (0, 1) the same way.
+    surface.indices = {0U, 1U, 2U, 0U, 1U, 3U};
+    EXPECT_THROW(geo::mesh::build_halfedge_from_surface_mesh(surface, container.interface), std::runtime_error);
+
+    geo::mesh::HalfedgeMeshInterface& mesh = container.interface;
+    EXPECT_FALSE(mesh.assign_triangles(surface.positions, surface.indices));
+    EXPECT_EQ(mesh.vertices_size(), 0U);
+}
@@ -0,0 +1,370 @@
+#pragma once
+
+#include "engine/math/common.hpp"
+#include "engine/math/matrix.hpp"
+#include "engine/math/parallel.hpp"
+#include "engine/math/vector.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+// Fixed-size factorizations for 2x2..4x4 matrices. Every routine runs a fixed number of fully unrolled
+// steps and selects between results instead of branching on data, so the same code runs in constexpr
+// evaluation, on device and in the batched (span) overloads below.
+namespace engine::math
+{
+    namespace detail
+    {
+        // std::sqrt outside constant evaluation; Newton iteration from above inside it.
+        template <typename T>
+        ENGINE_MATH_INLINE T constexpr_sqrt(T x) noexcept
+        {
+            if (std::is_constant_evaluated())
+            {
+                if (!(x > zero<T>()) || x == infinity<T>())
+                {
+                    return x > zero<T>() ? x : zero<T>();
+                }
+                T r = x > one<T>() ? x : one<T>();
+                for (int i = 0; i < 2048; ++i)
+                {
+                    const T next = T(0.5) * (r + x / r);
+                    if (!(next < r))
+                    {
+                        break;
+                    }
+                    r = next;
+                }
+                return r;
+            }
+            return std::sqrt(x);
+        }
+
+        template <typename T>
+        ENGINE_MATH_INLINE T select(bool condition, T if_true, T if_false) noexcept
+        {
+            return condition ? if_true : if_false;
+        }
+
+        template <typename T>
+        ENGINE_MATH_INLINE int default_jacobi_sweeps() noexcept
+        {
+            return sizeof(T) >= sizeof(double) ? 8 : 5;
+        }
+
+        // One cyclic-Jacobi step: a <- J^T a J with J chosen to annihilate a(p, q); v <- v J.
+        template <typename T, std::size_t N>
+        ENGINE_MATH_INLINE void jacobi_rotate(Matrix<T, N, N>& a, Matrix<T, N, N>& v, std::size_t p, std::size_t q) noexcept
+        {
+            const T apq = a(p, q);
+            const T app = a(p, p);
+            const T aqq = a(q, q);
+            const bool negligible = apq == zero<T>();
+            const T theta = (aqq - app) / select(negligible, one<T>(), T(2) * apq);
+            const T abs_theta = theta < zero<T>() ? -theta : theta;
+            const T sign = theta < zero<T>() ? -one<T>() : one<T>();
+            const T t = select(negligible, zero<T>(), sign / (abs_theta + constexpr_sqrt(theta * theta + one<T>())));
+            const T c = one<T>() / constexpr_sqrt(t * t + one<T>());
+            const T s = t * c;
+
+            for (std::size_t k = 0; k < N; ++k)
+            {
+                const T akp = a(k, p);
+                const T akq = a(k, q);
+                a(k, p) = c * akp - s * akq;
+                a(k, q) = s * akp + c * akq;
+            }
+            for (std::size_t k = 0; k < N; ++k)
+            {
+                const T apk = a(p, k);
+                const T aqk = a(q, k);
+                a(p, k) = c * apk - s * aqk;
+                a(q, k) = s * apk + c * aqk;
+            }
+            a(p, q) = zero<T>();
+            a(q, p) = zero<T>();
+
+            for (std::size_t k = 0; k < N; ++k)
+            {
+                const T vkp = v(k, p);
+                const T vkq = v(k, q);
+                v(k, p) = c * vkp - s * vkq;
+                v(k, q) = s * vkp + c * vkq;
+            }
+        }
+
+        template <typename T, std::size_t N>
+        ENGINE_MATH_INLINE void swap_columns_if(bool condition, Matrix<T, N, N>& m, std::size_t i, std::size_t j) noexcept
+        {
+            for (std::size_t k = 0; k < N; ++k)
+            {
+                const T mi = m(k, i);
+                const T mj = m(k, j);
+                m(k, i) = select(condition, mj, mi);
+                m(k, j) = select(condition, mi, mj);
+            }
+        }
+
+        template <typename T, std::size_t N>
+        ENGINE_MATH_INLINE T determinant_any(const Matrix<T, N, N>& m) noexcept
+        {
+            static_assert(N >= 2 && N <= 4, "fixed-size decompositions support 2x2, 3x3 and 4x4 matrices");
+            return determinant(m);
+        }
+    } // namespace detail
+
+    template <typename T, std::size_t N>
+    struct SymmetricEigen
+    {
+        Vector<T, N> values; // descending
+        Matrix<T, N, N> vectors; // column i is the unit eigenvector of values[i]; det(vectors) == +1
+    };
+
+    template <typename T, std::size_t N>
+    struct QrDecomposition
+    {
+        Matrix<T, N, N> q; // rotation (det == +1)
+        Matrix<T, N, N> r; // upper triangular, r(i, i) >= 0 except possibly the last
+    };
+
+    // A = u * diag(sigma) * transpose(v). u and v are rotations (McAdams et al. convention), so sigma is
+    // sorted by decreasing magnitude and only its last entry may be negative (when det(A) < 0).
+    template <typename T, std::size_t N>
+    struct SingularValueDecomposition
+    {
+        Matrix<T, N, N> u;
+        Vector<T, N> sigma;
+        Matrix<T, N, N> v;
+    };
+
+    // A = rotation * stretch with rotation a proper rotation and stretch symmetric. stretch is positive
+    // semi-definite when det(A) >= 0; otherwise the reflection is left in stretch.
+    template <typename T, std::size_t N>
+    struct PolarDecomposition
+    {
+        Matrix<T, N, N> rotation;
+        Matrix<T, N, N> stretch;
+    };
+
+    // Eigen-decomposition of a symmetric matrix by cyclic Jacobi with a fixed sweep count. Only the upper
+    // triangle is trusted.
+    template <typename T, std::size_t N>
+    ENGINE_MATH_INLINE SymmetricEigen<T, N> symmetric_eigen(const Matrix<T, N, N>& m,
+                                                            int sweeps = detail::default_jacobi_sweeps<T>()) noexcept
+    {
+        static_assert(N >= 2 && N <= 4, "fixed-size decompositions support 2x2, 3x3 and 4x4 matrices");
+        Matrix<T, N, N> a = m;
+        for (std::size_t c = 0; c < N; ++c)
+        {
+            for (std::size_t r = c + 1; r < N; ++r)
+            {
+                a(r, c) = a(c, r);
+            }
+        }
+        Matrix<T, N, N> v = identity_matrix<T, N>();
+        for (int sweep = 0; sweep < sweeps; ++sweep)
+        {
+            for (std::size_t p = 0; p + 1 < N; ++p)
+            {
+                for (std::size_t q = p + 1; q < N; ++q)
+                {
+                    detail::jacobi_rotate(a, v, p, q);
+                }
+            }
+        }
+
+        Vector<T, N> values{};
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            values[i] = a(i, i);
+        }
+        // Odd-even transposition network: N passes of compare-and-swap sort values descending.
+        for (std::size_t pass = 0; pass < N; ++pass)
+        {
+            for (std::size_t i = pass % 2; i + 1 < N; i += 2)
+            {
+                const bool swap = values[i] < values[i + 1];
+                const T vi = values[i];
+                values[i] = detail::select(swap, values[i + 1], vi);
+                values[i + 1] = detail::select(swap, vi, values[i + 1]);
+                detail::swap_columns_if(swap, v, i, i + 1);
+            }
+        }
+        // Column swaps may flip orientation; restore a proper rotation.
+        const T orientation = detail::determinant_any(v) < detail::zero<T>() ? -detail::one<T>() : detail::one<T>();
+        v.columns[N - 1] *= orientation;
+        return {values, v};
+    }
+
+    // QR by Givens rotations; A = q * r.
+    template <typename T, std::size_t N>
+    ENGINE_MATH_INLINE QrDecomposition<T, N> qr(const Matrix<T, N, N>& a) noexcept
+    {
+        static_assert(N >= 2 && N <= 4, "fixed-size decompositions support 2x2, 3x3 and 4x4 matrices");
+        Matrix<T, N, N> r = a;
+        Matrix<T, N, N> q = identity_matrix<T, N>();
+        for (std::size_t j = 0; j + 1 < N; ++j)
+        {
+            for (std::size_t i = N - 1; i > j; --i)
+            {
+                const T x = r(j, j);
+                const T y = r(i, j);
+                const T h = detail::constexpr_sqrt(x * x + y * y);
+                const bool degenerate = h == detail::zero<T>();
+                const T inv_h = detail::one<T>() / detail::select(degenerate, detail::one<T>(), h);
+                const T c = detail::select(degenerate, detail::one<T>(), x * inv_h);
+                const T s = detail::select(degenerate, detail::zero<T>(), y * inv_h);
+                for (std::size_t k = 0; k < N; ++k)
+                {
+                    const T rj = r(j, k);
+                    const T ri = r(i, k);
+                    r(j, k) = c * rj + s * ri;
+                    r(i, k) = c * ri - s * rj;
+
+                    const T qj = q(k, j);
+                    const T qi = q(k, i);
+                    q(k, j) = c * qj + s * qi;
+                    q(k, i) = c * qi - s * qj;
+                }
+                r(i, j) = detail::zero<T>();
+            }
+        }
+        return {q, r};
+    }
+
+    // Signed SVD following McAdams et al., "Computing the Singular Value Decomposition of 3x3 matrices with
+    // minimal branching and elementary floating point operations": V from the Jacobi eigenvectors of A^T A,
+    // then U and sigma from the Givens QR of A V.
+    template <typename T, std::size_t N>
+    ENGINE_MATH_INLINE SingularValueDecomposition<T, N> svd(const Matrix<T, N, N>& a,
+                                                            int sweeps = detail::default_jacobi_sweeps<T>()) noexcept
+    {
+        const SymmetricEigen<T, N> eigen = symmetric_eigen(transpose(a) * a, sweeps);
+        const QrDecomposition<T, N> factors = qr(a * eigen.vectors);
+        Vector<T, N> sigma{};
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            sigma[i] = factors.r(i, i);
+        }
+        return {factors.q, sigma, eigen.vectors};
+    }
+
+    template <typename T, std::size_t N>
+    ENGINE_MATH_INLINE PolarDecomposition<T, N> polar(const Matrix<T, N, N>& a,
+                                                      int sweeps = detail::default_jacobi_sweeps<T>()) noexcept
+    {
+        const SingularValueDecomposition<T, N> f = svd(a, sweeps);
+        const Matrix<T, N, N> vt = transpose(f.v);
+        Matrix<T, N, N> scaled_v = f.v;
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            scaled_v.columns[i] *= f.sigma[i];
+        }
+        return {f.u * vt, scaled_v * vt};
+    }
+
+    // Solves A x = b by LU with partial pivoting; nullopt when A is singular.
+    template <typename T, std::size_t N>
+    ENGINE_MATH_INLINE std::optional<Vector<T, N>> try_solve(const Matrix<T, N, N>& a, const Vector<T, N>& b) noexcept
+    {
+        static_assert(N >= 2 && N <= 4, "fixed-size decompositions support 2x2, 3x3 and 4x4 matrices");
+        Matrix<T, N, N> lu = a;
+        Vector<T, N> x = b;
+        bool singular = false;
+        for (std::size_t k = 0; k < N; ++k)
+        {
+            // Branch-free pivot search and row exchange.
+            std::size_t pivot = k;
+            T best = lu(k, k) < detail::zero<T>() ? -lu(k, k) : lu(k, k);
+            for (std::size_t i = k + 1; i < N; ++i)
+            {
+                const T candidate = lu(i, k) < detail::zero<T>() ? -lu(i, k) : lu(i, k);
+                const bool better = candidate > best;
+                best = detail::select(better, candidate, best);
+                pivot = better ? i : pivot;
+            }
+            for (std::size_t c = 0; c < N; ++c)
+            {
+                const T top = lu(k, c);
+                lu(k, c) = lu(pivot, c);
+                lu(pivot, c) = top;
+            }
+            const T top = x[k];
+            x[k] = x[pivot];
+            x[pivot] = top;
+
+            singular = singular || best == detail::zero<T>();
+            const T inv_pivot = detail::one<T>() / detail::select(best == detail::zero<T>(), detail::one<T>(), lu(k, k));
+            for (std::size_t i = k + 1; i < N; ++i)
+            {
+                const T factor = lu(i, k) * inv_pivot;
+                for (std::size_t c = k; c < N; ++c)
+                {
+                    lu(i, c) -= factor * lu(k, c);
+                }
+                x[i] -= factor * x[k];
+            }
+        }
+        if (singular)
+        {
+            return std::nullopt;
+        }
+        for (std::size_t k = N; k-- > 0;)
+        {
+            T sum = x[k];
+            for (std::size_t c = k + 1; c < N; ++c)
+            {
+                sum -= lu(k, c) * x[c];
+            }
+            x[k] = sum / lu(k, k);
+        }
+        return x;
+    }
+
+    // Batched forms: out[i] = f(in[i]), split across the shared worker pool.
+    namespace detail
+    {
+        inline constexpr std::size_t kDecompositionGrain = 256;
+
+        template <typename In, typename Out, typename Fn>
+        void decompose_batch(std::span<const In> in, std::span<Out> out, Fn&& fn)
+        {
+            assert(in.size() == out.size());
+            parallel::parallel_for(0, in.size(), kDecompositionGrain, [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    out[i] = fn(in[i]);
+                }
+            });
+        }
+    } // namespace detail
+
+    template <typename T, std::size_t N>
+    void symmetric_eigen(std::span<const Matrix<T, N, N>> in, std::span<SymmetricEigen<T, N>> out)
+    {
+        detail::decompose_batch(in, out, [](const Matrix<T, N, N>& m) { return symmetric_eigen(m); });
+    }
+
+    template <typename T, std::size_t N>
+    void qr(std::span<const Matrix<T, N, N>> in, std::span<QrDecomposition<T, N>> out)
+    {
+        detail::decompose_batch(in, out, [](const Matrix<T, N, N>& m) { return qr(m); });
+    }
+
+    template <typename T, std::size_t N>
+    void svd(std::span<const Matrix<T, N, N>> in, std::span<SingularValueDecomposition<T, N>> out)
+    {
+        detail::decompose_batch(in, out, [](const Matrix<T, N, N>& m) { return svd(m); });
+    }
+
+    template <typename T, std::size_t N>
+    void polar(std::span<const Matrix<T, N, N>> in, std::span<PolarDecomposition<T, N>> out)
+    {
+        detail::decompose_batch(in, out, [](const Matrix<T, N, N>& m) { return polar(m); });
+    }
+} // namespace engine::math
@@ -147,7 +147,7 @@ namespace engine::math
 
         ENGINE_MATH_INLINE T& operator()(size_type r, size_type c) noexcept { return columns[c][r]; }
 
-        ENGINE_MATH_INLINE const T& operator()(size_type r, size_type c) const noexcept { return columns[c][r]; }
+        ENGINE_MATH_INLINE T operator()(size_type r, size_type c) const noexcept { return columns[c][r]; }
 
         ENGINE_MATH_INLINE T* data() noexcept { return columns[0].elements; }
 
@@ -0,0 +1,252 @@
+#pragma once
+
+#include "utils/utils.hpp"
+#include "engine/math/common.hpp"
+#include "engine/math/parallel.hpp"
+#include "engine/math/vector.hpp"
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+
+// Compact storage types for vertex attributes. Each type is a trivially copyable wrapper around its bits and
+// converts to/from its full-precision counterpart through PackTraits, so attribute arrays can stay resident
+// packed and be expanded on demand with the batched pack()/unpack() kernels.
+namespace engine::math
+{
+    // IEEE 754 binary16. Conversion rounds to nearest even and preserves infinities, NaNs and subnormals
+    // (after F. Giesen, "half <-> float conversions").
+    struct half
+    {
+        std::uint16_t bits = 0;
+
+        ENGINE_MATH_INLINE static half from_float(float value) noexcept
+        {
+            constexpr std::uint32_t f32_infinity = 255u << 23;
+            constexpr std::uint32_t f16_overflow = (127u + 16u) << 23;
+            constexpr std::uint32_t denormal_limit = 113u << 23;
+            const float denormal_magic = std::bit_cast<float>(((127u - 15u) + (23u - 10u) + 1u) << 23);
+
+            std::uint32_t f = std::bit_cast<std::uint32_t>(value);
+            const std::uint32_t sign = f & 0x80000000u;
+            f ^= sign;
+
+            std::uint16_t out = 0;
+            if (f >= f16_overflow)
+            {
+                out = f > f32_infinity ? std::uint16_t{0x7e00} : std::uint16_t{0x7c00};
+            }
+            else if (f < denormal_limit)
+            {
+                const float shifted = std::bit_cast<float>(f) + denormal_magic;
+                out = static_cast<std::uint16_t>(std::bit_cast<std::uint32_t>(shifted) -
+                                                 std::bit_cast<std::uint32_t>(denormal_magic));
+            }
+            else
+            {
+                const std::uint32_t mantissa_odd = (f >> 13) & 1u;
+                f += (static_cast<std::uint32_t>(15 - 127) << 23) + 0xfffu;
+                f += mantissa_odd;
+                out = static_cast<std::uint16_t>(f >> 13);
+            }
+            return half{static_cast<std::uint16_t>(out | (sign >> 16))};
+        }
+
+        [[nodiscard]] ENGINE_MATH_INLINE float to_float() const noexcept
+        {
+            constexpr std::uint32_t shifted_exponent = 0x7c00u << 13;
+            const float magic = std::bit_cast<float>(113u << 23);
+
+            std::uint32_t out = (static_cast<std::uint32_t>(bits) & 0x7fffu) << 13;
+            const std::uint32_t exponent = shifted_exponent & out;
+            out += (127u - 15u) << 23;
+            if (exponent == shifted_exponent)
+            {
+                out += (128u - 16u) << 23; // Inf/NaN
+            }
+            else if (exponent == 0)
+            {
+                out += 1u << 23; // zero/subnormal: renormalise
+                out = std::bit_cast<std::uint32_t>(std::bit_cast<float>(out) - magic);
+            }
+            out |= (static_cast<std::uint32_t>(bits) & 0x8000u) << 16;
+            return std::bit_cast<float>(out);
+        }
+
+        friend ENGINE_MATH_INLINE bool operator==(half lhs, half rhs) noexcept = default;
+    };
+
+    inline std::ostream& operator<<(std::ostream& os, half value)
+    {
+        return os << value.to_float();
+    }
+
+    // Signed normalised 16-bit fixed point covering [-1, 1].
+    struct snorm16
+    {
+        std::int16_t bits = 0;
+
+        ENGINE_MATH_INLINE static snorm16 from_float(float value) noexcept
+        {
+            const float scaled = utils::clamp(value, -1.0F, 1.0F) * 32767.0F;
+            return snorm16{static_cast<std::int16_t>(scaled + (scaled >= 0.0F ? 0.5F : -0.5F))};
+        }
+
+        [[nodiscard]] ENGINE_MATH_INLINE float to_float() const noexcept
+        {
+            return utils::max(static_cast<float>(bits) / 32767.0F, -1.0F);
+        }
+
+        friend ENGINE_MATH_INLINE bool operator==(snorm16 lhs, snorm16 rhs) noexcept = default;
+    };
+
+    // Unsigned normalised 8-bit fixed point covering [0, 1] (colours, weights).
+    struct unorm8
+    {
+        std::uint8_t bits = 0;
+
+        ENGINE_MATH_INLINE static unorm8 from_float(float value) noexcept
+        {
+            return unorm8{static_cast<std::uint8_t>(utils::clamp(value, 0.0F, 1.0F) * 255.0F + 0.5F)};
+        }
+
+        [[nodiscard]] ENGINE_MATH_INLINE float to_float() const noexcept
+        {
+            return static_cast<float>(bits) / 255.0F;
+        }
+
+        friend ENGINE_MATH_INLINE bool operator==(unorm8 lhs, unorm8 rhs) noexcept = default;
+    };
+
+    // Unit vector in 4 bytes: octahedral projection (Cigolle et al., "A Survey of Efficient Representations
+    // for Independent Unit Vectors") quantised to two snorm16. Angular error stays below 8e-5 rad.
+    struct oct_normal16
+    {
+        snorm16 u;
+        snorm16 v;
+
+        ENGINE_MATH_INLINE static oct_normal16 from_vector(const Vector<float, 3>& n) noexcept
+        {
+            const float l1 = utils::abs(n[0]) + utils::abs(n[1]) + utils::abs(n[2]);
+            const float inv = l1 > 0.0F ? 1.0F / l1 : 0.0F;
+            float x = n[0] * inv;
+            float y = n[1] * inv;
+            if (n[2] < 0.0F)
+            {
+                const float fx = (1.0F - utils::abs(y)) * (x >= 0.0F ? 1.0F : -1.0F);
+                const float fy = (1.0F - utils::abs(x)) * (y >= 0.0F ? 1.0F : -1.0F);
+                x = fx;
+                y = fy;
+            }
+            return oct_normal16{snorm16::from_float(x), snorm16::from_float(y)};
+        }
+
+        // Unit length on return; the zero vector encodes to +z.
+        [[nodiscard]] ENGINE_MATH_INLINE Vector<float, 3> to_vector() const noexcept
+        {
+            float x = u.to_float();
+            float y = v.to_float();
+            const float z = 1.0F - utils::abs(x) - utils::abs(y);
+            const float fold = utils::max(-z, 0.0F);
+            x += x >= 0.0F ? -fold : fold;
+            y += y >= 0.0F ? -fold : fold;
+            const float inv_length = 1.0F / utils::sqrt(x * x + y * y + z * z);
+            return Vector<float, 3>{x * inv_length, y * inv_length, z * inv_length};
+        }
+
+        friend ENGINE_MATH_INLINE bool operator==(oct_normal16 lhs, oct_normal16 rhs) noexcept = default;
+    };
+
+    using hvec2 = Vector<half, 2>;
+    using hvec3 = Vector<half, 3>;
+    using hvec4 = Vector<half, 4>;
+
+    // PackTraits<P>::pack/unpack convert between a packed type and its full-precision type.
+    template <typename Packed>
+    struct PackTraits;
+
+    template <typename Scalar>
+        requires requires(Scalar s) { { Scalar::from_float(0.0F) }; { s.to_float() }; }
+    struct PackTraits<Scalar>
+    {
+        using unpacked_type = float;
+        ENGINE_MATH_INLINE static Scalar pack(float value) noexcept { return Scalar::from_float(value); }
+        ENGINE_MATH_INLINE static float unpack(Scalar value) noexcept { return value.to_float(); }
+    };
+
+    template <typename Packed, std::size_t N>
+    struct PackTraits<Vector<Packed, N>>
+    {
+        using unpacked_type = Vector<typename PackTraits<Packed>::unpacked_type, N>;
+
+        ENGINE_MATH_INLINE static Vector<Packed, N> pack(const unpacked_type& value) noexcept
+        {
+            Vector<Packed, N> out{};
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                out[i] = PackTraits<Packed>::pack(value[i]);
+            }
+            return out;
+        }
+
+        ENGINE_MATH_INLINE static unpacked_type unpack(const Vector<Packed, N>& value) noexcept
+        {
+            unpacked_type out{};
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                out[i] = PackTraits<Packed>::unpack(value[i]);
+            }
+            return out;
+        }
+    };
+
+    template <>
+    struct PackTraits<oct_normal16>
+    {
+        using unpacked_type = Vector<float, 3>;
+        ENGINE_MATH_INLINE static oct_normal16 pack(const unpacked_type& value) noexcept
+        {
+            return oct_normal16::from_vector(value);
+        }
+        ENGINE_MATH_INLINE static unpacked_type unpack(oct_normal16 value) noexcept { return value.to_vector(); }
+    };
+
+    template <typename Packed>
+    using unpacked_t = typename PackTraits<Packed>::unpacked_type;
+
+    namespace detail
+    {
+        inline constexpr std::size_t kPackGrain = 16384;
+    }
+
+    // out[i] = pack(in[i]); large arrays are split across the worker pool.
+    template <typename Packed>
+    void pack(std::span<const unpacked_t<Packed>> in, std::span<Packed> out)
+    {
+        assert(in.size() == out.size());
+        parallel::parallel_for(0, in.size(), detail::kPackGrain, [&](std::size_t first, std::size_t last)
+        {
+            for (std::size_t i = first; i < last; ++i)
+            {
+                out[i] = PackTraits<Packed>::pack(in[i]);
+            }
+        });
+    }
+
+    // out[i] = unpack(in[i]); large arrays are split across the worker pool.
+    template <typename Packed>
+    void unpack(std::span<const Packed> in, std::span<unpacked_t<Packed>> out)
+    {
+        assert(in.size() == out.size());
+        parallel::parallel_for(0, in.size(), detail::kPackGrain, [&](std::size_t first, std::size_t last)
+        {
+            for (std::size_t i = first; i < last; ++i)
+            {
+                out[i] = PackTraits<Packed>::unpack(in[i]);
+            }
+        });
+    }
+} // namespace engine::math
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace engine::math::parallel
+{
+    namespace detail
+    {
+        // Persistent fork/join pool shared by the data-parallel kernels of the engine. The calling thread
+        // participates in every job, so a pool with zero workers degrades to a plain serial loop. Only one
+        // job runs at a time: nested or concurrent dispatches find the pool busy and run
+        // serially on the caller instead of blocking.
+        class WorkerPool
+        {
+        public:
+            using ChunkFn = void (*)(void* context, std::size_t chunk);
+
+            static WorkerPool& instance()
+            {
+                static WorkerPool pool;
+                return pool;
+            }
+
+            WorkerPool(const WorkerPool&) = delete;
+            WorkerPool& operator=(const WorkerPool&) = delete;
+
+            ~WorkerPool()
+            {
+                {
+                    std::lock_guard lock(mutex_);
+                    stop_ = true;
+                }
+                wake_.notify_all();
+                for (auto& worker : workers_)
+                {
+                    worker.join();
+                }
+            }
+
+            [[nodiscard]] std::size_t concurrency() const noexcept
+            {
+                const std::size_t limit = max_concurrency_.load(std::memory_order_relaxed);
+                const std::size_t available = workers_.size() + 1;
+                return limit == 0 ? available : std::min(limit, available);
+            }
+
+            void set_max_concurrency(std::size_t limit) noexcept
+            {
+                max_concurrency_.store(limit, std::memory_order_relaxed);
+            }
+
+            // Runs fn(context, chunk) for every chunk in [0, chunk_count). Returns once all chunks finished.
+            void run(std::size_t chunk_count, ChunkFn fn, void* context)
+            {
+                bool idle = false;
+                if (concurrency() <= 1 || chunk_count <= 1 || !dispatching_.compare_exchange_strong(idle, true))
+                {
+                    for (std::size_t chunk = 0; chunk < chunk_count; ++chunk)
+                    {
+                        fn(context, chunk);
+                    }
+                    return;
+                }
+                struct DispatchGuard
+                {
+                    std::atomic<bool>& flag;
+                    ~DispatchGuard() { flag.store(false, std::memory_order_release); }
+                } guard{dispatching_};
+
+                {
+                    std::lock_guard lock(mutex_);
+                    job_fn_ = fn;
+                    job_context_ = context;
+                    job_chunks_ = chunk_count;
+                    job_helpers_ = std::min(concurrency(), chunk_count) - 1;
+                    next_chunk_.store(0, std::memory_order_relaxed);
+                    error_ = nullptr;
+                    ++generation_;
+                }
+                wake_.notify_all();
+
+                execute(fn, context, chunk_count);
+
+                std::unique_lock lock(mutex_);
+                done_.wait(lock, [this]() { return busy_ == 0; });
+                job_fn_ = nullptr;
+                job_context_ = nullptr;
+                job_chunks_ = 0;
+                job_helpers_ = 0;
+                if (error_)
+                {
+                    std::rethrow_exception(std::exchange(error_, nullptr));
+                }
+            }
+
+        private:
+            WorkerPool()
+            {
+                const std::size_t hardware = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+                workers_.reserve(hardware - 1);
+                for (std::size_t i = 0; i + 1 < hardware; ++i)
+                {
+                    workers_.emplace_back([this, i]() { worker_loop(i); });
+                }
+            }
+
+            void worker_loop(std::size_t index)
+            {
+                std::size_t seen = 0;
+                std::unique_lock lock(mutex_);
+                while (true)
+                {
+                    wake_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+                    if (stop_)
+                    {
+                        return;
+                    }
+                    seen = generation_;
+                    if (job_fn_ == nullptr || index >= job_helpers_)
+                    {
+                        continue;
+                    }
+
+                    const ChunkFn fn = job_fn_;
+                    void* context = job_context_;
+                    const std::size_t chunk_count = job_chunks_;
+                    ++busy_;
+                    lock.unlock();
+                    execute(fn, context, chunk_count);
+                    lock.lock();
+                    if (--busy_ == 0)
+                    {
+                        done_.notify_all();
+                    }
+                }
+            }
+
+            void execute(ChunkFn fn, void* context, std::size_t chunk_count)
+            {
+                while (true)
+                {
+                    const std::size_t chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed);
+                    if (chunk >= chunk_count)
+                    {
+                        return;
+                    }
+                    try
+                    {
+                        fn(context, chunk);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard lock(mutex_);
+                        if (!error_)
+                        {
+                            error_ = std::current_exception();
+                        }
+                        next_chunk_.store(chunk_count, std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            std::vector<std::thread> workers_;
+            std::atomic<bool> dispatching_{false};
+            std::mutex mutex_;
+            std::condition_variable wake_;
+            std::condition_variable done_;
+            std::atomic<std::size_t> next_chunk_{0};
+            std::atomic<std::size_t> max_concurrency_{0};
+            ChunkFn job_fn_ = nullptr;
+            void* job_context_ = nullptr;
+            std::size_t job_chunks_ = 0;
+            std::size_t job_helpers_ = 0;
+            std::size_t generation_ = 0;
+            std::size_t busy_ = 0;
+            std::exception_ptr error_;
+            bool stop_ = false;
+        };
+    } // namespace detail
+
+    // Number of threads (workers plus caller) a parallel_for may use.
+    inline std::size_t concurrency() noexcept
+    {
+        return detail::WorkerPool::instance().concurrency();
+    }
+
+    // Caps the threads used by subsequent parallel_for calls; 0 restores the hardware default and 1 forces
+    // serial execution. Results never depend on this value because chunking is fixed by the grain size.
+    inline void set_max_concurrency(std::size_t limit) noexcept
+    {
+        detail::WorkerPool::instance().set_max_concurrency(limit);
+    }
+
+    // Number of chunks parallel_for(begin, end, grain, ...) dispatches.
+    [[nodiscard]] constexpr std::size_t chunk_count(std::size_t begin, std::size_t end, std::size_t grain) noexcept
+    {
+        if (end <= begin)
+        {
+            return 0;
+        }
+        grain = std::max<std::size_t>(grain, 1);
+        return (end - begin + grain - 1) / grain;
+    }
+
+    // Calls fn(first, last) for consecutive [first, last) chunks of at most `grain` indices covering
+    // [begin, end). Chunk boundaries only depend on the arguments, so per-chunk partial results combined
+    // in chunk order are deterministic regardless of the thread count.
+    template <typename Fn>
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, Fn&& fn)
+    {
+        const std::size_t chunks = chunk_count(begin, end, grain);
+        if (chunks == 0)
+        {
+            return;
+        }
+        grain = std::max<std::size_t>(grain, 1);
+
+        struct Context
+        {
+            std::size_t begin;
+            std::size_t end;
+            std::size_t grain;
+            std::remove_reference_t<Fn>* fn;
+        } context{begin, end, grain, &fn};
+
+        detail::WorkerPool::instance().run(chunks, [](void* raw, std::size_t chunk)
+        {
+            auto& ctx = *static_cast<Context*>(raw);
+            const std::size_t first = ctx.begin + chunk * ctx.grain;
+            const std::size_t last = std::min(ctx.end, first + ctx.grain);
+            (*ctx.fn)(first, last);
+        }, &context);
+    }
+
+    // Computes map(first, last) for every parallel_for chunk and folds the partial results left to right with
+    // combine, starting from identity. The result is independent of the thread count even for
+    // non-associative combines such as floating-point sums.
+    template <typename T, typename Map, typename Combine>
+    [[nodiscard]] T parallel_reduce(std::size_t begin, std::size_t end, std::size_t grain, T identity, Map&& map,
+                                   Combine&& combine)
+    {
+        grain = std::max<std::size_t>(grain, 1);
+        std::vector<T> partials(chunk_count(begin, end, grain), identity);
+        parallel_for(begin, end, grain, [&](std::size_t first, std::size_t last)
+        {
+            partials[(first - begin) / grain] = map(first, last);
+        });
+        T result = std::move(identity);
+        for (auto& partial : partials)
+        {
+            result = combine(std::move(result), std::move(partial));
+        }
+        return result;
+    }
+} // namespace engine::math::parallel
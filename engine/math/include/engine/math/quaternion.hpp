@@ -4,6 +4,10 @@
 #include "engine/math/common.hpp"
 #include "engine/math/vector.hpp"
 #include "engine/math/matrix.hpp"
+#include "engine/math/parallel.hpp"
+
+#include <cassert>
+#include <span>
 
 namespace engine::math
 {
@@ -402,6 +406,81 @@ namespace engine::math
         return slerp(slerp1, slerp2, static_cast<T>(2) * t * (detail::one<T>() - t));
     }
 
+    // Normalised lerp along the shortest arc with the cubic time correction from Kapoulkine, "Approximating
+    // slerp" (2015): t is remapped by a polynomial in |cos theta| so the result stays within 8e-4 rad of
+    // slerp for unit inputs, using no trigonometry and no branches.
+    template <typename T>
+    ENGINE_MATH_INLINE Quaternion<T> nlerp(const Quaternion<T>& from, const Quaternion<T>& to, T t) noexcept
+    {
+        const T cos_theta = dot(from, to);
+        const T sign = cos_theta < detail::zero<T>() ? -detail::one<T>() : detail::one<T>();
+        const T d = cos_theta * sign;
+        const T a = T(1.0904) + d * (T(-3.2452) + d * (T(3.55645) - d * T(1.43519)));
+        const T b = T(0.848013) + d * (T(-1.06021) + d * T(0.215638));
+        const T centered = t - T(0.5);
+        const T k = a * centered * centered + b;
+        const T corrected = t + t * centered * (t - detail::one<T>()) * k;
+        return normalize((detail::one<T>() - corrected) * from + (corrected * sign) * to);
+    }
+
+    // Batched interpolation: out[i] = f(from[i], to[i], t or t[i]). Large batches are split across the
+    // shared worker pool; out may alias from or to.
+    namespace detail
+    {
+        inline constexpr std::size_t kQuaternionBatchGrain = 2048;
+
+        template <typename T, typename Weight, typename Fn>
+        void interpolate_batch(std::span<const Quaternion<T>> from,
+                               std::span<const Quaternion<T>> to,
+                               Weight weight,
+                               std::span<Quaternion<T>> out,
+                               Fn&& fn)
+        {
+            assert(from.size() == to.size() && out.size() == from.size());
+            parallel::parallel_for(0, out.size(), kQuaternionBatchGrain, [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    out[i] = fn(from[i], to[i], weight(i));
+                }
+            });
+        }
+    } // namespace detail
+
+    template <typename T>
+    void slerp(std::span<const Quaternion<T>> from, std::span<const Quaternion<T>> to, T t,
+               std::span<Quaternion<T>> out)
+    {
+        detail::interpolate_batch(from, to, [t](std::size_t) { return t; }, out,
+                                  [](const Quaternion<T>& a, const Quaternion<T>& b, T w) { return slerp(a, b, w); });
+    }
+
+    template <typename T>
+    void slerp(std::span<const Quaternion<T>> from, std::span<const Quaternion<T>> to, std::span<const T> t,
+               std::span<Quaternion<T>> out)
+    {
+        assert(t.size() == out.size());
+        detail::interpolate_batch(from, to, [t](std::size_t i) { return t[i]; }, out,
+                                  [](const Quaternion<T>& a, const Quaternion<T>& b, T w) { return slerp(a, b, w); });
+    }
+
+    template <typename T>
+    void nlerp(std::span<const Quaternion<T>> from, std::span<const Quaternion<T>> to, T t,
+               std::span<Quaternion<T>> out)
+    {
+        detail::interpolate_batch(from, to, [t](std::size_t) { return t; }, out,
+                                  [](const Quaternion<T>& a, const Quaternion<T>& b, T w) { return nlerp(a, b, w); });
+    }
+
+    template <typename T>
+    void nlerp(std::span<const Quaternion<T>> from, std::span<const Quaternion<T>> to, std::span<const T> t,
+               std::span<Quaternion<T>> out)
+    {
+        assert(t.size() == out.size());
+        detail::interpolate_batch(from, to, [t](std::size_t i) { return t[i]; }, out,
+                                  [](const Quaternion<T>& a, const Quaternion<T>& b, T w) { return nlerp(a, b, w); });
+    }
+
     template <typename T>
     ENGINE_MATH_INLINE Vector<T, 4> to_angle_axis(const Quaternion<T>& quat) noexcept
     {
@@ -0,0 +1,378 @@
+#pragma once
+
+#include "engine/math/sparse_matrix.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace engine::math
+{
+    enum class SparseOrdering : std::uint8_t
+    {
+        Natural,
+        ApproximateMinimumDegree,
+    };
+
+    // Fill-reducing symmetric ordering of the pattern of A + A^T (values and the diagonal are ignored).
+    // Minimum degree on the quotient graph: eliminated pivots become elements that absorb their neighbours'
+    // elements, and each variable's degree is the AMD upper bound |A_i| + sum_e |L_e \ i|. Supervariable
+    // detection is not performed. Returns perm with perm[new] = old.
+    template <typename T>
+    std::vector<std::size_t> approximate_minimum_degree(const SparseMatrix<T>& A)
+    {
+        assert(A.rows() == A.cols());
+        const std::size_t n = A.rows();
+
+        std::vector<std::vector<std::size_t>> variables(n); // A_i: live variable neighbours
+        std::vector<std::vector<std::size_t>> elements(n); // E_i: adjacent elements (eliminated pivots)
+        std::vector<std::vector<std::size_t>> element_vars(n); // L_e: live variables of element e
+        A.for_each_nz([&](std::size_t r, std::size_t c, const T&)
+        {
+            if (r != c)
+            {
+                variables[r].push_back(c);
+                variables[c].push_back(r);
+            }
+        });
+        for (auto& adjacency : variables)
+        {
+            std::sort(adjacency.begin(), adjacency.end());
+            adjacency.erase(std::unique(adjacency.begin(), adjacency.end()), adjacency.end());
+        }
+
+        std::vector<std::size_t> degree(n);
+        std::set<std::pair<std::size_t, std::size_t>> queue; // (degree, variable)
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            degree[i] = variables[i].size();
+            queue.emplace(degree[i], i);
+        }
+
+        constexpr std::size_t kNone = std::numeric_limits<std::size_t>::max();
+        std::vector<bool> eliminated(n, false);
+        std::vector<std::size_t> mark(n, kNone);
+        std::vector<std::size_t> perm;
+        perm.reserve(n);
+
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            const std::size_t p = queue.begin()->second;
+            queue.erase(queue.begin());
+            eliminated[p] = true;
+            perm.push_back(p);
+
+            // L_p = A_p u (union of absorbed L_e), minus p.
+            auto& pivot_vars = element_vars[p];
+            pivot_vars.clear();
+            mark[p] = p;
+            const auto gather = [&](std::size_t v)
+            {
+                if (mark[v] != p && !eliminated[v])
+                {
+                    mark[v] = p;
+                    pivot_vars.push_back(v);
+                }
+            };
+            for (std::size_t v : variables[p]) gather(v);
+            for (std::size_t e : elements[p])
+            {
+                for (std::size_t v : element_vars[e]) gather(v);
+            }
+            const std::vector<std::size_t> absorbed = std::move(elements[p]);
+            std::vector<std::size_t>().swap(variables[p]);
+            elements[p].clear();
+            for (std::size_t e : absorbed)
+            {
+                std::vector<std::size_t>().swap(element_vars[e]);
+            }
+
+            for (std::size_t i : pivot_vars)
+            {
+                // Absorbed elements are replaced by p; variable edges now covered by p are pruned.
+                auto& e_i = elements[i];
+                e_i.erase(std::remove_if(e_i.begin(), e_i.end(), [&](std::size_t e)
+                {
+                    return std::binary_search(absorbed.begin(), absorbed.end(), e) || e == p;
+                }), e_i.end());
+                e_i.push_back(p);
+                std::sort(e_i.begin(), e_i.end());
+
+                auto& a_i = variables[i];
+                a_i.erase(std::remove_if(a_i.begin(), a_i.end(), [&](std::size_t v)
+                {
+                    return v == p || mark[v] == p;
+                }), a_i.end());
+
+                std::size_t d = a_i.size();
+                for (std::size_t e : e_i)
+                {
+                    d += element_vars[e].size() - 1;
+                }
+                d = std::min(d, n - k - 1);
+                queue.erase({degree[i], i});
+                degree[i] = d;
+                queue.emplace(d, i);
+            }
+        }
+        return perm;
+    }
+
+    // Simplicial sparse LDL^T factorization P A P^T = L D L^T for symmetric (possibly indefinite) A.
+    // A may store the upper triangle, the lower triangle or both: each off-diagonal pair is read once, from its
+    // upper entry when present and otherwise from the lower one, and mirrored into the permuted upper triangle.
+    //
+    // analyze() computes the ordering, elimination tree and column counts; factorize() refills the numeric
+    // factor for any matrix with the analyzed sparsity pattern. Both are cached, so repeated solves with the
+    // same system cost one forward and one backward substitution, and a changing matrix on fixed topology
+    // only repeats factorize().
+    template <typename T>
+    class SparseLdlt
+    {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using index_type = std::size_t;
+
+        SparseLdlt() = default;
+
+        explicit SparseLdlt(const SparseMatrix<T>& A,
+                            SparseOrdering ordering = SparseOrdering::ApproximateMinimumDegree)
+        {
+            (void)compute(A, ordering);
+        }
+
+        // Symbolic analysis; returns false for non-square input.
+        [[nodiscard]] bool analyze(const SparseMatrix<T>& A,
+                                   SparseOrdering ordering = SparseOrdering::ApproximateMinimumDegree)
+        {
+            analyzed_ = false;
+            factorized_ = false;
+            if (A.rows() != A.cols())
+            {
+                return false;
+            }
+
+            n_ = A.rows();
+            pattern_col_ptr_ = A.col_ptr;
+            pattern_row_ind_ = A.row_ind;
+
+            if (ordering == SparseOrdering::ApproximateMinimumDegree)
+            {
+                perm_ = approximate_minimum_degree(A);
+            }
+            else
+            {
+                perm_.resize(n_);
+                for (size_type i = 0; i < n_; ++i) perm_[i] = i;
+            }
+            perm_inv_.resize(n_);
+            for (size_type k = 0; k < n_; ++k) perm_inv_[perm_[k]] = k;
+            build_permuted_upper(A);
+
+            parent_.assign(n_, kNone);
+            col_count_.assign(n_, 0);
+            flag_.assign(n_, kNone);
+            for (size_type k = 0; k < n_; ++k)
+            {
+                flag_[k] = k;
+                for (index_type p = upper_col_ptr_[k]; p < upper_col_ptr_[k + 1]; ++p)
+                {
+                    // Walk the elimination tree from i up to k; each visited node gains a nonzero in row k.
+                    for (size_type i = upper_row_ind_[p]; i < k && flag_[i] != k; i = parent_[i])
+                    {
+                        if (parent_[i] == kNone) parent_[i] = k;
+                        ++col_count_[i];
+                        flag_[i] = k;
+                    }
+                }
+            }
+
+            l_col_ptr_.assign(n_ + 1, 0);
+            for (size_type k = 0; k < n_; ++k)
+            {
+                l_col_ptr_[k + 1] = l_col_ptr_[k] + col_count_[k];
+            }
+            l_row_ind_.resize(l_col_ptr_[n_]);
+            l_values_.resize(l_col_ptr_[n_]);
+            d_.resize(n_);
+            work_.resize(n_);
+            pattern_.resize(n_);
+            analyzed_ = true;
+            return true;
+        }
+
+        // Numeric factorization. Returns false if A's pattern differs from the analyzed one or a zero pivot
+        // is encountered (A singular under this ordering).
+        [[nodiscard]] bool factorize(const SparseMatrix<T>& A)
+        {
+            factorized_ = false;
+            if (!analyzed_ || A.rows() != n_ || A.cols() != n_ ||
+                A.col_ptr != pattern_col_ptr_ || A.row_ind != pattern_row_ind_)
+            {
+                return false;
+            }
+
+            std::fill(work_.begin(), work_.end(), T(0));
+            std::fill(flag_.begin(), flag_.end(), kNone);
+            for (size_type k = 0; k < n_; ++k)
+            {
+                // Scatter column k of the permuted upper triangle into work_ and find the nonzero pattern of
+                // row k of L by walking the elimination tree (topological order in pattern_[top..n)).
+                size_type top = n_;
+                flag_[k] = k;
+                col_count_[k] = 0;
+                for (index_type p = upper_col_ptr_[k]; p < upper_col_ptr_[k + 1]; ++p)
+                {
+                    size_type i = upper_row_ind_[p];
+                    work_[i] += A.values[upper_source_[p]];
+                    size_type len = 0;
+                    for (; flag_[i] != k; i = parent_[i])
+                    {
+                        pattern_[len++] = i;
+                        flag_[i] = k;
+                    }
+                    while (len > 0) pattern_[--top] = pattern_[--len];
+                }
+
+                d_[k] = work_[k];
+                work_[k] = T(0);
+                for (; top < n_; ++top)
+                {
+                    const size_type i = pattern_[top];
+                    const T yi = work_[i];
+                    work_[i] = T(0);
+                    const index_type end = l_col_ptr_[i] + col_count_[i];
+                    for (index_type p = l_col_ptr_[i]; p < end; ++p)
+                    {
+                        work_[l_row_ind_[p]] -= l_values_[p] * yi;
+                    }
+                    const T l_ki = yi / d_[i];
+                    d_[k] -= l_ki * yi;
+                    l_row_ind_[end] = k;
+                    l_values_[end] = l_ki;
+                    ++col_count_[i];
+                }
+                if (d_[k] == T(0))
+                {
+                    return false;
+                }
+            }
+            factorized_ = true;
+            return true;
+        }
+
+        [[nodiscard]] bool compute(const SparseMatrix<T>& A,
+                                   SparseOrdering ordering = SparseOrdering::ApproximateMinimumDegree)
+        {
+            return analyze(A, ordering) && factorize(A);
+        }
+
+        // x = A^-1 b using the cached factor; b and x may alias. Not safe to call concurrently on one
+        // instance (uses an internal scratch vector); copy the solver per thread instead.
+        void solve(std::span<const T> b, std::span<T> x)
+        {
+            assert(factorized_ && b.size() == n_ && x.size() == n_);
+            for (size_type k = 0; k < n_; ++k) work_[k] = b[perm_[k]];
+            for (size_type j = 0; j < n_; ++j)
+            {
+                const T yj = work_[j];
+                for (index_type p = l_col_ptr_[j]; p < l_col_ptr_[j + 1]; ++p)
+                {
+                    work_[l_row_ind_[p]] -= l_values_[p] * yj;
+                }
+            }
+            for (size_type j = 0; j < n_; ++j) work_[j] /= d_[j];
+            for (size_type j = n_; j-- > 0;)
+            {
+                T yj = work_[j];
+                for (index_type p = l_col_ptr_[j]; p < l_col_ptr_[j + 1]; ++p)
+                {
+                    yj -= l_values_[p] * work_[l_row_ind_[p]];
+                }
+                work_[j] = yj;
+            }
+            for (size_type k = 0; k < n_; ++k) x[perm_[k]] = work_[k];
+        }
+
+        [[nodiscard]] bool analyzed() const noexcept { return analyzed_; }
+        [[nodiscard]] bool factorized() const noexcept { return factorized_; }
+        [[nodiscard]] size_type size() const noexcept { return n_; }
+
+        // Strictly lower nonzeros of L.
+        [[nodiscard]] size_type factor_nonzeros() const noexcept { return l_row_ind_.size(); }
+
+        // perm[new] = old.
+        [[nodiscard]] std::span<const index_type> permutation() const noexcept { return perm_; }
+
+        // D of the factorization, in permuted order; its signs give the inertia of A.
+        [[nodiscard]] std::span<const T> diagonal() const noexcept { return d_; }
+
+    private:
+        static constexpr index_type kNone = std::numeric_limits<index_type>::max();
+
+        // Pattern of the permuted upper triangle of A + A^T, keeping for every entry its index into A.values.
+        void build_permuted_upper(const SparseMatrix<T>& A)
+        {
+            const auto kept = [&](size_type row, size_type col)
+            {
+                return row <= col || !A.try_get(col, row).has_value();
+            };
+            upper_col_ptr_.assign(n_ + 1, 0);
+            A.for_each_nz([&](size_type row, size_type col, const T&)
+            {
+                if (kept(row, col)) ++upper_col_ptr_[std::max(perm_inv_[row], perm_inv_[col]) + 1];
+            });
+            for (size_type k = 0; k < n_; ++k) upper_col_ptr_[k + 1] += upper_col_ptr_[k];
+
+            upper_row_ind_.resize(upper_col_ptr_[n_]);
+            upper_source_.resize(upper_col_ptr_[n_]);
+            std::vector<index_type> next(upper_col_ptr_.begin(), upper_col_ptr_.end() - 1);
+            for (size_type col = 0; col < n_; ++col)
+            {
+                for (index_type p = A.col_ptr[col]; p < A.col_ptr[col + 1]; ++p)
+                {
+                    const size_type row = A.row_ind[p];
+                    if (!kept(row, col)) continue;
+                    const size_type i = perm_inv_[row];
+                    const size_type j = perm_inv_[col];
+                    const index_type slot = next[std::max(i, j)]++;
+                    upper_row_ind_[slot] = std::min(i, j);
+                    upper_source_[slot] = p;
+                }
+            }
+        }
+
+        size_type n_ = 0;
+        bool analyzed_ = false;
+        bool factorized_ = false;
+
+        // symbolic
+        std::vector<index_type> pattern_col_ptr_;
+        std::vector<index_type> pattern_row_ind_;
+        std::vector<index_type> perm_;
+        std::vector<index_type> perm_inv_;
+        std::vector<index_type> upper_col_ptr_;
+        std::vector<index_type> upper_row_ind_;
+        std::vector<index_type> upper_source_;
+        std::vector<index_type> parent_;
+        std::vector<index_type> l_col_ptr_;
+
+        // numeric
+        std::vector<index_type> l_row_ind_;
+        std::vector<T> l_values_;
+        std::vector<T> d_;
+
+        // scratch
+        std::vector<index_type> col_count_;
+        std::vector<index_type> flag_;
+        std::vector<index_type> pattern_;
+        std::vector<T> work_;
+    };
+} // namespace engine::math
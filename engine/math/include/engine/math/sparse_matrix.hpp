@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/math/matrix.hpp"
+#include "engine/math/parallel.hpp"
 
 #include <vector>
 #include <algorithm>
@@ -8,6 +9,7 @@
 #include <cassert>
 #include <optional>
 #include <limits>
+#include <span>
 
 namespace engine::math
 {
@@ -241,6 +243,23 @@ namespace engine::math
             }
         }
 
+        // y = A * x on caller-provided storage (no allocation). Column scatter is serial; convert to
+        // CsrMatrix for the multithreaded product.
+        ENGINE_MATH_INLINE void multiply(std::span<const value_type> x, std::span<value_type> y) const
+        {
+            assert(x.size() == cols_ && y.size() == rows_);
+            std::fill(y.begin(), y.end(), value_type{});
+            for (size_type c = 0; c < cols_; ++c)
+            {
+                const value_type xc = x[c];
+                if (xc == value_type{}) continue;
+                for (index_type k = col_ptr[c]; k < col_ptr[c + 1]; ++k)
+                {
+                    y[row_ind[k]] += values[k] * xc;
+                }
+            }
+        }
+
         // Simple structure checkers
         ENGINE_MATH_INLINE bool is_column_sorted() const noexcept
         {
@@ -382,4 +401,137 @@ namespace engine::math
         B *= s;
         return B;
     }
+
+    // Sparse, row-major (CSR) matrix with dynamic dimensions. Rows own disjoint outputs, so y = A * x splits
+    // across threads without write conflicts; this is the layout the iterative solvers operate on.
+    // Storage:
+    //   row_ptr: size = rows + 1, row_ptr[r]..row_ptr[r+1]-1 are indices of row r
+    //   col_ind: size = nnz, column index for each value (sorted within a row)
+    //   values : size = nnz, value for each nonzero
+    template <typename T>
+    struct CsrMatrix
+    {
+        using value_type = T;
+        using size_type = std::size_t;
+        using index_type = std::size_t;
+
+        // Rows per parallel task; small products stay on the calling thread.
+        static constexpr size_type kRowsPerTask = 1024;
+
+        size_type rows_ = 0;
+        size_type cols_ = 0;
+        std::vector<index_type> row_ptr; // size rows_ + 1
+        std::vector<index_type> col_ind; // size nnz
+        std::vector<value_type> values; // size nnz
+
+        CsrMatrix() noexcept = default;
+
+        CsrMatrix(size_type r, size_type c)
+            : rows_(r), cols_(c), row_ptr(r + 1, 0)
+        {
+        }
+
+        [[nodiscard]] size_type rows() const noexcept { return rows_; }
+        [[nodiscard]] size_type cols() const noexcept { return cols_; }
+        [[nodiscard]] size_type nnz() const noexcept { return values.size(); }
+
+        // The CSC arrays of A^T are exactly the CSR arrays of A.
+        static CsrMatrix from_csc(const SparseMatrix<T>& A)
+        {
+            SparseMatrix<T> AT = A.transpose();
+            CsrMatrix result;
+            result.rows_ = A.rows();
+            result.cols_ = A.cols();
+            result.row_ptr = std::move(AT.col_ptr);
+            result.col_ind = std::move(AT.row_ind);
+            result.values = std::move(AT.values);
+            return result;
+        }
+
+        static CsrMatrix from_triplets(size_type rows, size_type cols,
+                                       std::vector<typename SparseMatrix<T>::Triplet> trips)
+        {
+            return from_csc(SparseMatrix<T>::from_triplets(rows, cols, std::move(trips)));
+        }
+
+        [[nodiscard]] SparseMatrix<T> to_csc() const
+        {
+            SparseMatrix<T> AT(cols_, rows_);
+            AT.col_ptr = row_ptr;
+            AT.row_ind = col_ind;
+            AT.values = values;
+            return AT.transpose();
+        }
+
+        // Writes the main diagonal (missing entries read as zero); out.size() == min(rows, cols).
+        void diagonal(std::span<value_type> out) const
+        {
+            assert(out.size() == std::min(rows_, cols_));
+            for (size_type r = 0; r < out.size(); ++r)
+            {
+                const auto begin = col_ind.begin() + static_cast<std::ptrdiff_t>(row_ptr[r]);
+                const auto end = col_ind.begin() + static_cast<std::ptrdiff_t>(row_ptr[r + 1]);
+                const auto it = std::lower_bound(begin, end, r);
+                out[r] = (it != end && *it == r)
+                             ? values[static_cast<size_type>(it - col_ind.begin())]
+                             : value_type{};
+            }
+        }
+
+        // y = A * x, rows split across the worker pool. x and y must not alias.
+        void multiply(std::span<const value_type> x, std::span<value_type> y) const
+        {
+            assert(x.size() == cols_ && y.size() == rows_);
+            parallel::parallel_for(0, rows_, kRowsPerTask, [&](size_type first, size_type last)
+            {
+                for (size_type r = first; r < last; ++r)
+                {
+                    y[r] = row_dot(r, x);
+                }
+            });
+        }
+
+        // y += A * x, rows split across the worker pool. x and y must not alias.
+        void multiply_accumulate(std::span<const value_type> x, std::span<value_type> y) const
+        {
+            assert(x.size() == cols_ && y.size() == rows_);
+            parallel::parallel_for(0, rows_, kRowsPerTask, [&](size_type first, size_type last)
+            {
+                for (size_type r = first; r < last; ++r)
+                {
+                    y[r] += row_dot(r, x);
+                }
+            });
+        }
+
+        std::vector<value_type> operator*(const std::vector<value_type>& x) const
+        {
+            std::vector<value_type> y(rows_, value_type{});
+            multiply(x, y);
+            return y;
+        }
+
+    private:
+        // Two independent accumulators hide the FMA latency of the gather-bound row loop.
+        [[nodiscard]] value_type row_dot(size_type r, std::span<const value_type> x) const noexcept
+        {
+            const index_type* cols = col_ind.data();
+            const value_type* vals = values.data();
+            const value_type* xs = x.data();
+            index_type k = row_ptr[r];
+            const index_type end = row_ptr[r + 1];
+            value_type s0{};
+            value_type s1{};
+            for (; k + 1 < end; k += 2)
+            {
+                s0 += vals[k] * xs[cols[k]];
+                s1 += vals[k + 1] * xs[cols[k + 1]];
+            }
+            if (k < end)
+            {
+                s0 += vals[k] * xs[cols[k]];
+            }
+            return s0 + s1;
+        }
+    };
 } // namespace engine::math
@@ -0,0 +1,293 @@
+#pragma once
+
+#include "engine/math/parallel.hpp"
+#include "engine/math/sparse_matrix.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace engine::math
+{
+    enum class Preconditioner : std::uint8_t
+    {
+        None,
+        Jacobi, // diagonal scaling; rows with a zero diagonal are left unscaled
+    };
+
+    template <typename T>
+    struct IterativeSolverSettings
+    {
+        std::size_t max_iterations = 1000;
+        T tolerance = T(1e-6); // on ||b - A x|| / ||b||
+        Preconditioner preconditioner = Preconditioner::Jacobi;
+    };
+
+    template <typename T>
+    struct IterativeSolverReport
+    {
+        bool converged = false;
+        std::size_t iterations = 0;
+        T relative_residual = T(0);
+    };
+
+    // Scratch vectors owned by the caller and reused across solves. They are sized once per system
+    // dimension, so the iteration loops themselves never allocate.
+    template <typename T>
+    struct IterativeSolverWorkspace
+    {
+        std::vector<T> r, r_hat, p, v, s, t, y, z;
+        std::vector<T> inv_diagonal;
+        std::vector<T> partials; // one slot per reduction chunk
+
+        void prepare(std::size_t n)
+        {
+            for (auto* vec : {&r, &r_hat, &p, &v, &s, &t, &y, &z, &inv_diagonal})
+            {
+                vec->resize(n);
+            }
+            partials.resize(parallel::chunk_count(0, n, kVectorGrain));
+        }
+
+        // Elements per parallel task in the vector kernels.
+        static constexpr std::size_t kVectorGrain = 4096;
+    };
+
+    namespace detail
+    {
+        // Deterministic parallel dot product: per-chunk partial sums are combined in chunk order.
+        template <typename T>
+        T parallel_dot(std::span<const T> a, std::span<const T> b, std::span<T> partials)
+        {
+            assert(a.size() == b.size());
+            constexpr std::size_t grain = IterativeSolverWorkspace<T>::kVectorGrain;
+            parallel::parallel_for(0, a.size(), grain, [&](std::size_t first, std::size_t last)
+            {
+                T sum{};
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    sum += a[i] * b[i];
+                }
+                partials[first / grain] = sum;
+            });
+            T total{};
+            for (std::size_t c = 0; c < parallel::chunk_count(0, a.size(), grain); ++c)
+            {
+                total += partials[c];
+            }
+            return total;
+        }
+
+        // Element-wise kernel fn(i) over [0, n), split across the worker pool.
+        template <typename T, typename Fn>
+        void parallel_elementwise(std::size_t n, Fn&& fn)
+        {
+            parallel::parallel_for(0, n, IterativeSolverWorkspace<T>::kVectorGrain,
+                                   [&](std::size_t first, std::size_t last)
+                                   {
+                                       for (std::size_t i = first; i < last; ++i)
+                                       {
+                                           fn(i);
+                                       }
+                                   });
+        }
+
+        template <typename T>
+        void prepare_preconditioner(const CsrMatrix<T>& A,
+                                    Preconditioner preconditioner,
+                                    IterativeSolverWorkspace<T>& ws)
+        {
+            const std::size_t n = A.rows();
+            if (preconditioner == Preconditioner::Jacobi)
+            {
+                A.diagonal(ws.inv_diagonal);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    ws.inv_diagonal[i] = ws.inv_diagonal[i] != T(0) ? T(1) / ws.inv_diagonal[i] : T(1);
+                }
+            }
+            else
+            {
+                std::fill(ws.inv_diagonal.begin(), ws.inv_diagonal.end(), T(1));
+            }
+        }
+
+        // r = b - A x; returns ||b|| for the relative residual.
+        template <typename T>
+        T initial_residual(const CsrMatrix<T>& A,
+                           std::span<const T> b,
+                           std::span<const T> x,
+                           IterativeSolverWorkspace<T>& ws)
+        {
+            std::span<T> r{ws.r};
+            A.multiply(x, r);
+            parallel_elementwise<T>(r.size(), [&](std::size_t i) { r[i] = b[i] - r[i]; });
+            return std::sqrt(parallel_dot<T>(b, b, ws.partials));
+        }
+    } // namespace detail
+
+    // Preconditioned conjugate gradient for symmetric positive definite A. x holds the initial guess on
+    // entry and the solution on exit.
+    template <typename T>
+    IterativeSolverReport<T> conjugate_gradient(const CsrMatrix<T>& A,
+                                                std::span<const T> b,
+                                                std::span<T> x,
+                                                IterativeSolverWorkspace<T>& ws,
+                                                const IterativeSolverSettings<T>& settings = {})
+    {
+        assert(A.rows() == A.cols() && b.size() == A.rows() && x.size() == A.cols());
+        const std::size_t n = A.rows();
+        ws.prepare(n);
+        detail::prepare_preconditioner(A, settings.preconditioner, ws);
+
+        IterativeSolverReport<T> report{};
+        const T b_norm = detail::initial_residual<T>(A, b, x, ws);
+        if (b_norm == T(0))
+        {
+            std::fill(x.begin(), x.end(), T(0));
+            report.converged = true;
+            return report;
+        }
+
+        std::span<T> r{ws.r}, z{ws.z}, p{ws.p}, q{ws.v};
+        std::span<const T> inv_d{ws.inv_diagonal};
+        detail::parallel_elementwise<T>(n, [&](std::size_t i)
+        {
+            z[i] = inv_d[i] * r[i];
+            p[i] = z[i];
+        });
+        T rz = detail::parallel_dot<T>(r, z, ws.partials);
+
+        for (;;)
+        {
+            report.relative_residual = std::sqrt(detail::parallel_dot<T>(r, r, ws.partials)) / b_norm;
+            if (report.relative_residual <= settings.tolerance)
+            {
+                report.converged = true;
+                break;
+            }
+            if (report.iterations >= settings.max_iterations)
+            {
+                break;
+            }
+
+            A.multiply(p, q);
+            const T pq = detail::parallel_dot<T>(p, q, ws.partials);
+            if (!(pq > T(0)))
+            {
+                break; // A is not positive definite along p
+            }
+            const T alpha = rz / pq;
+            detail::parallel_elementwise<T>(n, [&](std::size_t i)
+            {
+                x[i] += alpha * p[i];
+                r[i] -= alpha * q[i];
+                z[i] = inv_d[i] * r[i];
+            });
+
+            const T rz_next = detail::parallel_dot<T>(r, z, ws.partials);
+            const T beta = rz_next / rz;
+            rz = rz_next;
+            detail::parallel_elementwise<T>(n, [&](std::size_t i) { p[i] = z[i] + beta * p[i]; });
+            ++report.iterations;
+        }
+        return report;
+    }
+
+    // Right-preconditioned BiCGSTAB for general (non-symmetric) square A. x holds the initial guess on
+    // entry and the solution on exit.
+    template <typename T>
+    IterativeSolverReport<T> bicgstab(const CsrMatrix<T>& A,
+                                      std::span<const T> b,
+                                      std::span<T> x,
+                                      IterativeSolverWorkspace<T>& ws,
+                                      const IterativeSolverSettings<T>& settings = {})
+    {
+        assert(A.rows() == A.cols() && b.size() == A.rows() && x.size() == A.cols());
+        const std::size_t n = A.rows();
+        ws.prepare(n);
+        detail::prepare_preconditioner(A, settings.preconditioner, ws);
+
+        IterativeSolverReport<T> report{};
+        const T b_norm = detail::initial_residual<T>(A, b, x, ws);
+        if (b_norm == T(0))
+        {
+            std::fill(x.begin(), x.end(), T(0));
+            report.converged = true;
+            return report;
+        }
+
+        std::span<T> r{ws.r}, r_hat{ws.r_hat}, p{ws.p}, v{ws.v}, s{ws.s}, t{ws.t}, y{ws.y}, z{ws.z};
+        std::span<const T> inv_d{ws.inv_diagonal};
+        detail::parallel_elementwise<T>(n, [&](std::size_t i)
+        {
+            r_hat[i] = r[i];
+            p[i] = T(0);
+            v[i] = T(0);
+        });
+
+        T rho = T(1);
+        T alpha = T(1);
+        T omega = T(1);
+        for (;;)
+        {
+            report.relative_residual = std::sqrt(detail::parallel_dot<T>(r, r, ws.partials)) / b_norm;
+            if (report.relative_residual <= settings.tolerance)
+            {
+                report.converged = true;
+                break;
+            }
+            if (report.iterations >= settings.max_iterations)
+            {
+                break;
+            }
+
+            const T rho_next = detail::parallel_dot<T>(r_hat, r, ws.partials);
+            if (rho_next == T(0))
+            {
+                break; // breakdown: r is orthogonal to the shadow residual
+            }
+            const T beta = (rho_next / rho) * (alpha / omega);
+            rho = rho_next;
+            detail::parallel_elementwise<T>(n, [&](std::size_t i)
+            {
+                p[i] = r[i] + beta * (p[i] - omega * v[i]);
+                y[i] = inv_d[i] * p[i];
+            });
+            A.multiply(y, v);
+
+            const T r_hat_v = detail::parallel_dot<T>(r_hat, v, ws.partials);
+            if (r_hat_v == T(0))
+            {
+                break;
+            }
+            alpha = rho / r_hat_v;
+            detail::parallel_elementwise<T>(n, [&](std::size_t i)
+            {
+                s[i] = r[i] - alpha * v[i];
+                z[i] = inv_d[i] * s[i];
+            });
+            A.multiply(z, t);
+
+            const T tt = detail::parallel_dot<T>(t, t, ws.partials);
+            omega = tt > T(0) ? detail::parallel_dot<T>(t, s, ws.partials) / tt : T(0);
+            detail::parallel_elementwise<T>(n, [&](std::size_t i)
+            {
+                x[i] += alpha * y[i] + omega * z[i];
+                r[i] = s[i] - omega * t[i];
+            });
+            ++report.iterations;
+            if (omega == T(0))
+            {
+                report.relative_residual = std::sqrt(detail::parallel_dot<T>(r, r, ws.partials)) / b_norm;
+                report.converged = report.relative_residual <= settings.tolerance;
+                break;
+            }
+        }
+        return report;
+    }
+} // namespace engine::math
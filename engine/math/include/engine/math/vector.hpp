@@ -5,6 +5,7 @@
 #include <ostream>
 #include <cassert>
 #include <array>
+#include <span>
 
 namespace engine::math
 {
@@ -279,6 +280,29 @@ namespace engine::math
         return (detail::one<T>() - t) * a + t * b;
     }
 
+    // Batched lerp over arrays (translations, scales); out may alias a or b. Plain unit-stride loops so the
+    // compiler can vectorise them; results match the scalar overload exactly.
+    template <typename T, std::size_t N>
+    void lerp(std::span<const Vector<T, N>> a, std::span<const Vector<T, N>> b, T t, std::span<Vector<T, N>> out) noexcept
+    {
+        assert(a.size() == b.size() && out.size() == a.size());
+        for (std::size_t i = 0; i < out.size(); ++i)
+        {
+            out[i] = lerp(a[i], b[i], t);
+        }
+    }
+
+    template <typename T, std::size_t N>
+    void lerp(std::span<const Vector<T, N>> a, std::span<const Vector<T, N>> b, std::span<const T> t,
+              std::span<Vector<T, N>> out) noexcept
+    {
+        assert(a.size() == b.size() && out.size() == a.size() && t.size() == a.size());
+        for (std::size_t i = 0; i < out.size(); ++i)
+        {
+            out[i] = lerp(a[i], b[i], t[i]);
+        }
+    }
+
     template <typename T, std::size_t N>
     std::ostream& operator<<(std::ostream& os, const Vector<T, N>& vector)
     {
@@ -0,0 +1,184 @@
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine/math/decompositions.hpp"
+
+using namespace engine::math;
+
+namespace
+{
+    template <typename T, std::size_t N>
+    Matrix<T, N, N> random_matrix(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<T> dist(T(-2), T(2));
+        Matrix<T, N, N> m{};
+        for (std::size_t c = 0; c < N; ++c)
+        {
+            for (std::size_t r = 0; r < N; ++r)
+            {
+                m(r, c) = dist(rng);
+            }
+        }
+        return m;
+    }
+
+    template <typename T, std::size_t N>
+    void ExpectMatrixNear(const Matrix<T, N, N>& actual, const Matrix<T, N, N>& expected, T tolerance)
+    {
+        for (std::size_t c = 0; c < N; ++c)
+        {
+            for (std::size_t r = 0; r < N; ++r)
+            {
+                EXPECT_NEAR(actual(r, c), expected(r, c), tolerance) << "at (" << r << ", " << c << ")";
+            }
+        }
+    }
+
+    template <typename T, std::size_t N>
+    Matrix<T, N, N> diagonal_matrix(const Vector<T, N>& d)
+    {
+        Matrix<T, N, N> m{};
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            m(i, i) = d[i];
+        }
+        return m;
+    }
+
+    template <typename T, std::size_t N>
+    void CheckDecompositions(std::mt19937& rng, T tolerance)
+    {
+        const Matrix<T, N, N> identity = identity_matrix<T, N>();
+        for (int trial = 0; trial < 50; ++trial)
+        {
+            const Matrix<T, N, N> a = random_matrix<T, N>(rng);
+
+            const auto f = svd(a);
+            ExpectMatrixNear(f.u * diagonal_matrix(f.sigma) * transpose(f.v), a, tolerance);
+            ExpectMatrixNear(transpose(f.u) * f.u, identity, tolerance);
+            ExpectMatrixNear(transpose(f.v) * f.v, identity, tolerance);
+            EXPECT_NEAR(determinant(f.u), T(1), tolerance);
+            EXPECT_NEAR(determinant(f.v), T(1), tolerance);
+            for (std::size_t i = 0; i + 1 < N; ++i)
+            {
+                EXPECT_GE(f.sigma[i], std::abs(f.sigma[i + 1]) - tolerance);
+            }
+
+            const auto p = polar(a);
+            ExpectMatrixNear(p.rotation * p.stretch, a, tolerance);
+            ExpectMatrixNear(transpose(p.rotation) * p.rotation, identity, tolerance);
+            ExpectMatrixNear(p.stretch, transpose(p.stretch), tolerance);
+
+            const auto q = qr(a);
+            ExpectMatrixNear(q.q * q.r, a, tolerance);
+            ExpectMatrixNear(transpose(q.q) * q.q, identity, tolerance);
+            for (std::size_t c = 0; c < N; ++c)
+            {
+                for (std::size_t r = c + 1; r < N; ++r)
+                {
+                    EXPECT_EQ(q.r(r, c), T(0));
+                }
+            }
+
+            const Matrix<T, N, N> s = a + transpose(a);
+            const auto e = symmetric_eigen(s);
+            ExpectMatrixNear(e.vectors * diagonal_matrix(e.values) * transpose(e.vectors), s, tolerance);
+            for (std::size_t i = 0; i + 1 < N; ++i)
+            {
+                EXPECT_GE(e.values[i], e.values[i + 1]);
+            }
+
+            Vector<T, N> b{};
+            for (std::size_t i = 0; i < N; ++i) b[i] = T(i + 1);
+            const auto x = try_solve(a, b);
+            ASSERT_TRUE(x.has_value());
+            const Vector<T, N> ax = a * *x;
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                EXPECT_NEAR(ax[i], b[i], tolerance * T(10));
+            }
+        }
+    }
+}
+
+TEST(Decompositions, RandomMatrices3x3And4x4)
+{
+    std::mt19937 rng(1234);
+    CheckDecompositions<double, 3>(rng, 1e-9);
+    CheckDecompositions<double, 4>(rng, 1e-9);
+    CheckDecompositions<float, 3>(rng, 2e-4f);
+    CheckDecompositions<float, 4>(rng, 2e-4f);
+}
+
+TEST(Decompositions, ReflectionKeepsRotationProper)
+{
+    const dmat3 mirror{
+        -1.0, 0.0, 0.0,
+        0.0, 2.0, 0.0,
+        0.0, 0.0, 3.0,
+    };
+    const auto f = svd(mirror);
+    EXPECT_NEAR(f.sigma[0], 3.0, 1e-12);
+    EXPECT_NEAR(f.sigma[1], 2.0, 1e-12);
+    EXPECT_NEAR(f.sigma[2], -1.0, 1e-12);
+
+    const auto p = polar(mirror);
+    EXPECT_NEAR(determinant(p.rotation), 1.0, 1e-12);
+}
+
+TEST(Decompositions, SingularInputs)
+{
+    const dmat3 rank_one{
+        1.0, 2.0, 3.0,
+        2.0, 4.0, 6.0,
+        3.0, 6.0, 9.0,
+    };
+    EXPECT_FALSE(try_solve(rank_one, dvec3{1.0, 1.0, 1.0}).has_value());
+
+    const auto f = svd(rank_one);
+    EXPECT_NEAR(f.sigma[0], 14.0, 1e-9);
+    EXPECT_NEAR(f.sigma[1], 0.0, 1e-6);
+    EXPECT_NEAR(f.sigma[2], 0.0, 1e-6);
+
+    const auto zero = svd(dmat3{});
+    EXPECT_EQ(zero.sigma, dvec3{});
+    ExpectMatrixNear(zero.u, identity_matrix<double, 3>(), 0.0);
+}
+
+TEST(Decompositions, UsableInConstantExpressions)
+{
+    constexpr dmat3 diagonal{
+        2.0, 0.0, 0.0,
+        0.0, 5.0, 0.0,
+        0.0, 0.0, 3.0,
+    };
+    constexpr auto f = svd(diagonal);
+    static_assert(f.sigma[0] == 5.0 && f.sigma[1] == 3.0 && f.sigma[2] == 2.0);
+
+    constexpr auto x = try_solve(diagonal, dvec3{4.0, 10.0, 9.0});
+    static_assert(x.has_value() && (*x)[0] == 2.0 && (*x)[1] == 2.0 && (*x)[2] == 3.0);
+
+    constexpr auto e = symmetric_eigen(Matrix<double, 2, 2>{2.0, 1.0, 1.0, 2.0});
+    static_assert(e.values[0] > 2.999999 && e.values[0] < 3.000001);
+    EXPECT_NEAR(e.values[1], 1.0, 1e-12);
+}
+
+TEST(Decompositions, BatchedMatchesScalar)
+{
+    std::mt19937 rng(42);
+    std::vector<mat3> inputs(1000);
+    for (auto& m : inputs) m = random_matrix<float, 3>(rng);
+
+    std::vector<SingularValueDecomposition<float, 3>> svds(inputs.size());
+    std::vector<PolarDecomposition<float, 3>> polars(inputs.size());
+    svd<float, 3>(inputs, svds);
+    polar<float, 3>(inputs, polars);
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        const auto expected = svd(inputs[i]);
+        EXPECT_EQ(svds[i].sigma, expected.sigma);
+        ExpectMatrixNear(polars[i].rotation, polar(inputs[i]).rotation, 0.0f);
+    }
+}
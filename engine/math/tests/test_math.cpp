@@ -2,6 +2,8 @@
 #include <cmath>
 #include <type_traits>
 #include <numbers>
+#include <random>
+#include <vector>
 
 
 #include <gtest/gtest.h>
@@ -394,6 +396,66 @@ TEST(Quaternion, SlerpSquadAndCast) {
     EXPECT_NEAR(cast_dst.z, -1.0, 1e-12);
 }
 
+TEST(Quaternion, NlerpStaysWithinBoundOfSlerp) {
+    std::mt19937 rng(2024);
+    std::normal_distribution<double> component(0.0, 1.0);
+    std::uniform_real_distribution<double> weight(0.0, 1.0);
+    double worst = 0.0;
+    for (int i = 0; i < 20000; ++i) {
+        const dquat a = normalize(dquat{component(rng), component(rng), component(rng), component(rng)});
+        const dquat b = normalize(dquat{component(rng), component(rng), component(rng), component(rng)});
+        const double t = weight(rng);
+        const double cos_half = std::min(1.0, std::abs(dot(slerp(a, b, t), nlerp(a, b, t))));
+        worst = std::max(worst, 2.0 * std::acos(cos_half));
+    }
+    EXPECT_LT(worst, 8e-4);
+
+    const quat identity = quat::Identity();
+    const quat flipped{-1.0F, 0.0F, 0.0F, 0.0F};
+    const quat same = nlerp(identity, flipped, 0.5F);
+    EXPECT_NEAR(std::abs(same.w), 1.0F, 1e-6F);
+}
+
+TEST(Quaternion, BatchedInterpolationMatchesScalar) {
+    std::mt19937 rng(7);
+    std::normal_distribution<float> component(0.0F, 1.0F);
+    std::uniform_real_distribution<float> weight(0.0F, 1.0F);
+    constexpr std::size_t count = 5000;
+    std::vector<quat> from(count), to(count), out(count);
+    std::vector<float> weights(count);
+    std::vector<vec3> a(count), b(count), lerped(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        from[i] = normalize(quat{component(rng), component(rng), component(rng), component(rng)});
+        to[i] = normalize(quat{component(rng), component(rng), component(rng), component(rng)});
+        weights[i] = weight(rng);
+        a[i] = vec3{component(rng), component(rng), component(rng)};
+        b[i] = vec3{component(rng), component(rng), component(rng)};
+    }
+
+    slerp<float>(from, to, 0.3F, out);
+    for (std::size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(out[i], slerp(from[i], to[i], 0.3F));
+    }
+    slerp<float>(from, to, weights, out);
+    for (std::size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(out[i], slerp(from[i], to[i], weights[i]));
+    }
+    nlerp<float>(from, to, weights, out);
+    for (std::size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(out[i], nlerp(from[i], to[i], weights[i]));
+    }
+
+    lerp<float, 3>(a, b, weights, lerped);
+    for (std::size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(lerped[i], lerp(a[i], b[i], weights[i]));
+    }
+    const std::vector<vec3> original = a;
+    lerp<float, 3>(a, b, 0.75F, a);
+    for (std::size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(a[i], lerp(original[i], b[i], 0.75F));
+    }
+}
+
 TEST(Quaternion, AngleAxisAndEulerConversions) {
     const float pi = static_cast<float>(std::acos(-1.0));
     const vec3 axis = normalize(vec3{1.0F, 2.0F, 3.0F});
@@ -0,0 +1,112 @@
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine/math/packed.hpp"
+
+using namespace engine::math;
+
+TEST(Packed, HalfRoundTripsEveryFiniteValue)
+{
+    for (std::uint32_t bits = 0; bits <= 0xffffu; ++bits)
+    {
+        const half h{static_cast<std::uint16_t>(bits)};
+        const float f = h.to_float();
+        if (std::isnan(f))
+        {
+            EXPECT_EQ(bits & 0x7c00u, 0x7c00u);
+            EXPECT_TRUE(std::isnan(half::from_float(f).to_float()));
+            continue;
+        }
+        EXPECT_EQ(half::from_float(f), h) << "bits " << bits;
+    }
+}
+
+TEST(Packed, HalfSpecialValuesAndRounding)
+{
+    EXPECT_EQ(half::from_float(1.0F).bits, 0x3c00u);
+    EXPECT_EQ(half::from_float(-2.0F).bits, 0xc000u);
+    EXPECT_EQ(half::from_float(65504.0F).bits, 0x7bffu);
+    EXPECT_EQ(half::from_float(65520.0F).bits, 0x7c00u); // rounds up to infinity
+    EXPECT_EQ(half::from_float(std::numeric_limits<float>::infinity()).bits, 0x7c00u);
+    EXPECT_EQ(half::from_float(-0.0F).bits, 0x8000u);
+    EXPECT_EQ(half::from_float(std::ldexp(1.0F, -24)).bits, 0x0001u); // smallest subnormal
+    EXPECT_EQ(half::from_float(std::ldexp(1.0F, -26)).bits, 0x0000u);
+
+    // Ties go to even: 1 + 2^-11 lies halfway between 1 and 1 + 2^-10.
+    EXPECT_EQ(half::from_float(1.0F + std::ldexp(1.0F, -11)).bits, 0x3c00u);
+    EXPECT_EQ(half::from_float(1.0F + 3.0F * std::ldexp(1.0F, -11)).bits, 0x3c02u);
+
+    static_assert(half::from_float(0.5F).bits == 0x3800u);
+    static_assert(half{0x3555u}.to_float() > 0.333F && half{0x3555u}.to_float() < 0.334F);
+}
+
+TEST(Packed, NormalizedIntegersClampAndRoundTrip)
+{
+    EXPECT_EQ(snorm16::from_float(1.0F).bits, 32767);
+    EXPECT_EQ(snorm16::from_float(-3.0F).bits, -32767);
+    EXPECT_FLOAT_EQ(snorm16{-32768}.to_float(), -1.0F);
+    EXPECT_EQ(unorm8::from_float(2.0F).bits, 255);
+    EXPECT_EQ(unorm8::from_float(-1.0F).bits, 0);
+    EXPECT_EQ(unorm8::from_float(0.5F).bits, 128);
+
+    for (int i = 0; i <= 255; ++i)
+    {
+        const unorm8 u{static_cast<std::uint8_t>(i)};
+        EXPECT_EQ(unorm8::from_float(u.to_float()), u);
+    }
+    for (float x = -1.0F; x <= 1.0F; x += 0.001F)
+    {
+        EXPECT_NEAR(snorm16::from_float(x).to_float(), x, 0.5F / 32767.0F + 1e-7F);
+    }
+}
+
+TEST(Packed, OctahedralNormalsStayWithinAngularBound)
+{
+    std::mt19937 rng(7);
+    std::normal_distribution<float> dist;
+    float worst = 0.0F;
+    for (int i = 0; i < 100000; ++i)
+    {
+        vec3 n{dist(rng), dist(rng), dist(rng)};
+        n = normalize(n);
+        const vec3 decoded = oct_normal16::from_vector(n).to_vector();
+        EXPECT_NEAR(length(decoded), 1.0F, 1e-6F);
+        worst = std::max(worst, std::atan2(length(cross(n, decoded)), dot(n, decoded)));
+    }
+    EXPECT_LT(worst, 8e-5F);
+
+    for (const vec3& axis : {vec3{0, 0, -1}, vec3{1, 0, 0}, vec3{0, -1, 0}, vec3{0, 0, 1}})
+    {
+        EXPECT_EQ(oct_normal16::from_vector(axis).to_vector(), axis);
+    }
+    EXPECT_EQ(oct_normal16::from_vector(vec3{}).to_vector(), (vec3{0, 0, 1}));
+}
+
+TEST(Packed, BatchedKernelsMatchScalar)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> dist(-100.0F, 100.0F);
+    std::vector<vec3> positions(50000);
+    for (auto& p : positions) p = vec3{dist(rng), dist(rng), dist(rng)};
+
+    std::vector<hvec3> packed(positions.size());
+    pack<hvec3>(positions, packed);
+    std::vector<vec3> restored(positions.size());
+    unpack<hvec3>(packed, restored);
+
+    static_assert(sizeof(hvec3) == 6 && sizeof(oct_normal16) == 4 && sizeof(Vector<unorm8, 4>) == 4);
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        EXPECT_EQ(packed[i], PackTraits<hvec3>::pack(positions[i]));
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            EXPECT_NEAR(restored[i][k], positions[i][k], std::abs(positions[i][k]) * (1.0F / 2048.0F));
+        }
+    }
+}
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine/math/sparse_ldlt.hpp"
+#include "engine/math/sparse_matrix.hpp"
+
+using namespace engine::math;
+
+namespace
+{
+    // 5-point Laplacian on an n x n grid plus `shift` on the diagonal; symmetric, both triangles stored.
+    SparseMatrix<double> grid_laplacian(std::size_t n, double shift)
+    {
+        std::vector<SparseMatrix<double>::Triplet> trips;
+        const auto id = [n](std::size_t i, std::size_t j) { return j * n + i; };
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const std::size_t row = id(i, j);
+                trips.push_back({row, row, 4.0 + shift});
+                if (i > 0) trips.push_back({row, id(i - 1, j), -1.0});
+                if (i + 1 < n) trips.push_back({row, id(i + 1, j), -1.0});
+                if (j > 0) trips.push_back({row, id(i, j - 1), -1.0});
+                if (j + 1 < n) trips.push_back({row, id(i, j + 1), -1.0});
+            }
+        }
+        return SparseMatrix<double>::from_triplets(n * n, n * n, std::move(trips));
+    }
+
+    double relative_residual(const SparseMatrix<double>& A, const std::vector<double>& x, const std::vector<double>& b)
+    {
+        const std::vector<double> ax = A * x;
+        double num = 0.0;
+        double den = 0.0;
+        for (std::size_t i = 0; i < b.size(); ++i)
+        {
+            num += (b[i] - ax[i]) * (b[i] - ax[i]);
+            den += b[i] * b[i];
+        }
+        return std::sqrt(num / den);
+    }
+}
+
+TEST(SparseLdlt, SolvesSymmetricPositiveDefiniteSystem)
+{
+    const SparseMatrix<double> A = grid_laplacian(24, 0.0);
+    std::vector<double> b(A.rows());
+    for (std::size_t i = 0; i < b.size(); ++i) b[i] = std::sin(0.3 * static_cast<double>(i));
+
+    for (auto ordering : {SparseOrdering::Natural, SparseOrdering::ApproximateMinimumDegree})
+    {
+        SparseLdlt<double> solver;
+        ASSERT_TRUE(solver.compute(A, ordering));
+        std::vector<double> x(A.cols());
+        solver.solve(b, x);
+        EXPECT_LT(relative_residual(A, x, b), 1e-12);
+        for (double d : solver.diagonal()) EXPECT_GT(d, 0.0);
+    }
+}
+
+TEST(SparseLdlt, ApproximateMinimumDegreeReducesFill)
+{
+    const SparseMatrix<double> A = grid_laplacian(30, 0.0);
+
+    const std::vector<std::size_t> perm = approximate_minimum_degree(A);
+    ASSERT_EQ(perm.size(), A.rows());
+    std::vector<std::size_t> sorted = perm;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<std::size_t> identity(A.rows());
+    std::iota(identity.begin(), identity.end(), 0u);
+    EXPECT_EQ(sorted, identity);
+
+    SparseLdlt<double> natural;
+    SparseLdlt<double> amd;
+    ASSERT_TRUE(natural.analyze(A, SparseOrdering::Natural));
+    ASSERT_TRUE(amd.analyze(A, SparseOrdering::ApproximateMinimumDegree));
+    EXPECT_LT(amd.factor_nonzeros(), natural.factor_nonzeros());
+}
+
+TEST(SparseLdlt, RefactorizesWithCachedAnalysis)
+{
+    SparseLdlt<double> solver;
+    ASSERT_TRUE(solver.analyze(grid_laplacian(12, 0.0)));
+    std::vector<double> b(solver.size(), 1.0);
+    std::vector<double> x(solver.size());
+
+    for (double shift : {0.0, 0.5, 2.0})
+    {
+        const SparseMatrix<double> A = grid_laplacian(12, shift);
+        ASSERT_TRUE(solver.factorize(A));
+        solver.solve(b, x);
+        EXPECT_LT(relative_residual(A, x, b), 1e-12);
+
+        // Repeated solves reuse the factor; b and x may alias.
+        std::vector<double> y = b;
+        solver.solve(y, y);
+        EXPECT_EQ(y, x);
+    }
+
+    // A different sparsity pattern must be re-analyzed.
+    EXPECT_FALSE(solver.factorize(grid_laplacian(13, 0.0)));
+    EXPECT_FALSE(solver.factorized());
+}
+
+TEST(SparseLdlt, AcceptsEitherStoredTriangle)
+{
+    // SPD tridiagonal [4, -1] and a 6 x 6 arrow matrix whose first row and column couple every unknown;
+    // each is factored from its lower triangle, its upper triangle and full storage.
+    std::vector<SparseMatrix<double>::Triplet> tridiagonal;
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        tridiagonal.push_back({i, i, 4.0});
+        if (i > 0) tridiagonal.push_back({i, i - 1, -1.0});
+    }
+    std::vector<SparseMatrix<double>::Triplet> arrow;
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        arrow.push_back({i, i, i == 0 ? 6.0 : 2.0});
+        if (i > 0) arrow.push_back({0, i, 1.0});
+    }
+
+    for (const auto& [n, triplets] : {std::pair{std::size_t{8}, tridiagonal}, std::pair{std::size_t{6}, arrow}})
+    {
+        std::vector<SparseMatrix<double>::Triplet> transposed;
+        std::vector<SparseMatrix<double>::Triplet> full = triplets;
+        for (const auto& t : triplets)
+        {
+            transposed.push_back({t.col, t.row, t.val});
+            if (t.row != t.col) full.push_back({t.col, t.row, t.val});
+        }
+        const auto A = SparseMatrix<double>::from_triplets(n, n, full);
+        std::vector<double> b(n);
+        for (std::size_t i = 0; i < n; ++i) b[i] = static_cast<double>(i + 1);
+
+        for (const auto& stored : {triplets, transposed, full})
+        {
+            const auto triangle = SparseMatrix<double>::from_triplets(n, n, stored);
+            for (auto ordering : {SparseOrdering::Natural, SparseOrdering::ApproximateMinimumDegree})
+            {
+                SparseLdlt<double> solver;
+                ASSERT_TRUE(solver.compute(triangle, ordering));
+                std::vector<double> x(n);
+                solver.solve(b, x);
+                EXPECT_LT(relative_residual(A, x, b), 1e-12);
+            }
+        }
+    }
+}
+
+TEST(SparseLdlt, FactorsIndefiniteMatrixAndRejectsSingular)
+{
+    // Saddle-point system [[2, 1], [1, -3]]: indefinite but non-singular.
+    const auto indefinite = SparseMatrix<double>::from_triplets(2, 2, {
+        {0, 0, 2.0}, {0, 1, 1.0}, {1, 0, 1.0}, {1, 1, -3.0},
+    });
+    SparseLdlt<double> solver(indefinite, SparseOrdering::Natural);
+    ASSERT_TRUE(solver.factorized());
+    std::vector<double> b{3.0, -2.0};
+    std::vector<double> x(2);
+    solver.solve(b, x);
+    EXPECT_NEAR(x[0], 1.0, 1e-12);
+    EXPECT_NEAR(x[1], 1.0, 1e-12);
+    EXPECT_GT(solver.diagonal()[0], 0.0);
+    EXPECT_LT(solver.diagonal()[1], 0.0);
+
+    const auto singular = SparseMatrix<double>::from_triplets(2, 2, {
+        {0, 0, 1.0}, {0, 1, 1.0}, {1, 0, 1.0}, {1, 1, 1.0},
+    });
+    SparseLdlt<double> failing;
+    EXPECT_FALSE(failing.compute(singular, SparseOrdering::Natural));
+    EXPECT_TRUE(failing.analyzed());
+    EXPECT_FALSE(failing.factorized());
+
+    EXPECT_FALSE(failing.analyze(SparseMatrix<double>(2, 3)));
+}
@@ -0,0 +1,198 @@
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine/math/parallel.hpp"
+#include "engine/math/sparse_matrix.hpp"
+#include "engine/math/sparse_solvers.hpp"
+
+using namespace engine::math;
+
+namespace
+{
+    // 5-point Laplacian on an n x n grid with Dirichlet boundary (SPD), optionally with a first-order
+    // convection term along x that makes it non-symmetric.
+    SparseMatrix<double> grid_operator(std::size_t n, double convection = 0.0)
+    {
+        std::vector<SparseMatrix<double>::Triplet> trips;
+        const auto id = [n](std::size_t i, std::size_t j) { return j * n + i; };
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const std::size_t row = id(i, j);
+                trips.push_back({row, row, 4.0});
+                if (i > 0) trips.push_back({row, id(i - 1, j), -1.0 - convection});
+                if (i + 1 < n) trips.push_back({row, id(i + 1, j), -1.0 + convection});
+                if (j > 0) trips.push_back({row, id(i, j - 1), -1.0});
+                if (j + 1 < n) trips.push_back({row, id(i, j + 1), -1.0});
+            }
+        }
+        return SparseMatrix<double>::from_triplets(n * n, n * n, std::move(trips));
+    }
+
+    double residual_norm(const CsrMatrix<double>& A, const std::vector<double>& x, const std::vector<double>& b)
+    {
+        const std::vector<double> ax = A * x;
+        double sum = 0.0;
+        for (std::size_t i = 0; i < b.size(); ++i)
+        {
+            sum += (b[i] - ax[i]) * (b[i] - ax[i]);
+        }
+        return std::sqrt(sum);
+    }
+
+    double norm(const std::vector<double>& v)
+    {
+        double sum = 0.0;
+        for (double value : v) sum += value * value;
+        return std::sqrt(sum);
+    }
+}
+
+TEST(Parallel, ParallelForCoversRangeExactlyOnce)
+{
+    constexpr std::size_t count = 100003;
+    std::vector<std::atomic<int>> hits(count);
+    parallel::parallel_for(0, count, 1000, [&](std::size_t first, std::size_t last)
+    {
+        EXPECT_LE(last - first, 1000u);
+        for (std::size_t i = first; i < last; ++i)
+        {
+            hits[i].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    for (const auto& hit : hits)
+    {
+        ASSERT_EQ(hit.load(), 1);
+    }
+    EXPECT_EQ(parallel::chunk_count(0, count, 1000), 101u);
+    EXPECT_EQ(parallel::chunk_count(5, 5, 1000), 0u);
+}
+
+TEST(Parallel, NestedParallelForRunsInline)
+{
+    std::atomic<std::size_t> total{0};
+    parallel::parallel_for(0, 64, 1, [&](std::size_t, std::size_t)
+    {
+        parallel::parallel_for(0, 100, 10, [&](std::size_t first, std::size_t last)
+        {
+            total.fetch_add(last - first, std::memory_order_relaxed);
+        });
+    });
+    EXPECT_EQ(total.load(), 6400u);
+}
+
+TEST(CsrMatrix, MultiplyMatchesCscProduct)
+{
+    const SparseMatrix<double> csc = grid_operator(70, 0.3);
+    const CsrMatrix<double> csr = CsrMatrix<double>::from_csc(csc);
+    ASSERT_EQ(csr.rows(), csc.rows());
+    ASSERT_EQ(csr.nnz(), csc.nnz());
+
+    std::vector<double> x(csc.cols());
+    for (std::size_t i = 0; i < x.size(); ++i) x[i] = std::sin(0.01 * static_cast<double>(i));
+
+    const std::vector<double> expected = csc * x;
+    std::vector<double> actual(csr.rows(), 1.0);
+    csr.multiply(x, actual);
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        ASSERT_NEAR(actual[i], expected[i], 1e-12);
+    }
+
+    std::vector<double> y(csc.rows());
+    csc.multiply(std::span<const double>{x}, std::span<double>{y});
+    csr.multiply_accumulate(x, y);
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        ASSERT_NEAR(y[i], 2.0 * expected[i], 1e-12);
+    }
+
+    const SparseMatrix<double> round_trip = csr.to_csc();
+    EXPECT_EQ(round_trip.col_ptr, csc.col_ptr);
+    EXPECT_EQ(round_trip.row_ind, csc.row_ind);
+    EXPECT_EQ(round_trip.values, csc.values);
+
+    std::vector<double> diagonal(csr.rows());
+    csr.diagonal(diagonal);
+    for (double d : diagonal) EXPECT_DOUBLE_EQ(d, 4.0);
+}
+
+TEST(SparseSolvers, ConjugateGradientSolvesLaplacian)
+{
+    const CsrMatrix<double> A = CsrMatrix<double>::from_csc(grid_operator(64));
+    std::vector<double> b(A.rows());
+    for (std::size_t i = 0; i < b.size(); ++i) b[i] = 1.0 + 0.5 * std::cos(0.1 * static_cast<double>(i));
+
+    for (auto preconditioner : {Preconditioner::None, Preconditioner::Jacobi})
+    {
+        std::vector<double> x(A.cols(), 0.0);
+        IterativeSolverWorkspace<double> workspace;
+        IterativeSolverSettings<double> settings;
+        settings.tolerance = 1e-10;
+        settings.preconditioner = preconditioner;
+
+        const auto report = conjugate_gradient<double>(A, b, x, workspace, settings);
+        EXPECT_TRUE(report.converged);
+        EXPECT_GT(report.iterations, 0u);
+        EXPECT_LE(report.relative_residual, 1e-10);
+        EXPECT_LE(residual_norm(A, x, b) / norm(b), 1e-9);
+    }
+}
+
+TEST(SparseSolvers, BiCgStabSolvesNonSymmetricSystem)
+{
+    const CsrMatrix<double> A = CsrMatrix<double>::from_csc(grid_operator(48, 0.4));
+    std::vector<double> b(A.rows());
+    for (std::size_t i = 0; i < b.size(); ++i) b[i] = (i % 7 == 0) ? 1.0 : -0.25;
+
+    std::vector<double> x(A.cols(), 0.0);
+    IterativeSolverWorkspace<double> workspace;
+    IterativeSolverSettings<double> settings;
+    settings.tolerance = 1e-10;
+
+    const auto report = bicgstab<double>(A, b, x, workspace, settings);
+    EXPECT_TRUE(report.converged);
+    EXPECT_LE(residual_norm(A, x, b) / norm(b), 1e-9);
+}
+
+TEST(SparseSolvers, WarmStartAndZeroRightHandSide)
+{
+    const CsrMatrix<double> A = CsrMatrix<double>::from_csc(grid_operator(16));
+    std::vector<double> b(A.rows(), 1.0);
+    std::vector<double> x(A.cols(), 0.0);
+    IterativeSolverWorkspace<double> workspace;
+
+    const auto cold = conjugate_gradient<double>(A, b, x, workspace);
+    ASSERT_TRUE(cold.converged);
+    const auto warm = conjugate_gradient<double>(A, b, x, workspace);
+    EXPECT_TRUE(warm.converged);
+    EXPECT_EQ(warm.iterations, 0u);
+
+    std::vector<double> zero(A.rows(), 0.0);
+    const auto trivial = bicgstab<double>(A, zero, x, workspace);
+    EXPECT_TRUE(trivial.converged);
+    for (double value : x) EXPECT_EQ(value, 0.0);
+}
+
+TEST(SparseSolvers, ResultsDoNotDependOnThreadCount)
+{
+    const CsrMatrix<double> A = CsrMatrix<double>::from_csc(grid_operator(96));
+    std::vector<double> b(A.rows());
+    for (std::size_t i = 0; i < b.size(); ++i) b[i] = std::sin(0.37 * static_cast<double>(i));
+
+    IterativeSolverWorkspace<double> workspace;
+    std::vector<double> parallel_x(A.cols(), 0.0);
+    const auto parallel_report = conjugate_gradient<double>(A, b, parallel_x, workspace);
+
+    parallel::set_max_concurrency(1);
+    std::vector<double> serial_x(A.cols(), 0.0);
+    const auto serial_report = conjugate_gradient<double>(A, b, serial_x, workspace);
+    parallel::set_max_concurrency(0);
+
+    EXPECT_EQ(parallel_report.iterations, serial_report.iterations);
+    EXPECT_EQ(parallel_x, serial_x);
+}
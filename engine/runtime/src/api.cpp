@@ -13,7 +13,7 @@
 #include <unordered_set>
 
 #include "engine/animation/deformation/linear_blend_skinning.hpp"
-#include "engine/geometry/deform/linear_blend_skinning.hpp"
+#include "engine/geometry/deform/skinning.hpp"
 
 #if ENGINE_ENABLE_ASSETS
 #    include "engine/assets/api.hpp"
@@ -67,6 +67,7 @@ namespace
         }
         mesh.positions = mesh.rest_positions;
         mesh.normals.assign(mesh.rest_positions.size(), engine::math::vec3{0.0F, 1.0F, 0.0F});
+        mesh.rest_normals = mesh.normals;
 
         mesh.indices.reserve(static_cast<std::size_t>(subdivisions) * subdivisions * 6U);
         for (std::uint32_t y = 0; y < subdivisions; ++y)
@@ -78,13 +79,14 @@ namespace
                 const std::uint32_t bottom_left = top_left + vertices_per_axis;
                 const std::uint32_t bottom_right = bottom_left + 1U;
 
+                // Counter-clockwise seen from +Y, matching the +Y rest normals.
                 mesh.indices.push_back(top_left);
-                mesh.indices.push_back(top_right);
                 mesh.indices.push_back(bottom_right);
+                mesh.indices.push_back(top_right);
 
                 mesh.indices.push_back(top_left);
-                mesh.indices.push_back(bottom_right);
                 mesh.indices.push_back(bottom_left);
+                mesh.indices.push_back(bottom_right);
             }
         }
 
@@ -127,6 +129,7 @@ namespace engine::runtime
         double simulation_time{0.0};
         animation::AnimationController controller{};
         animation::AnimationRigPose pose{};
+        animation::PoseEvaluationScratch pose_scratch{};
         geometry::SurfaceMesh mesh{};
         animation::RigBinding binding{};
         physics::PhysicsWorld world{};
@@ -140,6 +143,7 @@ namespace engine::runtime
         std::vector<std::string_view> subsystem_names{};
         std::vector<math::Transform<float>> joint_global_transforms{};
         std::vector<math::Transform<float>> skinning_transforms{};
+        geometry::deform::SkinningPalettes skinning_palettes{};
         using Clock = std::chrono::steady_clock;
         RuntimeDiagnostics diagnostics{};
         std::unordered_map<std::string, std::size_t> stage_lookup{};
@@ -700,7 +704,7 @@ namespace engine::runtime
                 [&]()
                 {
                     engine::animation::advance_controller(controller, dt);
-                    pose = engine::animation::evaluate_controller(controller);
+                    pose = engine::animation::evaluate_controller(controller, pose_scratch);
                 });
 
             const auto physics_forces = dispatcher_ref.add_kernel(
@@ -763,7 +767,7 @@ namespace engine::runtime
                                                                         root_translation);
                     animation::skinning::build_skinning_transforms(binding, joint_global_transforms,
                                                                     skinning_transforms);
-                    engine::geometry::deform::apply_linear_blend_skinning(binding, skinning_transforms, mesh);
+                    engine::geometry::deform::apply_skinning(binding, skinning_transforms, skinning_palettes, mesh);
                 },
                 {physics_integrate});
 
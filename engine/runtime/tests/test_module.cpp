@@ -341,6 +341,37 @@ TEST(RuntimeHost, AcceptsInjectedDependencies) {
     host.shutdown();
 }
 
+TEST(RuntimeHost, DefaultMeshNormalsMatchItsWinding) {
+    engine::runtime::RuntimeHost host{};
+    host.initialize();
+
+    engine::geometry::SurfaceMesh rest = host.current_mesh();
+    rest.positions = rest.rest_positions;
+    engine::geometry::recompute_vertex_normals(rest);
+    ASSERT_EQ(rest.rest_normals.size(), rest.normals.size());
+    for (std::size_t vertex = 0; vertex < rest.normals.size(); ++vertex)
+    {
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            EXPECT_NEAR(rest.rest_normals[vertex][axis], rest.normals[vertex][axis], 1e-5F);
+        }
+    }
+
+    const auto frame = host.tick(0.016);
+    ASSERT_FALSE(frame.dispatch_report.execution_order.empty());
+    engine::geometry::SurfaceMesh skinned = host.current_mesh();
+    engine::geometry::recompute_vertex_normals(skinned);
+    ASSERT_EQ(skinned.normals.size(), host.current_mesh().normals.size());
+    for (std::size_t vertex = 0; vertex < skinned.normals.size(); ++vertex)
+    {
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            EXPECT_NEAR(host.current_mesh().normals[vertex][axis], skinned.normals[vertex][axis], 1e-4F);
+        }
+    }
+    host.shutdown();
+}
+
 TEST(RuntimeHost, AppliesLinearBlendSkinning) {
     engine::animation::AnimationClip clip{};
     clip.name = "skinning";